@@ -1,10 +1,11 @@
 #ifndef R2SAMPLER_H_INCLUDED
 #define R2SAMPLER_H_INCLUDED
 
+#include <stddef.h>
 #include <stdint.h>
 
 /* ライブラリバージョン */
-#define R2SAMPLER_VERSION 5
+#define R2SAMPLER_VERSION 6
 
 /* 最大のステージ数 */
 #define R2SAMPLER_MAX_NUM_STAGES 10
@@ -14,22 +15,82 @@
 #define R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(max_num_input_samples, input_rate, output_rate)\
     ((((max_num_input_samples) * (output_rate) + (output_rate) + (input_rate) - 1)) / (input_rate))
 
+/* 可変レート変換で入力に対して必要になる最大のサンプル数計算 */
+/* 入力サンプル * 最大変換比 に、内部の小数位置の端数による増分を加算 */
+#define R2SAMPLER_VARIABLE_RATE_MAX_NUM_OUTPUT_SAMPLES(max_num_input_samples, max_ratio)\
+    ((uint32_t)((max_num_input_samples) * (max_ratio)) + 2)
+
 /* （ローパス）フィルタタイプ */
 typedef enum R2samplerFilterType {
     R2SAMPLER_FILTERTYPE_NONE = 0,           /* フィルタを適用しない */
     R2SAMPLER_FILTERTYPE_LPF_HANNWINDOW,     /* Hann窓によるLPF */
     R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW, /* Blackman窓によるLPF */
     R2SAMPLER_FILTERTYPE_LPF_NUTTALLWINDOW,  /* Nuttall窓によるLPF */
-    R2SAMPLER_FILTERTYPE_LPF_BLACKMANNUTTALLWINDOW /* Blackman-Nuttall窓によるLPF */
+    R2SAMPLER_FILTERTYPE_LPF_BLACKMANNUTTALLWINDOW, /* Blackman-Nuttall窓によるLPF */
+    R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW,   /* カイザー窓によるLPF（阻止域減衰量と遷移帯域幅から設計） */
+    R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE,     /* Parks-McClellan法による等リップルLPF（阻止域減衰量と遷移帯域幅から設計） */
+    R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES    /* 重み付き最小二乗法によるLPF（阻止域減衰量と遷移帯域幅, 帯域の重みから設計） */
 } R2samplerFilterType;
 
+/* 畳み込みの計算方法 */
+typedef enum R2samplerConvolutionMethod {
+    R2SAMPLER_CONVOLUTION_DIRECT = 0,   /* 出力サンプル毎に直接畳み込み */
+    R2SAMPLER_CONVOLUTION_FFT           /* FFTによるブロック単位の高速畳み込み（overlap-save法. 補間率が小さく1位相あたりのタップ数が長いときに有効） */
+} R2samplerConvolutionMethod;
+
+/* フィルタの位相特性 */
+typedef enum R2samplerFilterPhase {
+    R2SAMPLER_FILTERPHASE_LINEAR = 0,   /* 線形位相（波形を保つが群遅延はフィルタ次数の半分） */
+    R2SAMPLER_FILTERPHASE_MINIMUM       /* 最小位相（振幅特性は線形位相と同じで群遅延が短い. モニタリング等の低遅延用途向け） */
+} R2samplerFilterPhase;
+
+/* メモリ使用量の方針 */
+typedef enum R2samplerMemoryMode {
+    R2SAMPLER_MEMORYMODE_NORMAL = 0,    /* 最大入力サンプル数分をまとめて処理（内部バッファは最大入力サンプル数に比例） */
+    R2SAMPLER_MEMORYMODE_COMPACT        /* 内部で小さなブロックに分けて処理し、内部バッファをフィルタ長と分割したブロック長に合わせる（呼び出しあたりの処理は増える） */
+} R2samplerMemoryMode;
+
+/* ワークサイズの内訳（バイト数. 各項目の合計がワークサイズに一致） */
+struct R2samplerWorkSizeBreakdown {
+    int32_t coefficients; /* フィルタ係数とそのスペクトル（係数テーブル・キャッシュを参照する分は含まない） */
+    int32_t history; /* フィルタの遅延バッファ（入力サンプルの履歴） */
+    int32_t staging; /* ステージ間・入出力の受け渡しバッファとFFTによる畳み込みの作業領域 */
+    int32_t design; /* フィルタ設計用の作業領域（作成時のみ使用） */
+    int32_t other; /* ハンドル本体とアラインメントの余白 */
+    int32_t total; /* 合計 */
+};
+
+/* フィルタ係数キャッシュハンドル */
+struct R2samplerFilterCache;
+
+/* メモリ確保関数: alignmentバイト境界に揃えたsizeバイトの領域を返す（失敗時はNULL） */
+typedef void *(*R2samplerAllocFunction)(size_t size, size_t alignment, void *context);
+
+/* メモリ解放関数: R2samplerAllocFunctionで確保した領域を解放 */
+typedef void (*R2samplerFreeFunction)(void *ptr, void *context);
+
+/* メモリアロケータ（ワーク領域を渡さずにハンドルを作成した際に使用） */
+struct R2samplerAllocator {
+    R2samplerAllocFunction alloc;
+    R2samplerFreeFunction free;
+    void *context; /* alloc, freeに渡す引数 */
+};
+
 /* レート変換器生成コンフィグ */
 struct R2samplerRateConverterConfig {
     uint32_t max_num_input_samples;
     uint32_t input_rate;
     uint32_t output_rate;
     R2samplerFilterType filter_type;
-    uint32_t filter_order; /* 奇数 */
+    uint32_t filter_order; /* 奇数（カイザー窓・等リップル・最小二乗の場合は0を指定すると減衰量と遷移帯域幅から次数を自動決定） */
+    double stopband_attenuation; /* 阻止域減衰量[dB]（カイザー窓・等リップル・最小二乗で使用. 最小二乗では阻止域の平均電力の減衰量） */
+    double transition_width; /* 遷移帯域幅（入出力で低い方のナイキスト周波数に対する比, 0より大きく1未満. カイザー窓・等リップル・最小二乗で使用） */
+    double stopband_weight; /* 通過域の重みを1としたときの阻止域の重み（最小二乗で使用. 正値） */
+    struct R2samplerFilterCache *filter_cache; /* 係数を共有するキャッシュ（NULLの場合はハンドル毎に係数を保持） */
+    R2samplerConvolutionMethod convolution_method; /* 畳み込みの計算方法 */
+    R2samplerFilterPhase filter_phase; /* フィルタの位相特性 */
+    R2samplerMemoryMode memory_mode; /* メモリ使用量の方針 */
+    const struct R2samplerAllocator *allocator; /* ワーク領域を自前確保する際のアロケータ（NULLの場合はグローバルに設定したもの） */
 };
 
 /* マルチステージレート変換器生成コンフィグ */
@@ -38,6 +99,35 @@ struct R2samplerMultiStageRateConverterConfig {
     uint32_t max_num_stages;
 };
 
+/* マルチチャンネルレート変換器生成コンフィグ */
+struct R2samplerMultiChannelRateConverterConfig {
+    struct R2samplerMultiStageRateConverterConfig multi_stage;
+    uint32_t num_channels;
+};
+
+/* 可変レート変換器生成コンフィグ */
+struct R2samplerVariableRateConverterConfig {
+    uint32_t max_num_input_samples;
+    uint32_t num_channels;
+    R2samplerFilterType filter_type; /* 窓関数によるLPFのみ */
+    uint32_t num_taps; /* 1出力サンプルあたりのタップ数（偶数） */
+    uint32_t num_phases; /* 窓付きsincテーブルのオーバーサンプル数 */
+    double min_ratio; /* 変換比（出力レート/入力レート）の下限 */
+    double max_ratio; /* 変換比（出力レート/入力レート）の上限 */
+    double ratio; /* 初期変換比（出力レート/入力レート） */
+    const struct R2samplerAllocator *allocator; /* ワーク領域を自前確保する際のアロケータ（NULLの場合はグローバルに設定したもの） */
+};
+
+/* フィルタ係数キャッシュ生成コンフィグ */
+struct R2samplerFilterCacheConfig {
+    uint32_t max_num_entries; /* 保持するフィルタの最大数（同時に使用するフィルタの種類数以上） */
+    uint32_t max_num_coefficients; /* 1フィルタあたりの最大係数数（フィルタ係数・ポリフェーズ係数・ハーフバンド係数の合計） */
+    void (*lock)(void *lock_context); /* 排他制御の開始（複数スレッドで共有する場合に指定. 不要ならNULL） */
+    void (*unlock)(void *lock_context); /* 排他制御の終了（lockと共に指定） */
+    void *lock_context; /* lock, unlockに渡す引数 */
+    const struct R2samplerAllocator *allocator; /* ワーク領域を自前確保する際のアロケータ（NULLの場合はグローバルに設定したもの） */
+};
+
 /* API結果型 */
 typedef enum R2samplerRateConverterApiResult {
     R2SAMPLERRATECONVERTER_APIRESULT_OK = 0,
@@ -53,13 +143,43 @@ struct R2samplerRateConverter;
 /* マルチステージレート変換器ハンドル */
 struct R2samplerMultiStageRateConverter;
 
+/* マルチチャンネルレート変換器ハンドル */
+struct R2samplerMultiChannelRateConverter;
+
+/* 可変レート変換器ハンドル */
+struct R2samplerVariableRateConverter;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
+/* ワーク領域を自前確保する際に使用するアロケータをグローバルに設定（NULLを指定するとmalloc/freeに戻す）
+ * ハンドル作成と並行して呼ばないこと。作成済みのハンドルは作成時のアロケータで解放される */
+R2samplerRateConverterApiResult R2sampler_SetAllocator(const struct R2samplerAllocator *allocator);
+
+/* フィルタ係数キャッシュ作成に必要なワークサイズ計算 */
+int32_t R2samplerFilterCache_CalculateWorkSize(const struct R2samplerFilterCacheConfig *config);
+
+/* フィルタ係数キャッシュ作成
+ * 同じキャッシュを指定して作成したハンドル間で同一設定のフィルタ係数を共有する
+ * キャッシュは参照する全てのハンドルを破棄した後に破棄すること */
+struct R2samplerFilterCache *R2samplerFilterCache_Create(
+        const struct R2samplerFilterCacheConfig *config, void *work, int32_t work_size);
+
+/* フィルタ係数キャッシュ破棄 */
+void R2samplerFilterCache_Destroy(struct R2samplerFilterCache *cache);
+
+/* レート変換器生成コンフィグを既定値で初期化
+ * 最大入力サンプル数・入出力レートは0になるため、作成前に設定すること */
+R2samplerRateConverterApiResult R2samplerRateConverter_InitializeConfig(struct R2samplerRateConverterConfig *config);
+
 /* レート変換器作成に必要なワークサイズ計算 */
 int32_t R2samplerRateConverter_CalculateWorkSize(const struct R2samplerRateConverterConfig *config);
 
+/* レート変換器作成に必要なワークサイズの内訳を計算 */
+R2samplerRateConverterApiResult R2samplerRateConverter_CalculateWorkSizeBreakdown(
+        const struct R2samplerRateConverterConfig *config, struct R2samplerWorkSizeBreakdown *breakdown);
+
 /* レート変換器作成 */
 struct R2samplerRateConverter *R2samplerRateConverter_Create(
         const struct R2samplerRateConverterConfig *config, void *work, int32_t work_size);
@@ -76,9 +196,31 @@ R2samplerRateConverterApiResult R2samplerRateConverter_Process(
         const float *input, uint32_t num_input_samples,
         float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples);
 
+/* 通過域（直流）の群遅延を出力サンプル単位で取得（線形位相では(フィルタ次数 - 1) / 2 / ダウンレート） */
+R2samplerRateConverterApiResult R2samplerRateConverter_GetLatency(
+        const struct R2samplerRateConverter *converter, double *latency);
+
+/* 通過域（直流）の群遅延を入力サンプル単位で取得 */
+R2samplerRateConverterApiResult R2samplerRateConverter_GetInputLatency(
+        const struct R2samplerRateConverter *converter, double *latency);
+
+/* 入力終了後に内部に残っているサンプルを出力（ドレイン）
+ * 最後の入力サンプルが群遅延だけ遅れて現れる出力まで、呼び出しごとに出力する。出力サンプル数が0になったら終了
+ * 1回の出力は最大入力サンプル数を処理したときの出力サンプル数を超えない。処理を再開する場合はStartを呼ぶこと */
+R2samplerRateConverterApiResult R2samplerRateConverter_Drain(
+        struct R2samplerRateConverter *converter,
+        float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples);
+
+/* マルチステージレート変換器生成コンフィグを既定値で初期化（ステージ数の上限は最大） */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_InitializeConfig(struct R2samplerMultiStageRateConverterConfig *config);
+
 /* マルチステージレート変換器作成に必要なワークサイズ計算 */
 int32_t R2samplerMultiStageRateConverter_CalculateWorkSize(const struct R2samplerMultiStageRateConverterConfig *config);
 
+/* マルチステージレート変換器作成に必要なワークサイズの内訳を計算（全ステージの合計） */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_CalculateWorkSizeBreakdown(
+        const struct R2samplerMultiStageRateConverterConfig *config, struct R2samplerWorkSizeBreakdown *breakdown);
+
 /* マルチステージレート変換器作成 */
 struct R2samplerMultiStageRateConverter *R2samplerMultiStageRateConverter_Create(
         const struct R2samplerMultiStageRateConverterConfig *config, void *work, int32_t work_size);
@@ -89,12 +231,106 @@ void R2samplerMultiStageRateConverter_Destroy(struct R2samplerMultiStageRateConv
 /* マルチステージレート変換開始（内部バッファリセット） */
 R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_Start(struct R2samplerMultiStageRateConverter *converter);
 
+/* 各ステージのフィルタ次数を取得 */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_GetStageFilterOrders(
+        const struct R2samplerMultiStageRateConverter *converter,
+        uint32_t *filter_orders, uint32_t max_num_stages, uint32_t *num_stages);
+
+/* 全ステージを合わせた通過域の群遅延を出力サンプル単位で取得 */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_GetLatency(
+        const struct R2samplerMultiStageRateConverter *converter, double *latency);
+
+/* 全ステージを合わせた通過域の群遅延を入力サンプル単位で取得 */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_GetInputLatency(
+        const struct R2samplerMultiStageRateConverter *converter, double *latency);
+
 /* レート変換 */
 R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_Process(
         struct R2samplerMultiStageRateConverter *converter,
         const float *input, uint32_t num_input_samples,
         float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples);
 
+/* 入力終了後に全ステージに残っているサンプルを出力（ドレイン）
+ * 出力サンプル数が0になるまで繰り返し呼び出す。出力バッファにはProcessと同じサイズが必要 */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_Drain(
+        struct R2samplerMultiStageRateConverter *converter,
+        float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples);
+
+/* マルチチャンネルレート変換器生成コンフィグを既定値で初期化（1チャンネル） */
+R2samplerRateConverterApiResult R2samplerMultiChannelRateConverter_InitializeConfig(struct R2samplerMultiChannelRateConverterConfig *config);
+
+/* マルチチャンネルレート変換器作成に必要なワークサイズ計算 */
+int32_t R2samplerMultiChannelRateConverter_CalculateWorkSize(const struct R2samplerMultiChannelRateConverterConfig *config);
+
+/* マルチチャンネルレート変換器作成に必要なワークサイズの内訳を計算 */
+R2samplerRateConverterApiResult R2samplerMultiChannelRateConverter_CalculateWorkSizeBreakdown(
+        const struct R2samplerMultiChannelRateConverterConfig *config, struct R2samplerWorkSizeBreakdown *breakdown);
+
+/* マルチチャンネルレート変換器作成 */
+struct R2samplerMultiChannelRateConverter *R2samplerMultiChannelRateConverter_Create(
+        const struct R2samplerMultiChannelRateConverterConfig *config, void *work, int32_t work_size);
+
+/* マルチチャンネルレート変換器破棄 */
+void R2samplerMultiChannelRateConverter_Destroy(struct R2samplerMultiChannelRateConverter *converter);
+
+/* マルチチャンネルレート変換開始（内部バッファリセット） */
+R2samplerRateConverterApiResult R2samplerMultiChannelRateConverter_Start(struct R2samplerMultiChannelRateConverter *converter);
+
+/* 通過域の群遅延を出力サンプル単位で取得（全チャンネル共通） */
+R2samplerRateConverterApiResult R2samplerMultiChannelRateConverter_GetLatency(
+        const struct R2samplerMultiChannelRateConverter *converter, double *latency);
+
+/* 通過域の群遅延を入力サンプル単位で取得（全チャンネル共通） */
+R2samplerRateConverterApiResult R2samplerMultiChannelRateConverter_GetInputLatency(
+        const struct R2samplerMultiChannelRateConverter *converter, double *latency);
+
+/* マルチチャンネルレート変換
+ * チャンネルchのi番目のサンプルは input[ch * input_channel_stride + i * input_sample_stride] を参照し、
+ * output_buffer[ch * output_channel_stride + i * output_sample_stride] に書き出す
+ * インターリーブ: channel_stride = 1, sample_stride = チャンネル数
+ * プレーナ: channel_stride = 1チャンネルあたりのサンプル数, sample_stride = 1 */
+R2samplerRateConverterApiResult R2samplerMultiChannelRateConverter_Process(
+        struct R2samplerMultiChannelRateConverter *converter,
+        const float *input, uint32_t input_channel_stride, uint32_t input_sample_stride, uint32_t num_input_samples,
+        float *output_buffer, uint32_t output_channel_stride, uint32_t output_sample_stride,
+        uint32_t num_buffer_samples, uint32_t *num_output_samples);
+
+/* 入力終了後に内部に残っているサンプルを出力（ドレイン）
+ * 出力の形式はProcessと同じ。出力サンプル数が0になるまで繰り返し呼び出す */
+R2samplerRateConverterApiResult R2samplerMultiChannelRateConverter_Drain(
+        struct R2samplerMultiChannelRateConverter *converter,
+        float *output_buffer, uint32_t output_channel_stride, uint32_t output_sample_stride,
+        uint32_t num_buffer_samples, uint32_t *num_output_samples);
+
+/* 可変レート変換器作成に必要なワークサイズ計算 */
+int32_t R2samplerVariableRateConverter_CalculateWorkSize(const struct R2samplerVariableRateConverterConfig *config);
+
+/* 可変レート変換器作成 */
+struct R2samplerVariableRateConverter *R2samplerVariableRateConverter_Create(
+        const struct R2samplerVariableRateConverterConfig *config, void *work, int32_t work_size);
+
+/* 可変レート変換器破棄 */
+void R2samplerVariableRateConverter_Destroy(struct R2samplerVariableRateConverter *converter);
+
+/* 可変レート変換開始（内部バッファと変換比をリセット） */
+R2samplerRateConverterApiResult R2samplerVariableRateConverter_Start(struct R2samplerVariableRateConverter *converter);
+
+/* 変換比（出力レート/入力レート）を設定
+ * num_transition_samples出力サンプルかけて現在の変換比から線形に遷移する（0の場合は即時に切り替え） */
+R2samplerRateConverterApiResult R2samplerVariableRateConverter_SetRatio(
+        struct R2samplerVariableRateConverter *converter, double ratio, uint32_t num_transition_samples);
+
+/* 現在の変換比（出力レート/入力レート）を取得 */
+R2samplerRateConverterApiResult R2samplerVariableRateConverter_GetRatio(
+        const struct R2samplerVariableRateConverter *converter, double *ratio);
+
+/* 可変レート変換 入出力はチャンネルインターリーブ
+ * 出力バッファにはR2SAMPLER_VARIABLE_RATE_MAX_NUM_OUTPUT_SAMPLES(num_input_samples, max_ratio)サンプル以上が必要 */
+R2samplerRateConverterApiResult R2samplerVariableRateConverter_Process(
+        struct R2samplerVariableRateConverter *converter,
+        const float *input, uint32_t num_input_samples,
+        float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
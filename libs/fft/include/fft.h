@@ -1,16 +1,27 @@
 #ifndef FFT_H_INCLUDED
 #define FFT_H_INCLUDED
 
+#include <stdint.h>
+
 /* 複素数アクセスマクロ */
 #define FFTCOMPLEX_REAL(flt_array, i) ((flt_array)[((i) << 1)])
 #define FFTCOMPLEX_IMAG(flt_array, i) ((flt_array)[((i) << 1) + 1])
 
+/* FFTプラン生成コンフィグ */
+struct FFTPlanConfig {
+    uint32_t fft_size; /* 変換長（2^a 3^b 5^c 7^d. 因数7の段はスカラー演算のみ. 複素FFTは複素数の個数, 実数列のFFTは実数の個数で偶数であること） */
+    uint32_t max_batch_size; /* 一括変換でまとめて処理する最大の系列数（1以上. 短い変換長では系列数分の作業領域を確保する） */
+};
+
+/* FFTプラン（回転因子と作業領域を保持し、同じ長さの変換を三角関数の計算なしで行う） */
+struct FFTPlan;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /* FFT 正規化は行いません
-* n 系列長
+* n 系列長(2の冪)
 * flag -1:FFT, 1:IFFT
 * x フーリエ変換する系列(入出力 2nサイズ必須, 偶数番目に実数部, 奇数番目に虚数部)
 * y 作業用配列(xと同一サイズ)
@@ -18,13 +29,60 @@ extern "C" {
 void FFT_FloatFFT(int n, int flag, float *x, float *y);
 
 /* 実数列のFFT 正規化は行いません 正規化定数は2/n
-* n 系列長
+* n 系列長(2の冪)
 * flag -1:FFT, 1:IFFT
-* x フーリエ変換する系列(入出力 nサイズ必須, FFTの場合, x[0]に直流成分の実部, x[1]に最高周波数成分の虚数部が入る)
+* x フーリエ変換する系列(入出力 nサイズ必須, FFTの場合, x[0]に直流成分の実部, x[1]に最高周波数成分の実部が入る)
 * y 作業用配列(xと同一サイズ)
 */
 void FFT_RealFFT(int n, int flag, float *x, float *y);
 
+/* FFTプラン作成に必要なワークサイズ計算 */
+int32_t FFTPlan_CalculateWorkSize(const struct FFTPlanConfig *config);
+
+/* min_size以上で最小の高速に変換できる変換長（偶数の2^a 3^b 5^c）を計算 求まらない場合は0を返す */
+uint32_t FFTPlan_CalculateFastSize(uint32_t min_size);
+
+/* FFTプラン作成 */
+struct FFTPlan *FFTPlan_Create(const struct FFTPlanConfig *config, void *work, int32_t work_size);
+
+/* FFTプラン破棄 */
+void FFTPlan_Destroy(struct FFTPlan *plan);
+
+/* プランを使用したFFT 正規化は行いません
+* flag -1:FFT, 1:IFFT
+* x フーリエ変換する系列(入出力 2*fft_sizeサイズ必須, 偶数番目に実数部, 奇数番目に虚数部)
+* 注意）プランの作業領域を使うため、同じプランを複数スレッドから同時に使用しないこと
+*/
+void FFTPlan_FloatFFT(struct FFTPlan *plan, int flag, float *x);
+
+/* プランを使用した実数列のFFT 正規化は行いません 正規化定数は2/fft_size
+* fft_sizeは偶数であること
+* flag -1:FFT, 1:IFFT
+* x フーリエ変換する系列(入出力 fft_sizeサイズ必須, 配置はFFT_RealFFTと同じ)
+* 注意）プランの作業領域を使うため、同じプランを複数スレッドから同時に使用しないこと
+*/
+void FFTPlan_RealFFT(struct FFTPlan *plan, int flag, float *x);
+
+/* プランを使用した複数系列の一括FFT 正規化は行いません
+* 長さの等しい系列を最大max_batch_size個ずつまとめて変換する（短い変換長では系列方向にベクトル化する）
+* flag -1:FFT, 1:IFFT
+* x フーリエ変換する系列(入出力 b番目の系列はx[b * signal_stride]から始まり, 配置はFFTPlan_FloatFFTと同じ)
+* num_signals 系列数
+* signal_stride 系列の先頭の間隔(2*fft_size以上)
+* 注意）プランの作業領域を使うため、同じプランを複数スレッドから同時に使用しないこと
+*/
+void FFTPlan_FloatFFTBatch(struct FFTPlan *plan, int flag, float *x, uint32_t num_signals, uint32_t signal_stride);
+
+/* プランを使用した複数の実数列の一括FFT 正規化は行いません 正規化定数は2/fft_size
+* fft_sizeは偶数であること
+* flag -1:FFT, 1:IFFT
+* x フーリエ変換する系列(入出力 b番目の系列はx[b * signal_stride]から始まり, 配置はFFTPlan_RealFFTと同じ)
+* num_signals 系列数
+* signal_stride 系列の先頭の間隔(fft_size以上)
+* 注意）プランの作業領域を使うため、同じプランを複数スレッドから同時に使用しないこと
+*/
+void FFTPlan_RealFFTBatch(struct FFTPlan *plan, int flag, float *x, uint32_t num_signals, uint32_t signal_stride);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,4 +1,5 @@
 #include "fft.h"
+#include "fft_kernel.h"
 
 #include <string.h>
 #include <math.h>
@@ -6,6 +7,20 @@
 
 /* 円周率 */
 #define _PI 3.14159265358979323846
+/* メモリアラインメント */
+#define FFT_ALIGNMENT 16
+/* 最小値の選択 */
+#define FFT_MIN(a, b) (((a) < (b)) ? (a) : (b))
+/* nの倍数への切り上げ */
+#define FFT_ROUNDUP(val, n) ((((val) + ((n) - 1)) / (n)) * (n))
+/* 系列を交互に並べて一括変換する最大の変換長（複素数の個数）
+* これより長い系列は段ごとのベクトル化が十分に効き、並べ替えずに1系列ずつ変換した方が局所性が高く速い */
+#define FFT_MAX_INTERLEAVED_BATCH_SIZE 16
+/* 交互に並べて一括変換する系列数（実数列のFFTは半分の長さの複素FFTを使うのでその長さで判定） */
+#define FFT_NUM_INTERLEAVED_BATCHES(fft_size, max_batch_size)\
+    (((fft_size) <= (2 * FFT_MAX_INTERLEAVED_BATCH_SIZE)) ? (max_batch_size) : 1)
+/* 因数の最大数（2^31未満の変換長は高々31個の因数に分解される） */
+#define FFT_MAX_NUM_FACTORS 32
 
 /* 複素数型 */
 typedef struct FFTComplex {
@@ -13,6 +28,24 @@ typedef struct FFTComplex {
     float imag; /* 虚部 */
 } FFTComplex;
 
+/* 変換長の因数分解結果（各段の基数） */
+struct FFTFactors {
+    uint32_t num_factors;
+    uint8_t factors[FFT_MAX_NUM_FACTORS];
+};
+
+/* FFTプラン */
+struct FFTPlan {
+    uint32_t fft_size; /* 変換長 */
+    FFTComplex *twiddle; /* 回転因子テーブル exp(-2πik/fft_size), 0 <= k < fft_size */
+    uint32_t num_interleaved_batches; /* 一括変換で交互に並べて同時に変換する系列数 */
+    float *work; /* 作業用配列（複素数fft_size * num_interleaved_batches分） */
+    float *batch_work; /* 一括変換で系列を並べ替えて格納する配列（複素数fft_size * num_interleaved_batches分, 並べ替えない場合はNULL） */
+    struct FFTFactors factors; /* 複素FFT（長さfft_size）の段構成 */
+    struct FFTFactors half_factors; /* 実数列のFFTで使う長さfft_size/2の複素FFTの段構成 */
+    struct FFTKernel kernel; /* 演算カーネル */
+};
+
 /* FFT 正規化は行いません
 * n 系列長
 * flag -1:FFT, 1:IFFT
@@ -71,13 +104,13 @@ static void FFT_ComplexFFT(int n, const int flag, FFTComplex *x, FFTComplex *y)
         const int n2 = (n >> 1);
         const int n3 = n1 + n2;
         const float theta0 = (float)(2.0 * _PI / n);
-        FFTComplex j, wdelta;
-        j.real = 0.0; j.imag = flag;
-        wdelta.real = cosf(theta0); wdelta.imag = -flag * sinf(theta0);
+        FFTComplex j;
+        j.real = 0.0; j.imag = -flag;
         for (p = 0; p < n1; p++) {
-            const FFTComplex w1p = { cosf(p * theta0), flag * sinf(p * theta0) };
-            const FFTComplex w2p = FFTComplex_Mul(w1p, w1p);
-            const FFTComplex w3p = FFTComplex_Mul(w1p, w2p);
+            FFTComplex w1p, w2p, w3p;
+            w1p.real = (float)cos(p * theta0); w1p.imag = (float)(flag * sin(p * theta0));
+            w2p = FFTComplex_Mul(w1p, w1p);
+            w3p = FFTComplex_Mul(w1p, w2p);
             for (q = 0; q < s; q++) {
                 const FFTComplex    a = x[q + s * (p +  0)];
                 const FFTComplex    b = x[q + s * (p + n1)];
@@ -114,44 +147,127 @@ static void FFT_ComplexFFT(int n, const int flag, FFTComplex *x, FFTComplex *y)
     }
 }
 
-/* FFT 正規化は行いません
-* n 系列長
+/* 変換長を各段の基数に分解 分解できない場合は0を返す
+* 基数4の段を先に、基数3・5・7の段を続け、残った基数2の段を最後に置く
+* （基数2の段は最終段でのみ現れるので回転因子が不要） */
+static uint8_t FFT_Factorize(uint32_t n, struct FFTFactors *factors)
+{
+    assert(factors != NULL);
+
+    factors->num_factors = 0;
+    while (n > 1) {
+        uint8_t radix;
+        if ((n % 4) == 0) {
+            radix = 4;
+        } else if ((n % 3) == 0) {
+            radix = 3;
+        } else if ((n % 5) == 0) {
+            radix = 5;
+        } else if ((n % 7) == 0) {
+            radix = 7;
+        } else if (n == 2) {
+            radix = 2;
+        } else {
+            return 0;
+        }
+        assert(factors->num_factors < FFT_MAX_NUM_FACTORS);
+        factors->factors[factors->num_factors++] = radix;
+        n /= radix;
+    }
+
+    return 1;
+}
+
+/* プランの回転因子テーブルと演算カーネルを使用したFFTの全段を実行 正規化は行いません
+* factors 系列長の分解結果
 * flag -1:FFT, 1:IFFT
-* x フーリエ変換する系列(入出力 2nサイズ必須, 偶数番目に実数部, 奇数番目に虚数部)
+* x フーリエ変換する系列(入力 作業用に上書きされる. num_batch個の系列をx[b + num_batch * i]の順に並べる)
 * y 作業用配列(xと同一サイズ)
+* n 系列長
+* num_batch 同時に変換する系列数
+* 戻り値 結果が格納された配列（段数によりxかyのいずれか）
 */
-void FFT_FloatFFT(int n, const int flag, float *x, float *y)
+static const FFTComplex *FFT_ComplexFFTStages(const struct FFTPlan *plan, const struct FFTFactors *factors,
+        const int flag, FFTComplex *x, FFTComplex *y, int n, int num_batch)
 {
-    FFT_ComplexFFT(n, flag, (FFTComplex *)x, (FFTComplex *)y);
+    uint32_t i;
+    FFTComplex *tmp;
+    const float *twiddle = (const float *)plan->twiddle;
+    /* 現在の段のストライド 系列を交互に並べているので初段は系列数から始まり、
+    * 各段は全系列で同じ回転因子を使う */
+    int s = num_batch;
+
+    /* 混合基数 Stockham FFT */
+    for (i = 0; i < factors->num_factors; i++) {
+        /* w = exp(flag 2πj / n) はテーブルの(テーブル長/n)間隔で参照 */
+        const int twiddle_stride = (int)plan->fft_size / n;
+        switch (factors->factors[i]) {
+        case 4:
+            plan->kernel.radix4_stage(n, s, flag, (const float *)x, (float *)y, twiddle, twiddle_stride);
+            break;
+        case 3:
+            plan->kernel.radix3_stage(n, s, flag, (const float *)x, (float *)y, twiddle, twiddle_stride);
+            break;
+        case 5:
+            plan->kernel.radix5_stage(n, s, flag, (const float *)x, (float *)y, twiddle, twiddle_stride);
+            break;
+        case 7:
+            plan->kernel.radix7_stage(n, s, flag, (const float *)x, (float *)y, twiddle, twiddle_stride);
+            break;
+        case 2:
+            assert(n == 2);
+            plan->kernel.radix2_stage(s, (const float *)x, (float *)y);
+            break;
+        default:
+            assert(0);
+        }
+        n /= factors->factors[i];
+        s *= factors->factors[i];
+        tmp = x; x = y; y = tmp;
+    }
+
+    return x;
 }
 
-/* 実数列のFFT 正規化は行いません 正規化定数は2/n
-* n 系列長
+/* プランの回転因子テーブルと演算カーネルを使用したFFT 正規化は行いません
+* factors 系列長の分解結果
 * flag -1:FFT, 1:IFFT
-* x フーリエ変換する系列(入出力 nサイズ必須, FFTの場合, x[0]に直流成分の実部, x[1]に最高周波数成分の虚数部が入る)
+* x フーリエ変換する系列(入出力)
 * y 作業用配列(xと同一サイズ)
+* n 系列長
 */
-void FFT_RealFFT(int n, const int flag, float *x, float *y)
+static void FFT_ComplexFFTWithPlan(const struct FFTPlan *plan, const struct FFTFactors *factors,
+        const int flag, FFTComplex *x, FFTComplex *y, int n)
+{
+    const FFTComplex *result = FFT_ComplexFFTStages(plan, factors, flag, x, y, n, 1);
+    if (result != x) {
+        memcpy(x, result, sizeof(FFTComplex) * (size_t)n);
+    }
+}
+
+/* 実数列のFFTで、半分の長さの複素FFTの結果と実数列のスペクトルを相互に変換
+* n 系列長
+* flag -1:複素FFTの結果をスペクトルに整理, 1:スペクトルを複素IFFTの入力に整理
+* x 処理する系列(入出力)
+* plan 回転因子テーブルを持つプラン(NULLの場合は回転因子をその場で計算)
+*/
+static void FFT_RealFFTSplit(const struct FFTPlan *plan, int n, const int flag, float *x)
 {
     int i;
-    const float theta = (float)(-flag * 2.0 * _PI / n);
-    const float wpi = sinf(theta);
-    const float wpr = cosf(theta) - 1.0f;
+    const float theta = (float)(flag * 2.0 * _PI / n);
+    const float wpi = (float)sin(theta);
+    const float wpr = (float)cos(theta) - 1.0f;
     const float c2 = (float)flag * 0.5f;
     float wr, wi, wtmp;
 
-    /* FFTの場合は先に順変換 */
-    if (flag == -1) {
-        FFT_FloatFFT(n >> 1, -1, x, y);
-    }
-
     /* 回転因子初期化 */
     wr = 1.0f + wpr;
     wi = wpi;
 
     /* スペクトルの対称性を使用し */
     /* FFTの場合は最終結果をまとめ、IFFTの場合は元に戻るよう整理 */
-    for (i = 1; i < (n >> 2); i++) {
+    /* i番目とn/2-i番目の成分を組にして処理する */
+    for (i = 1; (i << 2) < n; i++) {
         const int i1 = (i << 1);
         const int i2 = i1 + 1;
         const int i3 = n - i1;
@@ -160,14 +276,26 @@ void FFT_RealFFT(int n, const int flag, float *x, float *y)
         const float h1i = 0.5f * (x[i2] - x[i4]);
         const float h2r =  -c2 * (x[i2] + x[i4]);
         const float h2i =   c2 * (x[i1] - x[i3]);
+        if (plan != NULL) {
+            /* テーブルは順変換の符号なので逆変換では共役をとる */
+            wr = plan->twiddle[i].real;
+            wi = (flag == -1) ? plan->twiddle[i].imag : -plan->twiddle[i].imag;
+        }
         x[i1] =  h1r + (wr * h2r) - (wi * h2i);
         x[i2] =  h1i + (wr * h2i) + (wi * h2r);
         x[i3] =  h1r - (wr * h2r) + (wi * h2i);
         x[i4] = -h1i + (wr * h2i) + (wi * h2r);
         /* 回転因子更新 */
-        wtmp = wr;
-        wr += wtmp * wpr - wi * wpi;
-        wi += wi * wpr + wtmp * wpi;
+        if (plan == NULL) {
+            wtmp = wr;
+            wr += wtmp * wpr - wi * wpi;
+            wi += wi * wpr + wtmp * wpi;
+        }
+    }
+
+    /* n/4番目の成分は対になる成分が自身なので共役をとるだけ */
+    if ((n >= 4) && ((n % 4) == 0)) {
+        x[(n >> 1) + 1] = -x[(n >> 1) + 1];
     }
 
     /* 直流成分/最高周波数成分 */
@@ -179,7 +307,297 @@ void FFT_RealFFT(int n, const int flag, float *x, float *y)
         } else {
             x[0] = 0.5f * (h1r + x[1]);
             x[1] = 0.5f * (h1r - x[1]);
-            FFT_FloatFFT(n >> 1, 1, x, y);
+        }
+    }
+}
+
+/* 実数列のFFT 正規化は行いません
+* n 系列長
+* flag -1:FFT, 1:IFFT
+* x フーリエ変換する系列(入出力)
+* y 作業用配列(xと同一サイズ)
+* plan 回転因子テーブルと演算カーネルを持つプラン(NULLの場合は回転因子をその場で計算)
+*/
+static void FFT_RealFFTCore(const struct FFTPlan *plan, int n, const int flag, float *x, float *y)
+{
+    /* FFTの場合は先に順変換、IFFTの場合は整理した後に逆変換 */
+    if (flag == 1) {
+        FFT_RealFFTSplit(plan, n, 1, x);
+    }
+    if (plan != NULL) {
+        FFT_ComplexFFTWithPlan(plan, &plan->half_factors, flag, (FFTComplex *)x, (FFTComplex *)y, n >> 1);
+    } else {
+        FFT_ComplexFFT(n >> 1, flag, (FFTComplex *)x, (FFTComplex *)y);
+    }
+    if (flag == -1) {
+        FFT_RealFFTSplit(plan, n, -1, x);
+    }
+}
+
+/* 一括変換のためnum_batch個の系列（複素数n個ずつ, signal_stride間隔）を交互に並べて格納 */
+static void FFT_GatherBatch(const float *x, uint32_t signal_stride, uint32_t num_batch, uint32_t n, FFTComplex *buffer)
+{
+    uint32_t b, i;
+    /* 書き込み側を連続にする */
+    for (i = 0; i < n; i++) {
+        for (b = 0; b < num_batch; b++) {
+            buffer[b + num_batch * i] = ((const FFTComplex *)&x[b * signal_stride])[i];
+        }
+    }
+}
+
+/* 交互に並べた一括変換の結果を各系列に戻す */
+static void FFT_ScatterBatch(const FFTComplex *buffer, uint32_t num_batch, uint32_t n, float *x, uint32_t signal_stride)
+{
+    uint32_t b, i;
+    for (b = 0; b < num_batch; b++) {
+        FFTComplex *px = (FFTComplex *)&x[b * signal_stride];
+        for (i = 0; i < n; i++) {
+            px[i] = buffer[b + num_batch * i];
+        }
+    }
+}
+
+/* FFT 正規化は行いません
+* n 系列長
+* flag -1:FFT, 1:IFFT
+* x フーリエ変換する系列(入出力 2nサイズ必須, 偶数番目に実数部, 奇数番目に虚数部)
+* y 作業用配列(xと同一サイズ)
+*/
+void FFT_FloatFFT(int n, const int flag, float *x, float *y)
+{
+    FFT_ComplexFFT(n, flag, (FFTComplex *)x, (FFTComplex *)y);
+}
+
+/* 実数列のFFT 正規化は行いません 正規化定数は2/n
+* n 系列長
+* flag -1:FFT, 1:IFFT
+* x フーリエ変換する系列(入出力 nサイズ必須, FFTの場合, x[0]に直流成分の実部, x[1]に最高周波数成分の実部が入る)
+* y 作業用配列(xと同一サイズ)
+*/
+void FFT_RealFFT(int n, const int flag, float *x, float *y)
+{
+    FFT_RealFFTCore(NULL, n, flag, x, y);
+}
+
+/* FFTプラン作成に必要なワークサイズ計算 */
+int32_t FFTPlan_CalculateWorkSize(const struct FFTPlanConfig *config)
+{
+    int32_t work_size;
+    uint32_t num_batches;
+
+    /* 引数チェック */
+    if (config == NULL) {
+        return -1;
+    }
+
+    /* 変換長は2以上で2・3・5・7以外の素因数を持たない */
+    {
+        struct FFTFactors factors;
+        if ((config->fft_size < 2) || (config->fft_size > INT32_MAX)
+                || !FFT_Factorize(config->fft_size, &factors)) {
+            return -1;
+        }
+    }
+
+    /* 一括変換する系列数は1以上で、作業領域サイズがint32_tに収まる */
+    if ((config->max_batch_size == 0)
+            || ((uint64_t)sizeof(FFTComplex) * config->fft_size * config->max_batch_size > INT32_MAX / 4)) {
+        return -1;
+    }
+
+    /* ハンドルサイズ */
+    work_size = sizeof(struct FFTPlan) + FFT_ALIGNMENT;
+
+    /* 回転因子テーブルサイズ */
+    work_size += (int32_t)(sizeof(FFTComplex) * config->fft_size + FFT_ALIGNMENT);
+
+    /* 作業用配列サイズ */
+    num_batches = FFT_NUM_INTERLEAVED_BATCHES(config->fft_size, config->max_batch_size);
+    work_size += (int32_t)(sizeof(FFTComplex) * config->fft_size * num_batches + FFT_ALIGNMENT);
+
+    /* 一括変換用の並べ替え領域サイズ */
+    if (num_batches > 1) {
+        work_size += (int32_t)(sizeof(FFTComplex) * config->fft_size * num_batches + FFT_ALIGNMENT);
+    }
+
+    return work_size;
+}
+
+/* min_size以上で最小の高速に変換できる変換長（偶数の2^a 3^b 5^c）を計算 */
+uint32_t FFTPlan_CalculateFastSize(uint32_t min_size)
+{
+    uint32_t best = 0;
+    uint64_t p3, p5, n;
+
+    /* 3^b 5^c を列挙し、それぞれ2の冪を掛けてmin_size以上の最小値を探す */
+    for (p5 = 1; p5 < 2 * (uint64_t)min_size + 2; p5 *= 5) {
+        for (p3 = p5; p3 < 2 * (uint64_t)min_size + 2; p3 *= 3) {
+            n = 2 * p3;
+            while (n < min_size) {
+                n <<= 1;
+            }
+            if ((n <= INT32_MAX) && ((best == 0) || (n < best))) {
+                best = (uint32_t)n;
+            }
+        }
+    }
+
+    return best;
+}
+
+/* FFTプラン作成 */
+struct FFTPlan *FFTPlan_Create(const struct FFTPlanConfig *config, void *work, int32_t work_size)
+{
+    uint32_t k;
+    struct FFTPlan *plan;
+    uint8_t *work_ptr;
+
+    /* 引数チェック */
+    if ((config == NULL) || (work == NULL) || (work_size < 0)) {
+        return NULL;
+    }
+
+    if ((FFTPlan_CalculateWorkSize(config) < 0) || (work_size < FFTPlan_CalculateWorkSize(config))) {
+        return NULL;
+    }
+
+    /* ハンドル領域割当 */
+    work_ptr = (uint8_t *)FFT_ROUNDUP((uintptr_t)work, FFT_ALIGNMENT);
+    plan = (struct FFTPlan *)work_ptr;
+    work_ptr += sizeof(struct FFTPlan);
+
+    plan->fft_size = config->fft_size;
+    plan->num_interleaved_batches = FFT_NUM_INTERLEAVED_BATCHES(config->fft_size, config->max_batch_size);
+
+    /* 各段の基数を決定 */
+    (void)FFT_Factorize(config->fft_size, &plan->factors);
+    plan->half_factors.num_factors = 0;
+    if ((config->fft_size % 2) == 0) {
+        (void)FFT_Factorize(config->fft_size / 2, &plan->half_factors);
+    }
+
+    /* 回転因子テーブル割当・計算 */
+    /* 長さnの段はテーブルを(r-1)p * (fft_size/n)番目まで参照するので1周分持つ */
+    work_ptr = (uint8_t *)FFT_ROUNDUP((uintptr_t)work_ptr, FFT_ALIGNMENT);
+    plan->twiddle = (FFTComplex *)work_ptr;
+    work_ptr += sizeof(FFTComplex) * config->fft_size;
+    for (k = 0; k < config->fft_size; k++) {
+        const double theta = 2.0 * _PI * k / config->fft_size;
+        plan->twiddle[k].real = (float)cos(theta);
+        plan->twiddle[k].imag = (float)-sin(theta);
+    }
+
+    /* 作業用配列割当 */
+    work_ptr = (uint8_t *)FFT_ROUNDUP((uintptr_t)work_ptr, FFT_ALIGNMENT);
+    plan->work = (float *)work_ptr;
+    work_ptr += sizeof(FFTComplex) * config->fft_size * plan->num_interleaved_batches;
+    plan->batch_work = NULL;
+    if (plan->num_interleaved_batches > 1) {
+        work_ptr = (uint8_t *)FFT_ROUNDUP((uintptr_t)work_ptr, FFT_ALIGNMENT);
+        plan->batch_work = (float *)work_ptr;
+        work_ptr += sizeof(FFTComplex) * config->fft_size * plan->num_interleaved_batches;
+    }
+
+    /* 実行環境で最速の演算カーネルを選択 */
+    FFTKernel_Select(&plan->kernel);
+
+    /* バッファオーバーランチェック */
+    assert((work_ptr - (uint8_t *)work) <= work_size);
+
+    return plan;
+}
+
+/* FFTプラン破棄 */
+void FFTPlan_Destroy(struct FFTPlan *plan)
+{
+    /* 領域は呼び出し側が管理するので特に何もしない */
+    (void)plan;
+}
+
+/* プランを使用したFFT 正規化は行いません */
+void FFTPlan_FloatFFT(struct FFTPlan *plan, int flag, float *x)
+{
+    assert((plan != NULL) && (x != NULL));
+    assert((flag == -1) || (flag == 1));
+    FFT_ComplexFFTWithPlan(plan, &plan->factors, flag,
+            (FFTComplex *)x, (FFTComplex *)plan->work, (int)plan->fft_size);
+}
+
+/* プランを使用した実数列のFFT 正規化は行いません 正規化定数は2/n */
+void FFTPlan_RealFFT(struct FFTPlan *plan, int flag, float *x)
+{
+    assert((plan != NULL) && (x != NULL));
+    assert((flag == -1) || (flag == 1));
+    assert((plan->fft_size % 2) == 0);
+    FFT_RealFFTCore(plan, (int)plan->fft_size, flag, x, plan->work);
+}
+
+/* プランを使用した複数系列の一括FFT 正規化は行いません */
+void FFTPlan_FloatFFTBatch(struct FFTPlan *plan, int flag, float *x, uint32_t num_signals, uint32_t signal_stride)
+{
+    uint32_t head, n, num_batch;
+
+    assert((plan != NULL) && (x != NULL));
+    assert((flag == -1) || (flag == 1));
+    n = plan->fft_size;
+    assert((num_signals <= 1) || (signal_stride >= 2 * n));
+
+    /* 長い系列は1系列ずつその場で変換 */
+    if ((plan->num_interleaved_batches == 1) || (n > FFT_MAX_INTERLEAVED_BATCH_SIZE)) {
+        for (head = 0; head < num_signals; head++) {
+            FFTPlan_FloatFFT(plan, flag, &x[head * signal_stride]);
+        }
+        return;
+    }
+
+    /* 短い系列は交互に並べて変換 全系列で回転因子の読み込みを共有し、系列方向にベクトル化される */
+    for (head = 0; head < num_signals; head += num_batch) {
+        float *px = &x[head * signal_stride];
+        num_batch = FFT_MIN(plan->num_interleaved_batches, num_signals - head);
+        FFT_GatherBatch(px, signal_stride, num_batch, n, (FFTComplex *)plan->batch_work);
+        FFT_ScatterBatch(FFT_ComplexFFTStages(plan, &plan->factors, flag,
+                    (FFTComplex *)plan->batch_work, (FFTComplex *)plan->work, (int)n, (int)num_batch),
+                num_batch, n, px, signal_stride);
+    }
+}
+
+/* プランを使用した複数の実数列の一括FFT 正規化は行いません 正規化定数は2/fft_size */
+void FFTPlan_RealFFTBatch(struct FFTPlan *plan, int flag, float *x, uint32_t num_signals, uint32_t signal_stride)
+{
+    uint32_t head, b, n, num_batch;
+
+    assert((plan != NULL) && (x != NULL));
+    assert((flag == -1) || (flag == 1));
+    n = plan->fft_size;
+    assert((n % 2) == 0);
+    assert((num_signals <= 1) || (signal_stride >= n));
+
+    /* 長い系列は1系列ずつその場で変換 */
+    if ((plan->num_interleaved_batches == 1) || ((n >> 1) > FFT_MAX_INTERLEAVED_BATCH_SIZE)) {
+        for (head = 0; head < num_signals; head++) {
+            FFTPlan_RealFFT(plan, flag, &x[head * signal_stride]);
+        }
+        return;
+    }
+
+    /* 長さn/2の複素FFTを交互に並べて一括で行い、前後の整理は系列ごとに行う */
+    for (head = 0; head < num_signals; head += num_batch) {
+        float *px = &x[head * signal_stride];
+        num_batch = FFT_MIN(plan->num_interleaved_batches, num_signals - head);
+        if (flag == 1) {
+            for (b = 0; b < num_batch; b++) {
+                FFT_RealFFTSplit(plan, (int)n, 1, &px[b * signal_stride]);
+            }
+        }
+        FFT_GatherBatch(px, signal_stride, num_batch, n >> 1, (FFTComplex *)plan->batch_work);
+        FFT_ScatterBatch(FFT_ComplexFFTStages(plan, &plan->half_factors, flag,
+                    (FFTComplex *)plan->batch_work, (FFTComplex *)plan->work, (int)(n >> 1), (int)num_batch),
+                num_batch, n >> 1, px, signal_stride);
+        if (flag == -1) {
+            for (b = 0; b < num_batch; b++) {
+                FFT_RealFFTSplit(plan, (int)n, -1, &px[b * signal_stride]);
+            }
         }
     }
 }
@@ -0,0 +1,693 @@
+#include "fft_kernel.h"
+
+#include <stddef.h>
+#include <assert.h>
+
+/* x86/x64 環境判定 */
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define FFTKERNEL_X86
+#endif
+
+/* NEON 環境判定 */
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define FFTKERNEL_NEON
+#endif
+
+/* 関数単位での命令セット指定（GCC/Clang） MSVCは指定なしで組み込み関数を使用可能 */
+#if defined(__GNUC__) || defined(__clang__)
+#define FFTKERNEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define FFTKERNEL_TARGET(isa)
+#endif
+
+#if defined(FFTKERNEL_X86)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(FFTKERNEL_NEON)
+#include <arm_neon.h>
+#endif
+
+/* 複素数配列のアクセス */
+#define FFTKERNEL_REAL(x, i) ((x)[((i) << 1)])
+#define FFTKERNEL_IMAG(x, i) ((x)[((i) << 1) + 1])
+
+/* 基数4の1段分のうちp番目のバタフライ群（参照実装） */
+static void FFTKernel_Radix4ButterflyScalar(int n, int s, int flag, int p,
+        const float *x, float *y, const float *twiddle, int twiddle_stride)
+{
+    int q;
+    const int n1 = (n >> 2);
+    const int n2 = (n >> 1);
+    const int n3 = n1 + n2;
+    const float fl = (float)flag;
+    /* テーブルは順変換の符号なので逆変換では虚部の符号を反転 */
+    const float w1r = FFTKERNEL_REAL(twiddle, 1 * p * twiddle_stride);
+    const float w1i = -fl * FFTKERNEL_IMAG(twiddle, 1 * p * twiddle_stride);
+    const float w2r = FFTKERNEL_REAL(twiddle, 2 * p * twiddle_stride);
+    const float w2i = -fl * FFTKERNEL_IMAG(twiddle, 2 * p * twiddle_stride);
+    const float w3r = FFTKERNEL_REAL(twiddle, 3 * p * twiddle_stride);
+    const float w3i = -fl * FFTKERNEL_IMAG(twiddle, 3 * p * twiddle_stride);
+
+    for (q = 0; q < s; q++) {
+        const int ia = q + s * (p +  0), ib = q + s * (p + n1);
+        const int ic = q + s * (p + n2), id = q + s * (p + n3);
+        const int iy = q + s * (p << 2);
+        const float apcr = FFTKERNEL_REAL(x, ia) + FFTKERNEL_REAL(x, ic);
+        const float apci = FFTKERNEL_IMAG(x, ia) + FFTKERNEL_IMAG(x, ic);
+        const float amcr = FFTKERNEL_REAL(x, ia) - FFTKERNEL_REAL(x, ic);
+        const float amci = FFTKERNEL_IMAG(x, ia) - FFTKERNEL_IMAG(x, ic);
+        const float bpdr = FFTKERNEL_REAL(x, ib) + FFTKERNEL_REAL(x, id);
+        const float bpdi = FFTKERNEL_IMAG(x, ib) + FFTKERNEL_IMAG(x, id);
+        /* (-flag j) * (b - d) */
+        const float jbmdr =  fl * (FFTKERNEL_IMAG(x, ib) - FFTKERNEL_IMAG(x, id));
+        const float jbmdi = -fl * (FFTKERNEL_REAL(x, ib) - FFTKERNEL_REAL(x, id));
+        const float t1r = amcr - jbmdr, t1i = amci - jbmdi;
+        const float t2r = apcr - bpdr, t2i = apci - bpdi;
+        const float t3r = amcr + jbmdr, t3i = amci + jbmdi;
+        FFTKERNEL_REAL(y, iy + 0 * s) = apcr + bpdr;
+        FFTKERNEL_IMAG(y, iy + 0 * s) = apci + bpdi;
+        FFTKERNEL_REAL(y, iy + 1 * s) = w1r * t1r - w1i * t1i;
+        FFTKERNEL_IMAG(y, iy + 1 * s) = w1r * t1i + w1i * t1r;
+        FFTKERNEL_REAL(y, iy + 2 * s) = w2r * t2r - w2i * t2i;
+        FFTKERNEL_IMAG(y, iy + 2 * s) = w2r * t2i + w2i * t2r;
+        FFTKERNEL_REAL(y, iy + 3 * s) = w3r * t3r - w3i * t3i;
+        FFTKERNEL_IMAG(y, iy + 3 * s) = w3r * t3i + w3i * t3r;
+    }
+}
+
+/* 基数4の1段（参照実装） */
+static void FFTKernel_Radix4StageScalar(int n, int s, int flag,
+        const float *x, float *y, const float *twiddle, int twiddle_stride)
+{
+    int p;
+    for (p = 0; p < (n >> 2); p++) {
+        FFTKernel_Radix4ButterflyScalar(n, s, flag, p, x, y, twiddle, twiddle_stride);
+    }
+}
+
+/* 基数3の1段（参照実装） */
+static void FFTKernel_Radix3StageScalar(int n, int s, int flag,
+        const float *x, float *y, const float *twiddle, int twiddle_stride)
+{
+    int p, q;
+    const int n1 = n / 3;
+    const float fl = (float)flag;
+    /* sin(2π/3)（回転方向の符号込み） */
+    const float s1 = fl * 0.866025403784438647f;
+
+    for (p = 0; p < n1; p++) {
+        /* テーブルは順変換の符号なので逆変換では虚部の符号を反転 */
+        const float w1r = FFTKERNEL_REAL(twiddle, 1 * p * twiddle_stride);
+        const float w1i = -fl * FFTKERNEL_IMAG(twiddle, 1 * p * twiddle_stride);
+        const float w2r = FFTKERNEL_REAL(twiddle, 2 * p * twiddle_stride);
+        const float w2i = -fl * FFTKERNEL_IMAG(twiddle, 2 * p * twiddle_stride);
+        for (q = 0; q < s; q++) {
+            const int i0 = q + s * p, i1 = i0 + s * n1, i2 = i1 + s * n1;
+            const int iy = q + s * (3 * p);
+            const float br = FFTKERNEL_REAL(x, i1) + FFTKERNEL_REAL(x, i2);
+            const float bi = FFTKERNEL_IMAG(x, i1) + FFTKERNEL_IMAG(x, i2);
+            const float dr = FFTKERNEL_REAL(x, i1) - FFTKERNEL_REAL(x, i2);
+            const float di = FFTKERNEL_IMAG(x, i1) - FFTKERNEL_IMAG(x, i2);
+            const float cr = FFTKERNEL_REAL(x, i0) - 0.5f * br;
+            const float ci = FFTKERNEL_IMAG(x, i0) - 0.5f * bi;
+            /* X1 = c + j s1 d, X2 = c - j s1 d */
+            const float t1r = cr - s1 * di, t1i = ci + s1 * dr;
+            const float t2r = cr + s1 * di, t2i = ci - s1 * dr;
+            FFTKERNEL_REAL(y, iy + 0 * s) = FFTKERNEL_REAL(x, i0) + br;
+            FFTKERNEL_IMAG(y, iy + 0 * s) = FFTKERNEL_IMAG(x, i0) + bi;
+            FFTKERNEL_REAL(y, iy + 1 * s) = w1r * t1r - w1i * t1i;
+            FFTKERNEL_IMAG(y, iy + 1 * s) = w1r * t1i + w1i * t1r;
+            FFTKERNEL_REAL(y, iy + 2 * s) = w2r * t2r - w2i * t2i;
+            FFTKERNEL_IMAG(y, iy + 2 * s) = w2r * t2i + w2i * t2r;
+        }
+    }
+}
+
+/* 基数5の1段（参照実装） */
+static void FFTKernel_Radix5StageScalar(int n, int s, int flag,
+        const float *x, float *y, const float *twiddle, int twiddle_stride)
+{
+    int p, q, m;
+    const int n1 = n / 5;
+    const float fl = (float)flag;
+    /* cos(2π/5), cos(4π/5), sin(2π/5), sin(4π/5)（正弦は回転方向の符号込み） */
+    const float c1 = 0.309016994374947424f, c2 = -0.809016994374947424f;
+    const float s1 = fl * 0.951056516295153572f, s2 = fl * 0.587785252292473129f;
+
+    for (p = 0; p < n1; p++) {
+        float wr[5], wi[5];
+        for (m = 1; m < 5; m++) {
+            /* テーブルは順変換の符号なので逆変換では虚部の符号を反転 */
+            wr[m] = FFTKERNEL_REAL(twiddle, m * p * twiddle_stride);
+            wi[m] = -fl * FFTKERNEL_IMAG(twiddle, m * p * twiddle_stride);
+        }
+        for (q = 0; q < s; q++) {
+            float tr[5], ti[5];
+            const int i0 = q + s * p, i1 = i0 + s * n1, i2 = i1 + s * n1, i3 = i2 + s * n1, i4 = i3 + s * n1;
+            const int iy = q + s * (5 * p);
+            const float b1r = FFTKERNEL_REAL(x, i1) + FFTKERNEL_REAL(x, i4);
+            const float b1i = FFTKERNEL_IMAG(x, i1) + FFTKERNEL_IMAG(x, i4);
+            const float b2r = FFTKERNEL_REAL(x, i2) + FFTKERNEL_REAL(x, i3);
+            const float b2i = FFTKERNEL_IMAG(x, i2) + FFTKERNEL_IMAG(x, i3);
+            const float d1r = FFTKERNEL_REAL(x, i1) - FFTKERNEL_REAL(x, i4);
+            const float d1i = FFTKERNEL_IMAG(x, i1) - FFTKERNEL_IMAG(x, i4);
+            const float d2r = FFTKERNEL_REAL(x, i2) - FFTKERNEL_REAL(x, i3);
+            const float d2i = FFTKERNEL_IMAG(x, i2) - FFTKERNEL_IMAG(x, i3);
+            /* 実部側: a0 + c1 b1 + c2 b2, a0 + c2 b1 + c1 b2 */
+            const float e1r = FFTKERNEL_REAL(x, i0) + c1 * b1r + c2 * b2r;
+            const float e1i = FFTKERNEL_IMAG(x, i0) + c1 * b1i + c2 * b2i;
+            const float e2r = FFTKERNEL_REAL(x, i0) + c2 * b1r + c1 * b2r;
+            const float e2i = FFTKERNEL_IMAG(x, i0) + c2 * b1i + c1 * b2i;
+            /* 虚部側: s1 d1 + s2 d2, s2 d1 - s1 d2 （j倍して加減算） */
+            const float f1r = s1 * d1r + s2 * d2r, f1i = s1 * d1i + s2 * d2i;
+            const float f2r = s2 * d1r - s1 * d2r, f2i = s2 * d1i - s1 * d2i;
+            tr[1] = e1r - f1i; ti[1] = e1i + f1r;
+            tr[4] = e1r + f1i; ti[4] = e1i - f1r;
+            tr[2] = e2r - f2i; ti[2] = e2i + f2r;
+            tr[3] = e2r + f2i; ti[3] = e2i - f2r;
+            FFTKERNEL_REAL(y, iy) = FFTKERNEL_REAL(x, i0) + b1r + b2r;
+            FFTKERNEL_IMAG(y, iy) = FFTKERNEL_IMAG(x, i0) + b1i + b2i;
+            for (m = 1; m < 5; m++) {
+                FFTKERNEL_REAL(y, iy + m * s) = wr[m] * tr[m] - wi[m] * ti[m];
+                FFTKERNEL_IMAG(y, iy + m * s) = wr[m] * ti[m] + wi[m] * tr[m];
+            }
+        }
+    }
+}
+
+/* 基数7の1段（参照実装） 対称な成分を組にして計算 */
+static void FFTKernel_Radix7StageScalar(int n, int s, int flag,
+        const float *x, float *y, const float *twiddle, int twiddle_stride)
+{
+    int p, q, m, k;
+    const int n1 = n / 7;
+    const float fl = (float)flag;
+    /* cos(2πk/7), sin(2πk/7) (k = 0,...,6) */
+    static const float c7[7] = {
+        1.0f, 0.623489801858733530f, -0.222520933956314404f, -0.900968867902419126f,
+        -0.900968867902419126f, -0.222520933956314404f, 0.623489801858733530f };
+    static const float s7[7] = {
+        0.0f, 0.781831482468029809f, 0.974927912181823607f, 0.433883739117558120f,
+        -0.433883739117558120f, -0.974927912181823607f, -0.781831482468029809f };
+
+    for (p = 0; p < n1; p++) {
+        float wr[7], wi[7];
+        for (m = 1; m < 7; m++) {
+            /* テーブルは順変換の符号なので逆変換では虚部の符号を反転 */
+            wr[m] = FFTKERNEL_REAL(twiddle, m * p * twiddle_stride);
+            wi[m] = -fl * FFTKERNEL_IMAG(twiddle, m * p * twiddle_stride);
+        }
+        for (q = 0; q < s; q++) {
+            float br[4], bi[4], dr[4], di[4], tr[7], ti[7];
+            const int i0 = q + s * p;
+            const int iy = q + s * (7 * p);
+            const float a0r = FFTKERNEL_REAL(x, i0), a0i = FFTKERNEL_IMAG(x, i0);
+            /* b_k = a_k + a_{7-k}, d_k = a_k - a_{7-k} */
+            for (k = 1; k < 4; k++) {
+                const int ik = i0 + s * k * n1, jk = i0 + s * (7 - k) * n1;
+                br[k] = FFTKERNEL_REAL(x, ik) + FFTKERNEL_REAL(x, jk);
+                bi[k] = FFTKERNEL_IMAG(x, ik) + FFTKERNEL_IMAG(x, jk);
+                dr[k] = FFTKERNEL_REAL(x, ik) - FFTKERNEL_REAL(x, jk);
+                di[k] = FFTKERNEL_IMAG(x, ik) - FFTKERNEL_IMAG(x, jk);
+            }
+            /* X_m = e_m + j f_m, X_{7-m} = e_m - j f_m
+            * e_m = a_0 + sum_k cos(2πmk/7) b_k, f_m = flag sum_k sin(2πmk/7) d_k */
+            for (m = 1; m < 4; m++) {
+                float er = a0r, ei = a0i, fr = 0.0f, fi = 0.0f;
+                for (k = 1; k < 4; k++) {
+                    const int mk = (m * k) % 7;
+                    er += c7[mk] * br[k];
+                    ei += c7[mk] * bi[k];
+                    fr += s7[mk] * dr[k];
+                    fi += s7[mk] * di[k];
+                }
+                fr *= fl; fi *= fl;
+                tr[m] = er - fi; ti[m] = ei + fr;
+                tr[7 - m] = er + fi; ti[7 - m] = ei - fr;
+            }
+            FFTKERNEL_REAL(y, iy) = a0r + br[1] + br[2] + br[3];
+            FFTKERNEL_IMAG(y, iy) = a0i + bi[1] + bi[2] + bi[3];
+            for (m = 1; m < 7; m++) {
+                FFTKERNEL_REAL(y, iy + m * s) = wr[m] * tr[m] - wi[m] * ti[m];
+                FFTKERNEL_IMAG(y, iy + m * s) = wr[m] * ti[m] + wi[m] * tr[m];
+            }
+        }
+    }
+}
+
+/* 基数2の最終段（参照実装） */
+static void FFTKernel_Radix2StageScalar(int s, const float *x, float *y)
+{
+    int q;
+    for (q = 0; q < (2 * s); q++) {
+        const float a = x[q], b = x[q + 2 * s];
+        y[q] = a + b;
+        y[q + 2 * s] = a - b;
+    }
+}
+
+#if defined(FFTKERNEL_X86)
+
+/* CPUID命令の実行 */
+static void FFTKernel_CPUID(uint32_t leaf, uint32_t subleaf, uint32_t *regs)
+{
+#if defined(_MSC_VER)
+    int tmp[4];
+    __cpuidex(tmp, (int)leaf, (int)subleaf);
+    regs[0] = (uint32_t)tmp[0]; regs[1] = (uint32_t)tmp[1];
+    regs[2] = (uint32_t)tmp[2]; regs[3] = (uint32_t)tmp[3];
+#else
+    unsigned int a, b, c, d;
+    if (__get_cpuid_max(0, NULL) < leaf) {
+        regs[0] = regs[1] = regs[2] = regs[3] = 0;
+        return;
+    }
+    __cpuid_count(leaf, subleaf, a, b, c, d);
+    regs[0] = a; regs[1] = b; regs[2] = c; regs[3] = d;
+#endif
+}
+
+/* OSが退避/復元するレジスタ状態(XCR0)の取得 */
+static uint32_t FFTKernel_GetXCR0(void)
+{
+#if defined(_MSC_VER)
+    return (uint32_t)_xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+    return eax;
+#endif
+}
+
+/* 複素数の積（SSE2） wr, wiは実部・虚部を各要素に複製したもの（wiは実部側の符号を反転済み） */
+FFTKERNEL_TARGET("sse2")
+static __m128 FFTKernel_ComplexMulSSE2(__m128 z, __m128 wr, __m128 wi)
+{
+    const __m128 swap = _mm_shuffle_ps(z, z, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_add_ps(_mm_mul_ps(z, wr), _mm_mul_ps(swap, wi));
+}
+
+/* 基数4の1段（SSE2） */
+FFTKERNEL_TARGET("sse2")
+static void FFTKernel_Radix4StageSSE2(int n, int s, int flag,
+        const float *x, float *y, const float *twiddle, int twiddle_stride)
+{
+    int p, q;
+    const int n1 = (n >> 2);
+    const int n2 = (n >> 1);
+    const int n3 = n1 + n2;
+    const float fl = (float)flag;
+    /* (-flag j)倍は実部・虚部を入れ替えて符号を掛ける */
+    const __m128 jsign = _mm_setr_ps(fl, -fl, fl, -fl);
+    /* 回転因子の虚部に掛ける符号（実部側は複素数積の符号反転分） */
+    const __m128 wsign = _mm_setr_ps(fl, -fl, fl, -fl);
+
+    if ((s % 2) == 0) {
+        /* 同じ回転因子を使うq方向に2要素ずつ処理 */
+        for (p = 0; p < n1; p++) {
+            const float *tw1 = &twiddle[2 * (1 * p * twiddle_stride)];
+            const float *tw2 = &twiddle[2 * (2 * p * twiddle_stride)];
+            const float *tw3 = &twiddle[2 * (3 * p * twiddle_stride)];
+            const __m128 w1r = _mm_set1_ps(tw1[0]), w1i = _mm_mul_ps(_mm_set1_ps(tw1[1]), wsign);
+            const __m128 w2r = _mm_set1_ps(tw2[0]), w2i = _mm_mul_ps(_mm_set1_ps(tw2[1]), wsign);
+            const __m128 w3r = _mm_set1_ps(tw3[0]), w3i = _mm_mul_ps(_mm_set1_ps(tw3[1]), wsign);
+            for (q = 0; q < s; q += 2) {
+                const __m128 a = _mm_loadu_ps(&x[2 * (q + s * (p +  0))]);
+                const __m128 b = _mm_loadu_ps(&x[2 * (q + s * (p + n1))]);
+                const __m128 c = _mm_loadu_ps(&x[2 * (q + s * (p + n2))]);
+                const __m128 d = _mm_loadu_ps(&x[2 * (q + s * (p + n3))]);
+                const __m128 apc = _mm_add_ps(a, c), amc = _mm_sub_ps(a, c);
+                const __m128 bpd = _mm_add_ps(b, d), bmd = _mm_sub_ps(b, d);
+                const __m128 jbmd = _mm_mul_ps(_mm_shuffle_ps(bmd, bmd, _MM_SHUFFLE(2, 3, 0, 1)), jsign);
+                float *py = &y[2 * (q + s * (p << 2))];
+                _mm_storeu_ps(&py[2 * 0 * s], _mm_add_ps(apc, bpd));
+                _mm_storeu_ps(&py[2 * 1 * s], FFTKernel_ComplexMulSSE2(_mm_sub_ps(amc, jbmd), w1r, w1i));
+                _mm_storeu_ps(&py[2 * 2 * s], FFTKernel_ComplexMulSSE2(_mm_sub_ps(apc, bpd), w2r, w2i));
+                _mm_storeu_ps(&py[2 * 3 * s], FFTKernel_ComplexMulSSE2(_mm_add_ps(amc, jbmd), w3r, w3i));
+            }
+        }
+    } else if ((s == 1) && ((n1 % 2) == 0)) {
+        /* 初段（s = 1）はp方向に2要素ずつ処理し、出力を並べ替えて格納 */
+        for (p = 0; p < n1; p += 2) {
+            __m128 w1, w2, w3, y0, y1, y2, y3;
+            const __m128 a = _mm_loadu_ps(&x[2 * (p +  0)]);
+            const __m128 b = _mm_loadu_ps(&x[2 * (p + n1)]);
+            const __m128 c = _mm_loadu_ps(&x[2 * (p + n2)]);
+            const __m128 d = _mm_loadu_ps(&x[2 * (p + n3)]);
+            const __m128 apc = _mm_add_ps(a, c), amc = _mm_sub_ps(a, c);
+            const __m128 bpd = _mm_add_ps(b, d), bmd = _mm_sub_ps(b, d);
+            const __m128 jbmd = _mm_mul_ps(_mm_shuffle_ps(bmd, bmd, _MM_SHUFFLE(2, 3, 0, 1)), jsign);
+            w1 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(),
+                        (const __m64 *)&twiddle[2 * (1 * (p + 0) * twiddle_stride)]),
+                        (const __m64 *)&twiddle[2 * (1 * (p + 1) * twiddle_stride)]);
+            w2 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(),
+                        (const __m64 *)&twiddle[2 * (2 * (p + 0) * twiddle_stride)]),
+                        (const __m64 *)&twiddle[2 * (2 * (p + 1) * twiddle_stride)]);
+            w3 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(),
+                        (const __m64 *)&twiddle[2 * (3 * (p + 0) * twiddle_stride)]),
+                        (const __m64 *)&twiddle[2 * (3 * (p + 1) * twiddle_stride)]);
+            y0 = _mm_add_ps(apc, bpd);
+            y1 = FFTKernel_ComplexMulSSE2(_mm_sub_ps(amc, jbmd),
+                    _mm_shuffle_ps(w1, w1, _MM_SHUFFLE(2, 2, 0, 0)),
+                    _mm_mul_ps(_mm_shuffle_ps(w1, w1, _MM_SHUFFLE(3, 3, 1, 1)), wsign));
+            y2 = FFTKernel_ComplexMulSSE2(_mm_sub_ps(apc, bpd),
+                    _mm_shuffle_ps(w2, w2, _MM_SHUFFLE(2, 2, 0, 0)),
+                    _mm_mul_ps(_mm_shuffle_ps(w2, w2, _MM_SHUFFLE(3, 3, 1, 1)), wsign));
+            y3 = FFTKernel_ComplexMulSSE2(_mm_add_ps(amc, jbmd),
+                    _mm_shuffle_ps(w3, w3, _MM_SHUFFLE(2, 2, 0, 0)),
+                    _mm_mul_ps(_mm_shuffle_ps(w3, w3, _MM_SHUFFLE(3, 3, 1, 1)), wsign));
+            /* y[4p + m] = ym[p] */
+            _mm_storeu_ps(&y[2 * (4 * p + 0)], _mm_movelh_ps(y0, y1));
+            _mm_storeu_ps(&y[2 * (4 * p + 2)], _mm_movelh_ps(y2, y3));
+            _mm_storeu_ps(&y[2 * (4 * p + 4)], _mm_movehl_ps(y1, y0));
+            _mm_storeu_ps(&y[2 * (4 * p + 6)], _mm_movehl_ps(y3, y2));
+        }
+    } else {
+        FFTKernel_Radix4StageScalar(n, s, flag, x, y, twiddle, twiddle_stride);
+    }
+}
+
+/* 基数2の最終段（SSE2） */
+FFTKERNEL_TARGET("sse2")
+static void FFTKernel_Radix2StageSSE2(int s, const float *x, float *y)
+{
+    int q;
+    for (q = 0; (q + 4) <= (2 * s); q += 4) {
+        const __m128 a = _mm_loadu_ps(&x[q]), b = _mm_loadu_ps(&x[q + 2 * s]);
+        _mm_storeu_ps(&y[q], _mm_add_ps(a, b));
+        _mm_storeu_ps(&y[q + 2 * s], _mm_sub_ps(a, b));
+    }
+    /* 端数 */
+    for (; q < (2 * s); q++) {
+        const float a = x[q], b = x[q + 2 * s];
+        y[q] = a + b;
+        y[q + 2 * s] = a - b;
+    }
+}
+
+/* 複素数の積（AVX2） wは実部・虚部を交互に並べた回転因子 */
+FFTKERNEL_TARGET("avx2,fma")
+static __m256 FFTKernel_ComplexMulAVX2(__m256 z, __m256 w, __m256 wsign)
+{
+    const __m256 swap = _mm256_permute_ps(z, _MM_SHUFFLE(2, 3, 0, 1));
+    const __m256 wi = _mm256_mul_ps(_mm256_movehdup_ps(w), wsign);
+    /* 偶数要素: zr * wr - zi * wi, 奇数要素: zi * wr + zr * wi */
+    return _mm256_fmaddsub_ps(z, _mm256_moveldup_ps(w), _mm256_mul_ps(swap, wi));
+}
+
+/* 基数4の1段（AVX2） */
+FFTKERNEL_TARGET("avx2,fma")
+static void FFTKernel_Radix4StageAVX2(int n, int s, int flag,
+        const float *x, float *y, const float *twiddle, int twiddle_stride)
+{
+    int p, q;
+    const int n1 = (n >> 2);
+    const int n2 = (n >> 1);
+    const int n3 = n1 + n2;
+    const float fl = (float)flag;
+    /* (-flag j)倍は実部・虚部を入れ替えて符号を掛ける */
+    const __m256 jsign = _mm256_setr_ps(fl, -fl, fl, -fl, fl, -fl, fl, -fl);
+    /* テーブルは順変換の符号なので逆変換では虚部の符号を反転 */
+    const __m256 wsign = _mm256_set1_ps(-fl);
+
+    if ((s % 4) == 0) {
+        /* 同じ回転因子を使うq方向に4要素ずつ処理 */
+        for (p = 0; p < n1; p++) {
+            const double *tw1 = (const double *)&twiddle[2 * (1 * p * twiddle_stride)];
+            const double *tw2 = (const double *)&twiddle[2 * (2 * p * twiddle_stride)];
+            const double *tw3 = (const double *)&twiddle[2 * (3 * p * twiddle_stride)];
+            const __m256 w1 = _mm256_castpd_ps(_mm256_broadcast_sd(tw1));
+            const __m256 w2 = _mm256_castpd_ps(_mm256_broadcast_sd(tw2));
+            const __m256 w3 = _mm256_castpd_ps(_mm256_broadcast_sd(tw3));
+            for (q = 0; q < s; q += 4) {
+                const __m256 a = _mm256_loadu_ps(&x[2 * (q + s * (p +  0))]);
+                const __m256 b = _mm256_loadu_ps(&x[2 * (q + s * (p + n1))]);
+                const __m256 c = _mm256_loadu_ps(&x[2 * (q + s * (p + n2))]);
+                const __m256 d = _mm256_loadu_ps(&x[2 * (q + s * (p + n3))]);
+                const __m256 apc = _mm256_add_ps(a, c), amc = _mm256_sub_ps(a, c);
+                const __m256 bpd = _mm256_add_ps(b, d), bmd = _mm256_sub_ps(b, d);
+                const __m256 jbmd = _mm256_mul_ps(_mm256_permute_ps(bmd, _MM_SHUFFLE(2, 3, 0, 1)), jsign);
+                float *py = &y[2 * (q + s * (p << 2))];
+                _mm256_storeu_ps(&py[2 * 0 * s], _mm256_add_ps(apc, bpd));
+                _mm256_storeu_ps(&py[2 * 1 * s], FFTKernel_ComplexMulAVX2(_mm256_sub_ps(amc, jbmd), w1, wsign));
+                _mm256_storeu_ps(&py[2 * 2 * s], FFTKernel_ComplexMulAVX2(_mm256_sub_ps(apc, bpd), w2, wsign));
+                _mm256_storeu_ps(&py[2 * 3 * s], FFTKernel_ComplexMulAVX2(_mm256_add_ps(amc, jbmd), w3, wsign));
+            }
+        }
+    } else if ((s == 1) && ((n1 % 4) == 0)) {
+        /* 初段（s = 1）はp方向に4要素ずつ処理し、出力を転置して格納 */
+        for (p = 0; p < n1; p += 4) {
+            __m256 w[3], ym[4];
+            __m256d t0, t1, t2, t3;
+            int m;
+            const __m256 a = _mm256_loadu_ps(&x[2 * (p +  0)]);
+            const __m256 b = _mm256_loadu_ps(&x[2 * (p + n1)]);
+            const __m256 c = _mm256_loadu_ps(&x[2 * (p + n2)]);
+            const __m256 d = _mm256_loadu_ps(&x[2 * (p + n3)]);
+            const __m256 apc = _mm256_add_ps(a, c), amc = _mm256_sub_ps(a, c);
+            const __m256 bpd = _mm256_add_ps(b, d), bmd = _mm256_sub_ps(b, d);
+            const __m256 jbmd = _mm256_mul_ps(_mm256_permute_ps(bmd, _MM_SHUFFLE(2, 3, 0, 1)), jsign);
+            for (m = 0; m < 3; m++) {
+                const float *tw = &twiddle[2 * (m + 1) * p * twiddle_stride];
+                const int k = 2 * (m + 1) * twiddle_stride;
+                w[m] = _mm256_setr_ps(tw[0 * k], tw[0 * k + 1], tw[1 * k], tw[1 * k + 1],
+                        tw[2 * k], tw[2 * k + 1], tw[3 * k], tw[3 * k + 1]);
+            }
+            ym[0] = _mm256_add_ps(apc, bpd);
+            ym[1] = FFTKernel_ComplexMulAVX2(_mm256_sub_ps(amc, jbmd), w[0], wsign);
+            ym[2] = FFTKernel_ComplexMulAVX2(_mm256_sub_ps(apc, bpd), w[1], wsign);
+            ym[3] = FFTKernel_ComplexMulAVX2(_mm256_add_ps(amc, jbmd), w[2], wsign);
+            /* 複素数（64bit）単位の4x4転置: y[4(p + k) + m] = ym[p + k] */
+            t0 = _mm256_unpacklo_pd(_mm256_castps_pd(ym[0]), _mm256_castps_pd(ym[1]));
+            t1 = _mm256_unpackhi_pd(_mm256_castps_pd(ym[0]), _mm256_castps_pd(ym[1]));
+            t2 = _mm256_unpacklo_pd(_mm256_castps_pd(ym[2]), _mm256_castps_pd(ym[3]));
+            t3 = _mm256_unpackhi_pd(_mm256_castps_pd(ym[2]), _mm256_castps_pd(ym[3]));
+            _mm256_storeu_pd((double *)&y[2 * (4 * p +  0)], _mm256_permute2f128_pd(t0, t2, 0x20));
+            _mm256_storeu_pd((double *)&y[2 * (4 * p +  4)], _mm256_permute2f128_pd(t1, t3, 0x20));
+            _mm256_storeu_pd((double *)&y[2 * (4 * p +  8)], _mm256_permute2f128_pd(t0, t2, 0x31));
+            _mm256_storeu_pd((double *)&y[2 * (4 * p + 12)], _mm256_permute2f128_pd(t1, t3, 0x31));
+        }
+    } else {
+        /* 要素数が少ない段はSSE2版で処理 */
+        FFTKernel_Radix4StageSSE2(n, s, flag, x, y, twiddle, twiddle_stride);
+    }
+}
+
+/* 基数2の最終段（AVX2） */
+FFTKERNEL_TARGET("avx2,fma")
+static void FFTKernel_Radix2StageAVX2(int s, const float *x, float *y)
+{
+    int q;
+    for (q = 0; (q + 8) <= (2 * s); q += 8) {
+        const __m256 a = _mm256_loadu_ps(&x[q]), b = _mm256_loadu_ps(&x[q + 2 * s]);
+        _mm256_storeu_ps(&y[q], _mm256_add_ps(a, b));
+        _mm256_storeu_ps(&y[q + 2 * s], _mm256_sub_ps(a, b));
+    }
+    /* 端数 */
+    for (; q < (2 * s); q++) {
+        const float a = x[q], b = x[q + 2 * s];
+        y[q] = a + b;
+        y[q + 2 * s] = a - b;
+    }
+}
+
+#endif /* FFTKERNEL_X86 */
+
+#if defined(FFTKERNEL_NEON)
+
+/* 基数4の1段（NEON） 実部・虚部を分離して読み込み4要素ずつ処理 */
+static void FFTKernel_Radix4StageNEON(int n, int s, int flag,
+        const float *x, float *y, const float *twiddle, int twiddle_stride)
+{
+    int p, q;
+    const int n1 = (n >> 2);
+    const int n2 = (n >> 1);
+    const int n3 = n1 + n2;
+    const float fl = (float)flag;
+
+    /* 初段などq方向に4要素ずつ処理できない段は参照実装で処理 */
+    if ((s % 4) != 0) {
+        FFTKernel_Radix4StageScalar(n, s, flag, x, y, twiddle, twiddle_stride);
+        return;
+    }
+
+    for (p = 0; p < n1; p++) {
+        const float *tw1 = &twiddle[2 * (1 * p * twiddle_stride)];
+        const float *tw2 = &twiddle[2 * (2 * p * twiddle_stride)];
+        const float *tw3 = &twiddle[2 * (3 * p * twiddle_stride)];
+        /* テーブルは順変換の符号なので逆変換では虚部の符号を反転 */
+        const float32x4_t w1r = vdupq_n_f32(tw1[0]), w1i = vdupq_n_f32(-fl * tw1[1]);
+        const float32x4_t w2r = vdupq_n_f32(tw2[0]), w2i = vdupq_n_f32(-fl * tw2[1]);
+        const float32x4_t w3r = vdupq_n_f32(tw3[0]), w3i = vdupq_n_f32(-fl * tw3[1]);
+        for (q = 0; q < s; q += 4) {
+            float32x4x2_t y0, y1, y2, y3;
+            const float32x4x2_t a = vld2q_f32(&x[2 * (q + s * (p +  0))]);
+            const float32x4x2_t b = vld2q_f32(&x[2 * (q + s * (p + n1))]);
+            const float32x4x2_t c = vld2q_f32(&x[2 * (q + s * (p + n2))]);
+            const float32x4x2_t d = vld2q_f32(&x[2 * (q + s * (p + n3))]);
+            const float32x4_t apcr = vaddq_f32(a.val[0], c.val[0]), apci = vaddq_f32(a.val[1], c.val[1]);
+            const float32x4_t amcr = vsubq_f32(a.val[0], c.val[0]), amci = vsubq_f32(a.val[1], c.val[1]);
+            const float32x4_t bpdr = vaddq_f32(b.val[0], d.val[0]), bpdi = vaddq_f32(b.val[1], d.val[1]);
+            /* (-flag j) * (b - d) */
+            const float32x4_t jbmdr = vmulq_n_f32(vsubq_f32(b.val[1], d.val[1]), fl);
+            const float32x4_t jbmdi = vmulq_n_f32(vsubq_f32(b.val[0], d.val[0]), -fl);
+            const float32x4_t t1r = vsubq_f32(amcr, jbmdr), t1i = vsubq_f32(amci, jbmdi);
+            const float32x4_t t2r = vsubq_f32(apcr, bpdr), t2i = vsubq_f32(apci, bpdi);
+            const float32x4_t t3r = vaddq_f32(amcr, jbmdr), t3i = vaddq_f32(amci, jbmdi);
+            float *py = &y[2 * (q + s * (p << 2))];
+            y0.val[0] = vaddq_f32(apcr, bpdr);
+            y0.val[1] = vaddq_f32(apci, bpdi);
+            y1.val[0] = vmlsq_f32(vmulq_f32(w1r, t1r), w1i, t1i);
+            y1.val[1] = vmlaq_f32(vmulq_f32(w1r, t1i), w1i, t1r);
+            y2.val[0] = vmlsq_f32(vmulq_f32(w2r, t2r), w2i, t2i);
+            y2.val[1] = vmlaq_f32(vmulq_f32(w2r, t2i), w2i, t2r);
+            y3.val[0] = vmlsq_f32(vmulq_f32(w3r, t3r), w3i, t3i);
+            y3.val[1] = vmlaq_f32(vmulq_f32(w3r, t3i), w3i, t3r);
+            vst2q_f32(&py[2 * 0 * s], y0);
+            vst2q_f32(&py[2 * 1 * s], y1);
+            vst2q_f32(&py[2 * 2 * s], y2);
+            vst2q_f32(&py[2 * 3 * s], y3);
+        }
+    }
+}
+
+/* 基数2の最終段（NEON） */
+static void FFTKernel_Radix2StageNEON(int s, const float *x, float *y)
+{
+    int q;
+    for (q = 0; (q + 4) <= (2 * s); q += 4) {
+        const float32x4_t a = vld1q_f32(&x[q]), b = vld1q_f32(&x[q + 2 * s]);
+        vst1q_f32(&y[q], vaddq_f32(a, b));
+        vst1q_f32(&y[q + 2 * s], vsubq_f32(a, b));
+    }
+    /* 端数 */
+    for (; q < (2 * s); q++) {
+        const float a = x[q], b = x[q + 2 * s];
+        y[q] = a + b;
+        y[q + 2 * s] = a - b;
+    }
+}
+
+#endif /* FFTKERNEL_NEON */
+
+/* 指定した命令セットが実行環境で使用可能か判定 */
+uint8_t FFTKernel_IsSupported(FFTKernelType type)
+{
+    switch (type) {
+    case FFTKERNEL_TYPE_SCALAR:
+        return 1;
+#if defined(FFTKERNEL_X86)
+    case FFTKERNEL_TYPE_SSE2:
+        {
+            uint32_t regs[4];
+            FFTKernel_CPUID(1, 0, regs);
+            return ((regs[3] >> 26) & 1) ? 1 : 0;
+        }
+    case FFTKERNEL_TYPE_AVX2:
+        {
+            uint32_t regs[4];
+            /* OSXSAVE, AVX, FMA */
+            FFTKernel_CPUID(1, 0, regs);
+            if (!((regs[2] >> 27) & 1) || !((regs[2] >> 28) & 1) || !((regs[2] >> 12) & 1)) {
+                return 0;
+            }
+            /* OSがYMMレジスタを退避するか */
+            if ((FFTKernel_GetXCR0() & 0x6) != 0x6) {
+                return 0;
+            }
+            FFTKernel_CPUID(7, 0, regs);
+            return ((regs[1] >> 5) & 1) ? 1 : 0;
+        }
+#endif /* FFTKERNEL_X86 */
+#if defined(FFTKERNEL_NEON)
+    case FFTKERNEL_TYPE_NEON:
+        /* NEONが有効なビルドでは常に使用可能 */
+        return 1;
+#endif
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+/* 指定した命令セットのカーネルを取得 使用できない場合は0を返す */
+uint8_t FFTKernel_Get(FFTKernelType type, struct FFTKernel *kernel)
+{
+    assert(kernel != NULL);
+
+    if (!FFTKernel_IsSupported(type)) {
+        return 0;
+    }
+
+    kernel->type = type;
+    switch (type) {
+    case FFTKERNEL_TYPE_SCALAR:
+        kernel->radix4_stage = FFTKernel_Radix4StageScalar;
+        kernel->radix3_stage = FFTKernel_Radix3StageScalar;
+        kernel->radix5_stage = FFTKernel_Radix5StageScalar;
+        kernel->radix7_stage = FFTKernel_Radix7StageScalar;
+        kernel->radix2_stage = FFTKernel_Radix2StageScalar;
+        break;
+#if defined(FFTKERNEL_X86)
+    case FFTKERNEL_TYPE_SSE2:
+        /* 基数3・5・7の段は参照実装を使用 */
+        kernel->radix4_stage = FFTKernel_Radix4StageSSE2;
+        kernel->radix3_stage = FFTKernel_Radix3StageScalar;
+        kernel->radix5_stage = FFTKernel_Radix5StageScalar;
+        kernel->radix7_stage = FFTKernel_Radix7StageScalar;
+        kernel->radix2_stage = FFTKernel_Radix2StageSSE2;
+        break;
+    case FFTKERNEL_TYPE_AVX2:
+        kernel->radix4_stage = FFTKernel_Radix4StageAVX2;
+        kernel->radix3_stage = FFTKernel_Radix3StageScalar;
+        kernel->radix5_stage = FFTKernel_Radix5StageScalar;
+        kernel->radix7_stage = FFTKernel_Radix7StageScalar;
+        kernel->radix2_stage = FFTKernel_Radix2StageAVX2;
+        break;
+#endif /* FFTKERNEL_X86 */
+#if defined(FFTKERNEL_NEON)
+    case FFTKERNEL_TYPE_NEON:
+        kernel->radix4_stage = FFTKernel_Radix4StageNEON;
+        kernel->radix3_stage = FFTKernel_Radix3StageScalar;
+        kernel->radix5_stage = FFTKernel_Radix5StageScalar;
+        kernel->radix7_stage = FFTKernel_Radix7StageScalar;
+        kernel->radix2_stage = FFTKernel_Radix2StageNEON;
+        break;
+#endif
+    default:
+        assert(0);
+        return 0;
+    }
+
+    return 1;
+}
+
+/* 実行環境で使用可能な最速のカーネルを取得 */
+void FFTKernel_Select(struct FFTKernel *kernel)
+{
+    /* 優先順（速い順）に並べた候補 */
+    static const FFTKernelType candidates[] = {
+        FFTKERNEL_TYPE_AVX2,
+        FFTKERNEL_TYPE_SSE2,
+        FFTKERNEL_TYPE_NEON,
+    };
+    uint32_t i;
+
+    assert(kernel != NULL);
+
+    for (i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        if (FFTKernel_Get(candidates[i], kernel)) {
+            return;
+        }
+    }
+
+    /* 参照実装は常に使用可能 */
+    (void)FFTKernel_Get(FFTKERNEL_TYPE_SCALAR, kernel);
+}
@@ -0,0 +1,54 @@
+#ifndef FFT_KERNEL_H_INCLUDED
+#define FFT_KERNEL_H_INCLUDED
+
+#include <stdint.h>
+
+/* FFT演算カーネルの命令セット種別 */
+typedef enum FFTKernelType {
+    FFTKERNEL_TYPE_SCALAR = 0,  /* 参照実装（スカラー演算） */
+    FFTKERNEL_TYPE_SSE2,        /* SSE2 */
+    FFTKERNEL_TYPE_AVX2,        /* AVX2 + FMA */
+    FFTKERNEL_TYPE_NEON,        /* NEON */
+    FFTKERNEL_TYPE_INVALID      /* 無効値 */
+} FFTKernelType;
+
+/* 基数rのStockham FFTの1段分 複素数は実部・虚部を交互に並べる
+ * n 現在の段の変換長, s ストライド(同時に変換する系列数 * 前段までの基数の積)
+ * flag -1:FFT, 1:IFFT
+ * twiddle 順変換の回転因子テーブル, twiddle_stride テーブルの参照間隔(テーブル長/n)
+ * w = exp(flag 2πj / n) として
+ * y[q + s * (rp + m)] = w^{mp} * sum_{k=0}^{r-1} w^{mkn/r} x[q + s * (p + k * n / r)] */
+typedef void (*FFTRadixStageFunction)(int n, int s, int flag,
+        const float *x, float *y, const float *twiddle, int twiddle_stride);
+
+/* 基数2のStockham FFTの最終段 y[q] = x[q] + x[q + s], y[q + s] = x[q] - x[q + s] */
+typedef void (*FFTRadix2StageFunction)(int s, const float *x, float *y);
+
+/* FFT演算カーネル */
+struct FFTKernel {
+    FFTKernelType type;
+    FFTRadixStageFunction radix4_stage;
+    FFTRadixStageFunction radix3_stage;
+    FFTRadixStageFunction radix5_stage;
+    FFTRadixStageFunction radix7_stage;
+    FFTRadix2StageFunction radix2_stage;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* 指定した命令セットが実行環境で使用可能か判定 */
+uint8_t FFTKernel_IsSupported(FFTKernelType type);
+
+/* 指定した命令セットのカーネルを取得 使用できない場合は0を返す */
+uint8_t FFTKernel_Get(FFTKernelType type, struct FFTKernel *kernel);
+
+/* 実行環境で使用可能な最速のカーネルを取得 */
+void FFTKernel_Select(struct FFTKernel *kernel);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FFT_KERNEL_H_INCLUDED */
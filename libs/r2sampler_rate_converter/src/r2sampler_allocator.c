@@ -0,0 +1,67 @@
+#include <r2sampler.h>
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "r2sampler_internal.h"
+
+/* 標準のメモリ確保（ワーク領域内でアラインメントを揃えるためalignmentは使用しない） */
+static void *R2samplerAllocator_DefaultAlloc(size_t size, size_t alignment, void *context)
+{
+    (void)alignment;
+    (void)context;
+    return malloc(size);
+}
+
+/* 標準のメモリ解放 */
+static void R2samplerAllocator_DefaultFree(void *ptr, void *context)
+{
+    (void)context;
+    free(ptr);
+}
+
+/* グローバルに設定されたアロケータ */
+static struct R2samplerAllocator st_global_allocator = {
+    R2samplerAllocator_DefaultAlloc, R2samplerAllocator_DefaultFree, NULL
+};
+
+/* ワーク領域を自前確保する際に使用するアロケータをグローバルに設定 */
+R2samplerRateConverterApiResult R2sampler_SetAllocator(const struct R2samplerAllocator *allocator)
+{
+    /* 標準のアロケータに戻す */
+    if (allocator == NULL) {
+        st_global_allocator.alloc = R2samplerAllocator_DefaultAlloc;
+        st_global_allocator.free = R2samplerAllocator_DefaultFree;
+        st_global_allocator.context = NULL;
+        return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+    }
+
+    /* 確保と解放は対で指定 */
+    if ((allocator->alloc == NULL) || (allocator->free == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    st_global_allocator = (*allocator);
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* 使用するアロケータを取得 */
+uint8_t R2sampler_GetAllocator(const struct R2samplerAllocator *allocator, struct R2samplerAllocator *result)
+{
+    assert(result != NULL);
+
+    /* 指定が無ければグローバルに設定したもの */
+    if (allocator == NULL) {
+        (*result) = st_global_allocator;
+        return 1;
+    }
+
+    /* 確保と解放は対で指定 */
+    if ((allocator->alloc == NULL) || (allocator->free == NULL)) {
+        return 0;
+    }
+
+    (*result) = (*allocator);
+    return 1;
+}
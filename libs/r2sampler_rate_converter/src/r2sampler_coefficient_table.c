@@ -0,0 +1,8 @@
+#include <stddef.h>
+
+#include "r2sampler_internal.h"
+
+/* 係数テーブルを生成しない場合の空のテーブル */
+/* R2SAMPLER_GENERATE_COEFFICIENT_TABLESを有効にしてビルドすると生成したテーブルに置き換わる */
+const struct R2samplerCoefficientTable *const R2sampler_coefficient_tables = NULL;
+const uint32_t R2sampler_num_coefficient_tables = 0;
@@ -0,0 +1,281 @@
+#include <r2sampler.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "r2sampler_internal.h"
+
+/* メモリアラインメント */
+#define R2SAMPLERFILTERCACHE_ALIGNMENT 16
+/* nの倍数に切り上げ */
+#define R2SAMPLERFILTERCACHE_ROUNDUP(val, n) ((((val) + ((n) - 1)) / (n)) * (n))
+/* 1エントリに格納する係数配列の数（フィルタ係数・ポリフェーズ係数・ハーフバンド係数） */
+#define R2SAMPLERFILTERCACHE_NUM_ARRAYS_PER_ENTRY 3
+/* 1エントリの係数領域のバイト数計算（係数配列ごとのアラインメント分を含む） */
+#define R2SAMPLERFILTERCACHE_ENTRY_SIZE(max_num_coefficients)\
+    R2SAMPLERFILTERCACHE_ROUNDUP(sizeof(float) * (max_num_coefficients)\
+            + R2SAMPLERFILTERCACHE_NUM_ARRAYS_PER_ENTRY * R2SAMPLERFILTERCACHE_ALIGNMENT, R2SAMPLERFILTERCACHE_ALIGNMENT)
+
+/* キャッシュエントリ */
+struct R2samplerFilterCacheEntry {
+    struct R2samplerFilterCacheKey key;
+    uint32_t reference_count; /* 参照中のハンドル数 */
+    uint32_t last_used; /* 最後に参照された時刻（参照されていないエントリの再利用順序） */
+    uint8_t valid; /* 係数が格納されているか */
+    void *data; /* 係数領域 */
+};
+
+/* フィルタ係数キャッシュ */
+struct R2samplerFilterCache {
+    struct R2samplerFilterCacheEntry *entries;
+    uint32_t max_num_entries;
+    uint32_t max_num_coefficients;
+    uint32_t clock; /* 参照の度に進める時刻 */
+    void (*lock)(void *lock_context);
+    void (*unlock)(void *lock_context);
+    void *lock_context;
+    uint8_t alloc_by_own;
+    struct R2samplerAllocator allocator; /* ワーク領域を確保したアロケータ */
+    void *work;
+};
+
+/* キーの一致判定 */
+uint8_t R2samplerFilterCache_IsKeyEqual(
+        const struct R2samplerFilterCacheKey *a, const struct R2samplerFilterCacheKey *b)
+{
+    assert((a != NULL) && (b != NULL));
+    /* パディングを含めて比較しないようメンバ毎に比較 */
+    return ((a->filter_type == b->filter_type)
+            && (a->up_rate == b->up_rate) && (a->down_rate == b->down_rate)
+            && (a->filter_order == b->filter_order) && (a->filter_phase == b->filter_phase)
+            && (a->passband_edge == b->passband_edge) && (a->stopband_edge == b->stopband_edge)
+            && (a->stopband_attenuation == b->stopband_attenuation)
+            && (a->stopband_weight == b->stopband_weight)) ? 1 : 0;
+}
+
+/* フィルタ係数キャッシュ作成に必要なワークサイズ計算 */
+int32_t R2samplerFilterCache_CalculateWorkSize(const struct R2samplerFilterCacheConfig *config)
+{
+    int32_t work_size;
+
+    /* 引数チェック */
+    if (config == NULL) {
+        return -1;
+    }
+
+    /* コンフィグチェック */
+    if ((config->max_num_entries == 0) || (config->max_num_coefficients == 0)) {
+        return -1;
+    }
+    /* ロックとアンロックは両方指定するかどちらも指定しない */
+    if ((config->lock == NULL) != (config->unlock == NULL)) {
+        return -1;
+    }
+
+    /* ハンドルサイズ */
+    work_size = sizeof(struct R2samplerFilterCache) + R2SAMPLERFILTERCACHE_ALIGNMENT;
+
+    /* エントリ配列サイズ */
+    work_size += sizeof(struct R2samplerFilterCacheEntry) * config->max_num_entries + R2SAMPLERFILTERCACHE_ALIGNMENT;
+
+    /* 係数領域サイズ */
+    work_size += R2SAMPLERFILTERCACHE_ENTRY_SIZE(config->max_num_coefficients) * config->max_num_entries + R2SAMPLERFILTERCACHE_ALIGNMENT;
+
+    return work_size;
+}
+
+/* フィルタ係数キャッシュ作成 */
+struct R2samplerFilterCache *R2samplerFilterCache_Create(
+        const struct R2samplerFilterCacheConfig *config, void *work, int32_t work_size)
+{
+    uint32_t i;
+    struct R2samplerFilterCache *cache;
+    uint8_t tmp_alloc_by_own = 0;
+    struct R2samplerAllocator allocator;
+    uint8_t *work_ptr;
+
+    /* ワーク領域時前確保の場合 */
+    if ((work == NULL) && (work_size == 0)) {
+        if ((work_size = R2samplerFilterCache_CalculateWorkSize(config)) < 0) {
+            return NULL;
+        }
+        /* 指定されたアロケータ（指定が無ければグローバルに設定したもの）で確保 */
+        if (!R2sampler_GetAllocator(config->allocator, &allocator)) {
+            return NULL;
+        }
+        work = allocator.alloc((size_t)work_size, R2SAMPLERFILTERCACHE_ALIGNMENT, allocator.context);
+        tmp_alloc_by_own = 1;
+    }
+
+    /* 引数チェック */
+    if ((config == NULL) || (work == NULL)
+            || (R2samplerFilterCache_CalculateWorkSize(config) < 0)
+            || (work_size < R2samplerFilterCache_CalculateWorkSize(config))) {
+        if ((tmp_alloc_by_own == 1) && (work != NULL)) {
+            allocator.free(work, allocator.context);
+        }
+        return NULL;
+    }
+
+    /* ワーク領域先頭ポインタ取得 */
+    work_ptr = (uint8_t *)work;
+
+    /* ハンドル領域確保 */
+    work_ptr = (uint8_t *)R2SAMPLERFILTERCACHE_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERFILTERCACHE_ALIGNMENT);
+    cache = (struct R2samplerFilterCache *)work_ptr;
+    work_ptr += sizeof(struct R2samplerFilterCache);
+
+    /* メンバ設定 */
+    cache->max_num_entries = config->max_num_entries;
+    cache->max_num_coefficients = config->max_num_coefficients;
+    cache->clock = 0;
+    cache->lock = config->lock;
+    cache->unlock = config->unlock;
+    cache->lock_context = config->lock_context;
+    cache->alloc_by_own = tmp_alloc_by_own;
+    if (tmp_alloc_by_own == 1) {
+        cache->allocator = allocator;
+    }
+    cache->work = work;
+
+    /* エントリ配列の領域確保 */
+    work_ptr = (uint8_t *)R2SAMPLERFILTERCACHE_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERFILTERCACHE_ALIGNMENT);
+    cache->entries = (struct R2samplerFilterCacheEntry *)work_ptr;
+    work_ptr += sizeof(struct R2samplerFilterCacheEntry) * config->max_num_entries;
+
+    /* 係数領域の割り当て */
+    work_ptr = (uint8_t *)R2SAMPLERFILTERCACHE_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERFILTERCACHE_ALIGNMENT);
+    for (i = 0; i < config->max_num_entries; i++) {
+        struct R2samplerFilterCacheEntry *entry = &cache->entries[i];
+        memset(&entry->key, 0, sizeof(struct R2samplerFilterCacheKey));
+        entry->reference_count = 0;
+        entry->last_used = 0;
+        entry->valid = 0;
+        entry->data = work_ptr;
+        work_ptr += R2SAMPLERFILTERCACHE_ENTRY_SIZE(config->max_num_coefficients);
+    }
+
+    /* バッファオーバーランチェック */
+    assert((work_ptr - (uint8_t *)work) <= work_size);
+
+    return cache;
+}
+
+/* フィルタ係数キャッシュ破棄 */
+void R2samplerFilterCache_Destroy(struct R2samplerFilterCache *cache)
+{
+    if (cache != NULL) {
+#ifndef NDEBUG
+        /* 参照中のハンドルが残っていないか確認 */
+        uint32_t i;
+        for (i = 0; i < cache->max_num_entries; i++) {
+            assert(cache->entries[i].reference_count == 0);
+        }
+#endif
+        if (cache->alloc_by_own == 1) {
+            cache->allocator.free(cache->work, cache->allocator.context);
+        }
+    }
+}
+
+/* 1エントリの係数領域のバイト数を取得 */
+int32_t R2samplerFilterCache_GetEntrySize(const struct R2samplerFilterCache *cache)
+{
+    assert(cache != NULL);
+    return (int32_t)R2SAMPLERFILTERCACHE_ENTRY_SIZE(cache->max_num_coefficients);
+}
+
+/* キャッシュの排他制御開始 */
+void R2samplerFilterCache_Lock(struct R2samplerFilterCache *cache)
+{
+    assert(cache != NULL);
+    if (cache->lock != NULL) {
+        cache->lock(cache->lock_context);
+    }
+}
+
+/* キャッシュの排他制御終了 */
+void R2samplerFilterCache_Unlock(struct R2samplerFilterCache *cache)
+{
+    assert(cache != NULL);
+    if (cache->unlock != NULL) {
+        cache->unlock(cache->lock_context);
+    }
+}
+
+/* キーに一致する係数を検索 */
+void *R2samplerFilterCache_Find(struct R2samplerFilterCache *cache, const struct R2samplerFilterCacheKey *key)
+{
+    uint32_t i;
+
+    assert((cache != NULL) && (key != NULL));
+
+    for (i = 0; i < cache->max_num_entries; i++) {
+        struct R2samplerFilterCacheEntry *entry = &cache->entries[i];
+        if (entry->valid && R2samplerFilterCache_IsKeyEqual(&entry->key, key)) {
+            entry->reference_count++;
+            entry->last_used = ++cache->clock;
+            return entry->data;
+        }
+    }
+
+    return NULL;
+}
+
+/* キーに対応する係数領域を新規に確保 */
+void *R2samplerFilterCache_Insert(struct R2samplerFilterCache *cache, const struct R2samplerFilterCacheKey *key)
+{
+    uint32_t i;
+    struct R2samplerFilterCacheEntry *entry;
+
+    assert((cache != NULL) && (key != NULL));
+
+    /* 未使用のエントリ、なければ参照されていない中で最も古いエントリを再利用 */
+    entry = NULL;
+    for (i = 0; i < cache->max_num_entries; i++) {
+        struct R2samplerFilterCacheEntry *candidate = &cache->entries[i];
+        if (!candidate->valid) {
+            entry = candidate;
+            break;
+        }
+        if ((candidate->reference_count == 0)
+                && ((entry == NULL) || (candidate->last_used < entry->last_used))) {
+            entry = candidate;
+        }
+    }
+
+    /* 全てのエントリが参照中 */
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    entry->key = (*key);
+    entry->reference_count = 1;
+    entry->last_used = ++cache->clock;
+    entry->valid = 1;
+
+    return entry->data;
+}
+
+/* 係数の参照を解放 */
+void R2samplerFilterCache_Release(struct R2samplerFilterCache *cache, const void *data)
+{
+    uint32_t i;
+
+    assert((cache != NULL) && (data != NULL));
+
+    R2samplerFilterCache_Lock(cache);
+
+    for (i = 0; i < cache->max_num_entries; i++) {
+        struct R2samplerFilterCacheEntry *entry = &cache->entries[i];
+        if (entry->data == data) {
+            assert(entry->reference_count > 0);
+            entry->reference_count--;
+            break;
+        }
+    }
+    assert(i < cache->max_num_entries);
+
+    R2samplerFilterCache_Unlock(cache);
+}
@@ -0,0 +1,175 @@
+#ifndef R2SAMPLER_INTERNAL_H_INCLUDED
+#define R2SAMPLER_INTERNAL_H_INCLUDED
+
+#include <r2sampler.h>
+#include <stdint.h>
+
+/* フィルタの帯域端（入力レート×アップレートで正規化した周波数） */
+struct R2samplerFilterBandEdges {
+    double passband_edge; /* 通過域端 */
+    double stopband_edge; /* 阻止域端 */
+};
+
+/* フィルタ係数キャッシュ・係数テーブルのキー（正規化したコンフィグ） */
+struct R2samplerFilterCacheKey {
+    R2samplerFilterType filter_type;
+    uint32_t up_rate;
+    uint32_t down_rate;
+    uint32_t filter_order;
+    R2samplerFilterPhase filter_phase;
+    double passband_edge; /* 以下は阻止域減衰量と遷移帯域幅から設計する場合のみ使用（それ以外は0） */
+    double stopband_edge;
+    double stopband_attenuation;
+    double stopband_weight;
+};
+
+/* 事前生成した係数テーブル */
+struct R2samplerCoefficientTable {
+    struct R2samplerFilterCacheKey key; /* 設計パラメータ */
+    uint32_t num_polyphase_taps; /* ポリフェーズフィルタ1位相あたりのタップ数 */
+    const float *filter_coef; /* フィルタ係数（filter_order個） */
+    const float *polyphase_coef; /* ポリフェーズフィルタ係数（up_rate * num_polyphase_taps個） */
+    const float *half_band_coef; /* ハーフバンドフィルタの非ゼロ係数（(filter_order + 1) / 4個. ハーフバンドとして処理しない場合はNULL） */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* 使用するアロケータを取得（NULLの場合はグローバルに設定したもの）
+ * alloc, freeのいずれかが未設定の場合は0を返す */
+uint8_t R2sampler_GetAllocator(const struct R2samplerAllocator *allocator, struct R2samplerAllocator *result);
+
+/* 係数テーブル一覧（ビルド時に生成. 生成しない場合は空） */
+extern const struct R2samplerCoefficientTable *const R2sampler_coefficient_tables;
+/* 係数テーブルの数 */
+extern const uint32_t R2sampler_num_coefficient_tables;
+
+/* チャンネル数を指定したレート変換器作成に必要なワークサイズ計算 */
+int32_t R2samplerRateConverter_CalculateMultiChannelWorkSize(
+        const struct R2samplerRateConverterConfig *config, uint32_t num_channels);
+
+/* チャンネル数を指定したレート変換器作成 */
+struct R2samplerRateConverter *R2samplerRateConverter_CreateMultiChannel(
+        const struct R2samplerRateConverterConfig *config, uint32_t num_channels, void *work, int32_t work_size);
+
+/* フィルタの帯域端を指定したレート変換器作成に必要なワークサイズ計算
+ * 阻止域減衰量と遷移帯域幅から設計するフィルタで、コンフィグの遷移帯域幅の代わりに使用する（NULLでコンフィグに従う） */
+int32_t R2samplerRateConverter_CalculateWorkSizeWithBandEdges(
+        const struct R2samplerRateConverterConfig *config, uint32_t num_channels,
+        const struct R2samplerFilterBandEdges *band_edges);
+
+/* フィルタの帯域端を指定したレート変換器作成に必要なワークサイズの内訳を計算（コンフィグが不正な場合は負値） */
+int32_t R2samplerRateConverter_CalculateWorkSizeBreakdownWithBandEdges(
+        const struct R2samplerRateConverterConfig *config, uint32_t num_channels,
+        const struct R2samplerFilterBandEdges *band_edges, struct R2samplerWorkSizeBreakdown *breakdown);
+
+/* フィルタの帯域端を指定したレート変換器作成 */
+struct R2samplerRateConverter *R2samplerRateConverter_CreateWithBandEdges(
+        const struct R2samplerRateConverterConfig *config, uint32_t num_channels,
+        const struct R2samplerFilterBandEdges *band_edges, void *work, int32_t work_size);
+
+/* フィルタ次数の取得 */
+uint32_t R2samplerRateConverter_GetFilterOrder(const struct R2samplerRateConverter *converter);
+
+/* 正規化した（互いに素な）アップレート・ダウンレートの取得 */
+void R2samplerRateConverter_GetRates(
+        const struct R2samplerRateConverter *converter, uint32_t *up_rate, uint32_t *down_rate);
+
+/* 内部でバッファリングしているサンプル数（ゼロ値挿入後、フィルタの遅延分を除く）を取得 */
+uint32_t R2samplerRateConverter_GetNumBufferedSamples(const struct R2samplerRateConverter *converter);
+
+/* ハーフバンドフィルタとして設計できるフィルタ種別・位相か判定
+ * 2倍/1/2倍の変換で、仕様から設計するフィルタは帯域端が0.25に対称な場合にハーフバンドとして処理する */
+uint8_t R2samplerRateConverter_IsHalfBandDesignable(const struct R2samplerRateConverterConfig *config);
+
+/* 1出力サンプルあたりの積和回数を見積もり（コンフィグが不正な場合は負値）
+ * filter_orderがNULLでなければ使用するフィルタ次数をセット */
+int32_t R2samplerRateConverter_EstimateNumMacsPerOutput(
+        const struct R2samplerRateConverterConfig *config, const struct R2samplerFilterBandEdges *band_edges,
+        uint32_t *filter_order);
+
+/* チャンネルインターリーブされたデータのレート変換
+ * サンプル数は1サンプルあたり全チャンネル分のデータを含む単位で数える */
+R2samplerRateConverterApiResult R2samplerRateConverter_ProcessInterleaved(
+        struct R2samplerRateConverter *converter,
+        const float *input, uint32_t num_input_samples,
+        float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples);
+
+/* チャンネル数を指定したマルチステージレート変換器作成に必要なワークサイズ計算 */
+int32_t R2samplerMultiStageRateConverter_CalculateMultiChannelWorkSize(
+        const struct R2samplerMultiStageRateConverterConfig *config, uint32_t num_channels);
+
+/* チャンネル数を指定したマルチステージレート変換器作成に必要なワークサイズの内訳を計算（コンフィグが不正な場合は負値） */
+int32_t R2samplerMultiStageRateConverter_CalculateMultiChannelWorkSizeBreakdown(
+        const struct R2samplerMultiStageRateConverterConfig *config, uint32_t num_channels,
+        struct R2samplerWorkSizeBreakdown *breakdown);
+
+/* マルチステージレート変換器で1回に全ステージに通す最大の入力サンプル数を計算 */
+uint32_t R2samplerMultiStageRateConverter_CalculateMaxNumBlockSamples(
+        const struct R2samplerMultiStageRateConverterConfig *config);
+
+/* マルチステージレート変換器で1ブロックの入力に対する最大の出力サンプル数を計算 */
+uint32_t R2samplerMultiStageRateConverter_CalculateMaxNumOutputSamples(
+        const struct R2samplerMultiStageRateConverterConfig *config);
+
+/* マルチステージレート変換器で入力サンプル数に対して得られる出力サンプル数を取得 */
+uint32_t R2samplerMultiStageRateConverter_GetNumOutputSamples(
+        const struct R2samplerMultiStageRateConverter *converter, uint32_t num_input_samples);
+
+/* マルチステージレート変換器で次のドレインで出力されるサンプル数を取得（未開始ならドレインを開始する） */
+uint32_t R2samplerMultiStageRateConverter_GetNumDrainOutputSamples(struct R2samplerMultiStageRateConverter *converter);
+
+/* チャンネル数を指定したマルチステージレート変換器作成 */
+struct R2samplerMultiStageRateConverter *R2samplerMultiStageRateConverter_CreateMultiChannel(
+        const struct R2samplerMultiStageRateConverterConfig *config, uint32_t num_channels, void *work, int32_t work_size);
+
+/* チャンネルインターリーブされたデータのマルチステージレート変換 */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_ProcessInterleaved(
+        struct R2samplerMultiStageRateConverter *converter,
+        const float *input, uint32_t num_input_samples,
+        float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples);
+
+/* チャンネルインターリーブされたデータの残りのサンプルの出力（ドレイン） */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_DrainInterleaved(
+        struct R2samplerMultiStageRateConverter *converter,
+        float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples);
+
+/* 作成済みのレート変換器の係数をテーブルの形式で取得（係数テーブル生成用） */
+void R2samplerRateConverter_GetCoefficientTable(
+        const struct R2samplerRateConverter *converter, struct R2samplerCoefficientTable *table);
+
+/* マルチステージレート変換器のステージ数を取得 */
+uint32_t R2samplerMultiStageRateConverter_GetNumStages(const struct R2samplerMultiStageRateConverter *converter);
+
+/* マルチステージレート変換器の各ステージのレート変換器を取得 */
+const struct R2samplerRateConverter *R2samplerMultiStageRateConverter_GetStage(
+        const struct R2samplerMultiStageRateConverter *converter, uint32_t stage);
+
+/* フィルタ係数キャッシュ・係数テーブルのキーの一致判定 */
+uint8_t R2samplerFilterCache_IsKeyEqual(
+        const struct R2samplerFilterCacheKey *a, const struct R2samplerFilterCacheKey *b);
+
+/* フィルタ係数キャッシュの1エントリの係数領域のバイト数を取得 */
+int32_t R2samplerFilterCache_GetEntrySize(const struct R2samplerFilterCache *cache);
+
+/* フィルタ係数キャッシュの排他制御開始 */
+void R2samplerFilterCache_Lock(struct R2samplerFilterCache *cache);
+
+/* フィルタ係数キャッシュの排他制御終了 */
+void R2samplerFilterCache_Unlock(struct R2samplerFilterCache *cache);
+
+/* キーに一致する係数領域を検索し参照カウントを増やす（見つからなければNULL. 排他制御中に呼ぶこと） */
+void *R2samplerFilterCache_Find(struct R2samplerFilterCache *cache, const struct R2samplerFilterCacheKey *key);
+
+/* キーに対応する係数領域を新規に確保（全エントリが参照中ならNULL. 排他制御中に呼び、解除前に係数を書き込むこと） */
+void *R2samplerFilterCache_Insert(struct R2samplerFilterCache *cache, const struct R2samplerFilterCacheKey *key);
+
+/* 係数領域の参照を解放（内部で排他制御する） */
+void R2samplerFilterCache_Release(struct R2samplerFilterCache *cache, const void *data);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* R2SAMPLER_INTERNAL_H_INCLUDED */
@@ -0,0 +1,1038 @@
+#include "r2sampler_kernel.h"
+
+#include <stddef.h>
+#include <assert.h>
+
+/* x86/x64 環境判定 */
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define R2SAMPLERKERNEL_X86
+#endif
+
+/* NEON 環境判定 */
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define R2SAMPLERKERNEL_NEON
+#endif
+
+/* 関数単位での命令セット指定（GCC/Clang） MSVCは指定なしで組み込み関数を使用可能 */
+#if defined(__GNUC__) || defined(__clang__)
+#define R2SAMPLERKERNEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define R2SAMPLERKERNEL_TARGET(isa)
+#endif
+
+/* AVX-512の組み込み関数（_mm512_reduce_add_ps等）が使えるコンパイラか判定 */
+#if defined(R2SAMPLERKERNEL_X86) \
+    && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ >= 7)) || (defined(_MSC_VER) && (_MSC_VER >= 1920)))
+#define R2SAMPLERKERNEL_ENABLE_AVX512
+#endif
+
+#if defined(R2SAMPLERKERNEL_X86)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(R2SAMPLERKERNEL_NEON)
+#include <arm_neon.h>
+#endif
+
+/* 内積（参照実装） */
+static float R2samplerKernel_DotProductScalar(
+        const float *x, const float *coef, uint32_t num_taps)
+{
+    uint32_t i;
+    float sum = 0.0f;
+
+    for (i = 0; i < num_taps; i++) {
+        sum += x[i] * coef[i];
+    }
+
+    return sum;
+}
+
+/* 偶対称係数のFIRフィルタ（参照実装） */
+static float R2samplerKernel_SymmetricFIRScalar(
+        const float *x, const float *coef, uint32_t filter_order)
+{
+    uint32_t i;
+    const uint32_t half_order = filter_order / 2;
+    float sum;
+
+    sum = x[half_order] * coef[half_order];
+    for (i = 0; i < half_order; i++) {
+        sum += (x[i] + x[filter_order - i - 1]) * coef[i];
+    }
+
+    return sum;
+}
+
+/* 偶数タップの偶対称係数のFIRフィルタ（参照実装） */
+static float R2samplerKernel_EvenSymmetricFIRScalar(
+        const float *x, const float *coef, uint32_t num_taps)
+{
+    uint32_t i;
+    const uint32_t half = num_taps / 2;
+    float sum = 0.0f;
+
+    for (i = 0; i < half; i++) {
+        sum += (x[i] + x[num_taps - i - 1]) * coef[i];
+    }
+
+    return sum;
+}
+
+/* ハーフバンドフィルタの非ゼロ係数の畳み込み（参照実装） */
+static float R2samplerKernel_HalfBandFIRScalar(
+        const float *x, const float *coef, uint32_t num_pairs)
+{
+    uint32_t i;
+    const uint32_t last = 4 * num_pairs - 2;
+    float sum = 0.0f;
+
+    for (i = 0; i < num_pairs; i++) {
+        sum += (x[2 * i] + x[last - 2 * i]) * coef[i];
+    }
+
+    return sum;
+}
+
+/* 複数チャンネルの内積 start_ch以降のチャンネルのみ計算 */
+static void R2samplerKernel_MultiChannelDotProductPartial(
+        const float *x, const float *coef, uint32_t num_taps, uint32_t num_channels, uint32_t start_ch, float *output)
+{
+    uint32_t ch;
+
+    for (ch = start_ch; ch < num_channels; ch++) {
+        uint32_t i;
+        float sum = 0.0f;
+        for (i = 0; i < num_taps; i++) {
+            sum += x[i * num_channels + ch] * coef[i];
+        }
+        output[ch] = sum;
+    }
+}
+
+/* 複数チャンネルの偶対称係数のFIRフィルタ start_ch以降のチャンネルのみ計算 */
+static void R2samplerKernel_MultiChannelSymmetricFIRPartial(
+        const float *x, const float *coef, uint32_t filter_order, uint32_t num_channels, uint32_t start_ch, float *output)
+{
+    uint32_t ch;
+    const uint32_t half_order = filter_order / 2;
+
+    for (ch = start_ch; ch < num_channels; ch++) {
+        uint32_t i;
+        float sum = x[half_order * num_channels + ch] * coef[half_order];
+        for (i = 0; i < half_order; i++) {
+            sum += (x[i * num_channels + ch] + x[(filter_order - i - 1) * num_channels + ch]) * coef[i];
+        }
+        output[ch] = sum;
+    }
+}
+
+/* 複数チャンネルのハーフバンドフィルタの非ゼロ係数の畳み込み start_ch以降のチャンネルのみ計算 */
+static void R2samplerKernel_MultiChannelHalfBandFIRPartial(
+        const float *x, const float *coef, uint32_t num_pairs, uint32_t num_channels, uint32_t start_ch, float *output)
+{
+    uint32_t ch;
+    const uint32_t last = 4 * num_pairs - 2;
+
+    for (ch = start_ch; ch < num_channels; ch++) {
+        uint32_t i;
+        float sum = 0.0f;
+        for (i = 0; i < num_pairs; i++) {
+            sum += (x[2 * i * num_channels + ch] + x[(last - 2 * i) * num_channels + ch]) * coef[i];
+        }
+        output[ch] = sum;
+    }
+}
+
+/* 複数チャンネルの内積（参照実装） */
+static void R2samplerKernel_MultiChannelDotProductScalar(
+        const float *x, const float *coef, uint32_t num_taps, uint32_t num_channels, float *output)
+{
+    R2samplerKernel_MultiChannelDotProductPartial(x, coef, num_taps, num_channels, 0, output);
+}
+
+/* 複数チャンネルの偶対称係数のFIRフィルタ（参照実装） */
+static void R2samplerKernel_MultiChannelSymmetricFIRScalar(
+        const float *x, const float *coef, uint32_t filter_order, uint32_t num_channels, float *output)
+{
+    R2samplerKernel_MultiChannelSymmetricFIRPartial(x, coef, filter_order, num_channels, 0, output);
+}
+
+/* 複数チャンネルのハーフバンドフィルタの非ゼロ係数の畳み込み（参照実装） */
+static void R2samplerKernel_MultiChannelHalfBandFIRScalar(
+        const float *x, const float *coef, uint32_t num_pairs, uint32_t num_channels, float *output)
+{
+    R2samplerKernel_MultiChannelHalfBandFIRPartial(x, coef, num_pairs, num_channels, 0, output);
+}
+
+#if defined(R2SAMPLERKERNEL_X86)
+
+/* CPUID命令の実行 */
+static void R2samplerKernel_CPUID(uint32_t leaf, uint32_t subleaf, uint32_t *regs)
+{
+#if defined(_MSC_VER)
+    int tmp[4];
+    __cpuidex(tmp, (int)leaf, (int)subleaf);
+    regs[0] = (uint32_t)tmp[0]; regs[1] = (uint32_t)tmp[1];
+    regs[2] = (uint32_t)tmp[2]; regs[3] = (uint32_t)tmp[3];
+#else
+    unsigned int a, b, c, d;
+    if (__get_cpuid_max(0, NULL) < leaf) {
+        regs[0] = regs[1] = regs[2] = regs[3] = 0;
+        return;
+    }
+    __cpuid_count(leaf, subleaf, a, b, c, d);
+    regs[0] = a; regs[1] = b; regs[2] = c; regs[3] = d;
+#endif
+}
+
+/* OSが退避/復元するレジスタ状態(XCR0)の取得 */
+static uint32_t R2samplerKernel_GetXCR0(void)
+{
+#if defined(_MSC_VER)
+    return (uint32_t)_xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+    return eax;
+#endif
+}
+
+/* SSEレジスタ内の総和 */
+R2SAMPLERKERNEL_TARGET("sse2")
+static float R2samplerKernel_HorizontalSumSSE2(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+/* 内積（SSE2） */
+R2SAMPLERKERNEL_TARGET("sse2")
+static float R2samplerKernel_DotProductSSE2(
+        const float *x, const float *coef, uint32_t num_taps)
+{
+    uint32_t i;
+    float sum;
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+
+    for (i = 0; (i + 8) <= num_taps; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(&x[i + 0]), _mm_loadu_ps(&coef[i + 0])));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(&x[i + 4]), _mm_loadu_ps(&coef[i + 4])));
+    }
+    if ((i + 4) <= num_taps) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(&x[i]), _mm_loadu_ps(&coef[i])));
+        i += 4;
+    }
+    sum = R2samplerKernel_HorizontalSumSSE2(_mm_add_ps(acc0, acc1));
+
+    /* 端数 */
+    for (; i < num_taps; i++) {
+        sum += x[i] * coef[i];
+    }
+
+    return sum;
+}
+
+/* 偶対称係数のFIRフィルタ（SSE2） */
+R2SAMPLERKERNEL_TARGET("sse2")
+static float R2samplerKernel_SymmetricFIRSSE2(
+        const float *x, const float *coef, uint32_t filter_order)
+{
+    uint32_t i;
+    const uint32_t half_order = filter_order / 2;
+    float sum;
+    __m128 acc = _mm_setzero_ps();
+
+    for (i = 0; (i + 4) <= half_order; i += 4) {
+        const __m128 head = _mm_loadu_ps(&x[i]);
+        __m128 tail = _mm_loadu_ps(&x[filter_order - i - 4]);
+        /* 後半は逆順に並べ替えて加算 */
+        tail = _mm_shuffle_ps(tail, tail, _MM_SHUFFLE(0, 1, 2, 3));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_add_ps(head, tail), _mm_loadu_ps(&coef[i])));
+    }
+    sum = R2samplerKernel_HorizontalSumSSE2(acc);
+
+    /* 端数と中央 */
+    for (; i < half_order; i++) {
+        sum += (x[i] + x[filter_order - i - 1]) * coef[i];
+    }
+    sum += x[half_order] * coef[half_order];
+
+    return sum;
+}
+
+/* 偶数タップの偶対称係数のFIRフィルタ（SSE2） */
+R2SAMPLERKERNEL_TARGET("sse2")
+static float R2samplerKernel_EvenSymmetricFIRSSE2(
+        const float *x, const float *coef, uint32_t num_taps)
+{
+    uint32_t i;
+    const uint32_t half = num_taps / 2;
+    float sum;
+    __m128 acc = _mm_setzero_ps();
+
+    for (i = 0; (i + 4) <= half; i += 4) {
+        const __m128 head = _mm_loadu_ps(&x[i]);
+        __m128 tail = _mm_loadu_ps(&x[num_taps - i - 4]);
+        /* 後半は逆順に並べ替えて加算 */
+        tail = _mm_shuffle_ps(tail, tail, _MM_SHUFFLE(0, 1, 2, 3));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_add_ps(head, tail), _mm_loadu_ps(&coef[i])));
+    }
+    sum = R2samplerKernel_HorizontalSumSSE2(acc);
+
+    /* 端数 */
+    for (; i < half; i++) {
+        sum += (x[i] + x[num_taps - i - 1]) * coef[i];
+    }
+
+    return sum;
+}
+
+/* ハーフバンドフィルタの非ゼロ係数の畳み込み（SSE2） */
+R2SAMPLERKERNEL_TARGET("sse2")
+static float R2samplerKernel_HalfBandFIRSSE2(
+        const float *x, const float *coef, uint32_t num_pairs)
+{
+    uint32_t i;
+    const uint32_t last = 4 * num_pairs - 2;
+    float sum;
+    __m128 acc = _mm_setzero_ps();
+
+    for (i = 0; (i + 4) <= num_pairs; i += 4) {
+        /* 前半: x[2i], x[2i+2], x[2i+4], x[2i+6] */
+        const __m128 head = _mm_shuffle_ps(
+                _mm_loadu_ps(&x[2 * i]), _mm_loadu_ps(&x[2 * i + 4]), _MM_SHUFFLE(2, 0, 2, 0));
+        /* 後半: x[last-2i], x[last-2i-2], x[last-2i-4], x[last-2i-6]（範囲外を読まないよう3要素ずらしてロード） */
+        const uint32_t base = last - 2 * i - 6;
+        const __m128 tail = _mm_shuffle_ps(
+                _mm_loadu_ps(&x[base + 3]), _mm_loadu_ps(&x[base]), _MM_SHUFFLE(0, 2, 1, 3));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_add_ps(head, tail), _mm_loadu_ps(&coef[i])));
+    }
+    sum = R2samplerKernel_HorizontalSumSSE2(acc);
+
+    /* 端数 */
+    for (; i < num_pairs; i++) {
+        sum += (x[2 * i] + x[last - 2 * i]) * coef[i];
+    }
+
+    return sum;
+}
+
+/* 複数チャンネルの内積（SSE2） チャンネル方向にベクトル化 */
+R2SAMPLERKERNEL_TARGET("sse2")
+static void R2samplerKernel_MultiChannelDotProductSSE2(
+        const float *x, const float *coef, uint32_t num_taps, uint32_t num_channels, float *output)
+{
+    uint32_t ch;
+
+    for (ch = 0; (ch + 4) <= num_channels; ch += 4) {
+        uint32_t i;
+        __m128 acc = _mm_setzero_ps();
+        for (i = 0; i < num_taps; i++) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(&x[i * num_channels + ch]), _mm_set1_ps(coef[i])));
+        }
+        _mm_storeu_ps(&output[ch], acc);
+    }
+
+    /* 端数チャンネル */
+    R2samplerKernel_MultiChannelDotProductPartial(x, coef, num_taps, num_channels, ch, output);
+}
+
+/* 複数チャンネルの偶対称係数のFIRフィルタ（SSE2） チャンネル方向にベクトル化 */
+R2SAMPLERKERNEL_TARGET("sse2")
+static void R2samplerKernel_MultiChannelSymmetricFIRSSE2(
+        const float *x, const float *coef, uint32_t filter_order, uint32_t num_channels, float *output)
+{
+    uint32_t ch;
+    const uint32_t half_order = filter_order / 2;
+
+    for (ch = 0; (ch + 4) <= num_channels; ch += 4) {
+        uint32_t i;
+        __m128 acc = _mm_mul_ps(_mm_loadu_ps(&x[half_order * num_channels + ch]), _mm_set1_ps(coef[half_order]));
+        for (i = 0; i < half_order; i++) {
+            const __m128 pair = _mm_add_ps(
+                    _mm_loadu_ps(&x[i * num_channels + ch]), _mm_loadu_ps(&x[(filter_order - i - 1) * num_channels + ch]));
+            acc = _mm_add_ps(acc, _mm_mul_ps(pair, _mm_set1_ps(coef[i])));
+        }
+        _mm_storeu_ps(&output[ch], acc);
+    }
+
+    /* 端数チャンネル */
+    R2samplerKernel_MultiChannelSymmetricFIRPartial(x, coef, filter_order, num_channels, ch, output);
+}
+
+/* 複数チャンネルのハーフバンドフィルタの非ゼロ係数の畳み込み（SSE2） チャンネル方向にベクトル化 */
+R2SAMPLERKERNEL_TARGET("sse2")
+static void R2samplerKernel_MultiChannelHalfBandFIRSSE2(
+        const float *x, const float *coef, uint32_t num_pairs, uint32_t num_channels, float *output)
+{
+    uint32_t ch;
+    const uint32_t last = 4 * num_pairs - 2;
+
+    for (ch = 0; (ch + 4) <= num_channels; ch += 4) {
+        uint32_t i;
+        __m128 acc = _mm_setzero_ps();
+        for (i = 0; i < num_pairs; i++) {
+            const __m128 pair = _mm_add_ps(
+                    _mm_loadu_ps(&x[2 * i * num_channels + ch]), _mm_loadu_ps(&x[(last - 2 * i) * num_channels + ch]));
+            acc = _mm_add_ps(acc, _mm_mul_ps(pair, _mm_set1_ps(coef[i])));
+        }
+        _mm_storeu_ps(&output[ch], acc);
+    }
+
+    /* 端数チャンネル */
+    R2samplerKernel_MultiChannelHalfBandFIRPartial(x, coef, num_pairs, num_channels, ch, output);
+}
+
+/* AVXレジスタ内の総和 */
+R2SAMPLERKERNEL_TARGET("avx2,fma")
+static float R2samplerKernel_HorizontalSumAVX2(__m256 v)
+{
+    __m128 t = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    t = _mm_add_ps(t, _mm_movehl_ps(t, t));
+    t = _mm_add_ss(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(t);
+}
+
+/* 内積（AVX2） */
+R2SAMPLERKERNEL_TARGET("avx2,fma")
+static float R2samplerKernel_DotProductAVX2(
+        const float *x, const float *coef, uint32_t num_taps)
+{
+    uint32_t i;
+    float sum;
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+
+    for (i = 0; (i + 16) <= num_taps; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(&x[i + 0]), _mm256_loadu_ps(&coef[i + 0]), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(&x[i + 8]), _mm256_loadu_ps(&coef[i + 8]), acc1);
+    }
+    if ((i + 8) <= num_taps) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(&x[i]), _mm256_loadu_ps(&coef[i]), acc0);
+        i += 8;
+    }
+    sum = R2samplerKernel_HorizontalSumAVX2(_mm256_add_ps(acc0, acc1));
+
+    /* 端数 */
+    for (; i < num_taps; i++) {
+        sum += x[i] * coef[i];
+    }
+
+    return sum;
+}
+
+/* 偶対称係数のFIRフィルタ（AVX2） */
+R2SAMPLERKERNEL_TARGET("avx2,fma")
+static float R2samplerKernel_SymmetricFIRAVX2(
+        const float *x, const float *coef, uint32_t filter_order)
+{
+    uint32_t i;
+    const uint32_t half_order = filter_order / 2;
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    float sum;
+    __m256 acc = _mm256_setzero_ps();
+
+    for (i = 0; (i + 8) <= half_order; i += 8) {
+        const __m256 head = _mm256_loadu_ps(&x[i]);
+        /* 後半は逆順に並べ替えて加算 */
+        const __m256 tail = _mm256_permutevar8x32_ps(_mm256_loadu_ps(&x[filter_order - i - 8]), reverse);
+        acc = _mm256_fmadd_ps(_mm256_add_ps(head, tail), _mm256_loadu_ps(&coef[i]), acc);
+    }
+    sum = R2samplerKernel_HorizontalSumAVX2(acc);
+
+    /* 端数と中央 */
+    for (; i < half_order; i++) {
+        sum += (x[i] + x[filter_order - i - 1]) * coef[i];
+    }
+    sum += x[half_order] * coef[half_order];
+
+    return sum;
+}
+
+/* 偶数タップの偶対称係数のFIRフィルタ（AVX2） */
+R2SAMPLERKERNEL_TARGET("avx2,fma")
+static float R2samplerKernel_EvenSymmetricFIRAVX2(
+        const float *x, const float *coef, uint32_t num_taps)
+{
+    uint32_t i;
+    const uint32_t half = num_taps / 2;
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    float sum;
+    __m256 acc = _mm256_setzero_ps();
+
+    for (i = 0; (i + 8) <= half; i += 8) {
+        const __m256 head = _mm256_loadu_ps(&x[i]);
+        /* 後半は逆順に並べ替えて加算 */
+        const __m256 tail = _mm256_permutevar8x32_ps(_mm256_loadu_ps(&x[num_taps - i - 8]), reverse);
+        acc = _mm256_fmadd_ps(_mm256_add_ps(head, tail), _mm256_loadu_ps(&coef[i]), acc);
+    }
+    sum = R2samplerKernel_HorizontalSumAVX2(acc);
+
+    /* 端数 */
+    for (; i < half; i++) {
+        sum += (x[i] + x[num_taps - i - 1]) * coef[i];
+    }
+
+    return sum;
+}
+
+/* ハーフバンドフィルタの非ゼロ係数の畳み込み（AVX2） */
+R2SAMPLERKERNEL_TARGET("avx2,fma")
+static float R2samplerKernel_HalfBandFIRAVX2(
+        const float *x, const float *coef, uint32_t num_pairs)
+{
+    uint32_t i;
+    const uint32_t last = 4 * num_pairs - 2;
+    /* シャッフル後の並び [0,2,8,10,4,6,12,14] を昇順/降順に並べ替えるインデックス */
+    const __m256i head_order = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+    const __m256i tail_order = _mm256_setr_epi32(7, 6, 3, 2, 5, 4, 1, 0);
+    float sum;
+    __m256 acc = _mm256_setzero_ps();
+
+    for (i = 0; (i + 8) <= num_pairs; i += 8) {
+        /* 前半: x[2i], x[2i+2], ..., x[2i+14] */
+        const __m256 head = _mm256_permutevar8x32_ps(_mm256_shuffle_ps(
+                    _mm256_loadu_ps(&x[2 * i]), _mm256_loadu_ps(&x[2 * i + 8]), _MM_SHUFFLE(2, 0, 2, 0)), head_order);
+        /* 後半: x[last-2i], x[last-2i-2], ..., x[last-2i-14]（範囲外を読まないよう1要素手前からロード） */
+        const uint32_t base = last - 2 * i - 14;
+        const __m256 tail = _mm256_permutevar8x32_ps(_mm256_shuffle_ps(
+                    _mm256_loadu_ps(&x[base - 1]), _mm256_loadu_ps(&x[base + 7]), _MM_SHUFFLE(3, 1, 3, 1)), tail_order);
+        acc = _mm256_fmadd_ps(_mm256_add_ps(head, tail), _mm256_loadu_ps(&coef[i]), acc);
+    }
+    sum = R2samplerKernel_HorizontalSumAVX2(acc);
+
+    /* 端数 */
+    for (; i < num_pairs; i++) {
+        sum += (x[2 * i] + x[last - 2 * i]) * coef[i];
+    }
+
+    return sum;
+}
+
+/* 複数チャンネルの内積（AVX2） チャンネル方向にベクトル化 */
+R2SAMPLERKERNEL_TARGET("avx2,fma")
+static void R2samplerKernel_MultiChannelDotProductAVX2(
+        const float *x, const float *coef, uint32_t num_taps, uint32_t num_channels, float *output)
+{
+    uint32_t ch;
+
+    for (ch = 0; (ch + 8) <= num_channels; ch += 8) {
+        uint32_t i;
+        __m256 acc = _mm256_setzero_ps();
+        for (i = 0; i < num_taps; i++) {
+            acc = _mm256_fmadd_ps(_mm256_loadu_ps(&x[i * num_channels + ch]), _mm256_set1_ps(coef[i]), acc);
+        }
+        _mm256_storeu_ps(&output[ch], acc);
+    }
+    for (; (ch + 4) <= num_channels; ch += 4) {
+        uint32_t i;
+        __m128 acc = _mm_setzero_ps();
+        for (i = 0; i < num_taps; i++) {
+            acc = _mm_fmadd_ps(_mm_loadu_ps(&x[i * num_channels + ch]), _mm_set1_ps(coef[i]), acc);
+        }
+        _mm_storeu_ps(&output[ch], acc);
+    }
+
+    /* 端数チャンネル */
+    R2samplerKernel_MultiChannelDotProductPartial(x, coef, num_taps, num_channels, ch, output);
+}
+
+/* 複数チャンネルの偶対称係数のFIRフィルタ（AVX2） チャンネル方向にベクトル化 */
+R2SAMPLERKERNEL_TARGET("avx2,fma")
+static void R2samplerKernel_MultiChannelSymmetricFIRAVX2(
+        const float *x, const float *coef, uint32_t filter_order, uint32_t num_channels, float *output)
+{
+    uint32_t ch;
+    const uint32_t half_order = filter_order / 2;
+
+    for (ch = 0; (ch + 8) <= num_channels; ch += 8) {
+        uint32_t i;
+        __m256 acc = _mm256_mul_ps(_mm256_loadu_ps(&x[half_order * num_channels + ch]), _mm256_set1_ps(coef[half_order]));
+        for (i = 0; i < half_order; i++) {
+            const __m256 pair = _mm256_add_ps(
+                    _mm256_loadu_ps(&x[i * num_channels + ch]), _mm256_loadu_ps(&x[(filter_order - i - 1) * num_channels + ch]));
+            acc = _mm256_fmadd_ps(pair, _mm256_set1_ps(coef[i]), acc);
+        }
+        _mm256_storeu_ps(&output[ch], acc);
+    }
+    for (; (ch + 4) <= num_channels; ch += 4) {
+        uint32_t i;
+        __m128 acc = _mm_mul_ps(_mm_loadu_ps(&x[half_order * num_channels + ch]), _mm_set1_ps(coef[half_order]));
+        for (i = 0; i < half_order; i++) {
+            const __m128 pair = _mm_add_ps(
+                    _mm_loadu_ps(&x[i * num_channels + ch]), _mm_loadu_ps(&x[(filter_order - i - 1) * num_channels + ch]));
+            acc = _mm_fmadd_ps(pair, _mm_set1_ps(coef[i]), acc);
+        }
+        _mm_storeu_ps(&output[ch], acc);
+    }
+
+    /* 端数チャンネル */
+    R2samplerKernel_MultiChannelSymmetricFIRPartial(x, coef, filter_order, num_channels, ch, output);
+}
+
+/* 複数チャンネルのハーフバンドフィルタの非ゼロ係数の畳み込み（AVX2） チャンネル方向にベクトル化 */
+R2SAMPLERKERNEL_TARGET("avx2,fma")
+static void R2samplerKernel_MultiChannelHalfBandFIRAVX2(
+        const float *x, const float *coef, uint32_t num_pairs, uint32_t num_channels, float *output)
+{
+    uint32_t ch;
+    const uint32_t last = 4 * num_pairs - 2;
+
+    for (ch = 0; (ch + 8) <= num_channels; ch += 8) {
+        uint32_t i;
+        __m256 acc = _mm256_setzero_ps();
+        for (i = 0; i < num_pairs; i++) {
+            const __m256 pair = _mm256_add_ps(
+                    _mm256_loadu_ps(&x[2 * i * num_channels + ch]), _mm256_loadu_ps(&x[(last - 2 * i) * num_channels + ch]));
+            acc = _mm256_fmadd_ps(pair, _mm256_set1_ps(coef[i]), acc);
+        }
+        _mm256_storeu_ps(&output[ch], acc);
+    }
+    for (; (ch + 4) <= num_channels; ch += 4) {
+        uint32_t i;
+        __m128 acc = _mm_setzero_ps();
+        for (i = 0; i < num_pairs; i++) {
+            const __m128 pair = _mm_add_ps(
+                    _mm_loadu_ps(&x[2 * i * num_channels + ch]), _mm_loadu_ps(&x[(last - 2 * i) * num_channels + ch]));
+            acc = _mm_fmadd_ps(pair, _mm_set1_ps(coef[i]), acc);
+        }
+        _mm_storeu_ps(&output[ch], acc);
+    }
+
+    /* 端数チャンネル */
+    R2samplerKernel_MultiChannelHalfBandFIRPartial(x, coef, num_pairs, num_channels, ch, output);
+}
+
+#if defined(R2SAMPLERKERNEL_ENABLE_AVX512)
+
+/* 内積（AVX-512） */
+R2SAMPLERKERNEL_TARGET("avx512f")
+static float R2samplerKernel_DotProductAVX512(
+        const float *x, const float *coef, uint32_t num_taps)
+{
+    uint32_t i;
+    __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+
+    for (i = 0; (i + 32) <= num_taps; i += 32) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(&x[i +  0]), _mm512_loadu_ps(&coef[i +  0]), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(&x[i + 16]), _mm512_loadu_ps(&coef[i + 16]), acc1);
+    }
+    if ((i + 16) <= num_taps) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(&x[i]), _mm512_loadu_ps(&coef[i]), acc0);
+        i += 16;
+    }
+    /* 端数はマスク付きロードで処理 */
+    if (i < num_taps) {
+        const __mmask16 mask = (__mmask16)((1U << (num_taps - i)) - 1);
+        acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, &x[i]), _mm512_maskz_loadu_ps(mask, &coef[i]), acc1);
+    }
+
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+/* 偶対称係数のFIRフィルタ（AVX-512） */
+R2SAMPLERKERNEL_TARGET("avx512f")
+static float R2samplerKernel_SymmetricFIRAVX512(
+        const float *x, const float *coef, uint32_t filter_order)
+{
+    uint32_t i;
+    const uint32_t half_order = filter_order / 2;
+    const __m512i reverse = _mm512_set_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    float sum;
+    __m512 acc = _mm512_setzero_ps();
+
+    for (i = 0; (i + 16) <= half_order; i += 16) {
+        const __m512 head = _mm512_loadu_ps(&x[i]);
+        /* 後半は逆順に並べ替えて加算 */
+        const __m512 tail = _mm512_permutexvar_ps(reverse, _mm512_loadu_ps(&x[filter_order - i - 16]));
+        acc = _mm512_fmadd_ps(_mm512_add_ps(head, tail), _mm512_loadu_ps(&coef[i]), acc);
+    }
+    sum = _mm512_reduce_add_ps(acc);
+
+    /* 端数と中央 */
+    for (; i < half_order; i++) {
+        sum += (x[i] + x[filter_order - i - 1]) * coef[i];
+    }
+    sum += x[half_order] * coef[half_order];
+
+    return sum;
+}
+
+/* 複数チャンネルの内積（AVX-512） チャンネル方向にベクトル化 */
+R2SAMPLERKERNEL_TARGET("avx512f")
+static void R2samplerKernel_MultiChannelDotProductAVX512(
+        const float *x, const float *coef, uint32_t num_taps, uint32_t num_channels, float *output)
+{
+    uint32_t ch;
+
+    for (ch = 0; ch < num_channels; ch += 16) {
+        uint32_t i;
+        /* 端数チャンネルはマスク付きロード/ストアで処理 */
+        const __mmask16 mask = ((ch + 16) <= num_channels) ? (__mmask16)0xFFFF : (__mmask16)((1U << (num_channels - ch)) - 1);
+        __m512 acc = _mm512_setzero_ps();
+        for (i = 0; i < num_taps; i++) {
+            acc = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, &x[i * num_channels + ch]), _mm512_set1_ps(coef[i]), acc);
+        }
+        _mm512_mask_storeu_ps(&output[ch], mask, acc);
+    }
+}
+
+/* 複数チャンネルの偶対称係数のFIRフィルタ（AVX-512） チャンネル方向にベクトル化 */
+R2SAMPLERKERNEL_TARGET("avx512f")
+static void R2samplerKernel_MultiChannelSymmetricFIRAVX512(
+        const float *x, const float *coef, uint32_t filter_order, uint32_t num_channels, float *output)
+{
+    uint32_t ch;
+    const uint32_t half_order = filter_order / 2;
+
+    for (ch = 0; ch < num_channels; ch += 16) {
+        uint32_t i;
+        /* 端数チャンネルはマスク付きロード/ストアで処理 */
+        const __mmask16 mask = ((ch + 16) <= num_channels) ? (__mmask16)0xFFFF : (__mmask16)((1U << (num_channels - ch)) - 1);
+        __m512 acc = _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, &x[half_order * num_channels + ch]), _mm512_set1_ps(coef[half_order]));
+        for (i = 0; i < half_order; i++) {
+            const __m512 pair = _mm512_add_ps(
+                    _mm512_maskz_loadu_ps(mask, &x[i * num_channels + ch]),
+                    _mm512_maskz_loadu_ps(mask, &x[(filter_order - i - 1) * num_channels + ch]));
+            acc = _mm512_fmadd_ps(pair, _mm512_set1_ps(coef[i]), acc);
+        }
+        _mm512_mask_storeu_ps(&output[ch], mask, acc);
+    }
+}
+
+#endif /* R2SAMPLERKERNEL_ENABLE_AVX512 */
+
+#endif /* R2SAMPLERKERNEL_X86 */
+
+#if defined(R2SAMPLERKERNEL_NEON)
+
+/* NEONレジスタ内の総和 */
+static float R2samplerKernel_HorizontalSumNEON(float32x4_t v)
+{
+    float32x2_t t = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    t = vpadd_f32(t, t);
+    return vget_lane_f32(t, 0);
+}
+
+/* 内積（NEON） */
+static float R2samplerKernel_DotProductNEON(
+        const float *x, const float *coef, uint32_t num_taps)
+{
+    uint32_t i;
+    float sum;
+    float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+
+    for (i = 0; (i + 8) <= num_taps; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(&x[i + 0]), vld1q_f32(&coef[i + 0]));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(&x[i + 4]), vld1q_f32(&coef[i + 4]));
+    }
+    if ((i + 4) <= num_taps) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(&x[i]), vld1q_f32(&coef[i]));
+        i += 4;
+    }
+    sum = R2samplerKernel_HorizontalSumNEON(vaddq_f32(acc0, acc1));
+
+    /* 端数 */
+    for (; i < num_taps; i++) {
+        sum += x[i] * coef[i];
+    }
+
+    return sum;
+}
+
+/* 偶対称係数のFIRフィルタ（NEON） */
+static float R2samplerKernel_SymmetricFIRNEON(
+        const float *x, const float *coef, uint32_t filter_order)
+{
+    uint32_t i;
+    const uint32_t half_order = filter_order / 2;
+    float sum;
+    float32x4_t acc = vdupq_n_f32(0.0f);
+
+    for (i = 0; (i + 4) <= half_order; i += 4) {
+        const float32x4_t head = vld1q_f32(&x[i]);
+        /* 後半は逆順に並べ替えて加算 */
+        float32x4_t tail = vrev64q_f32(vld1q_f32(&x[filter_order - i - 4]));
+        tail = vcombine_f32(vget_high_f32(tail), vget_low_f32(tail));
+        acc = vmlaq_f32(acc, vaddq_f32(head, tail), vld1q_f32(&coef[i]));
+    }
+    sum = R2samplerKernel_HorizontalSumNEON(acc);
+
+    /* 端数と中央 */
+    for (; i < half_order; i++) {
+        sum += (x[i] + x[filter_order - i - 1]) * coef[i];
+    }
+    sum += x[half_order] * coef[half_order];
+
+    return sum;
+}
+
+/* 偶数タップの偶対称係数のFIRフィルタ（NEON） */
+static float R2samplerKernel_EvenSymmetricFIRNEON(
+        const float *x, const float *coef, uint32_t num_taps)
+{
+    uint32_t i;
+    const uint32_t half = num_taps / 2;
+    float sum;
+    float32x4_t acc = vdupq_n_f32(0.0f);
+
+    for (i = 0; (i + 4) <= half; i += 4) {
+        const float32x4_t head = vld1q_f32(&x[i]);
+        /* 後半は逆順に並べ替えて加算 */
+        float32x4_t tail = vrev64q_f32(vld1q_f32(&x[num_taps - i - 4]));
+        tail = vcombine_f32(vget_high_f32(tail), vget_low_f32(tail));
+        acc = vmlaq_f32(acc, vaddq_f32(head, tail), vld1q_f32(&coef[i]));
+    }
+    sum = R2samplerKernel_HorizontalSumNEON(acc);
+
+    /* 端数 */
+    for (; i < half; i++) {
+        sum += (x[i] + x[num_taps - i - 1]) * coef[i];
+    }
+
+    return sum;
+}
+
+/* ハーフバンドフィルタの非ゼロ係数の畳み込み（NEON） */
+static float R2samplerKernel_HalfBandFIRNEON(
+        const float *x, const float *coef, uint32_t num_pairs)
+{
+    uint32_t i;
+    const uint32_t last = 4 * num_pairs - 2;
+    float sum;
+    float32x4_t acc = vdupq_n_f32(0.0f);
+
+    for (i = 0; (i + 4) <= num_pairs; i += 4) {
+        /* 前半: デインターリーブロードで偶数番目を取得 */
+        const float32x4_t head = vld2q_f32(&x[2 * i]).val[0];
+        /* 後半: 範囲外を読まないよう1要素手前からロードして奇数番目を取得し、逆順に並べ替え */
+        float32x4_t tail = vrev64q_f32(vld2q_f32(&x[last - 2 * i - 7]).val[1]);
+        tail = vcombine_f32(vget_high_f32(tail), vget_low_f32(tail));
+        acc = vmlaq_f32(acc, vaddq_f32(head, tail), vld1q_f32(&coef[i]));
+    }
+    sum = R2samplerKernel_HorizontalSumNEON(acc);
+
+    /* 端数 */
+    for (; i < num_pairs; i++) {
+        sum += (x[2 * i] + x[last - 2 * i]) * coef[i];
+    }
+
+    return sum;
+}
+
+/* 複数チャンネルの内積（NEON） チャンネル方向にベクトル化 */
+static void R2samplerKernel_MultiChannelDotProductNEON(
+        const float *x, const float *coef, uint32_t num_taps, uint32_t num_channels, float *output)
+{
+    uint32_t ch;
+
+    for (ch = 0; (ch + 4) <= num_channels; ch += 4) {
+        uint32_t i;
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for (i = 0; i < num_taps; i++) {
+            acc = vmlaq_n_f32(acc, vld1q_f32(&x[i * num_channels + ch]), coef[i]);
+        }
+        vst1q_f32(&output[ch], acc);
+    }
+
+    /* 端数チャンネル */
+    R2samplerKernel_MultiChannelDotProductPartial(x, coef, num_taps, num_channels, ch, output);
+}
+
+/* 複数チャンネルの偶対称係数のFIRフィルタ（NEON） チャンネル方向にベクトル化 */
+static void R2samplerKernel_MultiChannelSymmetricFIRNEON(
+        const float *x, const float *coef, uint32_t filter_order, uint32_t num_channels, float *output)
+{
+    uint32_t ch;
+    const uint32_t half_order = filter_order / 2;
+
+    for (ch = 0; (ch + 4) <= num_channels; ch += 4) {
+        uint32_t i;
+        float32x4_t acc = vmulq_n_f32(vld1q_f32(&x[half_order * num_channels + ch]), coef[half_order]);
+        for (i = 0; i < half_order; i++) {
+            const float32x4_t pair = vaddq_f32(
+                    vld1q_f32(&x[i * num_channels + ch]), vld1q_f32(&x[(filter_order - i - 1) * num_channels + ch]));
+            acc = vmlaq_n_f32(acc, pair, coef[i]);
+        }
+        vst1q_f32(&output[ch], acc);
+    }
+
+    /* 端数チャンネル */
+    R2samplerKernel_MultiChannelSymmetricFIRPartial(x, coef, filter_order, num_channels, ch, output);
+}
+
+/* 複数チャンネルのハーフバンドフィルタの非ゼロ係数の畳み込み（NEON） チャンネル方向にベクトル化 */
+static void R2samplerKernel_MultiChannelHalfBandFIRNEON(
+        const float *x, const float *coef, uint32_t num_pairs, uint32_t num_channels, float *output)
+{
+    uint32_t ch;
+    const uint32_t last = 4 * num_pairs - 2;
+
+    for (ch = 0; (ch + 4) <= num_channels; ch += 4) {
+        uint32_t i;
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for (i = 0; i < num_pairs; i++) {
+            const float32x4_t pair = vaddq_f32(
+                    vld1q_f32(&x[2 * i * num_channels + ch]), vld1q_f32(&x[(last - 2 * i) * num_channels + ch]));
+            acc = vmlaq_n_f32(acc, pair, coef[i]);
+        }
+        vst1q_f32(&output[ch], acc);
+    }
+
+    /* 端数チャンネル */
+    R2samplerKernel_MultiChannelHalfBandFIRPartial(x, coef, num_pairs, num_channels, ch, output);
+}
+
+#endif /* R2SAMPLERKERNEL_NEON */
+
+/* 指定した命令セットが実行環境で使用可能か判定 */
+uint8_t R2samplerKernel_IsSupported(R2samplerKernelType type)
+{
+    switch (type) {
+    case R2SAMPLERKERNEL_TYPE_SCALAR:
+        return 1;
+#if defined(R2SAMPLERKERNEL_X86)
+    case R2SAMPLERKERNEL_TYPE_SSE2:
+        {
+            uint32_t regs[4];
+            R2samplerKernel_CPUID(1, 0, regs);
+            return ((regs[3] >> 26) & 1) ? 1 : 0;
+        }
+    case R2SAMPLERKERNEL_TYPE_AVX2:
+    case R2SAMPLERKERNEL_TYPE_AVX512:
+        {
+            uint32_t regs[4], xcr0;
+            /* OSXSAVE, AVX, FMA */
+            R2samplerKernel_CPUID(1, 0, regs);
+            if (!((regs[2] >> 27) & 1) || !((regs[2] >> 28) & 1) || !((regs[2] >> 12) & 1)) {
+                return 0;
+            }
+            /* OSがYMMレジスタを退避するか */
+            xcr0 = R2samplerKernel_GetXCR0();
+            if ((xcr0 & 0x6) != 0x6) {
+                return 0;
+            }
+            R2samplerKernel_CPUID(7, 0, regs);
+            if (type == R2SAMPLERKERNEL_TYPE_AVX2) {
+                return ((regs[1] >> 5) & 1) ? 1 : 0;
+            }
+#if defined(R2SAMPLERKERNEL_ENABLE_AVX512)
+            /* AVX2（一部の処理で使用）とAVX-512F かつOSがZMMレジスタ/マスクレジスタを退避するか */
+            return (((regs[1] >> 5) & 1) && ((regs[1] >> 16) & 1) && ((xcr0 & 0xE6) == 0xE6)) ? 1 : 0;
+#else
+            return 0;
+#endif
+        }
+#endif /* R2SAMPLERKERNEL_X86 */
+#if defined(R2SAMPLERKERNEL_NEON)
+    case R2SAMPLERKERNEL_TYPE_NEON:
+        /* NEONが有効なビルドでは常に使用可能 */
+        return 1;
+#endif
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+/* 指定した命令セットのカーネルを取得 使用できない場合は0を返す */
+uint8_t R2samplerKernel_Get(R2samplerKernelType type, struct R2samplerKernel *kernel)
+{
+    assert(kernel != NULL);
+
+    if (!R2samplerKernel_IsSupported(type)) {
+        return 0;
+    }
+
+    kernel->type = type;
+    switch (type) {
+    case R2SAMPLERKERNEL_TYPE_SCALAR:
+        kernel->dot_product = R2samplerKernel_DotProductScalar;
+        kernel->symmetric_fir = R2samplerKernel_SymmetricFIRScalar;
+        kernel->even_symmetric_fir = R2samplerKernel_EvenSymmetricFIRScalar;
+        kernel->half_band_fir = R2samplerKernel_HalfBandFIRScalar;
+        kernel->multi_channel_dot_product = R2samplerKernel_MultiChannelDotProductScalar;
+        kernel->multi_channel_symmetric_fir = R2samplerKernel_MultiChannelSymmetricFIRScalar;
+        kernel->multi_channel_half_band_fir = R2samplerKernel_MultiChannelHalfBandFIRScalar;
+        break;
+#if defined(R2SAMPLERKERNEL_X86)
+    case R2SAMPLERKERNEL_TYPE_SSE2:
+        kernel->dot_product = R2samplerKernel_DotProductSSE2;
+        kernel->symmetric_fir = R2samplerKernel_SymmetricFIRSSE2;
+        kernel->even_symmetric_fir = R2samplerKernel_EvenSymmetricFIRSSE2;
+        kernel->half_band_fir = R2samplerKernel_HalfBandFIRSSE2;
+        kernel->multi_channel_dot_product = R2samplerKernel_MultiChannelDotProductSSE2;
+        kernel->multi_channel_symmetric_fir = R2samplerKernel_MultiChannelSymmetricFIRSSE2;
+        kernel->multi_channel_half_band_fir = R2samplerKernel_MultiChannelHalfBandFIRSSE2;
+        break;
+    case R2SAMPLERKERNEL_TYPE_AVX2:
+        kernel->dot_product = R2samplerKernel_DotProductAVX2;
+        kernel->symmetric_fir = R2samplerKernel_SymmetricFIRAVX2;
+        kernel->even_symmetric_fir = R2samplerKernel_EvenSymmetricFIRAVX2;
+        kernel->half_band_fir = R2samplerKernel_HalfBandFIRAVX2;
+        kernel->multi_channel_dot_product = R2samplerKernel_MultiChannelDotProductAVX2;
+        kernel->multi_channel_symmetric_fir = R2samplerKernel_MultiChannelSymmetricFIRAVX2;
+        kernel->multi_channel_half_band_fir = R2samplerKernel_MultiChannelHalfBandFIRAVX2;
+        break;
+#if defined(R2SAMPLERKERNEL_ENABLE_AVX512)
+    case R2SAMPLERKERNEL_TYPE_AVX512:
+        kernel->dot_product = R2samplerKernel_DotProductAVX512;
+        kernel->symmetric_fir = R2samplerKernel_SymmetricFIRAVX512;
+        /* ハーフバンド系はAVX2版を使用（AVX-512はAVX2を包含） */
+        kernel->even_symmetric_fir = R2samplerKernel_EvenSymmetricFIRAVX2;
+        kernel->half_band_fir = R2samplerKernel_HalfBandFIRAVX2;
+        kernel->multi_channel_dot_product = R2samplerKernel_MultiChannelDotProductAVX512;
+        kernel->multi_channel_symmetric_fir = R2samplerKernel_MultiChannelSymmetricFIRAVX512;
+        kernel->multi_channel_half_band_fir = R2samplerKernel_MultiChannelHalfBandFIRAVX2;
+        break;
+#endif
+#endif /* R2SAMPLERKERNEL_X86 */
+#if defined(R2SAMPLERKERNEL_NEON)
+    case R2SAMPLERKERNEL_TYPE_NEON:
+        kernel->dot_product = R2samplerKernel_DotProductNEON;
+        kernel->symmetric_fir = R2samplerKernel_SymmetricFIRNEON;
+        kernel->even_symmetric_fir = R2samplerKernel_EvenSymmetricFIRNEON;
+        kernel->half_band_fir = R2samplerKernel_HalfBandFIRNEON;
+        kernel->multi_channel_dot_product = R2samplerKernel_MultiChannelDotProductNEON;
+        kernel->multi_channel_symmetric_fir = R2samplerKernel_MultiChannelSymmetricFIRNEON;
+        kernel->multi_channel_half_band_fir = R2samplerKernel_MultiChannelHalfBandFIRNEON;
+        break;
+#endif
+    default:
+        assert(0);
+        return 0;
+    }
+
+    return 1;
+}
+
+/* 実行環境で使用可能な最速のカーネルを取得 */
+void R2samplerKernel_Select(struct R2samplerKernel *kernel)
+{
+    /* 優先順（速い順）に並べた候補 */
+    static const R2samplerKernelType candidates[] = {
+        R2SAMPLERKERNEL_TYPE_AVX512,
+        R2SAMPLERKERNEL_TYPE_AVX2,
+        R2SAMPLERKERNEL_TYPE_SSE2,
+        R2SAMPLERKERNEL_TYPE_NEON,
+    };
+    uint32_t i;
+
+    assert(kernel != NULL);
+
+    for (i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        if (R2samplerKernel_Get(candidates[i], kernel)) {
+            return;
+        }
+    }
+
+    /* 参照実装は常に使用可能 */
+    (void)R2samplerKernel_Get(R2SAMPLERKERNEL_TYPE_SCALAR, kernel);
+}
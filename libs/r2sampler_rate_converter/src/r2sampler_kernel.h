@@ -0,0 +1,77 @@
+#ifndef R2SAMPLER_KERNEL_H_INCLUDED
+#define R2SAMPLER_KERNEL_H_INCLUDED
+
+#include <stdint.h>
+
+/* 演算カーネルの命令セット種別 */
+typedef enum R2samplerKernelType {
+    R2SAMPLERKERNEL_TYPE_SCALAR = 0,    /* 参照実装（スカラー演算） */
+    R2SAMPLERKERNEL_TYPE_SSE2,          /* SSE2 */
+    R2SAMPLERKERNEL_TYPE_AVX2,          /* AVX2 + FMA */
+    R2SAMPLERKERNEL_TYPE_AVX512,        /* AVX-512F */
+    R2SAMPLERKERNEL_TYPE_NEON,          /* NEON */
+    R2SAMPLERKERNEL_TYPE_INVALID        /* 無効値 */
+} R2samplerKernelType;
+
+/* 内積 sum_{i=0}^{num_taps-1} x[i] * coef[i] */
+typedef float (*R2samplerDotProductFunction)(
+        const float *x, const float *coef, uint32_t num_taps);
+
+/* 偶対称係数（奇数次数）のFIRフィルタ
+ * x[half] * coef[half] + sum_{i=0}^{half-1} (x[i] + x[filter_order - i - 1]) * coef[i] */
+typedef float (*R2samplerSymmetricFIRFunction)(
+        const float *x, const float *coef, uint32_t filter_order);
+
+/* 複数チャンネルの内積 入力はチャンネルインターリーブ（x[i * num_channels + ch]）
+ * output[ch] = sum_{i=0}^{num_taps-1} x[i * num_channels + ch] * coef[i] */
+typedef void (*R2samplerMultiChannelDotProductFunction)(
+        const float *x, const float *coef, uint32_t num_taps, uint32_t num_channels, float *output);
+
+/* 複数チャンネルの偶対称係数（奇数次数）のFIRフィルタ 入力はチャンネルインターリーブ */
+typedef void (*R2samplerMultiChannelSymmetricFIRFunction)(
+        const float *x, const float *coef, uint32_t filter_order, uint32_t num_channels, float *output);
+
+/* 偶数タップの偶対称係数のFIRフィルタ（中央タップなし）
+ * sum_{i=0}^{num_taps/2-1} (x[i] + x[num_taps - i - 1]) * coef[i] */
+typedef float (*R2samplerEvenSymmetricFIRFunction)(
+        const float *x, const float *coef, uint32_t num_taps);
+
+/* ハーフバンドフィルタの非ゼロ係数（1つおき）の畳み込み 中央タップは含まない
+ * sum_{i=0}^{num_pairs-1} (x[2 * i] + x[4 * num_pairs - 2 * i - 2]) * coef[i] */
+typedef float (*R2samplerHalfBandFIRFunction)(
+        const float *x, const float *coef, uint32_t num_pairs);
+
+/* 複数チャンネルのハーフバンドフィルタの非ゼロ係数の畳み込み 入力はチャンネルインターリーブ */
+typedef void (*R2samplerMultiChannelHalfBandFIRFunction)(
+        const float *x, const float *coef, uint32_t num_pairs, uint32_t num_channels, float *output);
+
+/* 演算カーネル */
+struct R2samplerKernel {
+    R2samplerKernelType type;
+    R2samplerDotProductFunction dot_product;
+    R2samplerSymmetricFIRFunction symmetric_fir;
+    R2samplerEvenSymmetricFIRFunction even_symmetric_fir;
+    R2samplerHalfBandFIRFunction half_band_fir;
+    R2samplerMultiChannelDotProductFunction multi_channel_dot_product;
+    R2samplerMultiChannelSymmetricFIRFunction multi_channel_symmetric_fir;
+    R2samplerMultiChannelHalfBandFIRFunction multi_channel_half_band_fir;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* 指定した命令セットが実行環境で使用可能か判定 */
+uint8_t R2samplerKernel_IsSupported(R2samplerKernelType type);
+
+/* 指定した命令セットのカーネルを取得 使用できない場合は0を返す */
+uint8_t R2samplerKernel_Get(R2samplerKernelType type, struct R2samplerKernel *kernel);
+
+/* 実行環境で使用可能な最速のカーネルを取得 */
+void R2samplerKernel_Select(struct R2samplerKernel *kernel);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* R2SAMPLER_KERNEL_H_INCLUDED */
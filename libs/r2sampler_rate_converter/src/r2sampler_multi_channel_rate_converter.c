@@ -0,0 +1,362 @@
+#include <r2sampler.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "r2sampler_utility.h"
+#include "r2sampler_internal.h"
+
+/* メモリアラインメント */
+#define R2SAMPLERMCRATECONVERTER_ALIGNMENT 16
+/* nの倍数に切り上げ */
+#define R2SAMPLERMCRATECONVERTER_ROUNDUP(val, n) ((((val) + ((n) - 1)) / (n)) * (n))
+/* a,bのうち小さい方を選択 */
+#define R2SAMPLERMCRATECONVERTER_MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+/* マルチチャンネルレート変換器ハンドル */
+struct R2samplerMultiChannelRateConverter {
+    struct R2samplerMultiStageRateConverter *multi_stage;
+    uint32_t num_channels;
+    uint32_t max_num_input_samples;
+    uint32_t max_num_block_samples; /* 1回にマルチステージ変換器に入れる最大の入力サンプル数 */
+    uint32_t max_num_output_samples;
+    float *input_buffer; /* チャンネルインターリーブした入力 */
+    float *output_buffer; /* チャンネルインターリーブした出力 */
+    uint8_t alloc_by_own;
+    struct R2samplerAllocator allocator; /* ワーク領域を確保したアロケータ */
+    void *work;
+};
+
+/* 内部バッファに必要な出力サンプル数を計算 */
+static uint32_t R2samplerMultiChannelRateConverter_CalculateMaxNumOutputSamples(
+        const struct R2samplerMultiChannelRateConverterConfig *config)
+{
+    assert(config != NULL);
+    /* マルチステージ変換器の最終ステージの最大出力サンプル数 */
+    return R2samplerMultiStageRateConverter_CalculateMaxNumOutputSamples(&config->multi_stage);
+}
+
+/* マルチチャンネルレート変換器生成コンフィグを既定値で初期化 */
+R2samplerRateConverterApiResult R2samplerMultiChannelRateConverter_InitializeConfig(struct R2samplerMultiChannelRateConverterConfig *config)
+{
+    R2samplerRateConverterApiResult ret;
+
+    /* 引数チェック */
+    if (config == NULL) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    memset(config, 0, sizeof(struct R2samplerMultiChannelRateConverterConfig));
+    if ((ret = R2samplerMultiStageRateConverter_InitializeConfig(&config->multi_stage)) != R2SAMPLERRATECONVERTER_APIRESULT_OK) {
+        return ret;
+    }
+    config->num_channels = 1;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* マルチチャンネルレート変換器作成に必要なワークサイズ計算 */
+int32_t R2samplerMultiChannelRateConverter_CalculateWorkSize(const struct R2samplerMultiChannelRateConverterConfig *config)
+{
+    struct R2samplerWorkSizeBreakdown breakdown;
+
+    /* 引数チェック */
+    if (config == NULL) {
+        return -1;
+    }
+
+    if (R2samplerMultiChannelRateConverter_CalculateWorkSizeBreakdown(config, &breakdown) != R2SAMPLERRATECONVERTER_APIRESULT_OK) {
+        return -1;
+    }
+
+    return breakdown.total;
+}
+
+/* マルチチャンネルレート変換器作成に必要なワークサイズの内訳を計算 */
+R2samplerRateConverterApiResult R2samplerMultiChannelRateConverter_CalculateWorkSizeBreakdown(
+        const struct R2samplerMultiChannelRateConverterConfig *config, struct R2samplerWorkSizeBreakdown *breakdown)
+{
+    /* 引数チェック */
+    if ((config == NULL) || (breakdown == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* コンフィグチェック */
+    if ((config->num_channels == 0) || (config->multi_stage.single.max_num_input_samples == 0)
+            || (config->multi_stage.single.input_rate == 0) || (config->multi_stage.single.output_rate == 0)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* マルチステージ変換器サイズ */
+    if (R2samplerMultiStageRateConverter_CalculateMultiChannelWorkSizeBreakdown(
+                &config->multi_stage, config->num_channels, breakdown) < 0) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* ハンドルサイズ */
+    breakdown->other += sizeof(struct R2samplerMultiChannelRateConverter) + R2SAMPLERMCRATECONVERTER_ALIGNMENT;
+
+    /* 入出力バッファサイズ */
+    breakdown->staging += sizeof(float) * config->num_channels * R2samplerMultiStageRateConverter_CalculateMaxNumBlockSamples(&config->multi_stage) + R2SAMPLERMCRATECONVERTER_ALIGNMENT;
+    breakdown->staging += sizeof(float) * config->num_channels * R2samplerMultiChannelRateConverter_CalculateMaxNumOutputSamples(config) + R2SAMPLERMCRATECONVERTER_ALIGNMENT;
+
+    /* 合計 */
+    breakdown->total = breakdown->coefficients + breakdown->history + breakdown->staging + breakdown->design + breakdown->other;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* マルチチャンネルレート変換器作成 */
+struct R2samplerMultiChannelRateConverter *R2samplerMultiChannelRateConverter_Create(
+        const struct R2samplerMultiChannelRateConverterConfig *config, void *work, int32_t work_size)
+{
+    struct R2samplerMultiChannelRateConverter *converter;
+    uint8_t tmp_alloc_by_own = 0;
+    struct R2samplerAllocator allocator;
+    uint8_t *work_ptr;
+    int32_t tmp_work_size;
+
+    /* ワーク領域時前確保の場合 */
+    if ((work == NULL) && (work_size == 0)) {
+        if ((work_size = R2samplerMultiChannelRateConverter_CalculateWorkSize(config)) < 0) {
+            return NULL;
+        }
+        /* 指定されたアロケータ（指定が無ければグローバルに設定したもの）で確保 */
+        if (!R2sampler_GetAllocator(config->multi_stage.single.allocator, &allocator)) {
+            return NULL;
+        }
+        work = allocator.alloc((size_t)work_size, R2SAMPLERMCRATECONVERTER_ALIGNMENT, allocator.context);
+        tmp_alloc_by_own = 1;
+    }
+
+    /* 引数チェック */
+    if ((config == NULL) || (work == NULL)
+            || (R2samplerMultiChannelRateConverter_CalculateWorkSize(config) < 0)
+            || (work_size < R2samplerMultiChannelRateConverter_CalculateWorkSize(config))) {
+        if ((tmp_alloc_by_own == 1) && (work != NULL)) {
+            allocator.free(work, allocator.context);
+        }
+        return NULL;
+    }
+
+    /* ワーク領域先頭ポインタ取得 */
+    work_ptr = (uint8_t *)work;
+
+    /* ハンドル領域確保 */
+    work_ptr = (uint8_t *)R2SAMPLERMCRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERMCRATECONVERTER_ALIGNMENT);
+    converter = (struct R2samplerMultiChannelRateConverter *)work_ptr;
+    work_ptr += sizeof(struct R2samplerMultiChannelRateConverter);
+
+    /* メンバ設定 */
+    converter->num_channels = config->num_channels;
+    converter->max_num_input_samples = config->multi_stage.single.max_num_input_samples;
+    converter->max_num_block_samples = R2samplerMultiStageRateConverter_CalculateMaxNumBlockSamples(&config->multi_stage);
+    converter->max_num_output_samples = R2samplerMultiChannelRateConverter_CalculateMaxNumOutputSamples(config);
+    converter->alloc_by_own = tmp_alloc_by_own;
+    if (tmp_alloc_by_own == 1) {
+        converter->allocator = allocator;
+    }
+    converter->work = work;
+
+    /* マルチステージ変換器作成（全チャンネルで1つのフィルタ係数を共有） */
+    tmp_work_size = R2samplerMultiStageRateConverter_CalculateMultiChannelWorkSize(&config->multi_stage, config->num_channels);
+    assert(tmp_work_size >= 0);
+    if ((converter->multi_stage = R2samplerMultiStageRateConverter_CreateMultiChannel(
+                    &config->multi_stage, config->num_channels, work_ptr, tmp_work_size)) == NULL) {
+        if (tmp_alloc_by_own == 1) {
+            allocator.free(work, allocator.context);
+        }
+        return NULL;
+    }
+    work_ptr += tmp_work_size;
+
+    /* 入出力バッファの領域確保 */
+    work_ptr = (uint8_t *)R2SAMPLERMCRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERMCRATECONVERTER_ALIGNMENT);
+    converter->input_buffer = (float *)work_ptr;
+    work_ptr += sizeof(float) * converter->num_channels * converter->max_num_block_samples;
+    work_ptr = (uint8_t *)R2SAMPLERMCRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERMCRATECONVERTER_ALIGNMENT);
+    converter->output_buffer = (float *)work_ptr;
+    work_ptr += sizeof(float) * converter->num_channels * converter->max_num_output_samples;
+
+    /* バッファオーバーランチェック */
+    assert((work_ptr - (uint8_t *)work) <= work_size);
+
+    /* 作成直後にレート変換を行えるように開始を指示 */
+    (void)R2samplerMultiChannelRateConverter_Start(converter);
+
+    return converter;
+}
+
+/* マルチチャンネルレート変換器破棄 */
+void R2samplerMultiChannelRateConverter_Destroy(struct R2samplerMultiChannelRateConverter *converter)
+{
+    if (converter != NULL) {
+        R2samplerMultiStageRateConverter_Destroy(converter->multi_stage);
+        if (converter->alloc_by_own == 1) {
+            converter->allocator.free(converter->work, converter->allocator.context);
+        }
+    }
+}
+
+/* マルチチャンネルレート変換開始（内部バッファリセット） */
+R2samplerRateConverterApiResult R2samplerMultiChannelRateConverter_Start(struct R2samplerMultiChannelRateConverter *converter)
+{
+    /* 引数チェック */
+    if (converter == NULL) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    return R2samplerMultiStageRateConverter_Start(converter->multi_stage);
+}
+
+/* 通過域の群遅延を出力サンプル単位で取得 */
+R2samplerRateConverterApiResult R2samplerMultiChannelRateConverter_GetLatency(
+        const struct R2samplerMultiChannelRateConverter *converter, double *latency)
+{
+    /* 引数チェック */
+    if (converter == NULL) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    return R2samplerMultiStageRateConverter_GetLatency(converter->multi_stage, latency);
+}
+
+/* 通過域の群遅延を入力サンプル単位で取得 */
+R2samplerRateConverterApiResult R2samplerMultiChannelRateConverter_GetInputLatency(
+        const struct R2samplerMultiChannelRateConverter *converter, double *latency)
+{
+    /* 引数チェック */
+    if (converter == NULL) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    return R2samplerMultiStageRateConverter_GetInputLatency(converter->multi_stage, latency);
+}
+
+/* インターリーブされた内部出力を指定された形式で書き出し */
+static void R2samplerMultiChannelRateConverter_WriteOutput(
+        const struct R2samplerMultiChannelRateConverter *converter,
+        float *output_buffer, uint32_t output_channel_stride, uint32_t output_sample_stride, uint32_t num_output_samples)
+{
+    uint32_t ch, smpl;
+    const uint32_t num_channels = converter->num_channels;
+
+    if ((output_sample_stride == num_channels) && ((output_channel_stride == 1) || (num_channels == 1))) {
+        memcpy(output_buffer, converter->output_buffer, sizeof(float) * num_channels * num_output_samples);
+    } else {
+        for (smpl = 0; smpl < num_output_samples; smpl++) {
+            for (ch = 0; ch < num_channels; ch++) {
+                output_buffer[ch * output_channel_stride + smpl * output_sample_stride] = converter->output_buffer[smpl * num_channels + ch];
+            }
+        }
+    }
+}
+
+/* マルチチャンネルレート変換 */
+R2samplerRateConverterApiResult R2samplerMultiChannelRateConverter_Process(
+        struct R2samplerMultiChannelRateConverter *converter,
+        const float *input, uint32_t input_channel_stride, uint32_t input_sample_stride, uint32_t num_input_samples,
+        float *output_buffer, uint32_t output_channel_stride, uint32_t output_sample_stride,
+        uint32_t num_buffer_samples, uint32_t *num_output_samples)
+{
+    uint32_t ch, smpl, offset, num_channels, tmp_num_output_samples, output_offset;
+    const float *pinput;
+    R2samplerRateConverterApiResult ret;
+
+    /* 引数チェック */
+    if ((converter == NULL) || (input == NULL)
+            || (output_buffer == NULL) || (num_output_samples == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* 入力サンプル数が多すぎる */
+    if (num_input_samples > converter->max_num_input_samples) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_TOOMANY_NUM_INPUTS;
+    }
+
+    /* バッファサイズ不足（状態を変える前に判定） */
+    if (R2samplerMultiStageRateConverter_GetNumOutputSamples(converter->multi_stage, num_input_samples) > num_buffer_samples) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER;
+    }
+
+    num_channels = converter->num_channels;
+
+    /* ブロック単位で処理（省メモリモードでなければ1ブロックで全ての入力を処理） */
+    offset = output_offset = 0;
+    do {
+        const uint32_t num_block_samples
+            = R2SAMPLERMCRATECONVERTER_MIN(num_input_samples - offset, converter->max_num_block_samples);
+
+        /* 入力をインターリーブ形式に揃える（既にインターリーブされていればそのまま使用） */
+        if ((input_sample_stride == num_channels) && ((input_channel_stride == 1) || (num_channels == 1))) {
+            pinput = &input[offset * num_channels];
+        } else {
+            for (smpl = 0; smpl < num_block_samples; smpl++) {
+                for (ch = 0; ch < num_channels; ch++) {
+                    converter->input_buffer[smpl * num_channels + ch]
+                        = input[ch * input_channel_stride + (offset + smpl) * input_sample_stride];
+                }
+            }
+            pinput = converter->input_buffer;
+        }
+
+        /* 全チャンネルまとめてレート変換 */
+        if ((ret = R2samplerMultiStageRateConverter_ProcessInterleaved(converter->multi_stage,
+                        pinput, num_block_samples, converter->output_buffer,
+                        converter->max_num_output_samples, &tmp_num_output_samples)) != R2SAMPLERRATECONVERTER_APIRESULT_OK) {
+            return ret;
+        }
+
+        /* 出力を指定された形式で書き出し */
+        assert((output_offset + tmp_num_output_samples) <= num_buffer_samples);
+        R2samplerMultiChannelRateConverter_WriteOutput(converter,
+                &output_buffer[output_offset * output_sample_stride],
+                output_channel_stride, output_sample_stride, tmp_num_output_samples);
+
+        offset += num_block_samples;
+        output_offset += tmp_num_output_samples;
+    } while (offset < num_input_samples);
+
+    /* 出力サンプル数をセット */
+    (*num_output_samples) = output_offset;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* 残りのサンプルの出力（ドレイン） */
+R2samplerRateConverterApiResult R2samplerMultiChannelRateConverter_Drain(
+        struct R2samplerMultiChannelRateConverter *converter,
+        float *output_buffer, uint32_t output_channel_stride, uint32_t output_sample_stride,
+        uint32_t num_buffer_samples, uint32_t *num_output_samples)
+{
+    uint32_t tmp_num_output_samples;
+    R2samplerRateConverterApiResult ret;
+
+    /* 引数チェック */
+    if ((converter == NULL) || (output_buffer == NULL) || (num_output_samples == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* バッファサイズ不足（状態を変える前に判定） */
+    if (R2samplerMultiStageRateConverter_GetNumDrainOutputSamples(converter->multi_stage) > num_buffer_samples) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER;
+    }
+
+    /* 全チャンネルまとめて残りを出力 */
+    if ((ret = R2samplerMultiStageRateConverter_DrainInterleaved(converter->multi_stage,
+                    converter->output_buffer, converter->max_num_output_samples,
+                    &tmp_num_output_samples)) != R2SAMPLERRATECONVERTER_APIRESULT_OK) {
+        return ret;
+    }
+
+    /* 出力を指定された形式で書き出し */
+    assert(tmp_num_output_samples <= num_buffer_samples);
+    R2samplerMultiChannelRateConverter_WriteOutput(converter,
+            output_buffer, output_channel_stride, output_sample_stride, tmp_num_output_samples);
+
+    /* 出力サンプル数をセット */
+    (*num_output_samples) = tmp_num_output_samples;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
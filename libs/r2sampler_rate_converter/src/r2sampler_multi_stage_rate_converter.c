@@ -2,10 +2,12 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <assert.h>
 
 #include "ring_buffer.h"
 #include "r2sampler_utility.h"
+#include "r2sampler_internal.h"
 
 /* メモリアラインメント */
 #define R2SAMPLERMSRATECONVERTER_ALIGNMENT 16
@@ -13,6 +15,16 @@
 #define R2SAMPLERMSRATECONVERTER_ROUNDUP(val, n) ((((val) + ((n) - 1)) / (n)) * (n))
 /* a,bのうち大きい方を選択 */
 #define R2SAMPLERMSRATECONVERTER_MAX(a, b) (((a) > (b)) ? (a) : (b))
+/* a,bのうち小さい方を選択 */
+#define R2SAMPLERMSRATECONVERTER_MIN(a, b) (((a) < (b)) ? (a) : (b))
+/* ステージ構成探索で扱う約数の最大数（超える場合は探索せず素因数分解による構成を使用） */
+#define R2SAMPLERMSRATECONVERTER_MAX_NUM_DIVISORS 256
+/* ステージ構成探索で評価するステージの最大数（探索時間の上限） */
+#define R2SAMPLERMSRATECONVERTER_MAX_NUM_PLAN_EVALUATIONS 100000
+/* ステージ構成のコストにおけるメモリ量（フィルタ係数・中間バッファのサンプル数）の重み */
+#define R2SAMPLERMSRATECONVERTER_FOOTPRINT_COST_WEIGHT (1.0 / 16.0)
+/* 省メモリモードで全ステージに通す入力ブロックの最小サンプル数 */
+#define R2SAMPLERMSRATECONVERTER_COMPACT_MIN_NUM_BLOCK_SAMPLES 64
 
 /* マルチステージレート変換器ハンドル */
 struct R2samplerMultiStageRateConverter {
@@ -22,9 +34,14 @@ struct R2samplerMultiStageRateConverter {
     uint32_t max_num_stages;
     uint32_t num_stages;
     uint32_t max_num_input_samples;
+    uint32_t max_num_block_samples; /* 1回に全ステージに通す最大の入力サンプル数 */
+    uint32_t num_channels;
     float *process_buffer[2];
-    uint32_t max_num_buffer_samples;
+    uint32_t max_num_buffer_samples[2]; /* 各処理バッファに入る最大のサンプル数 */
+    uint8_t draining; /* ドレイン中か */
+    uint32_t num_drain_samples; /* ドレインで出力する残りのサンプル数 */
     uint8_t alloc_by_own;
+    struct R2samplerAllocator allocator; /* ワーク領域を確保したアロケータ */
     void *work;
 };
 
@@ -34,6 +51,21 @@ struct R2samplerMultiStageUpDownRateConfig {
     uint32_t down_rate;
 };
 
+/* ステージ構成の探索器 */
+struct R2samplerMultiStagePlanner {
+    const struct R2samplerRateConverterConfig *config;
+    uint32_t max_num_stages;
+    uint32_t up_divisors[R2SAMPLERMSRATECONVERTER_MAX_NUM_DIVISORS];
+    uint32_t num_up_divisors;
+    uint32_t down_divisors[R2SAMPLERMSRATECONVERTER_MAX_NUM_DIVISORS];
+    uint32_t num_down_divisors;
+    uint32_t num_evaluations;
+    struct R2samplerMultiStageUpDownRateConfig stages[R2SAMPLER_MAX_NUM_STAGES];
+    struct R2samplerMultiStageUpDownRateConfig best_stages[R2SAMPLER_MAX_NUM_STAGES];
+    uint32_t best_num_stages;
+    double best_cost;
+};
+
 /* アップレート・ダウンレート設定比較 */
 static int R2samplerMultiStageRateConverter_UpDownConfigCompare(const void *a, const void *b)
 {
@@ -59,8 +91,8 @@ static void R2samplerMultiStageRateConverter_SetUpDownRateConfig(
     assert((config != NULL) && (num_stages != NULL));
     assert(max_num_stages <= R2SAMPLER_MAX_NUM_STAGES);
 
-    /* ダウンレートを素因数分解 */
-    R2sampler_Factorize(down_rate, factors, R2SAMPLER_MAX_NUM_STAGES, &num_factors);
+    /* ダウンレートを素因数分解（上限を超える分は最後の因数にまとめる） */
+    R2sampler_Factorize(down_rate, factors, max_num_stages, &num_factors);
 
     /* 各ステージでダウンレートよりも大きくなるようにアップレートを設定 */
     stage = 0;
@@ -87,13 +119,19 @@ static void R2samplerMultiStageRateConverter_SetUpDownRateConfig(
         up_rate /= up;
     }
 
-    /* 残ったアップレートを配置 */
+    /* 残ったアップレートを空いているステージに配置 */
     if (up_rate > 1) {
-        R2sampler_Factorize(up_rate, factors, R2SAMPLER_MAX_NUM_STAGES, &num_factors);
-        for (i = 0; i < num_factors; i++) {
-            config[stage].up_rate = factors[i];
-            config[stage].down_rate = 1;
-            stage++;
+        if (stage < max_num_stages) {
+            R2sampler_Factorize(up_rate, factors, max_num_stages - stage, &num_factors);
+            for (i = 0; i < num_factors; i++) {
+                config[stage].up_rate = factors[i];
+                config[stage].down_rate = 1;
+                stage++;
+            }
+        } else {
+            /* 空きが無ければ最後のステージにまとめる */
+            assert(stage > 0);
+            config[stage - 1].up_rate *= up_rate;
         }
     }
 
@@ -101,22 +139,401 @@ static void R2samplerMultiStageRateConverter_SetUpDownRateConfig(
     qsort(config, stage, sizeof(struct R2samplerMultiStageUpDownRateConfig), R2samplerMultiStageRateConverter_UpDownConfigCompare);
 
     /* 結果をセット */
-    assert(stage < max_num_stages);
+    assert(stage <= max_num_stages);
     (*num_stages) = stage;
 }
 
+/* 1ステージ分のフィルタの帯域端を計算（レート・帯域幅は入力レートを1とした単位） */
+static void R2samplerMultiStageRateConverter_CalculateBandEdges(
+    const struct R2samplerRateConverterConfig *config, double band, double input_rate,
+    const struct R2samplerMultiStageUpDownRateConfig *udconfig, struct R2samplerFilterBandEdges *band_edges)
+{
+    double output_rate, stage_band, stage_min_rate;
+
+    assert((config != NULL) && (udconfig != NULL) && (band_edges != NULL));
+
+    output_rate = (input_rate * udconfig->up_rate) / udconfig->down_rate;
+    stage_min_rate = R2SAMPLERMSRATECONVERTER_MIN(input_rate, output_rate);
+    /* このステージを通過できる帯域 */
+    stage_band = R2SAMPLERMSRATECONVERTER_MIN(band, 0.5 * stage_min_rate);
+    /* 折り返し・鏡像が残す帯域に重なり始める周波数を阻止域端とし、フィルタの動作レートで正規化 */
+    band_edges->passband_edge = ((1.0 - config->transition_width) * stage_band) / (input_rate * udconfig->up_rate);
+    band_edges->stopband_edge = (stage_min_rate - stage_band) / (input_rate * udconfig->up_rate);
+    /* 2倍/1/2倍のステージは阻止域端を保ったまま通過域端を広げて0.25に対称にできれば、ハーフバンドフィルタとして処理させる
+     * 阻止域端が0.25の場合は遷移帯域が無くなるため通常の設計とする */
+    if ((((udconfig->up_rate == 2) && (udconfig->down_rate == 1)) || ((udconfig->up_rate == 1) && (udconfig->down_rate == 2)))
+            && R2samplerRateConverter_IsHalfBandDesignable(config)
+            && ((band_edges->passband_edge + band_edges->stopband_edge) <= 0.5) && (band_edges->stopband_edge > 0.25)) {
+        band_edges->passband_edge = 0.5 - band_edges->stopband_edge;
+    }
+}
+
+/* 各ステージのフィルタの帯域端を計算
+ * 全体の通過域は最終的に残る帯域（入出力で低い方のナイキスト周波数）で決まるため、
+ * 各ステージでは残す帯域に折り返す・鏡像が重なる成分だけを阻止すればよく、前段ほど遷移帯域を広く取れる
+ * 遷移帯域幅の指定が不正な場合はNULLを返し、単一ステージ側のコンフィグチェックに委ねる */
+static const struct R2samplerFilterBandEdges *R2samplerMultiStageRateConverter_CalculateStageBandEdges(
+    const struct R2samplerRateConverterConfig *config,
+    const struct R2samplerMultiStageUpDownRateConfig *udconfig, uint32_t num_stages,
+    struct R2samplerFilterBandEdges *band_edges)
+{
+    uint32_t i, gcd;
+    double band, input_rate;
+
+    assert((config != NULL) && (udconfig != NULL) && (band_edges != NULL));
+
+    if ((config->transition_width <= 0.0) || (config->transition_width >= 1.0)) {
+        return NULL;
+    }
+
+    /* 入力レートを1とした単位で、最終的に残す帯域幅 */
+    gcd = R2sampler_GCD(config->input_rate, config->output_rate);
+    band = 0.5 * R2SAMPLERMSRATECONVERTER_MIN(1.0, (double)(config->output_rate / gcd) / (config->input_rate / gcd));
+
+    input_rate = 1.0;
+    for (i = 0; i < num_stages; i++) {
+        R2samplerMultiStageRateConverter_CalculateBandEdges(
+                config, band, input_rate, &udconfig[i], &band_edges[i]);
+        input_rate = (input_rate * udconfig[i].up_rate) / udconfig[i].down_rate;
+    }
+
+    return band_edges;
+}
+
+/* 1ステージ分のコストを計算（出力1サンプルあたりの積和回数とメモリ量の重み付け和） */
+static double R2samplerMultiStageRateConverter_CalculateStageCost(
+    const struct R2samplerRateConverterConfig *config,
+    const struct R2samplerMultiStageUpDownRateConfig *udconfig, double input_rate)
+{
+    int32_t num_macs;
+    uint32_t gcd, filter_order;
+    double band, output_rate, final_output_rate;
+    struct R2samplerRateConverterConfig tmp_config;
+    struct R2samplerFilterBandEdges band_edges;
+
+    assert((config != NULL) && (udconfig != NULL));
+
+    /* 入力レートを1とした単位の最終出力レートと残す帯域幅 */
+    gcd = R2sampler_GCD(config->input_rate, config->output_rate);
+    final_output_rate = (double)(config->output_rate / gcd) / (config->input_rate / gcd);
+    band = 0.5 * R2SAMPLERMSRATECONVERTER_MIN(1.0, final_output_rate);
+
+    /* このステージの積和回数 */
+    tmp_config = (*config);
+    tmp_config.input_rate = udconfig->down_rate;
+    tmp_config.output_rate = udconfig->up_rate;
+    R2samplerMultiStageRateConverter_CalculateBandEdges(config, band, input_rate, udconfig, &band_edges);
+    if ((num_macs = R2samplerRateConverter_EstimateNumMacsPerOutput(&tmp_config, &band_edges, &filter_order)) < 0) {
+        return -1.0;
+    }
+
+    /* 最終出力1サンプルあたりに換算 */
+    output_rate = (input_rate * udconfig->up_rate) / udconfig->down_rate;
+    return (num_macs + R2SAMPLERMSRATECONVERTER_FOOTPRINT_COST_WEIGHT) * (output_rate / final_output_rate)
+        + R2SAMPLERMSRATECONVERTER_FOOTPRINT_COST_WEIGHT * filter_order;
+}
+
+/* ステージ構成全体のコストを計算（計算できない場合は負値） */
+static double R2samplerMultiStageRateConverter_CalculatePlanCost(
+    const struct R2samplerRateConverterConfig *config,
+    const struct R2samplerMultiStageUpDownRateConfig *udconfig, uint32_t num_stages)
+{
+    uint32_t i;
+    double cost, stage_cost, input_rate;
+
+    assert((config != NULL) && (udconfig != NULL));
+
+    cost = 0.0;
+    input_rate = 1.0;
+    for (i = 0; i < num_stages; i++) {
+        if ((stage_cost = R2samplerMultiStageRateConverter_CalculateStageCost(config, &udconfig[i], input_rate)) < 0.0) {
+            return -1.0;
+        }
+        cost += stage_cost;
+        input_rate = (input_rate * udconfig[i].up_rate) / udconfig[i].down_rate;
+    }
+
+    return cost;
+}
+
+/* 約数を列挙（上限を超える場合は0を返す） */
+static uint32_t R2samplerMultiStageRateConverter_EnumerateDivisors(uint32_t x, uint32_t *divisors, uint32_t max_num_divisors)
+{
+    uint32_t d, num_divisors, num_small_divisors;
+
+    assert(divisors != NULL);
+
+    /* sqrt(x)以下の約数を昇順に列挙 */
+    num_divisors = 0;
+    for (d = 1; d <= x / d; d++) {
+        if ((x % d) == 0) {
+            if (num_divisors >= max_num_divisors) {
+                return 0;
+            }
+            divisors[num_divisors++] = d;
+        }
+    }
+
+    /* 対になる約数を追加 */
+    num_small_divisors = num_divisors;
+    while (num_small_divisors > 0) {
+        d = divisors[--num_small_divisors];
+        if (d != (x / d)) {
+            if (num_divisors >= max_num_divisors) {
+                return 0;
+            }
+            divisors[num_divisors++] = x / d;
+        }
+    }
+
+    return num_divisors;
+}
+
+/* ステージ構成を分枝限定法で探索 */
+static void R2samplerMultiStageRateConverter_SearchPlan(
+    struct R2samplerMultiStagePlanner *planner,
+    uint32_t up_rate, uint32_t down_rate, double input_rate, uint32_t stage, double cost)
+{
+    uint32_t i, j;
+
+    assert(planner != NULL);
+
+    /* 全ての変換比を割り当て終えた */
+    if ((up_rate == 1) && (down_rate == 1)) {
+        if (cost < planner->best_cost) {
+            memcpy(planner->best_stages, planner->stages, sizeof(struct R2samplerMultiStageUpDownRateConfig) * stage);
+            planner->best_num_stages = stage;
+            planner->best_cost = cost;
+        }
+        return;
+    }
+
+    /* ステージ数の上限に達した */
+    if (stage >= planner->max_num_stages) {
+        return;
+    }
+
+    /* 残りの変換比の約数の組をこのステージに割り当てる */
+    for (i = 0; i < planner->num_up_divisors; i++) {
+        const uint32_t up = planner->up_divisors[i];
+        if ((up_rate % up) != 0) {
+            continue;
+        }
+        for (j = 0; j < planner->num_down_divisors; j++) {
+            double stage_cost;
+            const uint32_t down = planner->down_divisors[j];
+            if (((down_rate % down) != 0) || ((up == 1) && (down == 1))) {
+                continue;
+            }
+            /* 最終ステージは残りを全て割り当てる */
+            if (((stage + 1) == planner->max_num_stages) && ((up != up_rate) || (down != down_rate))) {
+                continue;
+            }
+            /* 評価回数の上限 */
+            if (planner->num_evaluations >= R2SAMPLERMSRATECONVERTER_MAX_NUM_PLAN_EVALUATIONS) {
+                return;
+            }
+            planner->num_evaluations++;
+            planner->stages[stage].up_rate = up;
+            planner->stages[stage].down_rate = down;
+            stage_cost = R2samplerMultiStageRateConverter_CalculateStageCost(
+                    planner->config, &planner->stages[stage], input_rate);
+            /* 既知の最良値を超える構成は打ち切り */
+            if ((stage_cost < 0.0) || ((cost + stage_cost) >= planner->best_cost)) {
+                continue;
+            }
+            R2samplerMultiStageRateConverter_SearchPlan(planner,
+                    up_rate / up, down_rate / down, (input_rate * up) / down, stage + 1, cost + stage_cost);
+        }
+    }
+}
+
+/* 各ステージでのアップレート・ダウンレートを決定
+ * フィルタ次数を自動決定する場合は、品質（阻止域減衰量と遷移帯域幅）が一定のもとで
+ * 積和回数とメモリ量のコストが最小となる構成を探索する
+ * 次数が固定の場合はステージ構成により品質が変わるため素因数分解による構成を使用
+ * ステージ数の上限に収まる構成が無い場合は0を返す */
+static uint8_t R2samplerMultiStageRateConverter_PlanStages(
+    const struct R2samplerRateConverterConfig *config, uint32_t up_rate, uint32_t down_rate,
+    struct R2samplerMultiStageUpDownRateConfig *udconfig, uint32_t max_num_stages, uint32_t *num_stages)
+{
+    double cost;
+    struct R2samplerMultiStagePlanner planner;
+
+    assert((config != NULL) && (udconfig != NULL) && (num_stages != NULL));
+    assert(max_num_stages <= R2SAMPLER_MAX_NUM_STAGES);
+
+    /* 素因数分解による構成 */
+    R2samplerMultiStageRateConverter_SetUpDownRateConfig(up_rate, down_rate, udconfig, max_num_stages, num_stages);
+    if (((*num_stages) == 0) || ((*num_stages) > max_num_stages)) {
+        return 0;
+    }
+
+    /* 次数固定の場合はそのまま使用 */
+    if (config->filter_order != 0) {
+        return 1;
+    }
+
+    /* 探索器の初期化 */
+    planner.config = config;
+    planner.max_num_stages = max_num_stages;
+    planner.num_evaluations = 0;
+    planner.num_up_divisors = R2samplerMultiStageRateConverter_EnumerateDivisors(
+            up_rate, planner.up_divisors, R2SAMPLERMSRATECONVERTER_MAX_NUM_DIVISORS);
+    planner.num_down_divisors = R2samplerMultiStageRateConverter_EnumerateDivisors(
+            down_rate, planner.down_divisors, R2SAMPLERMSRATECONVERTER_MAX_NUM_DIVISORS);
+    if ((planner.num_up_divisors == 0) || (planner.num_down_divisors == 0)) {
+        return 1;
+    }
+
+    /* 素因数分解による構成を初期解とする */
+    if ((cost = R2samplerMultiStageRateConverter_CalculatePlanCost(config, udconfig, (*num_stages))) < 0.0) {
+        /* コストを計算できないコンフィグは作成時のチェックに委ねる */
+        return 1;
+    }
+    memcpy(planner.best_stages, udconfig, sizeof(struct R2samplerMultiStageUpDownRateConfig) * (*num_stages));
+    planner.best_num_stages = (*num_stages);
+    planner.best_cost = cost;
+
+    /* 探索 */
+    R2samplerMultiStageRateConverter_SearchPlan(&planner, up_rate, down_rate, 1.0, 0, 0.0);
+
+    /* 結果をセット */
+    assert((planner.best_num_stages > 0) && (planner.best_num_stages <= max_num_stages));
+    memcpy(udconfig, planner.best_stages, sizeof(struct R2samplerMultiStageUpDownRateConfig) * planner.best_num_stages);
+    (*num_stages) = planner.best_num_stages;
+
+    return 1;
+}
+
+/* ステージ構成から各処理バッファに必要なサンプル数を計算
+ * 処理バッファ0には入力と奇数番目（1始まり）のステージの出力、処理バッファ1には偶数番目のステージの出力が交互に入る
+ * 戻り値は最終ステージの最大出力サンプル数 */
+static uint32_t R2samplerMultiStageRateConverter_CalculateProcessBufferSamples(
+    const struct R2samplerMultiStageUpDownRateConfig *udconfig, uint32_t num_stages,
+    uint32_t max_num_block_samples, uint32_t *max_num_buffer_samples)
+{
+    uint32_t i, num_samples;
+
+    assert((udconfig != NULL) && (max_num_buffer_samples != NULL));
+
+    num_samples = max_num_block_samples;
+    max_num_buffer_samples[0] = num_samples;
+    max_num_buffer_samples[1] = 0;
+    for (i = 0; i < num_stages; i++) {
+        /* 各ステージの最大出力サンプル数はステージ作成時の最大入力サンプル数と同じ計算 */
+        num_samples = R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(num_samples, udconfig[i].down_rate, udconfig[i].up_rate);
+        max_num_buffer_samples[(i + 1) % 2] = R2SAMPLERMSRATECONVERTER_MAX(max_num_buffer_samples[(i + 1) % 2], num_samples);
+    }
+
+    return num_samples;
+}
+
+/* 1回に全ステージに通す入力サンプル数（ブロック長）の計算
+ * 省メモリモードでは入力を分割し、処理バッファと各ステージのバッファを分割したブロック長に合わせる
+ * 分割してもレート変換器を作成できるように、ブロック長は全体のダウンレート以上とする */
+uint32_t R2samplerMultiStageRateConverter_CalculateMaxNumBlockSamples(
+        const struct R2samplerMultiStageRateConverterConfig *config)
+{
+    uint32_t gcd, num_block_samples;
+
+    assert(config != NULL);
+
+    if (config->single.memory_mode != R2SAMPLER_MEMORYMODE_COMPACT) {
+        return config->single.max_num_input_samples;
+    }
+
+    gcd = R2sampler_GCD(config->single.input_rate, config->single.output_rate);
+    num_block_samples = R2SAMPLERMSRATECONVERTER_MAX(
+            R2SAMPLERMSRATECONVERTER_COMPACT_MIN_NUM_BLOCK_SAMPLES, config->single.input_rate / gcd);
+    return R2SAMPLERMSRATECONVERTER_MIN(config->single.max_num_input_samples, num_block_samples);
+}
+
+/* 1ブロックの入力に対する最大の出力サンプル数を計算（ステージ毎の切り上げを含む. ステージ構成が無い場合は0） */
+uint32_t R2samplerMultiStageRateConverter_CalculateMaxNumOutputSamples(
+        const struct R2samplerMultiStageRateConverterConfig *config)
+{
+    uint32_t gcd, num_stages, max_num_buffer_samples[2];
+    struct R2samplerMultiStageUpDownRateConfig udconfig[R2SAMPLER_MAX_NUM_STAGES];
+
+    assert(config != NULL);
+
+    gcd = R2sampler_GCD(config->single.input_rate, config->single.output_rate);
+    if (!R2samplerMultiStageRateConverter_PlanStages(&config->single,
+                config->single.output_rate / gcd, config->single.input_rate / gcd, udconfig, config->max_num_stages, &num_stages)) {
+        return 0;
+    }
+
+    return R2samplerMultiStageRateConverter_CalculateProcessBufferSamples(udconfig, num_stages,
+            R2samplerMultiStageRateConverter_CalculateMaxNumBlockSamples(config), max_num_buffer_samples);
+}
+
+/* マルチステージレート変換器生成コンフィグを既定値で初期化 */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_InitializeConfig(struct R2samplerMultiStageRateConverterConfig *config)
+{
+    R2samplerRateConverterApiResult ret;
+
+    /* 引数チェック */
+    if (config == NULL) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    memset(config, 0, sizeof(struct R2samplerMultiStageRateConverterConfig));
+    if ((ret = R2samplerRateConverter_InitializeConfig(&config->single)) != R2SAMPLERRATECONVERTER_APIRESULT_OK) {
+        return ret;
+    }
+    config->max_num_stages = R2SAMPLER_MAX_NUM_STAGES;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
 /* レート変換器作成に必要なワークサイズ計算 */
 int32_t R2samplerMultiStageRateConverter_CalculateWorkSize(const struct R2samplerMultiStageRateConverterConfig *config)
 {
-    int32_t work_size, tmp_work_size;
-    uint32_t i, gcd, tmp_up_rate, tmp_down_rate, tmp_max_num_input_samples;
+    return R2samplerMultiStageRateConverter_CalculateMultiChannelWorkSize(config, 1);
+}
+
+/* レート変換器作成に必要なワークサイズの内訳を計算 */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_CalculateWorkSizeBreakdown(
+        const struct R2samplerMultiStageRateConverterConfig *config, struct R2samplerWorkSizeBreakdown *breakdown)
+{
+    /* 引数チェック */
+    if ((config == NULL) || (breakdown == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    if (R2samplerMultiStageRateConverter_CalculateMultiChannelWorkSizeBreakdown(config, 1, breakdown) < 0) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* チャンネル数を指定したレート変換器作成に必要なワークサイズ計算 */
+int32_t R2samplerMultiStageRateConverter_CalculateMultiChannelWorkSize(
+        const struct R2samplerMultiStageRateConverterConfig *config, uint32_t num_channels)
+{
+    struct R2samplerWorkSizeBreakdown breakdown;
+    return R2samplerMultiStageRateConverter_CalculateMultiChannelWorkSizeBreakdown(config, num_channels, &breakdown);
+}
+
+/* チャンネル数を指定したレート変換器作成に必要なワークサイズの内訳を計算 */
+int32_t R2samplerMultiStageRateConverter_CalculateMultiChannelWorkSizeBreakdown(
+        const struct R2samplerMultiStageRateConverterConfig *config, uint32_t num_channels,
+        struct R2samplerWorkSizeBreakdown *breakdown)
+{
+    uint32_t i, gcd, tmp_up_rate, tmp_down_rate, tmp_max_num_input_samples, max_num_block_samples;
+    uint32_t max_num_buffer_samples[2];
     struct R2samplerRateConverterConfig tmp_config;
+    struct R2samplerWorkSizeBreakdown stage_breakdown;
 
     uint32_t num_stages;
     struct R2samplerMultiStageUpDownRateConfig udconfig[R2SAMPLER_MAX_NUM_STAGES];
+    struct R2samplerFilterBandEdges band_edges[R2SAMPLER_MAX_NUM_STAGES];
+    const struct R2samplerFilterBandEdges *pband_edges;
 
     /* 引数チェック */
-    if (config == NULL) {
+    if ((config == NULL) || (num_channels == 0) || (breakdown == NULL)) {
         return -1;
     }
 
@@ -127,66 +544,100 @@ int32_t R2samplerMultiStageRateConverter_CalculateWorkSize(const struct R2sample
         return -1;
     }
 
-    /* ワークサイズ計算 */
-    work_size = sizeof(struct R2samplerMultiStageRateConverter) + R2SAMPLERMSRATECONVERTER_ALIGNMENT;
+    /* ハンドル本体のサイズ */
+    breakdown->coefficients = breakdown->history = breakdown->staging = breakdown->design = 0;
+    breakdown->other = sizeof(struct R2samplerMultiStageRateConverter) + R2SAMPLERMSRATECONVERTER_ALIGNMENT;
 
     /* 互いに素な入出力レートを計算 */
     gcd = R2sampler_GCD(config->single.input_rate, config->single.output_rate);
     tmp_up_rate = config->single.output_rate / gcd;
     tmp_down_rate = config->single.input_rate / gcd;
 
-    /* 補間データバッファx2サイズ計算 */
-    work_size += 2 * (sizeof(float) * config->single.max_num_input_samples * tmp_up_rate + R2SAMPLERMSRATECONVERTER_ALIGNMENT);
-
     /* 各ステージでのアップレート・ダウンレートを設定 */
-    R2samplerMultiStageRateConverter_SetUpDownRateConfig(tmp_up_rate, tmp_down_rate, udconfig, R2SAMPLER_MAX_NUM_STAGES, &num_stages);
+    if (!R2samplerMultiStageRateConverter_PlanStages(&config->single,
+                tmp_up_rate, tmp_down_rate, udconfig, config->max_num_stages, &num_stages)) {
+        return -1;
+    }
+
+    /* 処理データバッファx2サイズ計算 */
+    max_num_block_samples = R2samplerMultiStageRateConverter_CalculateMaxNumBlockSamples(config);
+    (void)R2samplerMultiStageRateConverter_CalculateProcessBufferSamples(udconfig, num_stages, max_num_block_samples, max_num_buffer_samples);
+    for (i = 0; i < 2; i++) {
+        breakdown->staging += sizeof(float) * num_channels * max_num_buffer_samples[i] + R2SAMPLERMSRATECONVERTER_ALIGNMENT;
+    }
 
     /* ハンドルのポインタ領域を計算 */
-    work_size += sizeof(struct R2samplerRateConverter*) * num_stages + R2SAMPLERMSRATECONVERTER_ALIGNMENT;
+    breakdown->other += sizeof(struct R2samplerRateConverter*) * num_stages + R2SAMPLERMSRATECONVERTER_ALIGNMENT;
+
+    /* 各ステージのフィルタの帯域端を計算 */
+    pband_edges = R2samplerMultiStageRateConverter_CalculateStageBandEdges(&config->single, udconfig, num_stages, band_edges);
 
     /* レート変換器のサイズを計算 */
-    tmp_max_num_input_samples = config->single.max_num_input_samples;
+    tmp_max_num_input_samples = max_num_block_samples;
     for (i = 0; i < num_stages; i++) {
+        /* フィルタの設定は全ステージ共通 */
+        /* 阻止域減衰量と遷移帯域幅から設計する場合は各ステージの帯域端に応じた次数となる */
+        tmp_config = config->single;
         tmp_config.max_num_input_samples = tmp_max_num_input_samples;
         tmp_config.input_rate = udconfig[i].down_rate;
         tmp_config.output_rate = udconfig[i].up_rate;
-        tmp_config.filter_type = config->single.filter_type; /* 各ステージで変えるのもあり */
-        tmp_config.filter_order = config->single.filter_order; /* 各ステージで変えるのもあり */
-        if ((tmp_work_size = R2samplerRateConverter_CalculateWorkSize(&tmp_config)) < 0) {
+        if (R2samplerRateConverter_CalculateWorkSizeBreakdownWithBandEdges(&tmp_config, num_channels,
+                        (pband_edges != NULL) ? &pband_edges[i] : NULL, &stage_breakdown) < 0) {
             return -1;
         }
-        work_size += tmp_work_size;
+        breakdown->coefficients += stage_breakdown.coefficients;
+        breakdown->history += stage_breakdown.history;
+        breakdown->staging += stage_breakdown.staging;
+        breakdown->design += stage_breakdown.design;
+        breakdown->other += stage_breakdown.other;
         /* 次のステージで必要になるサンプル数 */
         tmp_max_num_input_samples
             = R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(tmp_max_num_input_samples, udconfig[i].down_rate, udconfig[i].up_rate);
     }
 
-    return work_size;
+    /* 合計 */
+    breakdown->total = breakdown->coefficients + breakdown->history + breakdown->staging + breakdown->design + breakdown->other;
+
+    return breakdown->total;
 }
 
 /* レート変換器作成 */
 struct R2samplerMultiStageRateConverter* R2samplerMultiStageRateConverter_Create(
     const struct R2samplerMultiStageRateConverterConfig* config, void* work, int32_t work_size)
+{
+    return R2samplerMultiStageRateConverter_CreateMultiChannel(config, 1, work, work_size);
+}
+
+/* チャンネル数を指定したレート変換器作成 */
+struct R2samplerMultiStageRateConverter* R2samplerMultiStageRateConverter_CreateMultiChannel(
+    const struct R2samplerMultiStageRateConverterConfig* config, uint32_t num_channels, void* work, int32_t work_size)
 {
     struct R2samplerMultiStageRateConverter* converter;
     uint8_t tmp_alloc_by_own = 0;
+    struct R2samplerAllocator allocator;
     uint8_t* work_ptr;
-    uint32_t i, gcd, tmp_up_rate, tmp_down_rate;
+    uint32_t i, gcd, tmp_up_rate, tmp_down_rate, max_num_block_samples;
     uint32_t num_stages;
     struct R2samplerMultiStageUpDownRateConfig udconfig[R2SAMPLER_MAX_NUM_STAGES];
+    struct R2samplerFilterBandEdges band_edges[R2SAMPLER_MAX_NUM_STAGES];
+    const struct R2samplerFilterBandEdges *pband_edges;
 
     /* ワーク領域時前確保の場合 */
     if ((work == NULL) && (work_size == 0)) {
-        if ((work_size = R2samplerMultiStageRateConverter_CalculateWorkSize(config)) < 0) {
+        if ((work_size = R2samplerMultiStageRateConverter_CalculateMultiChannelWorkSize(config, num_channels)) < 0) {
             return NULL;
         }
-        work = malloc((size_t)work_size);
+        /* 指定されたアロケータ（指定が無ければグローバルに設定したもの）で確保 */
+        if (!R2sampler_GetAllocator(config->single.allocator, &allocator)) {
+            return NULL;
+        }
+        work = allocator.alloc((size_t)work_size, R2SAMPLERMSRATECONVERTER_ALIGNMENT, allocator.context);
         tmp_alloc_by_own = 1;
     }
 
     /* 引数チェック */
-    if ((config == NULL) || (work == NULL)
-        || (work_size < R2samplerMultiStageRateConverter_CalculateWorkSize(config))) {
+    if ((config == NULL) || (work == NULL) || (num_channels == 0)
+        || (work_size < R2samplerMultiStageRateConverter_CalculateMultiChannelWorkSize(config, num_channels))) {
         return NULL;
     }
 
@@ -208,7 +659,11 @@ struct R2samplerMultiStageRateConverter* R2samplerMultiStageRateConverter_Create
     /* メンバ設定 */
     converter->max_num_input_samples = config->single.max_num_input_samples;
     converter->max_num_stages = config->max_num_stages;
+    converter->num_channels = num_channels;
     converter->alloc_by_own = tmp_alloc_by_own;
+    if (tmp_alloc_by_own == 1) {
+        converter->allocator = allocator;
+    }
     converter->work = work;
 
     /* 互いに素な入出力レートを計算 */
@@ -216,46 +671,58 @@ struct R2samplerMultiStageRateConverter* R2samplerMultiStageRateConverter_Create
     tmp_up_rate = config->single.output_rate / gcd;
     tmp_down_rate = config->single.input_rate / gcd;
 
-    /* 処理データバッファの領域確保 */
-    for (i = 0; i < 2; i++) {
-        work_ptr = (uint8_t*)R2SAMPLERMSRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERMSRATECONVERTER_ALIGNMENT);
-        converter->process_buffer[i] = (float*)work_ptr;
-        work_ptr += sizeof(float) * config->single.max_num_input_samples * tmp_up_rate;
-    }
-
     /* 入出力レートを記録 */
     converter->up_rate = tmp_up_rate;
     converter->down_rate = tmp_down_rate;
-    converter->max_num_buffer_samples = tmp_up_rate * config->single.max_num_input_samples;
 
     /* 各ステージでのアップレート・ダウンレートを設定 */
-    R2samplerMultiStageRateConverter_SetUpDownRateConfig(tmp_up_rate, tmp_down_rate, udconfig, R2SAMPLER_MAX_NUM_STAGES, &num_stages);
+    if (!R2samplerMultiStageRateConverter_PlanStages(&config->single,
+                tmp_up_rate, tmp_down_rate, udconfig, config->max_num_stages, &num_stages)) {
+        return NULL;
+    }
 
     /* ステージ数を記録 */
     converter->num_stages = num_stages;
 
+    /* 処理データバッファの領域確保（ステージ構成から求めた中間データの最大長） */
+    max_num_block_samples = R2samplerMultiStageRateConverter_CalculateMaxNumBlockSamples(config);
+    converter->max_num_block_samples = max_num_block_samples;
+    (void)R2samplerMultiStageRateConverter_CalculateProcessBufferSamples(udconfig, num_stages,
+            max_num_block_samples, converter->max_num_buffer_samples);
+    for (i = 0; i < 2; i++) {
+        work_ptr = (uint8_t*)R2SAMPLERMSRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERMSRATECONVERTER_ALIGNMENT);
+        converter->process_buffer[i] = (float*)work_ptr;
+        work_ptr += sizeof(float) * num_channels * converter->max_num_buffer_samples[i];
+    }
+
     /* レート変換器ハンドルのポインタ領域を確保 */
     work_ptr = (uint8_t*)R2SAMPLERMSRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERMSRATECONVERTER_ALIGNMENT);
     converter->resampler = (struct R2samplerRateConverter **)work_ptr;
     work_ptr += sizeof(struct R2samplerRateConverter *) * num_stages;
 
+    /* 各ステージのフィルタの帯域端を計算 */
+    pband_edges = R2samplerMultiStageRateConverter_CalculateStageBandEdges(&config->single, udconfig, num_stages, band_edges);
+
     {
         int32_t tmp_work_size;
         uint32_t tmp_max_num_input_samples;
         struct R2samplerRateConverterConfig tmp_config;
 
         /* レート変換器作成 */
-        tmp_max_num_input_samples = config->single.max_num_input_samples;
+        tmp_max_num_input_samples = max_num_block_samples;
         for (i = 0; i < num_stages; i++) {
+            const struct R2samplerFilterBandEdges *stage_band_edges = (pband_edges != NULL) ? &pband_edges[i] : NULL;
+            /* フィルタの設定は全ステージ共通 */
+            /* 阻止域減衰量と遷移帯域幅から設計する場合は各ステージの帯域端に応じた次数となる */
+            tmp_config = config->single;
             tmp_config.max_num_input_samples = tmp_max_num_input_samples;
             tmp_config.input_rate = udconfig[i].down_rate;
             tmp_config.output_rate = udconfig[i].up_rate;
-            tmp_config.filter_type = config->single.filter_type; /* 各ステージで変えるのもあり */
-            tmp_config.filter_order = config->single.filter_order; /* 各ステージで変えるのもあり */
-            if ((tmp_work_size = R2samplerRateConverter_CalculateWorkSize(&tmp_config)) < 0) {
+            if ((tmp_work_size = R2samplerRateConverter_CalculateWorkSizeWithBandEdges(&tmp_config, num_channels, stage_band_edges)) < 0) {
                 return NULL;
             }
-            if ((converter->resampler[i] = R2samplerRateConverter_Create(&tmp_config, work_ptr, tmp_work_size)) == NULL) {
+            if ((converter->resampler[i] = R2samplerRateConverter_CreateWithBandEdges(&tmp_config, num_channels,
+                            stage_band_edges, work_ptr, tmp_work_size)) == NULL) {
                 return NULL;
             }
             work_ptr += tmp_work_size;
@@ -284,7 +751,7 @@ void R2samplerMultiStageRateConverter_Destroy(struct R2samplerMultiStageRateConv
             R2samplerRateConverter_Destroy(converter->resampler[i]);
         }
         if (converter->alloc_by_own == 1) {
-            free(converter->work);
+            converter->allocator.free(converter->work, converter->allocator.context);
         }
     }
 }
@@ -300,8 +767,11 @@ R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_Start(struct R2
     }
 
     /* 処理バッファをゼロ埋め */
-    for (i = 0; i < converter->up_rate * converter->max_num_input_samples; i++) {
-        converter->process_buffer[0][i] = converter->process_buffer[1][i] = 0.0f;
+    for (i = 0; i < converter->num_channels * converter->max_num_buffer_samples[0]; i++) {
+        converter->process_buffer[0][i] = 0.0f;
+    }
+    for (i = 0; i < converter->num_channels * converter->max_num_buffer_samples[1]; i++) {
+        converter->process_buffer[1][i] = 0.0f;
     }
 
     /* リサンプラをリセット */
@@ -309,6 +779,97 @@ R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_Start(struct R2
         R2samplerRateConverter_Start(converter->resampler[i]);
     }
 
+    /* ドレイン状態をリセット */
+    converter->draining = 0;
+    converter->num_drain_samples = 0;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* ステージ数を取得 */
+uint32_t R2samplerMultiStageRateConverter_GetNumStages(const struct R2samplerMultiStageRateConverter *converter)
+{
+    assert(converter != NULL);
+    return converter->num_stages;
+}
+
+/* 各ステージのレート変換器を取得 */
+const struct R2samplerRateConverter *R2samplerMultiStageRateConverter_GetStage(
+        const struct R2samplerMultiStageRateConverter *converter, uint32_t stage)
+{
+    assert((converter != NULL) && (stage < converter->num_stages));
+    return converter->resampler[stage];
+}
+
+/* 各ステージのフィルタ次数を取得 */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_GetStageFilterOrders(
+        const struct R2samplerMultiStageRateConverter *converter,
+        uint32_t *filter_orders, uint32_t max_num_stages, uint32_t *num_stages)
+{
+    uint32_t i;
+
+    /* 引数チェック */
+    if ((converter == NULL) || (filter_orders == NULL) || (num_stages == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* バッファサイズ不足 */
+    if (max_num_stages < converter->num_stages) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER;
+    }
+
+    for (i = 0; i < converter->num_stages; i++) {
+        filter_orders[i] = R2samplerRateConverter_GetFilterOrder(converter->resampler[i]);
+    }
+    (*num_stages) = converter->num_stages;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* 全ステージを合わせた通過域の群遅延を出力サンプル単位で取得 */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_GetLatency(
+        const struct R2samplerMultiStageRateConverter *converter, double *latency)
+{
+    uint32_t i;
+    double total_latency;
+
+    /* 引数チェック */
+    if ((converter == NULL) || (latency == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* 前段までの遅延を各段の変換比で換算しながら加算 */
+    total_latency = 0.0;
+    for (i = 0; i < converter->num_stages; i++) {
+        uint32_t up_rate, down_rate;
+        double stage_latency;
+        R2samplerRateConverter_GetRates(converter->resampler[i], &up_rate, &down_rate);
+        (void)R2samplerRateConverter_GetLatency(converter->resampler[i], &stage_latency);
+        total_latency = total_latency * up_rate / down_rate + stage_latency;
+    }
+    (*latency) = total_latency;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* 全ステージを合わせた通過域の群遅延を入力サンプル単位で取得 */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_GetInputLatency(
+        const struct R2samplerMultiStageRateConverter *converter, double *latency)
+{
+    R2samplerRateConverterApiResult ret;
+    double output_latency;
+
+    /* 引数チェック */
+    if ((converter == NULL) || (latency == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* 出力サンプル単位の遅延を全体の変換比で換算 */
+    if ((ret = R2samplerMultiStageRateConverter_GetLatency(converter, &output_latency)) != R2SAMPLERRATECONVERTER_APIRESULT_OK) {
+        return ret;
+    }
+    (*latency) = output_latency * converter->down_rate / converter->up_rate;
+
     return R2SAMPLERRATECONVERTER_APIRESULT_OK;
 }
 
@@ -318,7 +879,123 @@ R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_Process(
         const float *input, uint32_t num_input_samples,
         float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples)
 {
-    uint32_t i, num_input, num_output;
+    return R2samplerMultiStageRateConverter_ProcessInterleaved(converter,
+            input, num_input_samples, output_buffer, num_buffer_samples, num_output_samples);
+}
+
+/* 各ステージでバッファリングしているサンプル数を取得 */
+static void R2samplerMultiStageRateConverter_GetStageStates(
+        const struct R2samplerMultiStageRateConverter *converter, uint32_t *num_buffered_samples)
+{
+    uint32_t i;
+
+    assert((converter != NULL) && (num_buffered_samples != NULL));
+
+    for (i = 0; i < converter->num_stages; i++) {
+        num_buffered_samples[i] = R2samplerRateConverter_GetNumBufferedSamples(converter->resampler[i]);
+    }
+}
+
+/* 1ブロックを全ステージに通したときの出力サンプル数を計算し、バッファリングしているサンプル数を更新
+ * ProcessStagesと同様に途中で出力がなくなった場合はそこで中断する */
+static uint32_t R2samplerMultiStageRateConverter_AdvanceStageStates(
+        const struct R2samplerMultiStageRateConverter *converter, uint32_t *num_buffered_samples, uint32_t num_input_samples)
+{
+    uint32_t i, num_samples;
+
+    assert((converter != NULL) && (num_buffered_samples != NULL));
+
+    num_samples = num_input_samples;
+    for (i = 0; i < converter->num_stages; i++) {
+        uint32_t up_rate, down_rate, num_interp_samples;
+        R2samplerRateConverter_GetRates(converter->resampler[i], &up_rate, &down_rate);
+        num_interp_samples = num_buffered_samples[i] + up_rate * num_samples;
+        num_samples = num_interp_samples / down_rate;
+        num_buffered_samples[i] = num_interp_samples - num_samples * down_rate;
+        if (num_samples == 0) {
+            break;
+        }
+    }
+
+    return num_samples;
+}
+
+/* 入力サンプル数に対して得られる出力サンプル数を取得 */
+uint32_t R2samplerMultiStageRateConverter_GetNumOutputSamples(
+        const struct R2samplerMultiStageRateConverter *converter, uint32_t num_input_samples)
+{
+    uint32_t smpl, num_output_samples;
+    uint32_t num_buffered_samples[R2SAMPLER_MAX_NUM_STAGES];
+
+    assert(converter != NULL);
+
+    /* 処理と同じブロック単位で各ステージの状態を進める */
+    R2samplerMultiStageRateConverter_GetStageStates(converter, num_buffered_samples);
+    smpl = num_output_samples = 0;
+    do {
+        const uint32_t num_block_samples
+            = R2SAMPLERMSRATECONVERTER_MIN(num_input_samples - smpl, converter->max_num_block_samples);
+        num_output_samples += R2samplerMultiStageRateConverter_AdvanceStageStates(converter, num_buffered_samples, num_block_samples);
+        smpl += num_block_samples;
+    } while (smpl < num_input_samples);
+
+    return num_output_samples;
+}
+
+/* ドレインの開始（初回の呼び出しで残りの出力サンプル数を確定） */
+static void R2samplerMultiStageRateConverter_BeginDrain(struct R2samplerMultiStageRateConverter *converter)
+{
+    uint32_t i;
+    double num_remain_samples;
+
+    assert(converter != NULL);
+
+    if (converter->draining) {
+        return;
+    }
+
+    /* 各ステージに残っているサンプル数と群遅延を、遅延と同様に変換比で換算しながら出力サンプル単位で合算 */
+    num_remain_samples = 0.0;
+    for (i = 0; i < converter->num_stages; i++) {
+        uint32_t up_rate, down_rate;
+        double stage_latency;
+        R2samplerRateConverter_GetRates(converter->resampler[i], &up_rate, &down_rate);
+        (void)R2samplerRateConverter_GetLatency(converter->resampler[i], &stage_latency);
+        num_remain_samples = num_remain_samples * up_rate / down_rate
+            + (double)R2samplerRateConverter_GetNumBufferedSamples(converter->resampler[i]) / down_rate + stage_latency;
+    }
+    converter->num_drain_samples = (uint32_t)ceil(num_remain_samples);
+    converter->draining = 1;
+}
+
+/* 次のドレインで出力されるサンプル数を取得 */
+uint32_t R2samplerMultiStageRateConverter_GetNumDrainOutputSamples(struct R2samplerMultiStageRateConverter *converter)
+{
+    uint32_t num_output_samples;
+    uint32_t num_buffered_samples[R2SAMPLER_MAX_NUM_STAGES];
+
+    assert(converter != NULL);
+
+    R2samplerMultiStageRateConverter_BeginDrain(converter);
+
+    /* ドレインと同様に出力が得られるまでゼロのブロックを入力 */
+    R2samplerMultiStageRateConverter_GetStageStates(converter, num_buffered_samples);
+    num_output_samples = 0;
+    while ((converter->num_drain_samples > 0) && (num_output_samples == 0)) {
+        num_output_samples = R2samplerMultiStageRateConverter_AdvanceStageStates(converter,
+                num_buffered_samples, converter->max_num_block_samples);
+    }
+
+    return R2SAMPLERMSRATECONVERTER_MIN(num_output_samples, converter->num_drain_samples);
+}
+
+/* 処理バッファ先頭にセットした入力を全ステージに通す
+ * 結果は処理バッファのいずれかに入り、その先頭をoutputにセットする */
+static R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_ProcessStages(
+        struct R2samplerMultiStageRateConverter *converter, uint32_t num_input_samples,
+        const float **output, uint32_t *num_output_samples)
+{
+    uint32_t i, num_input, num_output, output_index;
     float *pinput, *poutput;
     R2samplerRateConverterApiResult ret;
     /* ポインタの入れ替え */
@@ -328,45 +1005,143 @@ R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_Process(
         tmp__ = p1; p1 = p2; p2 = tmp__;\
     } while(0);
 
-    /* 引数チェック */
-    if ((converter == NULL) || (input == NULL)
-            || (output_buffer == NULL) || (num_output_samples == NULL)) {
-        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
-    }
-
-    /* 入力サンプル数が多すぎる */
-    if (num_input_samples > converter->max_num_input_samples) {
-        return R2SAMPLERRATECONVERTER_APIRESULT_TOOMANY_NUM_INPUTS;
-    }
+    assert((converter != NULL) && (output != NULL) && (num_output_samples != NULL));
 
     /* 処理ポインタをセット */
     pinput = converter->process_buffer[0];
     poutput = converter->process_buffer[1];
+    output_index = 1;
     num_input = num_input_samples;
-
-    /* 入力データをセット */
-    memcpy(pinput, input, sizeof(float) * num_input_samples);
+    num_output = 0;
 
     /* リサンプル */
     for (i = 0; i < converter->num_stages; i++) {
-        if ((ret = R2samplerRateConverter_Process(converter->resampler[i],
+        if ((ret = R2samplerRateConverter_ProcessInterleaved(converter->resampler[i],
             pinput, num_input, poutput,
-            converter->max_num_buffer_samples, &num_output)) != R2SAMPLERRATECONVERTER_APIRESULT_OK) {
+            converter->max_num_buffer_samples[output_index], &num_output)) != R2SAMPLERRATECONVERTER_APIRESULT_OK) {
             return ret;
         }
         /* 途中で出力がなくなった場合はそこで中断 */
         if (num_output == 0) {
-            (*num_output_samples) = 0;
-            return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+            break;
         }
         /* 出力を次の入力に差し替え */
         SWAP_POINTER(pinput, poutput);
+        output_index ^= 1;
         num_input = num_output;
     }
+#undef SWAP_POINTER
+
+    /* 最後に入れ替えが入るので入力ポインタが最終結果を指している */
+    (*output) = pinput;
+    (*num_output_samples) = num_output;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* チャンネルインターリーブされたデータのレート変換 */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_ProcessInterleaved(
+        struct R2samplerMultiStageRateConverter *converter,
+        const float *input, uint32_t num_input_samples,
+        float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples)
+{
+    uint32_t smpl, num_output, output_offset;
+    const float *poutput;
+    R2samplerRateConverterApiResult ret;
+
+    /* 引数チェック */
+    if ((converter == NULL) || (input == NULL)
+            || (output_buffer == NULL) || (num_output_samples == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* 入力サンプル数が多すぎる */
+    if (num_input_samples > converter->max_num_input_samples) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_TOOMANY_NUM_INPUTS;
+    }
+
+    /* バッファサイズ不足（状態を変える前に判定） */
+    if (R2samplerMultiStageRateConverter_GetNumOutputSamples(converter, num_input_samples) > num_buffer_samples) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER;
+    }
+
+    /* ブロック単位で処理（省メモリモードでなければ1ブロックで全ての入力を処理） */
+    smpl = output_offset = 0;
+    do {
+        const uint32_t num_block_samples
+            = R2SAMPLERMSRATECONVERTER_MIN(num_input_samples - smpl, converter->max_num_block_samples);
+
+        /* 入力データをセット */
+        memcpy(converter->process_buffer[0], &input[smpl * converter->num_channels],
+                sizeof(float) * converter->num_channels * num_block_samples);
+
+        /* リサンプル */
+        if ((ret = R2samplerMultiStageRateConverter_ProcessStages(converter,
+                        num_block_samples, &poutput, &num_output)) != R2SAMPLERRATECONVERTER_APIRESULT_OK) {
+            return ret;
+        }
+
+        /* 出力データを取得 */
+        assert(num_buffer_samples >= (output_offset + num_output));
+        memcpy(&output_buffer[output_offset * converter->num_channels], poutput,
+                sizeof(float) * converter->num_channels * num_output);
+
+        smpl += num_block_samples;
+        output_offset += num_output;
+    } while (smpl < num_input_samples);
+
+    /* 出力サンプル数をセット */
+    (*num_output_samples) = output_offset;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* 残りのサンプルの出力（ドレイン） */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_Drain(
+        struct R2samplerMultiStageRateConverter *converter,
+        float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples)
+{
+    return R2samplerMultiStageRateConverter_DrainInterleaved(converter,
+            output_buffer, num_buffer_samples, num_output_samples);
+}
+
+/* チャンネルインターリーブされたデータの残りのサンプルの出力（ドレイン）
+ * 初段にゼロを入力して各ステージに残っているサンプルを押し出す */
+R2samplerRateConverterApiResult R2samplerMultiStageRateConverter_DrainInterleaved(
+        struct R2samplerMultiStageRateConverter *converter,
+        float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples)
+{
+    uint32_t num_output;
+    const float *poutput;
+    R2samplerRateConverterApiResult ret;
+
+    /* 引数チェック */
+    if ((converter == NULL) || (output_buffer == NULL) || (num_output_samples == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* バッファサイズ不足（状態を変える前に判定） */
+    if (R2samplerMultiStageRateConverter_GetNumDrainOutputSamples(converter) > num_buffer_samples) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER;
+    }
+
+    /* ゼロを入力して出力が得られるまで処理 */
+    poutput = converter->process_buffer[0];
+    num_output = 0;
+    while ((converter->num_drain_samples > 0) && (num_output == 0)) {
+        memset(converter->process_buffer[0], 0, sizeof(float) * converter->num_channels * converter->max_num_block_samples);
+        if ((ret = R2samplerMultiStageRateConverter_ProcessStages(converter,
+                        converter->max_num_block_samples, &poutput, &num_output)) != R2SAMPLERRATECONVERTER_APIRESULT_OK) {
+            return ret;
+        }
+        /* 残りの分だけ出力（超えた分は捨てる） */
+        num_output = R2SAMPLERMSRATECONVERTER_MIN(num_output, converter->num_drain_samples);
+    }
 
-    /* 出力データを取得（最後に入れ替えが入るので入力ポインタが最終結果を指している） */
+    /* 出力データを取得 */
     assert(num_buffer_samples >= num_output);
-    memcpy(output_buffer, pinput, sizeof(float) * num_output);
+    memcpy(output_buffer, poutput, sizeof(float) * converter->num_channels * num_output);
+    converter->num_drain_samples -= num_output;
 
     /* 出力サンプル数をセット */
     (*num_output_samples) = num_output;
@@ -1,10 +1,15 @@
 #include <r2sampler.h>
 
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <assert.h>
 
 #include "ring_buffer.h"
+#include "fft.h"
 #include "r2sampler_utility.h"
+#include "r2sampler_kernel.h"
+#include "r2sampler_internal.h"
 
 /* メモリアラインメント */
 #define R2SAMPLERRATECONVERTER_ALIGNMENT 16
@@ -14,55 +19,738 @@
 #define R2SAMPLERRATECONVERTER_MIN(a, b) (((a) < (b)) ? (a) : (b))
 /* nの倍数に切り上げ */
 #define R2SAMPLERRATECONVERTER_ROUNDUP(val, n) ((((val) + ((n) - 1)) / (n)) * (n))
+/* ポリフェーズフィルタ1位相あたりのタップ数の切り上げ単位（SIMD演算幅に合わせる） */
+#define R2SAMPLERRATECONVERTER_POLYPHASE_TAPS_UNIT 8
+/* ポリフェーズフィルタ1位相あたりのタップ数計算 */
+#define R2SAMPLERRATECONVERTER_NUM_POLYPHASE_TAPS(filter_order, up_rate)\
+    R2SAMPLERRATECONVERTER_ROUNDUP(((filter_order) + (up_rate) - 1) / (up_rate), R2SAMPLERRATECONVERTER_POLYPHASE_TAPS_UNIT)
+/* 等リップルフィルタの次数推定で見込む減衰量の余裕[dB] */
+#define R2SAMPLERRATECONVERTER_EQUIRIPPLE_ATTENUATION_MARGIN 2.0
+/* ハーフバンドフィルタの非ゼロ係数（中央を除く）の対の数計算 */
+#define R2SAMPLERRATECONVERTER_NUM_HALF_BAND_PAIRS(filter_order) (((filter_order) + 1) / 4)
+/* ハーフバンドと判定する帯域端の和と0.5の差の許容誤差 */
+#define R2SAMPLERRATECONVERTER_HALF_BAND_EDGE_TOLERANCE 1.0e-9
+/* FFTによる畳み込みのFFTサイズの、1位相あたりのタップ数に対する最小倍率（大きいほど1ブロックで得られる出力が増える） */
+#define R2SAMPLERRATECONVERTER_FFT_SIZE_PER_TAPS 4
+/* FFTによる畳み込みの最小FFTサイズ */
+#define R2SAMPLERRATECONVERTER_MIN_FFT_SIZE 16
 
 /* レート変換器ハンドル */
 struct R2samplerRateConverter {
     uint32_t max_num_input_samples;
+    uint32_t max_num_block_samples; /* 1回にディレイバッファへ入れる最大の入力サンプル数 */
+    uint32_t num_channels;
     uint32_t up_rate;
     uint32_t down_rate;
     struct RingBuffer *output_buffer;
-    float *interp_buffer;
-    uint32_t num_interp_buffer_samples;
     R2samplerFilterType filter_type;
     uint32_t filter_order;
-    float *filter_coef;
+    R2samplerFilterPhase filter_phase;
+    double group_delay; /* 通過域（直流）の群遅延（ゼロ値挿入後のサンプル数） */
+    float *filter_coef; /* フィルタ係数（バッファの古いサンプルから順に掛ける並び. 最小位相では時間反転している） */
+    float *polyphase_coef;
+    uint32_t num_polyphase_taps;
     uint32_t interp_offset;
+    uint8_t draining; /* ドレイン中か */
+    uint32_t num_drain_samples; /* ドレインで出力する残りのサンプル数 */
+    uint8_t half_band; /* ハーフバンドフィルタとして処理するか */
+    float *half_band_coef; /* ハーフバンドフィルタの非ゼロ係数（中央を除く前半） */
+    uint32_t num_half_band_pairs;
+    uint32_t half_band_offset; /* 最初の非ゼロ係数のインデックス */
+    float half_band_center_coef;
+    struct R2samplerKernel kernel;
+    uint8_t fft_convolution; /* FFTによる畳み込みで処理するか */
+    uint32_t fft_size; /* FFTサイズ（2の冪） */
+    float *fft_filter_spectrum; /* 位相ごとの（反転した）ポリフェーズフィルタ係数のスペクトル（正規化定数込み） */
+    float *fft_convolved; /* 位相ごとの畳み込み結果 */
+    float *fft_block; /* 入力ブロック */
+    struct FFTPlan *fft_plan; /* FFTプラン */
+    uint8_t *fft_phase_used; /* ブロック内で使用する位相か */
+    struct R2samplerFilterCacheKey filter_key; /* 係数の設計パラメータ */
+    struct R2samplerFilterCache *filter_cache;
+    void *filter_cache_data; /* キャッシュから参照している係数領域（キャッシュ不使用時はNULL） */
     uint8_t alloc_by_own;
+    struct R2samplerAllocator allocator; /* ワーク領域を確保したアロケータ */
     void *work;
 };
 
+/* 阻止域減衰量と遷移帯域幅から設計するフィルタか判定 */
+static uint8_t R2samplerRateConverter_IsDesignedBySpecification(R2samplerFilterType filter_type)
+{
+    return ((filter_type == R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW)
+            || (filter_type == R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE)
+            || (filter_type == R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES)) ? 1 : 0;
+}
+
+/* フィルタ設計に必要な作業領域サイズ計算 */
+static int32_t R2samplerRateConverter_CalculateDesignWorkSize(
+        R2samplerFilterType filter_type, R2samplerFilterPhase filter_phase, uint32_t filter_order)
+{
+    int32_t work_size = 0;
+
+    switch (filter_type) {
+    case R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE:
+        work_size = R2sampler_CalculateRemezWorkSize(filter_order);
+        break;
+    case R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES:
+        work_size = R2sampler_CalculateLeastSquaresWorkSize(filter_order);
+        break;
+    default:
+        break;
+    }
+
+    /* 最小位相化は設計後に同じ領域を使って行う */
+    if (filter_phase == R2SAMPLER_FILTERPHASE_MINIMUM) {
+        work_size = R2SAMPLERRATECONVERTER_MAX(work_size, R2sampler_CalculateMinimumPhaseWorkSize(filter_order));
+    }
+
+    return work_size;
+}
+
+/* 阻止域減衰量と遷移帯域幅の指定をチェック */
+static uint8_t R2samplerRateConverter_CheckSpecification(
+        const struct R2samplerRateConverterConfig *config, const struct R2samplerFilterBandEdges *band_edges)
+{
+    assert(config != NULL);
+
+    /* 仕様から設計しないフィルタは確認不要 */
+    if (!R2samplerRateConverter_IsDesignedBySpecification(config->filter_type)) {
+        return 1;
+    }
+
+    /* 阻止域減衰量 */
+    if (config->stopband_attenuation <= 0.0) {
+        return 0;
+    }
+
+    /* 遷移帯域幅: 帯域端の指定があればそちらを使用 */
+    if (band_edges != NULL) {
+        if ((band_edges->passband_edge <= 0.0) || (band_edges->passband_edge >= band_edges->stopband_edge)
+                || (band_edges->stopband_edge > 0.5)) {
+            return 0;
+        }
+    } else if ((config->transition_width <= 0.0) || (config->transition_width >= 1.0)) {
+        return 0;
+    }
+
+    /* 最小二乗は帯域の重みの指定を要求 */
+    if ((config->filter_type == R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES) && (config->stopband_weight <= 0.0)) {
+        return 0;
+    }
+
+    return 1;
+}
+
+/* フィルタの帯域端を取得 */
+static void R2samplerRateConverter_GetBandEdges(
+        const struct R2samplerRateConverterConfig *config, const struct R2samplerFilterBandEdges *band_edges,
+        struct R2samplerFilterBandEdges *result)
+{
+    uint32_t gcd, up_rate, down_rate;
+    double nyquist;
+
+    assert((config != NULL) && (result != NULL));
+    assert((config->input_rate != 0) && (config->output_rate != 0));
+
+    /* 指定があればそのまま使用 */
+    if (band_edges != NULL) {
+        (*result) = (*band_edges);
+        return;
+    }
+
+    /* 阻止域端を狭い方のナイキスト周波数に合わせ、その手前を遷移帯域とする */
+    gcd = R2sampler_GCD(config->input_rate, config->output_rate);
+    up_rate = config->output_rate / gcd;
+    down_rate = config->input_rate / gcd;
+    nyquist = 0.5 / R2SAMPLERRATECONVERTER_MAX(up_rate, down_rate);
+    result->stopband_edge = nyquist;
+    result->passband_edge = nyquist * (1.0 - config->transition_width);
+}
+
+/* ハーフバンドフィルタとして設計できるフィルタか判定（帯域端の条件を除く） */
+uint8_t R2samplerRateConverter_IsHalfBandDesignable(const struct R2samplerRateConverterConfig *config)
+{
+    assert(config != NULL);
+
+    /* 係数の対称性を使うため線形位相のみ */
+    if (config->filter_phase != R2SAMPLER_FILTERPHASE_LINEAR) {
+        return 0;
+    }
+
+    switch (config->filter_type) {
+    case R2SAMPLER_FILTERTYPE_LPF_HANNWINDOW:
+    case R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW:
+    case R2SAMPLER_FILTERTYPE_LPF_NUTTALLWINDOW:
+    case R2SAMPLER_FILTERTYPE_LPF_BLACKMANNUTTALLWINDOW:
+    case R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW:
+    case R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE:
+        return 1;
+    case R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES:
+        /* 通過域と阻止域の誤差の重みが等しい場合のみ応答が0.25に対称になる */
+        return (config->stopband_weight == 1.0) ? 1 : 0;
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+/* ハーフバンドフィルタとして処理できるか判定 */
+static uint8_t R2samplerRateConverter_IsHalfBandApplicable(
+        const struct R2samplerRateConverterConfig *config, const struct R2samplerFilterBandEdges *band_edges,
+        uint32_t up_rate, uint32_t down_rate, uint32_t filter_order)
+{
+    assert(config != NULL);
+
+    /* 2倍の補間または1/2の間引きのみ */
+    if (!(((up_rate == 2) && (down_rate == 1)) || ((up_rate == 1) && (down_rate == 2)))) {
+        return 0;
+    }
+
+    if (!R2samplerRateConverter_IsHalfBandDesignable(config)) {
+        return 0;
+    }
+
+    /* 窓関数法のLPFはカットオフが半帯域となり、中央以外の偶数オフセットの係数がゼロになる */
+    /* 仕様から設計するフィルタは遷移帯域が0.25に対称な場合のみ同様の係数となる */
+    if (R2samplerRateConverter_IsDesignedBySpecification(config->filter_type)) {
+        struct R2samplerFilterBandEdges edges;
+        R2samplerRateConverter_GetBandEdges(config, band_edges, &edges);
+        if (fabs(edges.passband_edge + edges.stopband_edge - 0.5) > R2SAMPLERRATECONVERTER_HALF_BAND_EDGE_TOLERANCE) {
+            return 0;
+        }
+    }
+
+    /* 非ゼロ係数の対が1つ以上必要 */
+    return (filter_order >= 3) ? 1 : 0;
+}
+
+/* 使用するフィルタ次数を計算 */
+static uint32_t R2samplerRateConverter_CalculateFilterOrder(
+        const struct R2samplerRateConverterConfig *config, const struct R2samplerFilterBandEdges *band_edges)
+{
+    double transition_width;
+    struct R2samplerFilterBandEdges edges;
+
+    assert(config != NULL);
+
+    /* 次数が指定されていればそのまま使用 */
+    if (!R2samplerRateConverter_IsDesignedBySpecification(config->filter_type) || (config->filter_order != 0)) {
+        return config->filter_order;
+    }
+
+    /* 正規化周波数での遷移帯域幅 */
+    R2samplerRateConverter_GetBandEdges(config, band_edges, &edges);
+    transition_width = edges.stopband_edge - edges.passband_edge;
+    assert((transition_width > 0.0) && (transition_width < 0.5));
+
+    /* 減衰量と遷移帯域幅を満たす次数 */
+    if (config->filter_type == R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE) {
+        /* 等リップル: 推定式の誤差を見込んで余裕を持たせる */
+        return R2sampler_CalculateEquirippleFilterOrder(
+                config->stopband_attenuation + R2SAMPLERRATECONVERTER_EQUIRIPPLE_ATTENUATION_MARGIN, transition_width);
+    }
+    /* カイザー窓・最小二乗: 最小二乗の阻止域平均電力はカイザー窓の最大値を下回るため同じ推定式を使用 */
+    return R2sampler_CalculateKaiserFilterOrder(config->stopband_attenuation, transition_width);
+}
+
+/* レート変換器生成コンフィグを既定値で初期化 */
+R2samplerRateConverterApiResult R2samplerRateConverter_InitializeConfig(struct R2samplerRateConverterConfig *config)
+{
+    /* 引数チェック */
+    if (config == NULL) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* 以降に追加されるメンバも既定値（0/NULL）になるよう全体をゼロクリア */
+    memset(config, 0, sizeof(struct R2samplerRateConverterConfig));
+
+    /* 減衰量と遷移帯域幅から次数を自動決定するカイザー窓 */
+    config->filter_type = R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW;
+    config->filter_order = 0;
+    config->stopband_attenuation = 80.0;
+    config->transition_width = 0.2;
+    config->stopband_weight = 1.0;
+    config->filter_cache = NULL;
+    config->convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+    config->filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+    config->memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+    config->allocator = NULL;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
 /* レート変換器作成に必要なワークサイズ計算 */
 int32_t R2samplerRateConverter_CalculateWorkSize(const struct R2samplerRateConverterConfig *config)
 {
-    int32_t work_size;
-    uint32_t tmp_up_rate;
+    return R2samplerRateConverter_CalculateMultiChannelWorkSize(config, 1);
+}
+
+/* チャンネル数を指定したレート変換器作成に必要なワークサイズ計算 */
+int32_t R2samplerRateConverter_CalculateMultiChannelWorkSize(
+        const struct R2samplerRateConverterConfig *config, uint32_t num_channels)
+{
+    return R2samplerRateConverter_CalculateWorkSizeWithBandEdges(config, num_channels, NULL);
+}
+
+/* レート変換器作成に必要なワークサイズの内訳を計算 */
+R2samplerRateConverterApiResult R2samplerRateConverter_CalculateWorkSizeBreakdown(
+        const struct R2samplerRateConverterConfig *config, struct R2samplerWorkSizeBreakdown *breakdown)
+{
+    /* 引数チェック */
+    if ((config == NULL) || (breakdown == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    if (R2samplerRateConverter_CalculateWorkSizeBreakdownWithBandEdges(config, 1, NULL, breakdown) < 0) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* 1出力サンプルあたりの積和回数を見積もり */
+int32_t R2samplerRateConverter_EstimateNumMacsPerOutput(
+        const struct R2samplerRateConverterConfig *config, const struct R2samplerFilterBandEdges *band_edges,
+        uint32_t *filter_order)
+{
+    uint32_t gcd, up_rate, down_rate, tmp_filter_order;
 
     /* 引数チェック */
     if (config == NULL) {
         return -1;
     }
 
+    /* コンフィグチェック */
+    if ((config->input_rate == 0) || (config->output_rate == 0)
+            || !R2samplerRateConverter_CheckSpecification(config, band_edges)) {
+        return -1;
+    }
+
+    gcd = R2sampler_GCD(config->input_rate, config->output_rate);
+    up_rate = config->output_rate / gcd;
+    down_rate = config->input_rate / gcd;
+    tmp_filter_order = R2samplerRateConverter_CalculateFilterOrder(config, band_edges);
+
+    if (filter_order != NULL) {
+        (*filter_order) = tmp_filter_order;
+    }
+
+    /* ハーフバンドは対称な係数の組と中央タップのみ */
+    if (R2samplerRateConverter_IsHalfBandApplicable(config, band_edges, up_rate, down_rate, tmp_filter_order)) {
+        return (int32_t)(R2SAMPLERRATECONVERTER_NUM_HALF_BAND_PAIRS(tmp_filter_order) + 1);
+    }
+
+    /* 出力1サンプルにつき1位相分のタップを畳み込む */
+    return (int32_t)R2SAMPLERRATECONVERTER_NUM_POLYPHASE_TAPS(tmp_filter_order, up_rate);
+}
+
+/* フィルタ係数領域のサイズ計算 */
+static int32_t R2samplerRateConverter_CalculateCoefficientSize(uint32_t filter_order, uint32_t up_rate)
+{
+    int32_t size;
+    /* フィルタ係数 */
+    size = (int32_t)(sizeof(float) * filter_order + R2SAMPLERRATECONVERTER_ALIGNMENT);
+    /* ポリフェーズフィルタ係数 */
+    size += (int32_t)(sizeof(float) * up_rate * R2SAMPLERRATECONVERTER_NUM_POLYPHASE_TAPS(filter_order, up_rate) + R2SAMPLERRATECONVERTER_ALIGNMENT);
+    /* ハーフバンドフィルタ係数 */
+    size += (int32_t)(sizeof(float) * R2SAMPLERRATECONVERTER_NUM_HALF_BAND_PAIRS(filter_order) + R2SAMPLERRATECONVERTER_ALIGNMENT);
+    return size;
+}
+
+/* フィルタ係数をキャッシュで共有するか判定 */
+static uint8_t R2samplerRateConverter_IsFilterCacheApplicable(
+        const struct R2samplerRateConverterConfig *config, int32_t coefficient_size)
+{
+    assert(config != NULL);
+    /* 1エントリに収まらない係数はハンドル毎に保持 */
+    return ((config->filter_cache != NULL)
+            && (coefficient_size <= R2samplerFilterCache_GetEntrySize(config->filter_cache))) ? 1 : 0;
+}
+
+/* フィルタ係数領域の割り当て（割り当てた領域の末尾を返す） */
+static uint8_t *R2samplerRateConverter_SetCoefficientArea(struct R2samplerRateConverter *converter, uint8_t *ptr)
+{
+    assert((converter != NULL) && (ptr != NULL));
+
+    /* フィルタ係数の領域確保 */
+    ptr = (uint8_t *)R2SAMPLERRATECONVERTER_ROUNDUP((uintptr_t)ptr, R2SAMPLERRATECONVERTER_ALIGNMENT);
+    converter->filter_coef = (float *)ptr;
+    ptr += sizeof(float) * converter->filter_order;
+
+    /* ポリフェーズフィルタ係数の領域確保 */
+    ptr = (uint8_t *)R2SAMPLERRATECONVERTER_ROUNDUP((uintptr_t)ptr, R2SAMPLERRATECONVERTER_ALIGNMENT);
+    converter->polyphase_coef = (float *)ptr;
+    ptr += sizeof(float) * converter->up_rate * converter->num_polyphase_taps;
+
+    /* ハーフバンドフィルタ係数の領域確保 */
+    ptr = (uint8_t *)R2SAMPLERRATECONVERTER_ROUNDUP((uintptr_t)ptr, R2SAMPLERRATECONVERTER_ALIGNMENT);
+    converter->half_band_coef = (float *)ptr;
+    ptr += sizeof(float) * converter->num_half_band_pairs;
+
+    return ptr;
+}
+
+/* フィルタ係数キャッシュ・係数テーブルのキーを作成 */
+static void R2samplerRateConverter_SetFilterKey(
+        const struct R2samplerRateConverterConfig *config, const struct R2samplerFilterBandEdges *band_edges,
+        uint32_t up_rate, uint32_t down_rate, uint32_t filter_order, struct R2samplerFilterCacheKey *key)
+{
+    assert((config != NULL) && (key != NULL));
+
+    key->filter_type = config->filter_type;
+    key->up_rate = up_rate;
+    key->down_rate = down_rate;
+    key->filter_order = filter_order;
+    key->filter_phase = config->filter_phase;
+    key->passband_edge = key->stopband_edge = 0.0;
+    key->stopband_attenuation = key->stopband_weight = 0.0;
+
+    /* 仕様から設計するフィルタは設計に使うパラメータを含める */
+    if (R2samplerRateConverter_IsDesignedBySpecification(config->filter_type)) {
+        struct R2samplerFilterBandEdges edges;
+        R2samplerRateConverter_GetBandEdges(config, band_edges, &edges);
+        key->passband_edge = edges.passband_edge;
+        key->stopband_edge = edges.stopband_edge;
+        key->stopband_attenuation = config->stopband_attenuation;
+        if (config->filter_type == R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES) {
+            key->stopband_weight = config->stopband_weight;
+        }
+    }
+}
+
+/* 事前生成した係数テーブルを検索（見つからなければNULL） */
+static const struct R2samplerCoefficientTable *R2samplerRateConverter_FindCoefficientTable(
+        const struct R2samplerFilterCacheKey *key)
+{
+    uint32_t i;
+
+    assert(key != NULL);
+
+    for (i = 0; i < R2sampler_num_coefficient_tables; i++) {
+        const struct R2samplerCoefficientTable *table = &R2sampler_coefficient_tables[i];
+        if (R2samplerFilterCache_IsKeyEqual(&table->key, key)
+                /* タップ数の切り上げ単位が生成時と異なるテーブルは使用しない */
+                && (table->num_polyphase_taps == R2SAMPLERRATECONVERTER_NUM_POLYPHASE_TAPS(key->filter_order, key->up_rate))) {
+            return table;
+        }
+    }
+
+    return NULL;
+}
+
+/* 1回にディレイバッファへ入れる入力サンプル数（ブロック長）の計算
+ * 省メモリモードでは1位相あたりのタップ数（間引きで1出力あたりに進む入力数の方が多ければそちら）に分割し、
+ * ディレイバッファとFFTの作業領域を最大入力サンプル数によらない大きさにする */
+static uint32_t R2samplerRateConverter_CalculateNumBlockSamples(
+        R2samplerMemoryMode memory_mode, uint32_t max_num_input_samples,
+        uint32_t up_rate, uint32_t down_rate, uint32_t num_polyphase_taps)
+{
+    if (memory_mode != R2SAMPLER_MEMORYMODE_COMPACT) {
+        return max_num_input_samples;
+    }
+    return R2SAMPLERRATECONVERTER_MIN(max_num_input_samples,
+            R2SAMPLERRATECONVERTER_MAX(num_polyphase_taps, (down_rate + up_rate - 1) / up_rate));
+}
+
+/* FFTによる畳み込みのFFTサイズ計算 */
+/* 1回の処理で進む入力数を1ブロックで賄える大きさにするが、タップ数に対して大きすぎる変換はしない */
+static uint32_t R2samplerRateConverter_CalculateFFTSize(uint32_t num_polyphase_taps, uint32_t max_num_input_samples)
+{
+    const uint32_t required_size = R2SAMPLERRATECONVERTER_MIN(
+            R2SAMPLERRATECONVERTER_FFT_SIZE_PER_TAPS * num_polyphase_taps, num_polyphase_taps + max_num_input_samples);
+    /* 2の冪に限らず3・5の因数も許してゼロ詰めを減らす */
+    return FFTPlan_CalculateFastSize(R2SAMPLERRATECONVERTER_MAX(R2SAMPLERRATECONVERTER_MIN_FFT_SIZE, required_size));
+}
+
+/* FFTによる畳み込みに必要な領域のサイズ計算 */
+static int32_t R2samplerRateConverter_CalculateFFTWorkSize(uint32_t up_rate, uint32_t fft_size)
+{
+    int32_t size = 0, tmp_size;
+    struct FFTPlanConfig plan_config;
+    /* 位相ごとのスペクトルと畳み込み結果 */
+    size += 2 * (int32_t)(sizeof(float) * up_rate * fft_size + R2SAMPLERRATECONVERTER_ALIGNMENT);
+    /* 入力ブロック */
+    size += (int32_t)(sizeof(float) * fft_size + R2SAMPLERRATECONVERTER_ALIGNMENT);
+    /* FFTプラン */
+    plan_config.fft_size = fft_size;
+    plan_config.max_batch_size = 1;
+    tmp_size = FFTPlan_CalculateWorkSize(&plan_config);
+    assert(tmp_size >= 0);
+    size += tmp_size;
+    /* 使用する位相のフラグ */
+    size += (int32_t)(sizeof(uint8_t) * up_rate);
+    return size;
+}
+
+/* FFTによる畳み込みを行う場合のバッファ設定 */
+/* 1ブロック分の入力をまとめて参照できるようにする */
+static void R2samplerRateConverter_SetFFTBufferConfig(
+        uint32_t num_channels, uint32_t fft_size, struct RingBufferConfig *buffer_config)
+{
+    const size_t block_size = sizeof(float) * num_channels * fft_size;
+    assert(buffer_config != NULL);
+    buffer_config->max_required_size = R2SAMPLERRATECONVERTER_MAX(buffer_config->max_required_size,
+            R2SAMPLERRATECONVERTER_MIN(buffer_config->max_size, block_size));
+}
+
+/* FFTによる畳み込みに使う位相ごとのフィルタのスペクトルを計算 */
+/* 相関 sum_i x[n + i] h[i] を畳み込みとして計算するため係数を反転して変換する */
+static void R2samplerRateConverter_CalculateFilterSpectrum(struct R2samplerRateConverter *converter)
+{
+    uint32_t phase, i;
+    const uint32_t fft_size = converter->fft_size;
+    const uint32_t num_taps = converter->num_polyphase_taps;
+    /* 逆変換の正規化定数 */
+    const float norm = 2.0f / (float)fft_size;
+
+    assert(converter->fft_convolution);
+
+    for (phase = 0; phase < converter->up_rate; phase++) {
+        float *spectrum = &converter->fft_filter_spectrum[phase * fft_size];
+        const float *pcoef = &converter->polyphase_coef[phase * num_taps];
+        for (i = 0; i < num_taps; i++) {
+            spectrum[i] = norm * pcoef[num_taps - 1 - i];
+        }
+        for (; i < fft_size; i++) {
+            spectrum[i] = 0.0f;
+        }
+        FFTPlan_RealFFT(converter->fft_plan, -1, spectrum);
+    }
+}
+
+/* フィルタ係数の設計（係数領域は割り当て済みであること） */
+static void R2samplerRateConverter_DesignFilter(
+        struct R2samplerRateConverter *converter,
+        const struct R2samplerRateConverterConfig *config, const struct R2samplerFilterBandEdges *band_edges,
+        void *design_work, int32_t design_work_size)
+{
+    assert((converter != NULL) && (config != NULL));
+
+    /* フィルタ設計 */
+    switch (converter->filter_type) {
+    case R2SAMPLER_FILTERTYPE_NONE:
+        /* インパルス応答の畳込みとする */
+        assert(converter->filter_order == 1);
+        converter->filter_coef[0] = 1.0f;
+        break;
+    case R2SAMPLER_FILTERTYPE_LPF_HANNWINDOW:
+    case R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW:
+    case R2SAMPLER_FILTERTYPE_LPF_NUTTALLWINDOW:
+    case R2SAMPLER_FILTERTYPE_LPF_BLACKMANNUTTALLWINDOW:
+        {
+            uint32_t i;
+            R2samplerLPFWindowType window_type = R2SAMPLERLPF_WINDOW_TYPE_INVALID;
+            /* 阻止域: エイリアシング防止のため狭い方に設定 */
+            const float cutoff = 0.5f / R2SAMPLERRATECONVERTER_MAX(converter->up_rate, converter->down_rate);
+            /* フィルタ設計 */
+            switch (converter->filter_type) {
+            case R2SAMPLER_FILTERTYPE_LPF_HANNWINDOW:
+                window_type = R2SAMPLERLPF_WINDOW_TYPE_HANN;
+                break;
+            case R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW:
+                window_type = R2SAMPLERLPF_WINDOW_TYPE_BLACKMAN;
+                break;
+            case R2SAMPLER_FILTERTYPE_LPF_NUTTALLWINDOW:
+                window_type = R2SAMPLERLPF_WINDOW_TYPE_NUTTALL;
+                break;
+            case R2SAMPLER_FILTERTYPE_LPF_BLACKMANNUTTALLWINDOW:
+                window_type = R2SAMPLERLPF_WINDOW_TYPE_BLACKMANNUTTALL;
+                break;
+            default:
+                assert(0);
+            }
+            assert(window_type != R2SAMPLERLPF_WINDOW_TYPE_INVALID);
+            if (converter->half_band) {
+                /* ゼロとなる係数を厳密にゼロにして設計 */
+                assert(cutoff == 0.25f);
+                R2sampler_CreateHalfBandLPFByWindowFunction(
+                        window_type, converter->filter_coef, converter->filter_order);
+            } else {
+                R2sampler_CreateLPFByWindowFunction(cutoff,
+                        window_type, converter->filter_coef, converter->filter_order);
+            }
+            /* 利得調整 */
+            for (i = 0; i < converter->filter_order; i++) {
+                converter->filter_coef[i] *= converter->up_rate;
+            }
+        }
+        break;
+    case R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW:
+        {
+            uint32_t i;
+            struct R2samplerFilterBandEdges edges;
+            float cutoff;
+            /* 遷移帯域の中央をカットオフとする */
+            R2samplerRateConverter_GetBandEdges(config, band_edges, &edges);
+            cutoff = (float)(0.5 * (edges.passband_edge + edges.stopband_edge));
+            R2sampler_CreateLPFByKaiserWindow(cutoff,
+                    R2sampler_CalculateKaiserBeta(config->stopband_attenuation),
+                    converter->filter_coef, converter->filter_order);
+            /* 利得調整 */
+            for (i = 0; i < converter->filter_order; i++) {
+                converter->filter_coef[i] *= converter->up_rate;
+            }
+        }
+        break;
+    case R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE:
+        {
+            uint32_t i;
+            struct R2samplerFilterBandEdges edges;
+            R2samplerRateConverter_GetBandEdges(config, band_edges, &edges);
+            (void)R2sampler_CreateLPFByRemez(edges.passband_edge, edges.stopband_edge, 1.0,
+                    converter->filter_coef, converter->filter_order, design_work, design_work_size);
+            /* 利得調整 */
+            for (i = 0; i < converter->filter_order; i++) {
+                converter->filter_coef[i] *= converter->up_rate;
+            }
+        }
+        break;
+    case R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES:
+        {
+            uint32_t i;
+            struct R2samplerFilterBandEdges edges;
+            /* 遷移帯域は誤差を評価しない */
+            R2samplerRateConverter_GetBandEdges(config, band_edges, &edges);
+            R2sampler_CreateLPFByLeastSquares(edges.passband_edge, edges.stopband_edge,
+                    config->stopband_weight, converter->filter_coef, converter->filter_order, design_work, design_work_size);
+            /* 利得調整 */
+            for (i = 0; i < converter->filter_order; i++) {
+                converter->filter_coef[i] *= converter->up_rate;
+            }
+        }
+        break;
+    default:
+        assert(0);
+    }
+
+    /* 仕様から設計したハーフバンドフィルタはゼロとなる係数を厳密にゼロにする */
+    if (converter->half_band && R2samplerRateConverter_IsDesignedBySpecification(converter->filter_type)) {
+        R2sampler_SetHalfBandZeros(converter->filter_coef, converter->filter_order);
+    }
+
+    /* 最小位相への変換（振幅特性は変えない） */
+    /* 畳み込みはバッファの古いサンプルから順に係数を掛けるため、非対称な係数は時間反転して保持する */
+    if (converter->filter_phase == R2SAMPLER_FILTERPHASE_MINIMUM) {
+        uint32_t i;
+        R2sampler_ConvertToMinimumPhase(converter->filter_coef, converter->filter_order, design_work, design_work_size);
+        for (i = 0; i < converter->filter_order / 2; i++) {
+            const float tmp = converter->filter_coef[i];
+            converter->filter_coef[i] = converter->filter_coef[converter->filter_order - i - 1];
+            converter->filter_coef[converter->filter_order - i - 1] = tmp;
+        }
+    }
+
+    /* ポリフェーズフィルタ係数の作成 */
+    /* 位相pのフィルタは元の係数のp, p + up_rate, p + 2 * up_rate, ...番目を連続して並べたもの（末尾はゼロ埋め） */
+    {
+        uint32_t phase, i;
+        for (phase = 0; phase < converter->up_rate; phase++) {
+            float *pcoef = &converter->polyphase_coef[phase * converter->num_polyphase_taps];
+            for (i = 0; i < converter->num_polyphase_taps; i++) {
+                const uint32_t idx = phase + i * converter->up_rate;
+                pcoef[i] = (idx < converter->filter_order) ? converter->filter_coef[idx] : 0.0f;
+            }
+        }
+    }
+
+    /* ハーフバンドフィルタの非ゼロ係数の抽出 */
+    /* 中央から奇数オフセットの係数（中央の偶奇と逆のインデックス）を前半のみ並べる */
+    if (converter->half_band) {
+        uint32_t i;
+        const uint32_t offset = ((converter->filter_order - 1) / 2 + 1) % 2;
+        for (i = 0; i < converter->num_half_band_pairs; i++) {
+            converter->half_band_coef[i] = converter->filter_coef[offset + 2 * i];
+        }
+    }
+}
+
+/* 通過域（直流）の群遅延の計算 */
+static double R2samplerRateConverter_CalculateGroupDelay(const struct R2samplerRateConverter *converter)
+{
+    uint32_t i;
+    double sum, moment;
+
+    assert(converter != NULL);
+
+    /* 線形位相は係数の中央 */
+    if (converter->filter_phase == R2SAMPLER_FILTERPHASE_LINEAR) {
+        return (converter->filter_order - 1) / 2.0;
+    }
+
+    /* 直流の群遅延 sum(n h[n]) / sum(h[n]) （係数は時間反転して保持している） */
+    sum = moment = 0.0;
+    for (i = 0; i < converter->filter_order; i++) {
+        sum += converter->filter_coef[i];
+        moment += (double)(converter->filter_order - i - 1) * converter->filter_coef[i];
+    }
+    assert(sum != 0.0);
+
+    return moment / sum;
+}
+
+/* フィルタの帯域端を指定したレート変換器作成に必要なワークサイズ計算 */
+int32_t R2samplerRateConverter_CalculateWorkSizeWithBandEdges(
+        const struct R2samplerRateConverterConfig *config, uint32_t num_channels,
+        const struct R2samplerFilterBandEdges *band_edges)
+{
+    struct R2samplerWorkSizeBreakdown breakdown;
+    return R2samplerRateConverter_CalculateWorkSizeBreakdownWithBandEdges(config, num_channels, band_edges, &breakdown);
+}
+
+/* フィルタの帯域端を指定したレート変換器作成に必要なワークサイズの内訳を計算 */
+int32_t R2samplerRateConverter_CalculateWorkSizeBreakdownWithBandEdges(
+        const struct R2samplerRateConverterConfig *config, uint32_t num_channels,
+        const struct R2samplerFilterBandEdges *band_edges, struct R2samplerWorkSizeBreakdown *breakdown)
+{
+    int32_t coefficient_size;
+    uint32_t tmp_up_rate, tmp_down_rate, filter_order, num_block_samples;
+
+    /* 引数チェック */
+    if ((config == NULL) || (num_channels == 0) || (breakdown == NULL)) {
+        return -1;
+    }
+
     /* コンフィグチェック */
     if ((config->max_num_input_samples == 0)
             || (config->input_rate == 0) || (config->output_rate == 0)) {
         return -1;
     }
+    if ((config->convolution_method != R2SAMPLER_CONVOLUTION_DIRECT)
+            && (config->convolution_method != R2SAMPLER_CONVOLUTION_FFT)) {
+        return -1;
+    }
+    if ((config->filter_phase != R2SAMPLER_FILTERPHASE_LINEAR)
+            && (config->filter_phase != R2SAMPLER_FILTERPHASE_MINIMUM)) {
+        return -1;
+    }
+    if ((config->memory_mode != R2SAMPLER_MEMORYMODE_NORMAL)
+            && (config->memory_mode != R2SAMPLER_MEMORYMODE_COMPACT)) {
+        return -1;
+    }
+    /* カイザー窓・等リップル・最小二乗は阻止域減衰量と遷移帯域幅の指定を要求 */
+    if (!R2samplerRateConverter_CheckSpecification(config, band_edges)) {
+        return -1;
+    }
+    /* 使用するフィルタ次数を決定 */
+    filter_order = R2samplerRateConverter_CalculateFilterOrder(config, band_edges);
     /* フィルタ次数は奇数を要求 */
-    if ((config->filter_order % 2) == 0) {
+    if ((filter_order % 2) == 0) {
         return -1;
     }
     /* フィルタを適用しない場合は次数は1を要求 */
-    if ((config->filter_type == R2SAMPLER_FILTERTYPE_NONE) && (config->filter_order != 1)) {
+    if ((config->filter_type == R2SAMPLER_FILTERTYPE_NONE) && (filter_order != 1)) {
         return -1;
     }
 
-    /* ワークサイズ計算 */
-    work_size = sizeof(struct R2samplerRateConverter) + R2SAMPLERRATECONVERTER_ALIGNMENT;
+    /* ハンドル本体のサイズ */
+    breakdown->coefficients = breakdown->history = breakdown->staging = breakdown->design = 0;
+    breakdown->other = sizeof(struct R2samplerRateConverter) + R2SAMPLERRATECONVERTER_ALIGNMENT;
 
     /* バッファワークサイズ計算 */
     {
         int32_t tmp_work_size;
-        uint32_t gcd, tmp_down_rate, buffer_num_samples;
+        uint32_t gcd, buffer_num_samples, num_polyphase_taps;
         struct RingBufferConfig buffer_config;
 
         /* バッファに必要なサンプル数（=正規化した入出力レート）を計算 */
@@ -77,45 +765,97 @@ int32_t R2samplerRateConverter_CalculateWorkSize(const struct R2samplerRateConve
         }
 
         /* ワークサイズ計算*/
-        /* バッファサンプル数: 最大入力数+間引き時に残りうるサンプル数にフィルタサイズ分 */
-        buffer_num_samples = config->max_num_input_samples * tmp_up_rate + (tmp_down_rate - 1) + config->filter_order;
-        buffer_config.max_size = sizeof(float) * buffer_num_samples;
-        buffer_config.max_required_size = sizeof(float) * R2SAMPLERRATECONVERTER_MAX(tmp_down_rate, config->filter_order);
+        /* バッファには入力サンプル（ゼロ値挿入前）のみを保持する */
+        /* バッファサンプル数: 1回に入れる入力数+間引き時に残りうるサンプル数にフィルタサイズ分 */
+        num_polyphase_taps = R2SAMPLERRATECONVERTER_NUM_POLYPHASE_TAPS(filter_order, tmp_up_rate);
+        num_block_samples = R2samplerRateConverter_CalculateNumBlockSamples(config->memory_mode,
+                config->max_num_input_samples, tmp_up_rate, tmp_down_rate, num_polyphase_taps);
+        buffer_num_samples = num_block_samples + (tmp_down_rate + tmp_up_rate - 1) / tmp_up_rate + num_polyphase_taps;
+        buffer_config.max_size = sizeof(float) * num_channels * buffer_num_samples;
+        buffer_config.max_required_size = sizeof(float) * num_channels * R2SAMPLERRATECONVERTER_MAX((tmp_down_rate + tmp_up_rate - 1) / tmp_up_rate, num_polyphase_taps);
+        if (config->convolution_method == R2SAMPLER_CONVOLUTION_FFT) {
+            R2samplerRateConverter_SetFFTBufferConfig(num_channels,
+                    R2samplerRateConverter_CalculateFFTSize(num_polyphase_taps, num_block_samples), &buffer_config);
+        }
         if ((tmp_work_size = RingBuffer_CalculateWorkSize(&buffer_config)) < 0) {
             return -1;
         }
-        work_size += tmp_work_size;
+        breakdown->history += tmp_work_size;
+    }
+
+    /* FFTによる畳み込みに必要な領域サイズ（フィルタのスペクトルは係数として計上） */
+    if (config->convolution_method == R2SAMPLER_CONVOLUTION_FFT) {
+        const uint32_t fft_size = R2samplerRateConverter_CalculateFFTSize(
+                R2SAMPLERRATECONVERTER_NUM_POLYPHASE_TAPS(filter_order, tmp_up_rate), num_block_samples);
+        const int32_t spectrum_size = (int32_t)(sizeof(float) * tmp_up_rate * fft_size + R2SAMPLERRATECONVERTER_ALIGNMENT);
+        breakdown->coefficients += spectrum_size;
+        breakdown->staging += R2samplerRateConverter_CalculateFFTWorkSize(tmp_up_rate, fft_size) - spectrum_size;
+    }
+
+    /* 事前生成した係数テーブルがなければ係数領域・設計用の作業領域が必要 */
+    {
+        struct R2samplerFilterCacheKey key;
+        R2samplerRateConverter_SetFilterKey(config, band_edges, tmp_up_rate, tmp_down_rate, filter_order, &key);
+        if (R2samplerRateConverter_FindCoefficientTable(&key) == NULL) {
+            /* フィルタ係数サイズ計算（キャッシュで共有する場合はキャッシュ側に保持） */
+            coefficient_size = R2samplerRateConverter_CalculateCoefficientSize(filter_order, tmp_up_rate);
+            if (!R2samplerRateConverter_IsFilterCacheApplicable(config, coefficient_size)) {
+                breakdown->coefficients += coefficient_size;
+            }
+            /* フィルタ設計用の作業領域サイズ計算 */
+            breakdown->design += R2samplerRateConverter_CalculateDesignWorkSize(config->filter_type, config->filter_phase, filter_order) + R2SAMPLERRATECONVERTER_ALIGNMENT;
+        }
     }
 
-    /* フィルタ係数サイズ計算 */
-    work_size += sizeof(float) * config->filter_order + R2SAMPLERRATECONVERTER_ALIGNMENT;
-    /* 補間データバッファサイズ計算 */
-    work_size += sizeof(float) * config->max_num_input_samples * tmp_up_rate + R2SAMPLERRATECONVERTER_ALIGNMENT;
+    /* 合計 */
+    breakdown->total = breakdown->coefficients + breakdown->history + breakdown->staging + breakdown->design + breakdown->other;
 
-    return work_size;
+    return breakdown->total;
 }
 
 /* レート変換器作成 */
 struct R2samplerRateConverter *R2samplerRateConverter_Create(
         const struct R2samplerRateConverterConfig *config, void *work, int32_t work_size)
+{
+    return R2samplerRateConverter_CreateMultiChannel(config, 1, work, work_size);
+}
+
+/* チャンネル数を指定したレート変換器作成 */
+struct R2samplerRateConverter *R2samplerRateConverter_CreateMultiChannel(
+        const struct R2samplerRateConverterConfig *config, uint32_t num_channels, void *work, int32_t work_size)
+{
+    return R2samplerRateConverter_CreateWithBandEdges(config, num_channels, NULL, work, work_size);
+}
+
+/* フィルタの帯域端を指定したレート変換器作成 */
+struct R2samplerRateConverter *R2samplerRateConverter_CreateWithBandEdges(
+        const struct R2samplerRateConverterConfig *config, uint32_t num_channels,
+        const struct R2samplerFilterBandEdges *band_edges, void *work, int32_t work_size)
 {
     struct R2samplerRateConverter *converter;
     uint8_t tmp_alloc_by_own = 0;
-    uint8_t *work_ptr;
-    uint32_t tmp_up_rate;
+    struct R2samplerAllocator allocator;
+    uint8_t *work_ptr, *design_work;
+    int32_t design_work_size;
+    uint32_t tmp_up_rate, filter_order;
+    const struct R2samplerCoefficientTable *table;
 
     /* ワーク領域時前確保の場合 */
     if ((work == NULL) && (work_size == 0)) {
-        if ((work_size = R2samplerRateConverter_CalculateWorkSize(config)) < 0) {
+        if ((work_size = R2samplerRateConverter_CalculateWorkSizeWithBandEdges(config, num_channels, band_edges)) < 0) {
+            return NULL;
+        }
+        /* 指定されたアロケータ（指定が無ければグローバルに設定したもの）で確保 */
+        if (!R2sampler_GetAllocator(config->allocator, &allocator)) {
             return NULL;
         }
-        work = malloc((size_t)work_size);
+        work = allocator.alloc((size_t)work_size, R2SAMPLERRATECONVERTER_ALIGNMENT, allocator.context);
         tmp_alloc_by_own = 1;
     }
 
     /* 引数チェック */
-    if ((config == NULL) || (work == NULL)
-            || (work_size < R2samplerRateConverter_CalculateWorkSize(config))) {
+    if ((config == NULL) || (work == NULL) || (num_channels == 0)
+            || (work_size < R2samplerRateConverter_CalculateWorkSizeWithBandEdges(config, num_channels, band_edges))) {
         return NULL;
     }
 
@@ -124,12 +864,30 @@ struct R2samplerRateConverter *R2samplerRateConverter_Create(
             || (config->input_rate == 0) || (config->output_rate == 0)) {
         return NULL;
     }
+    if ((config->convolution_method != R2SAMPLER_CONVOLUTION_DIRECT)
+            && (config->convolution_method != R2SAMPLER_CONVOLUTION_FFT)) {
+        return NULL;
+    }
+    if ((config->filter_phase != R2SAMPLER_FILTERPHASE_LINEAR)
+            && (config->filter_phase != R2SAMPLER_FILTERPHASE_MINIMUM)) {
+        return NULL;
+    }
+    if ((config->memory_mode != R2SAMPLER_MEMORYMODE_NORMAL)
+            && (config->memory_mode != R2SAMPLER_MEMORYMODE_COMPACT)) {
+        return NULL;
+    }
+    /* カイザー窓・等リップル・最小二乗は阻止域減衰量と遷移帯域幅の指定を要求 */
+    if (!R2samplerRateConverter_CheckSpecification(config, band_edges)) {
+        return NULL;
+    }
+    /* 使用するフィルタ次数を決定 */
+    filter_order = R2samplerRateConverter_CalculateFilterOrder(config, band_edges);
     /* フィルタ次数は奇数を要求 */
-    if ((config->filter_order % 2) == 0) {
+    if ((filter_order % 2) == 0) {
         return NULL;
     }
     /* フィルタを適用しない場合は次数は1を要求 */
-    if ((config->filter_type == R2SAMPLER_FILTERTYPE_NONE) && (config->filter_order != 1)) {
+    if ((config->filter_type == R2SAMPLER_FILTERTYPE_NONE) && (filter_order != 1)) {
         return NULL;
     }
 
@@ -143,15 +901,20 @@ struct R2samplerRateConverter *R2samplerRateConverter_Create(
 
     /* メンバ設定 */
     converter->max_num_input_samples = config->max_num_input_samples;
+    converter->num_channels = num_channels;
     converter->filter_type = config->filter_type;
-    converter->filter_order = config->filter_order;
+    converter->filter_order = filter_order;
+    converter->filter_phase = config->filter_phase;
     converter->alloc_by_own = tmp_alloc_by_own;
+    if (tmp_alloc_by_own == 1) {
+        converter->allocator = allocator;
+    }
     converter->work = work;
 
     /* バッファ作成 */
     {
         int32_t tmp_work_size;
-        uint32_t gcd, tmp_down_rate, buffer_num_samples;
+        uint32_t gcd, tmp_down_rate, buffer_num_samples, num_polyphase_taps;
         struct RingBufferConfig buffer_config;
 
         /* バッファに必要なサンプル数（=正規化した入力レート）を計算 */
@@ -166,10 +929,18 @@ struct R2samplerRateConverter *R2samplerRateConverter_Create(
         }
 
         /* バッファ作成 */
-        /* バッファサンプル数: 最大入力数+間引き時に残りうるサンプル数にフィルタサイズ分 */
-        buffer_num_samples = config->max_num_input_samples * tmp_up_rate + (tmp_down_rate - 1) + config->filter_order;
-        buffer_config.max_size = sizeof(float) * buffer_num_samples;
-        buffer_config.max_required_size = sizeof(float) * R2SAMPLERRATECONVERTER_MAX(tmp_down_rate, config->filter_order);
+        /* バッファには入力サンプル（ゼロ値挿入前）のみを保持する */
+        /* バッファサンプル数: 1回に入れる入力数+間引き時に残りうるサンプル数にフィルタサイズ分 */
+        num_polyphase_taps = R2SAMPLERRATECONVERTER_NUM_POLYPHASE_TAPS(filter_order, tmp_up_rate);
+        converter->max_num_block_samples = R2samplerRateConverter_CalculateNumBlockSamples(config->memory_mode,
+                config->max_num_input_samples, tmp_up_rate, tmp_down_rate, num_polyphase_taps);
+        buffer_num_samples = converter->max_num_block_samples + (tmp_down_rate + tmp_up_rate - 1) / tmp_up_rate + num_polyphase_taps;
+        buffer_config.max_size = sizeof(float) * num_channels * buffer_num_samples;
+        buffer_config.max_required_size = sizeof(float) * num_channels * R2SAMPLERRATECONVERTER_MAX((tmp_down_rate + tmp_up_rate - 1) / tmp_up_rate, num_polyphase_taps);
+        if (config->convolution_method == R2SAMPLER_CONVOLUTION_FFT) {
+            R2samplerRateConverter_SetFFTBufferConfig(num_channels,
+                    R2samplerRateConverter_CalculateFFTSize(num_polyphase_taps, converter->max_num_block_samples), &buffer_config);
+        }
         if ((tmp_work_size = RingBuffer_CalculateWorkSize(&buffer_config)) < 0) {
             return NULL;
         }
@@ -182,80 +953,197 @@ struct R2samplerRateConverter *R2samplerRateConverter_Create(
         converter->down_rate = tmp_down_rate;
     }
 
-    /* フィルタ係数の領域確保 */
-    work_ptr = (uint8_t *)R2SAMPLERRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERRATECONVERTER_ALIGNMENT);
-    converter->filter_coef = (float *)work_ptr;
-    work_ptr += sizeof(float) * config->filter_order;
+    /* 2倍/1/2倍の変換はハーフバンドフィルタとして処理 */
+    converter->half_band = R2samplerRateConverter_IsHalfBandApplicable(config, band_edges,
+            converter->up_rate, converter->down_rate, converter->filter_order);
 
-    /* 補間データバッファの領域確保 */
-    work_ptr = (uint8_t *)R2SAMPLERRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERRATECONVERTER_ALIGNMENT);
-    converter->interp_buffer = (float *)work_ptr;
-    work_ptr += sizeof(float) * config->max_num_input_samples * tmp_up_rate;
-    converter->num_interp_buffer_samples = config->max_num_input_samples * tmp_up_rate;
+    /* FFTによる畳み込みの領域確保 */
+    converter->num_polyphase_taps = R2SAMPLERRATECONVERTER_NUM_POLYPHASE_TAPS(filter_order, tmp_up_rate);
+    converter->fft_convolution = (config->convolution_method == R2SAMPLER_CONVOLUTION_FFT) ? 1 : 0;
+    converter->fft_size = 0;
+    converter->fft_filter_spectrum = converter->fft_convolved = NULL;
+    converter->fft_block = NULL;
+    converter->fft_plan = NULL;
+    converter->fft_phase_used = NULL;
+    if (converter->fft_convolution) {
+        const uint32_t fft_size = R2samplerRateConverter_CalculateFFTSize(converter->num_polyphase_taps, converter->max_num_block_samples);
+        converter->fft_size = fft_size;
+        work_ptr = (uint8_t *)R2SAMPLERRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERRATECONVERTER_ALIGNMENT);
+        converter->fft_filter_spectrum = (float *)work_ptr;
+        work_ptr += sizeof(float) * tmp_up_rate * fft_size;
+        work_ptr = (uint8_t *)R2SAMPLERRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERRATECONVERTER_ALIGNMENT);
+        converter->fft_convolved = (float *)work_ptr;
+        work_ptr += sizeof(float) * tmp_up_rate * fft_size;
+        work_ptr = (uint8_t *)R2SAMPLERRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERRATECONVERTER_ALIGNMENT);
+        converter->fft_block = (float *)work_ptr;
+        work_ptr += sizeof(float) * fft_size;
+        work_ptr = (uint8_t *)R2SAMPLERRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERRATECONVERTER_ALIGNMENT);
+        {
+            struct FFTPlanConfig plan_config;
+            int32_t plan_work_size;
+            plan_config.fft_size = fft_size;
+            plan_config.max_batch_size = 1;
+            plan_work_size = FFTPlan_CalculateWorkSize(&plan_config);
+            converter->fft_plan = FFTPlan_Create(&plan_config, work_ptr, plan_work_size);
+            assert(converter->fft_plan != NULL);
+            work_ptr += plan_work_size;
+        }
+        converter->fft_phase_used = work_ptr;
+        work_ptr += sizeof(uint8_t) * tmp_up_rate;
+    }
+
+    /* フィルタ係数の領域確保 */
+    /* 係数テーブルがあればテーブルを参照、キャッシュで共有する場合は作成時にキャッシュから取得 */
+    converter->num_half_band_pairs = R2SAMPLERRATECONVERTER_NUM_HALF_BAND_PAIRS(filter_order);
+    converter->filter_cache = NULL;
+    converter->filter_cache_data = NULL;
+    R2samplerRateConverter_SetFilterKey(config, band_edges,
+            converter->up_rate, converter->down_rate, filter_order, &converter->filter_key);
+    design_work = NULL;
+    design_work_size = 0;
+    if ((table = R2samplerRateConverter_FindCoefficientTable(&converter->filter_key)) == NULL) {
+        if (R2samplerRateConverter_IsFilterCacheApplicable(config,
+                    R2samplerRateConverter_CalculateCoefficientSize(filter_order, tmp_up_rate))) {
+            converter->filter_cache = config->filter_cache;
+        } else {
+            work_ptr = R2samplerRateConverter_SetCoefficientArea(converter, work_ptr);
+        }
+        /* フィルタ設計用の作業領域確保（設計後は使用しない） */
+        work_ptr = (uint8_t *)R2SAMPLERRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERRATECONVERTER_ALIGNMENT);
+        design_work = work_ptr;
+        design_work_size = R2samplerRateConverter_CalculateDesignWorkSize(config->filter_type, config->filter_phase, filter_order);
+        work_ptr += design_work_size;
+    }
 
     /* バッファオーバーランチェック */
     assert((work_ptr - (uint8_t *)work) <= work_size);
 
-    /* フィルタ設計 */
-    switch (converter->filter_type) {
-    case R2SAMPLER_FILTERTYPE_NONE:
-        /* インパルス応答の畳込みとする */
-        assert(converter->filter_order == 1);
-        converter->filter_coef[0] = 1.0f;
-        break;
-    case R2SAMPLER_FILTERTYPE_LPF_HANNWINDOW:
-    case R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW:
-    case R2SAMPLER_FILTERTYPE_LPF_NUTTALLWINDOW:
-    case R2SAMPLER_FILTERTYPE_LPF_BLACKMANNUTTALLWINDOW:
-        {
-            uint32_t i;
-            R2samplerLPFWindowType window_type = R2SAMPLERLPF_WINDOW_TYPE_INVALID;
-            /* 阻止域: エイリアシング防止のため狭い方に設定 */
-            const float cutoff = 0.5f / R2SAMPLERRATECONVERTER_MAX(converter->up_rate, converter->down_rate);
-            /* フィルタ設計 */
-            switch (converter->filter_type) {
-            case R2SAMPLER_FILTERTYPE_LPF_HANNWINDOW:
-                window_type = R2SAMPLERLPF_WINDOW_TYPE_HANN;
-                break;
-            case R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW:
-                window_type = R2SAMPLERLPF_WINDOW_TYPE_BLACKMAN;
-                break;
-            case R2SAMPLER_FILTERTYPE_LPF_NUTTALLWINDOW:
-                window_type = R2SAMPLERLPF_WINDOW_TYPE_NUTTALL;
-                break;
-            case R2SAMPLER_FILTERTYPE_LPF_BLACKMANNUTTALLWINDOW:
-                window_type = R2SAMPLERLPF_WINDOW_TYPE_BLACKMANNUTTALL;
-                break;
-            default:
-                assert(0);
-            }
-            assert(window_type != R2SAMPLERLPF_WINDOW_TYPE_INVALID);
-            R2sampler_CreateLPFByWindowFunction(cutoff,
-                    window_type, converter->filter_coef, converter->filter_order);
-            /* 利得調整 */
-            for (i = 0; i < converter->filter_order; i++) {
-                converter->filter_coef[i] *= converter->up_rate;
+    /* 係数の設計、またはテーブル・キャッシュからの取得 */
+    if (table != NULL) {
+        /* 係数テーブルを直接参照（作成後に係数へ書き込むことはない） */
+        converter->filter_coef = (float *)table->filter_coef;
+        converter->polyphase_coef = (float *)table->polyphase_coef;
+        converter->half_band_coef = (float *)table->half_band_coef;
+        assert(!converter->half_band || (converter->half_band_coef != NULL));
+    } else if (converter->filter_cache != NULL) {
+        R2samplerFilterCache_Lock(converter->filter_cache);
+        if ((converter->filter_cache_data = R2samplerFilterCache_Find(converter->filter_cache, &converter->filter_key)) != NULL) {
+            /* 設計済みの係数を共有 */
+            (void)R2samplerRateConverter_SetCoefficientArea(converter, (uint8_t *)converter->filter_cache_data);
+        } else if ((converter->filter_cache_data = R2samplerFilterCache_Insert(converter->filter_cache, &converter->filter_key)) != NULL) {
+            /* 新規に設計してキャッシュに格納 */
+            (void)R2samplerRateConverter_SetCoefficientArea(converter, (uint8_t *)converter->filter_cache_data);
+            R2samplerRateConverter_DesignFilter(converter, config, band_edges, design_work, design_work_size);
+        }
+        R2samplerFilterCache_Unlock(converter->filter_cache);
+        /* キャッシュの全エントリが使用中 */
+        if (converter->filter_cache_data == NULL) {
+            if (tmp_alloc_by_own == 1) {
+                allocator.free(work, allocator.context);
             }
+            return NULL;
         }
-        break;
-    default:
-        assert(0);
+    } else {
+        R2samplerRateConverter_DesignFilter(converter, config, band_edges, design_work, design_work_size);
+    }
+
+    /* ハーフバンドフィルタの中央係数と最初の非ゼロ係数の位置 */
+    if (converter->half_band) {
+        const uint32_t center = (converter->filter_order - 1) / 2;
+        converter->half_band_offset = (center + 1) % 2;
+        converter->half_band_center_coef = converter->filter_coef[center];
+    }
+
+    /* 通過域の群遅延 */
+    converter->group_delay = R2samplerRateConverter_CalculateGroupDelay(converter);
+
+    /* FFTによる畳み込みに使うフィルタのスペクトル */
+    if (converter->fft_convolution) {
+        R2samplerRateConverter_CalculateFilterSpectrum(converter);
     }
 
+    /* 実行環境に合わせた演算カーネルを選択 */
+    R2samplerKernel_Select(&converter->kernel);
+
     /* 作成直後にレート変換を行えるように開始を指示 */
     (void)R2samplerRateConverter_Start(converter);
 
     return converter;
 }
 
+/* フィルタ次数の取得 */
+uint32_t R2samplerRateConverter_GetFilterOrder(const struct R2samplerRateConverter *converter)
+{
+    assert(converter != NULL);
+    return converter->filter_order;
+}
+
+/* 正規化したアップレート・ダウンレートの取得 */
+void R2samplerRateConverter_GetRates(
+        const struct R2samplerRateConverter *converter, uint32_t *up_rate, uint32_t *down_rate)
+{
+    assert((converter != NULL) && (up_rate != NULL) && (down_rate != NULL));
+    (*up_rate) = converter->up_rate;
+    (*down_rate) = converter->down_rate;
+}
+
+/* 通過域の群遅延を出力サンプル単位で取得 */
+R2samplerRateConverterApiResult R2samplerRateConverter_GetLatency(
+        const struct R2samplerRateConverter *converter, double *latency)
+{
+    /* 引数チェック */
+    if ((converter == NULL) || (latency == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* ゼロ値挿入後のサンプルを間引いて出力する */
+    (*latency) = converter->group_delay / converter->down_rate;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* 通過域の群遅延を入力サンプル単位で取得 */
+R2samplerRateConverterApiResult R2samplerRateConverter_GetInputLatency(
+        const struct R2samplerRateConverter *converter, double *latency)
+{
+    /* 引数チェック */
+    if ((converter == NULL) || (latency == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* 入力サンプルにゼロ値を挿入してからフィルタリングする */
+    (*latency) = converter->group_delay / converter->up_rate;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* 作成済みのレート変換器の係数をテーブルの形式で取得 */
+void R2samplerRateConverter_GetCoefficientTable(
+        const struct R2samplerRateConverter *converter, struct R2samplerCoefficientTable *table)
+{
+    assert((converter != NULL) && (table != NULL));
+    table->key = converter->filter_key;
+    table->num_polyphase_taps = converter->num_polyphase_taps;
+    table->filter_coef = converter->filter_coef;
+    table->polyphase_coef = converter->polyphase_coef;
+    table->half_band_coef = (converter->half_band) ? converter->half_band_coef : NULL;
+}
+
 /* レート変換器破棄 */
 void R2samplerRateConverter_Destroy(struct R2samplerRateConverter *converter)
 {
     if (converter != NULL) {
         /* 先にバッファを破棄しておく */
         RingBuffer_Destroy(converter->output_buffer);
+        if (converter->fft_plan != NULL) {
+            FFTPlan_Destroy(converter->fft_plan);
+        }
+        /* 共有している係数の参照を解放 */
+        if (converter->filter_cache_data != NULL) {
+            R2samplerFilterCache_Release(converter->filter_cache, converter->filter_cache_data);
+        }
         if (converter->alloc_by_own == 1) {
-            free(converter->work);
+            converter->allocator.free(converter->work, converter->allocator.context);
         }
     }
 }
@@ -264,6 +1152,7 @@ void R2samplerRateConverter_Destroy(struct R2samplerRateConverter *converter)
 R2samplerRateConverterApiResult R2samplerRateConverter_Start(struct R2samplerRateConverter *converter)
 {
     uint32_t i;
+    const float zero = 0.0f;
 
     /* 引数チェック */
     if (converter == NULL) {
@@ -273,35 +1162,34 @@ R2samplerRateConverterApiResult R2samplerRateConverter_Start(struct R2samplerRat
     /* リングバッファクリア */
     RingBuffer_Clear(converter->output_buffer);
 
-    /* 補間バッファをゼロ埋め */
-    for (i = 0; i < converter->num_interp_buffer_samples; i++) {
-        converter->interp_buffer[i] = 0.0f;
-    }
-
     /* フィルタ係数-1分の遅延を挿入（次に入るサンプルが丁度末尾に入るように） */
-    i = 0;
-    while (i < (converter->filter_order - 1)) {
-        uint32_t num_put_samples = R2SAMPLERRATECONVERTER_MIN(
-                converter->num_interp_buffer_samples, (converter->filter_order - 1) - i);
-        RingBuffer_Put(converter->output_buffer, converter->interp_buffer, sizeof(float) * num_put_samples);
-        i += num_put_samples;
+    /* バッファには入力サンプルのみを入れるため、ゼロ値挿入後に(filter_order - 1)サンプル分となる入力サンプル数を挿入 */
+    for (i = 0; i < converter->num_channels * ((converter->filter_order - 1) / converter->up_rate); i++) {
+        RingBuffer_Put(converter->output_buffer, &zero, sizeof(float));
     }
 
     /* ゼロ値挿入したデータの非ゼロ値のオフセットをリセット */
     converter->interp_offset = (converter->filter_order - 1) % converter->up_rate;
 
+    /* ドレイン状態をリセット */
+    converter->draining = 0;
+    converter->num_drain_samples = 0;
+
     return R2SAMPLERRATECONVERTER_APIRESULT_OK;
 }
 
-/* 内部でバッファリングしているサンプル数を取得 */
-static uint32_t R2samplerRateConverter_GetNumBufferedSamples(const struct R2samplerRateConverter *converter)
+/* 内部でバッファリングしているサンプル数（ゼロ値挿入後）を取得 */
+uint32_t R2samplerRateConverter_GetNumBufferedSamples(const struct R2samplerRateConverter *converter)
 {
     uint32_t num_buffered_samples;
 
     /* 引数チェック */
     assert(converter != NULL);
 
-    num_buffered_samples = (uint32_t)RingBuffer_GetRemainSize(converter->output_buffer) / sizeof(float);
+    /* ゼロ値挿入後のサンプル数に換算 */
+    /* 先頭の非ゼロ値の手前にあるinterp_offset個のゼロ値を加算 */
+    num_buffered_samples = (uint32_t)(RingBuffer_GetRemainSize(converter->output_buffer) / (sizeof(float) * converter->num_channels));
+    num_buffered_samples = num_buffered_samples * converter->up_rate + converter->interp_offset;
 
     /* 遅延分を削除 */
     assert(num_buffered_samples >= (converter->filter_order - 1));
@@ -325,13 +1213,260 @@ static uint32_t R2samplerRateConverter_GetNumOutputSamples(
     return nsmpls / converter->down_rate;
 }
 
+/* ハーフバンドフィルタによる2倍補間の1出力 */
+static void R2samplerRateConverter_HalfBandInterpolate(
+        const struct R2samplerRateConverter *converter, const float *x, uint32_t num_taps, float *output)
+{
+    uint32_t ch;
+    const uint32_t num_channels = converter->num_channels;
+    const uint32_t center = (converter->filter_order - 1) / 2;
+
+    assert(converter->half_band && (converter->up_rate == 2));
+
+    if (converter->interp_offset == (center % 2)) {
+        /* 中央を含む位相: 中央以外の係数はゼロのため1乗算のみ */
+        for (ch = 0; ch < num_channels; ch++) {
+            output[ch] = converter->half_band_center_coef * x[(center / 2) * num_channels + ch];
+        }
+    } else {
+        /* もう一方の位相: 全て非ゼロかつ偶対称 */
+        assert(num_taps == (2 * converter->num_half_band_pairs));
+        if (num_channels == 1) {
+            output[0] = converter->kernel.even_symmetric_fir(x, converter->half_band_coef, num_taps);
+        } else {
+            converter->kernel.multi_channel_dot_product(x,
+                    &converter->polyphase_coef[converter->interp_offset * converter->num_polyphase_taps],
+                    num_taps, num_channels, output);
+        }
+    }
+}
+
+/* ハーフバンドフィルタによる1/2間引きの1出力 */
+static void R2samplerRateConverter_HalfBandDecimate(
+        const struct R2samplerRateConverter *converter, const float *x, float *output)
+{
+    uint32_t ch;
+    const uint32_t num_channels = converter->num_channels;
+    const uint32_t center = (converter->filter_order - 1) / 2;
+
+    assert(converter->half_band && (converter->up_rate == 1));
+
+    /* ゼロ係数を飛ばし、偶対称性を使って畳み込み */
+    if (num_channels == 1) {
+        output[0] = converter->kernel.half_band_fir(&x[converter->half_band_offset],
+                converter->half_band_coef, converter->num_half_band_pairs);
+    } else {
+        converter->kernel.multi_channel_half_band_fir(&x[converter->half_band_offset * num_channels],
+                converter->half_band_coef, converter->num_half_band_pairs, num_channels, output);
+    }
+
+    /* 中央の係数 */
+    for (ch = 0; ch < num_channels; ch++) {
+        output[ch] += converter->half_band_center_coef * x[center * num_channels + ch];
+    }
+}
+
+/* FFTによる畳み込み（overlap-save法）でのレート変換
+ * 直接畳み込みと同じ順序で位相と入力位置を進め、各出力をその位相の畳み込み結果から取り出す */
+static void R2samplerRateConverter_FFTConvolve(
+        struct R2samplerRateConverter *converter, float *output_buffer, uint32_t num_output_samples)
+{
+    uint32_t smpl, ch;
+    void *pdata;
+    RingBufferApiResult rbf_ret;
+    const uint32_t num_channels = converter->num_channels;
+    const uint32_t up_rate = converter->up_rate;
+    const uint32_t down_rate = converter->down_rate;
+    const uint32_t fft_size = converter->fft_size;
+    const uint32_t num_taps = converter->num_polyphase_taps;
+    /* 1ブロックで有効な畳み込み結果の数（入力位置の数） */
+    const uint32_t num_valid = fft_size - num_taps + 1;
+    /* ゼロ値挿入したデータの非ゼロ値のオフセット更新量: -down_rate (mod up_rate) */
+    const uint32_t interp_delta = up_rate - (down_rate % up_rate);
+
+    assert(converter->fft_convolution);
+
+    smpl = 0;
+    while (smpl < num_output_samples) {
+        uint32_t i, phase, pos, offset, end_smpl, num_block_samples;
+        const float *pblock;
+
+        /* ブロック内で得られる出力の範囲と使用する位相を求める */
+        for (phase = 0; phase < up_rate; phase++) {
+            converter->fft_phase_used[phase] = 0;
+        }
+        pos = 0;
+        offset = converter->interp_offset;
+        for (end_smpl = smpl; (end_smpl < num_output_samples) && (pos < num_valid); end_smpl++) {
+            const uint32_t next_offset = (offset + interp_delta) % up_rate;
+            converter->fft_phase_used[offset] = 1;
+            pos += (down_rate + next_offset - offset) / up_rate;
+            offset = next_offset;
+        }
+
+        /* ディレイバッファからブロックを参照（足りない分はゼロとみなす） */
+        num_block_samples = (uint32_t)(RingBuffer_GetRemainSize(converter->output_buffer) / (sizeof(float) * num_channels));
+        num_block_samples = R2SAMPLERRATECONVERTER_MIN(num_block_samples, fft_size);
+        pblock = NULL;
+        if (num_block_samples > 0) {
+            rbf_ret = RingBuffer_Peek(converter->output_buffer, &pdata, sizeof(float) * num_channels * num_block_samples);
+            assert(rbf_ret == RINGBUFFER_APIRESULT_OK);
+            pblock = (const float *)pdata;
+        }
+
+        for (ch = 0; ch < num_channels; ch++) {
+            /* 入力ブロックのスペクトル */
+            for (i = 0; i < num_block_samples; i++) {
+                converter->fft_block[i] = pblock[i * num_channels + ch];
+            }
+            for (; i < fft_size; i++) {
+                converter->fft_block[i] = 0.0f;
+            }
+            FFTPlan_RealFFT(converter->fft_plan, -1, converter->fft_block);
+
+            /* 使用する位相ごとにフィルタのスペクトルを掛けて逆変換 */
+            for (phase = 0; phase < up_rate; phase++) {
+                float *convolved = &converter->fft_convolved[phase * fft_size];
+                const float *spectrum = &converter->fft_filter_spectrum[phase * fft_size];
+                if (!converter->fft_phase_used[phase]) {
+                    continue;
+                }
+                /* 直流・最高周波数成分は実数 */
+                convolved[0] = converter->fft_block[0] * spectrum[0];
+                convolved[1] = converter->fft_block[1] * spectrum[1];
+                for (i = 1; i < (fft_size >> 1); i++) {
+                    const float xr = converter->fft_block[2 * i], xi = converter->fft_block[2 * i + 1];
+                    const float hr = spectrum[2 * i], hi = spectrum[2 * i + 1];
+                    convolved[2 * i] = xr * hr - xi * hi;
+                    convolved[2 * i + 1] = xr * hi + xi * hr;
+                }
+                FFTPlan_RealFFT(converter->fft_plan, 1, convolved);
+            }
+
+            /* 出力を取り出す: 入力位置posの結果は巡回畳み込みの(pos + num_taps - 1)番目 */
+            pos = 0;
+            offset = converter->interp_offset;
+            for (i = smpl; i < end_smpl; i++) {
+                const uint32_t next_offset = (offset + interp_delta) % up_rate;
+                output_buffer[i * num_channels + ch] = converter->fft_convolved[offset * fft_size + pos + num_taps - 1];
+                pos += (down_rate + next_offset - offset) / up_rate;
+                offset = next_offset;
+            }
+        }
+
+        /* 処理したブロックの入力を捨てて状態を進める */
+        if (pos > 0) {
+            rbf_ret = RingBuffer_Get(converter->output_buffer, &pdata, sizeof(float) * num_channels * pos);
+            assert(rbf_ret == RINGBUFFER_APIRESULT_OK);
+        }
+        converter->interp_offset = offset;
+        smpl = end_smpl;
+    }
+
+    /* アサート無効時の未使用警告回避 */
+    (void)rbf_ret;
+}
+
+/* ディレイバッファのサンプルを間引きしつつフィルタリング */
+static void R2samplerRateConverter_Convolve(
+        struct R2samplerRateConverter *converter, float *output_buffer, uint32_t num_output_samples)
+{
+    uint32_t smpl;
+    void *pdata;
+    RingBufferApiResult rbf_ret;
+    const uint32_t num_channels = converter->num_channels;
+
+    if (converter->fft_convolution) {
+        /* FFTによるブロック単位の畳み込み */
+        R2samplerRateConverter_FFTConvolve(converter, output_buffer, num_output_samples);
+    } else if (converter->up_rate > 1) {
+        /* ゼロ値挿入分をスキップした処理 */
+        /* ゼロ値挿入したデータの非ゼロ値のオフセット更新量: -down_rate (mod up_rate) */
+        const uint32_t interp_delta = converter->up_rate - (converter->down_rate % converter->up_rate);
+        for (smpl = 0; smpl < num_output_samples; smpl++) {
+            uint32_t num_taps, next_offset, num_skip_samples;
+            const float *pdecim;
+            const float *pcoef;
+            /* 非ゼロ値のオフセットに対応する位相のフィルタ係数を使用 */
+            pcoef = &converter->polyphase_coef[converter->interp_offset * converter->num_polyphase_taps];
+            num_taps = (converter->filter_order - converter->interp_offset + converter->up_rate - 1) / converter->up_rate;
+            /* バッファには非ゼロ値のみが連続して並んでいる */
+            /* 補足）フィルタ次数がup_rateより小さいとき、タップを持たない位相がある */
+            if (num_taps > 0) {
+                /* ディレイバッファから参照 */
+                rbf_ret = RingBuffer_Peek(converter->output_buffer, &pdata, sizeof(float) * num_channels * num_taps);
+                assert(rbf_ret == RINGBUFFER_APIRESULT_OK);
+                pdecim = (const float *)pdata;
+                if (converter->half_band) {
+                    R2samplerRateConverter_HalfBandInterpolate(converter, pdecim, num_taps, &output_buffer[smpl * num_channels]);
+                } else if (num_channels == 1) {
+                    output_buffer[smpl] = converter->kernel.dot_product(pdecim, pcoef, num_taps);
+                } else {
+                    /* 1つの係数を全チャンネルで共有 */
+                    converter->kernel.multi_channel_dot_product(pdecim, pcoef, num_taps, num_channels, &output_buffer[smpl * num_channels]);
+                }
+            } else {
+                uint32_t ch;
+                for (ch = 0; ch < num_channels; ch++) {
+                    output_buffer[smpl * num_channels + ch] = 0.0f;
+                }
+            }
+            /* ゼロ値挿入したデータの非ゼロ値のオフセット更新 */
+            next_offset = (converter->interp_offset + interp_delta) % converter->up_rate;
+            /* down_rateだけ進めて間引く: 先頭の非ゼロ値が進んだ分の入力サンプルを捨てる */
+            num_skip_samples = (converter->down_rate + next_offset - converter->interp_offset) / converter->up_rate;
+            if (num_skip_samples > 0) {
+                rbf_ret = RingBuffer_Get(converter->output_buffer, &pdata, sizeof(float) * num_channels * num_skip_samples);
+                assert(rbf_ret == RINGBUFFER_APIRESULT_OK);
+            }
+            converter->interp_offset = next_offset;
+        }
+    } else {
+        /* 通常のFIRフィルタによる畳み込み */
+        for (smpl = 0; smpl < num_output_samples; smpl++) {
+            const float *pdecim;
+            /* ディレイバッファから取得（同時にdown_rateだけ進めて間引く） */
+            rbf_ret = RingBuffer_Get(converter->output_buffer, &pdata, sizeof(float) * num_channels * converter->down_rate);
+            assert(rbf_ret == RINGBUFFER_APIRESULT_OK);
+            pdecim = (const float *)pdata;
+            /* フィルタ適用: 線形位相では係数は奇数かつ偶対象であることを使用 */
+            if (converter->half_band) {
+                R2samplerRateConverter_HalfBandDecimate(converter, pdecim, &output_buffer[smpl * num_channels]);
+            } else if (converter->filter_phase != R2SAMPLER_FILTERPHASE_LINEAR) {
+                if (num_channels == 1) {
+                    output_buffer[smpl] = converter->kernel.dot_product(pdecim, converter->filter_coef, converter->filter_order);
+                } else {
+                    converter->kernel.multi_channel_dot_product(pdecim, converter->filter_coef, converter->filter_order, num_channels, &output_buffer[smpl * num_channels]);
+                }
+            } else if (num_channels == 1) {
+                output_buffer[smpl] = converter->kernel.symmetric_fir(pdecim, converter->filter_coef, converter->filter_order);
+            } else {
+                converter->kernel.multi_channel_symmetric_fir(pdecim, converter->filter_coef, converter->filter_order, num_channels, &output_buffer[smpl * num_channels]);
+            }
+        }
+    }
+
+    /* アサート無効時の未使用警告回避 */
+    (void)rbf_ret;
+}
+
 /* レート変換 */
 R2samplerRateConverterApiResult R2samplerRateConverter_Process(
         struct R2samplerRateConverter *converter,
         const float *input, uint32_t num_input_samples,
         float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples)
 {
-    uint32_t smpl, tmp_num_output_samples;
+    return R2samplerRateConverter_ProcessInterleaved(converter,
+            input, num_input_samples, output_buffer, num_buffer_samples, num_output_samples);
+}
+
+/* チャンネルインターリーブされたデータのレート変換 */
+R2samplerRateConverterApiResult R2samplerRateConverter_ProcessInterleaved(
+        struct R2samplerRateConverter *converter,
+        const float *input, uint32_t num_input_samples,
+        float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples)
+{
+    uint32_t smpl, tmp_num_output_samples, num_channels, num_block_output_samples, output_offset;
     RingBufferApiResult rbf_ret;
 
     /* 引数チェック */
@@ -345,6 +1480,8 @@ R2samplerRateConverterApiResult R2samplerRateConverter_Process(
         return R2SAMPLERRATECONVERTER_APIRESULT_TOOMANY_NUM_INPUTS;
     }
 
+    num_channels = converter->num_channels;
+
     /* 出力サンプル数の計算 */
     tmp_num_output_samples = R2samplerRateConverter_GetNumOutputSamples(converter, num_input_samples);
 
@@ -353,55 +1490,89 @@ R2samplerRateConverterApiResult R2samplerRateConverter_Process(
         return R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER;
     }
 
-    /* サンプル値+ゼロ値挿入 */
-    for (smpl = 0; smpl < num_input_samples * converter->up_rate; smpl++) {
-        converter->interp_buffer[smpl] = 0.0f;
+    /* ブロック単位で処理（省メモリモードでなければ1ブロックで全ての入力を処理） */
+    smpl = output_offset = 0;
+    do {
+        const uint32_t num_block_samples
+            = R2SAMPLERRATECONVERTER_MIN(num_input_samples - smpl, converter->max_num_block_samples);
+
+        /* 入力サンプルをディレイバッファに入力（ゼロ値は挿入しない） */
+        if (num_block_samples > 0) {
+            rbf_ret = RingBuffer_Put(converter->output_buffer,
+                    &input[smpl * num_channels], sizeof(float) * num_channels * num_block_samples);
+            assert(rbf_ret == RINGBUFFER_APIRESULT_OK);
+        }
+
+        /* 間引きしつつフィルタリング */
+        num_block_output_samples = R2samplerRateConverter_GetNumOutputSamples(converter, 0);
+        R2samplerRateConverter_Convolve(converter, &output_buffer[output_offset * num_channels], num_block_output_samples);
+
+        smpl += num_block_samples;
+        output_offset += num_block_output_samples;
+    } while (smpl < num_input_samples);
+    assert(output_offset == tmp_num_output_samples);
+
+    /* アサート無効時の未使用警告回避 */
+    (void)rbf_ret;
+
+    /* 出力サンプル数をセット */
+    (*num_output_samples) = tmp_num_output_samples;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* 残りのサンプルの出力（ドレイン） */
+R2samplerRateConverterApiResult R2samplerRateConverter_Drain(
+        struct R2samplerRateConverter *converter,
+        float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples)
+{
+    uint32_t i, num_buffered_samples, tmp_num_output_samples;
+    const float zero = 0.0f;
+
+    /* 引数チェック */
+    if ((converter == NULL) || (output_buffer == NULL) || (num_output_samples == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
     }
-    for (smpl = 0; smpl < num_input_samples; smpl++) {
-        converter->interp_buffer[smpl * converter->up_rate] = input[smpl];
+
+    num_buffered_samples = R2samplerRateConverter_GetNumBufferedSamples(converter);
+
+    /* 初回の呼び出しで残りの出力サンプル数を確定 */
+    /* 最後の入力サンプルが群遅延だけ遅れて現れる出力までを出す */
+    if (!converter->draining) {
+        converter->num_drain_samples
+            = (uint32_t)ceil((num_buffered_samples + converter->group_delay) / converter->down_rate);
+        converter->draining = 1;
     }
 
-    /* ゼロ値挿入したデータをディレイバッファに入力 */
-    rbf_ret = RingBuffer_Put(converter->output_buffer,
-            converter->interp_buffer, sizeof(float) * converter->up_rate * num_input_samples);
-    assert(rbf_ret == RINGBUFFER_APIRESULT_OK);
+    /* 全て出力済み */
+    if (converter->num_drain_samples == 0) {
+        (*num_output_samples) = 0;
+        return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+    }
 
-    /* 間引きしつつフィルタリング */
-    if (converter->up_rate > 1) {
-        /* ゼロ値挿入分をスキップした処理 */
-        /* ゼロ値挿入したデータの先頭位置の更新量: up_rate - down_rate */
-        const uint32_t interp_delta = converter->down_rate * (converter->up_rate - 1);
-        for (smpl = 0; smpl < tmp_num_output_samples; smpl++) {
-            uint32_t i;
-            float *pdecim;
-            /* ディレイバッファから取得（同時にdown_rateだけ進めて間引く） */
-            rbf_ret = RingBuffer_Get(converter->output_buffer, (void **)&pdecim, sizeof(float) * converter->down_rate);
-            assert(rbf_ret == RINGBUFFER_APIRESULT_OK);
-            /* up_rate間隔でデータが並んでいる以外は全て0なので積和演算をスキップ可 */
-            output_buffer[smpl] = 0.0f;
-            for (i = converter->interp_offset; i < converter->filter_order; i += converter->up_rate) {
-                output_buffer[smpl] += pdecim[i] * converter->filter_coef[i];
-            }
-            /* ゼロ値挿入したデータの非ゼロ値のオフセット更新 */
-            converter->interp_offset = (converter->interp_offset + interp_delta) % converter->up_rate;
-        }
-    } else {
-        /* 通常のFIRフィルタによる畳み込み */
-        const uint32_t half_order = converter->filter_order / 2;
-        for (smpl = 0; smpl < tmp_num_output_samples; smpl++) {
-            uint32_t i;
-            float *pdecim;
-            /* ディレイバッファから取得（同時にdown_rateだけ進めて間引く） */
-            rbf_ret = RingBuffer_Get(converter->output_buffer, (void **)&pdecim, sizeof(float) * converter->down_rate);
-            assert(rbf_ret == RINGBUFFER_APIRESULT_OK);
-            /* フィルタ適用: 係数は奇数かつ偶対象であることを使用 */
-            output_buffer[smpl] = pdecim[half_order] * converter->filter_coef[half_order];
-            for (i = 0; i < half_order; i++) {
-                output_buffer[smpl] += (pdecim[i] + pdecim[converter->filter_order - i - 1]) * converter->filter_coef[i];
-            }
+    /* バッファサイズ不足 */
+    if (num_buffer_samples == 0) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER;
+    }
+
+    /* 今回の出力サンプル数: 1ブロック分の入力を入れたときの出力サンプル数を超えない */
+    tmp_num_output_samples = R2SAMPLERRATECONVERTER_MIN(converter->num_drain_samples, num_buffer_samples);
+    tmp_num_output_samples = R2SAMPLERRATECONVERTER_MIN(tmp_num_output_samples,
+            R2samplerRateConverter_GetNumOutputSamples(converter, converter->max_num_block_samples));
+
+    /* 出力に足りない分だけゼロを入力 */
+    if (tmp_num_output_samples * converter->down_rate > num_buffered_samples) {
+        const uint32_t num_zero_samples
+            = (tmp_num_output_samples * converter->down_rate - num_buffered_samples + converter->up_rate - 1) / converter->up_rate;
+        for (i = 0; i < converter->num_channels * num_zero_samples; i++) {
+            RingBuffer_Put(converter->output_buffer, &zero, sizeof(float));
         }
     }
 
+    /* 間引きしつつフィルタリング */
+    R2samplerRateConverter_Convolve(converter, output_buffer, tmp_num_output_samples);
+    converter->num_drain_samples -= tmp_num_output_samples;
+
     /* 出力サンプル数をセット */
     (*num_output_samples) = tmp_num_output_samples;
 
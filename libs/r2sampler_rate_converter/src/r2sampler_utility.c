@@ -4,40 +4,56 @@
 #include <assert.h>
 #include <stddef.h>
 
+#include "fft.h"
+
 /* 円周率 */
 #define R2SAMPLER_PI 3.14159265358979323846
+/* a,bのうち大きい方を選択 */
+#define R2SAMPLER_MAX(a, b) (((a) > (b)) ? (a) : (b))
+/* Remez交換法の周波数グリッド密度（極値点あたりのグリッド点数） */
+#define R2SAMPLER_REMEZ_GRID_DENSITY 16
+/* Remez交換法の周波数グリッドの最大点数 */
+#define R2SAMPLER_REMEZ_MAX_NUM_GRID(num_points) (R2SAMPLER_REMEZ_GRID_DENSITY * (num_points) + 4)
+/* 最小二乗法の正規方程式に加える正則化項 */
+#define R2SAMPLER_LEAST_SQUARES_REGULARIZATION 1.0e-12
+/* Remez交換法の最大反復回数 */
+#define R2SAMPLER_REMEZ_MAX_NUM_ITERATIONS 100
 
-/* sinc関数 */
-static double sinc(double x)
-{
-    return (fabs(x) > 1.0e-8) ? (sin(x) / x) : 1.0;
-}
-
-/* ハン窓 0 <= x <= 1 */
-static double hanning_window(double x)
-{
-    return 0.5 - 0.5 * cos(2.0 * R2SAMPLER_PI * x);
-}
-
-/* Blackman窓 0 <= x <= 1 */
-static double blackman_window(double x)
-{
-    return 0.42 - 0.5 * cos(2.0 * R2SAMPLER_PI * x) + 0.08 * cos(4.0 * R2SAMPLER_PI * x);
-}
+/* 漸化式で回転させた三角関数を直接計算し直す間隔（丸め誤差の蓄積を抑える） */
+#define R2SAMPLER_TRIGONOMETRIC_RECURRENCE_RESET_INTERVAL 64
+/* 0次の第1種変形ベッセル関数の級数展開の最大項数 */
+#define R2SAMPLER_BESSEL_I0_MAX_NUM_TERMS 256
+/* カイザー窓でまとめて評価する点数 */
+#define R2SAMPLER_KAISER_WINDOW_BLOCK_SIZE 8
+/* 最小位相化のFFTサイズのフィルタ次数に対する最小倍率（大きいほどケプストラムの折り返しが減る） */
+#define R2SAMPLER_MINIMUM_PHASE_FFT_SIZE_FACTOR 32
+/* 最小位相化で対数を取る振幅の下限（振幅の最大値に対する比. 阻止域の零点での発散を防ぐ） */
+#define R2SAMPLER_MINIMUM_PHASE_MAGNITUDE_FLOOR 1.0e-8
 
-/* Nuttall窓 0 <= x <= 1 */
-static double nuttall_window(double x)
-{
-    return 0.355768 - 0.487396 * cos(2.0 * R2SAMPLER_PI * x) + 0.144232 * cos(4.0 * R2SAMPLER_PI * x) - 0.012604 * cos(6.0 * R2SAMPLER_PI * x);
-}
+/* 窓関数の余弦級数の係数 w(x) = a0 - a1 cos(2πx) + a2 cos(4πx) - a3 cos(6πx) */
+static const double window_cosine_coefficients[][4] = {
+    { 1.0, 0.0, 0.0, 0.0 },                             /* 矩形窓 */
+    { 0.5, 0.5, 0.0, 0.0 },                             /* ハン窓 */
+    { 0.42, 0.5, 0.08, 0.0 },                           /* Blackman窓 */
+    { 0.355768, 0.487396, 0.144232, 0.012604 },         /* Nuttall窓 */
+    { 0.3635819, 0.4891775, 0.1365995, 0.0106411 },     /* Blackman-Nuttall窓 */
+};
 
-/* Blackman-Nuttall窓 0 <= x <= 1 */
-static double blackman_nuttall_window(double x)
+/* 角度stepずつ回転する正弦・余弦を漸化式で更新 */
+/* indexが一定間隔ごとに直接計算し直して誤差の蓄積を抑える */
+static void R2sampler_RotateSinCos(
+        double step, double sin_step, double cos_step, uint32_t index, double *sin_val, double *cos_val)
 {
-    return 0.3635819 - 0.4891775 * cos(2.0 * R2SAMPLER_PI * x) + 0.1365995 * cos(4.0 * R2SAMPLER_PI * x) - 0.0106411 * cos(6.0 * R2SAMPLER_PI * x);
+    if ((index % R2SAMPLER_TRIGONOMETRIC_RECURRENCE_RESET_INTERVAL) == 0) {
+        (*sin_val) = sin(step * index);
+        (*cos_val) = cos(step * index);
+    } else {
+        const double tmp = (*sin_val) * cos_step + (*cos_val) * sin_step;
+        (*cos_val) = (*cos_val) * cos_step - (*sin_val) * sin_step;
+        (*sin_val) = tmp;
+    }
 }
 
-
 /* xとyの最大公約数を求める */
 uint32_t R2sampler_GCD(uint32_t x, uint32_t y)
 {
@@ -103,63 +119,662 @@ END:
 }
 
 /* 窓関数によりLPF設計 */
+/* 係数は中央に対して対称なので片側のみ計算し、三角関数は回転の漸化式で求める */
 void R2sampler_CreateLPFByWindowFunction(
         float cutoff, R2samplerLPFWindowType window_type,
         float *filter_coef, uint32_t filter_order)
 {
     uint32_t i;
-    const float half = (filter_order - 1.0f) / 2.0f;
+    const uint32_t half = (filter_order - 1) / 2;
 
     /* 引数チェック */
     assert(filter_coef != NULL);
     assert(filter_order > 0);
     assert((cutoff >= 0.0f) && (cutoff < 1.0f));
+    assert(window_type < R2SAMPLERLPF_WINDOW_TYPE_INVALID);
     /* フィルタ次数は奇数を要求（直線位相特性のため） */
     assert(filter_order % 2 == 1);
 
     /* sinc関数により理想LPFの係数を取得 */
+    /* 2fc sinc(2πfc i) = sin(2πfc i) / (πi) */
+    {
+        double sin_val = 0.0, cos_val = 1.0;
+        const double step = 2.0 * R2SAMPLER_PI * cutoff;
+        const double sin_step = sin(step), cos_step = cos(step);
+        filter_coef[half] = 2.0f * cutoff;
+        for (i = 1; i <= half; i++) {
+            R2sampler_RotateSinCos(step, sin_step, cos_step, i, &sin_val, &cos_val);
+            filter_coef[half + i] = filter_coef[half - i] = (float)(sin_val / (R2SAMPLER_PI * i));
+        }
+    }
+
+    /* フィルタサイズが1の場合・矩形窓の場合は窓を掛けずに終わり */
+    if ((filter_order == 1) || (window_type == R2SAMPLERLPF_WINDOW_TYPE_RECTANGULAR)) {
+        return;
+    }
+
+    /* 窓関数適用 */
+    /* 余弦級数の高次項はチェビシェフ多項式で cos(2θ) = 2cos^2(θ) - 1, cos(3θ) = (2cos(2θ) - 1)cos(θ) */
+    {
+        double sin_val = 0.0, cos_val = 1.0;
+        const double *a = window_cosine_coefficients[window_type];
+        const double step = 2.0 * R2SAMPLER_PI / (filter_order - 1);
+        const double sin_step = sin(step), cos_step = cos(step);
+        for (i = 0; i <= half; i++) {
+            double cos2, cos3;
+            R2sampler_RotateSinCos(step, sin_step, cos_step, i, &sin_val, &cos_val);
+            cos2 = 2.0 * cos_val * cos_val - 1.0;
+            cos3 = (2.0 * cos2 - 1.0) * cos_val;
+            filter_coef[i] *= (float)(a[0] - a[1] * cos_val + a[2] * cos2 - a[3] * cos3);
+            filter_coef[filter_order - 1 - i] = filter_coef[i];
+        }
+    }
+}
+
+/* カイザー窓のパラメータβを阻止域減衰量[dB]から計算 */
+double R2sampler_CalculateKaiserBeta(double stopband_attenuation)
+{
+    /* Kaiserの経験式 */
+    if (stopband_attenuation > 50.0) {
+        return 0.1102 * (stopband_attenuation - 8.7);
+    } else if (stopband_attenuation > 21.0) {
+        return 0.5842 * pow(stopband_attenuation - 21.0, 0.4) + 0.07886 * (stopband_attenuation - 21.0);
+    }
+    return 0.0;
+}
+
+/* 阻止域減衰量[dB]と遷移帯域幅（正規化周波数）を満たすカイザー窓LPFの最小次数（奇数）を計算 */
+uint32_t R2sampler_CalculateKaiserFilterOrder(double stopband_attenuation, double transition_width)
+{
+    uint32_t filter_order;
+    double d;
+
+    assert((transition_width > 0.0) && (transition_width < 0.5));
+
+    /* Kaiserの経験式: 次数 = D / 遷移帯域幅 + 1 */
+    d = (stopband_attenuation > 21.0) ? ((stopband_attenuation - 7.95) / 14.36) : 0.9222;
+    filter_order = (uint32_t)ceil(d / transition_width) + 1;
+
+    /* 奇数に切り上げ */
+    if ((filter_order % 2) == 0) {
+        filter_order++;
+    }
+
+    return filter_order;
+}
+
+/* カイザー窓によりLPF設計 */
+void R2sampler_CreateLPFByKaiserWindow(
+        float cutoff, double beta, float *filter_coef, uint32_t filter_order)
+{
+    uint32_t i, num_terms;
+    double inv_square[R2SAMPLER_BESSEL_I0_MAX_NUM_TERMS + 1];
+    double i0_beta;
+    const uint32_t half = (filter_order - 1) / 2;
+
+    /* 引数チェック */
+    assert(filter_coef != NULL);
+    assert(beta >= 0.0);
+
+    /* 打ち切ったsinc関数を作成 */
+    R2sampler_CreateLPFByWindowFunction(cutoff, R2SAMPLERLPF_WINDOW_TYPE_RECTANGULAR, filter_coef, filter_order);
+
+    /* フィルタサイズが1の場合は窓を掛けずに終わり */
+    if (filter_order == 1) {
+        return;
+    }
+
+    /* 0次の第1種変形ベッセル関数 I0(x) = sum_k (y^k / (k!)^2), y = (x/2)^2 の項数を決定 */
+    /* 窓の中でベッセル関数の引数はβが最大なので、βで収束する項数で全ての点が収束する */
+    {
+        double term = 1.0;
+        const double half_beta = beta / 2.0;
+        i0_beta = 1.0;
+        for (num_terms = 1; num_terms < R2SAMPLER_BESSEL_I0_MAX_NUM_TERMS; num_terms++) {
+            term *= half_beta / num_terms;
+            i0_beta += term * term;
+            inv_square[num_terms] = 1.0 / ((double)num_terms * num_terms);
+            if ((term * term) < (i0_beta * 1.0e-16)) {
+                break;
+            }
+        }
+        if (num_terms == R2SAMPLER_BESSEL_I0_MAX_NUM_TERMS) {
+            num_terms--;
+        }
+    }
+
+    /* カイザー窓適用 w(i) = I0(β sqrt(1 - t^2)) / I0(β), t = 2i / (N - 1) - 1 */
+    /* 級数は除算を含まないホーナー法 1 + y/1^2 (1 + y/2^2 (1 + ...)) で評価 */
+    /* 依存関係の無い複数点をまとめて評価してパイプライン・SIMD化を効かせる */
+    for (i = 0; i <= half; i += R2SAMPLER_KAISER_WINDOW_BLOCK_SIZE) {
+        uint32_t j, k;
+        double y[R2SAMPLER_KAISER_WINDOW_BLOCK_SIZE], i0_val[R2SAMPLER_KAISER_WINDOW_BLOCK_SIZE];
+        for (j = 0; j < R2SAMPLER_KAISER_WINDOW_BLOCK_SIZE; j++) {
+            const double t = (2.0 * (i + j)) / (filter_order - 1.0) - 1.0;
+            y[j] = (beta * beta / 4.0) * R2SAMPLER_MAX(1.0 - t * t, 0.0);
+            i0_val[j] = 1.0;
+        }
+        for (k = num_terms; k >= 1; k--) {
+            for (j = 0; j < R2SAMPLER_KAISER_WINDOW_BLOCK_SIZE; j++) {
+                i0_val[j] = 1.0 + i0_val[j] * y[j] * inv_square[k];
+            }
+        }
+        for (j = 0; (j < R2SAMPLER_KAISER_WINDOW_BLOCK_SIZE) && ((i + j) <= half); j++) {
+            filter_coef[i + j] *= (float)(i0_val[j] / i0_beta);
+            filter_coef[filter_order - 1 - (i + j)] = filter_coef[i + j];
+        }
+    }
+}
+
+/* 阻止域減衰量[dB]と遷移帯域幅（正規化周波数）を満たす等リップルLPFの推定次数（奇数）を計算 */
+uint32_t R2sampler_CalculateEquirippleFilterOrder(double stopband_attenuation, double transition_width)
+{
+    uint32_t filter_order;
+
+    assert((transition_width > 0.0) && (transition_width < 0.5));
+
+    /* 通過域・阻止域の誤差を等しくしたときのKaiserの推定式: 次数 = (A - 13) / (14.6 * 遷移帯域幅) + 1 */
+    filter_order = (uint32_t)ceil(R2SAMPLER_MAX(stopband_attenuation - 13.0, 1.0) / (14.6 * transition_width)) + 1;
+
+    /* 奇数に切り上げ */
+    if ((filter_order % 2) == 0) {
+        filter_order++;
+    }
+
+    return filter_order;
+}
+
+/* 重心型ラグランジュ補間の重みを計算（オーバーフロー回避のため対数で計算し最大値で正規化） */
+static void R2sampler_RemezCalculateBarycentricWeights(const double *x, uint32_t num_points, double *weights)
+{
+    uint32_t i, j;
+    double max_log = -HUGE_VAL;
+
+    for (i = 0; i < num_points; i++) {
+        double log_sum = 0.0, sign = 1.0;
+        for (j = 0; j < num_points; j++) {
+            if (i != j) {
+                const double diff = x[i] - x[j];
+                log_sum -= log(fabs(diff));
+                sign = (diff < 0.0) ? -sign : sign;
+            }
+        }
+        weights[i] = sign;
+        max_log = R2SAMPLER_MAX(max_log, log_sum);
+        /* 一旦対数を保持 */
+        weights[num_points + i] = log_sum;
+    }
+
+    for (i = 0; i < num_points; i++) {
+        weights[i] *= exp(weights[num_points + i] - max_log);
+    }
+}
+
+/* 重心型ラグランジュ補間による多項式の評価 */
+static double R2sampler_RemezEvaluate(
+        const double *x, const double *values, const double *weights, uint32_t num_points, double xval)
+{
+    uint32_t i;
+    double num = 0.0, den = 0.0;
+
+    for (i = 0; i < num_points; i++) {
+        const double diff = xval - x[i];
+        double t;
+        if (fabs(diff) < 1.0e-15) {
+            return values[i];
+        }
+        t = weights[i] / diff;
+        num += t * values[i];
+        den += t;
+    }
+
+    return num / den;
+}
+
+/* Parks-McClellan法（Remez交換法）による設計に必要なワークサイズ計算 */
+int32_t R2sampler_CalculateRemezWorkSize(uint32_t filter_order)
+{
+    const uint32_t num_points = (filter_order - 1) / 2 + 2;
+    const uint32_t num_grid = R2SAMPLER_REMEZ_MAX_NUM_GRID(num_points);
+
+    /* フィルタ次数は奇数を要求 */
+    if ((filter_order % 2) == 0) {
+        return -1;
+    }
+
+    /* グリッド・目標値・重み・誤差, 極値点の座標・値・補間重み(x2), 振幅特性 */
+    return (int32_t)(sizeof(double) * (4 * num_grid + 4 * num_points + num_points)
+            + sizeof(uint32_t) * (num_points + num_grid));
+}
+
+/* Parks-McClellan法（Remez交換法）により等リップルLPF設計 */
+double R2sampler_CreateLPFByRemez(
+        double passband_edge, double stopband_edge, double stopband_weight,
+        float *filter_coef, uint32_t filter_order, void *work, int32_t work_size)
+{
+    uint32_t i, k, iteration, num_grid, num_pass_grid, num_candidates;
+    double delta = 0.0;
+    double *grid, *desired, *weight, *error;
+    double *ext_x, *ext_values, *bary_weights, *amplitude;
+    uint32_t *extremals, *candidates;
+    const uint32_t half = (filter_order - 1) / 2;
+    /* 極値点数: 余弦多項式の係数数+1 */
+    const uint32_t num_points = half + 2;
+
+    /* 引数チェック */
+    assert(filter_coef != NULL);
+    assert(filter_order % 2 == 1);
+    assert((work != NULL) && (work_size >= R2sampler_CalculateRemezWorkSize(filter_order)));
+    assert((passband_edge > 0.0) && (passband_edge < stopband_edge) && (stopband_edge <= 0.5));
+    assert(stopband_weight > 0.0);
+    /* アサート無効時の未使用警告回避 */
+    (void)work_size;
+
+    /* フィルタサイズが1の場合は直流を通すのみ */
+    if (filter_order == 1) {
+        filter_coef[0] = 1.0f;
+        return 0.0;
+    }
+
+    /* 周波数グリッドの点数を帯域幅に比例して割り当て */
+    {
+        const double spacing = 0.5 / (R2SAMPLER_REMEZ_GRID_DENSITY * num_points);
+        num_pass_grid = (uint32_t)ceil(passband_edge / spacing) + 1;
+        num_grid = num_pass_grid + (uint32_t)ceil((0.5 - stopband_edge) / spacing) + 1;
+    }
+
+    assert(num_grid <= R2SAMPLER_REMEZ_MAX_NUM_GRID(num_points));
+
+    /* ワーク領域割り当て */
+    grid = (double *)work;
+    desired = grid + num_grid;
+    weight = desired + num_grid;
+    error = weight + num_grid;
+    ext_x = error + num_grid;
+    ext_values = ext_x + num_points;
+    bary_weights = ext_values + num_points;
+    amplitude = bary_weights + 2 * num_points;
+    extremals = (uint32_t *)(amplitude + (half + 1));
+    candidates = extremals + num_points;
+    assert((uint8_t *)(candidates + num_grid) <= ((uint8_t *)work + work_size));
+
+    /* グリッド作成（周波数はcos(2πf)に変換して保持） */
+    for (i = 0; i < num_grid; i++) {
+        double freq;
+        if (i < num_pass_grid) {
+            freq = passband_edge * i / (num_pass_grid - 1.0);
+            desired[i] = 1.0;
+            weight[i] = 1.0;
+        } else {
+            freq = (num_grid > (num_pass_grid + 1))
+                ? (stopband_edge + (0.5 - stopband_edge) * (i - num_pass_grid) / (num_grid - num_pass_grid - 1.0)) : stopband_edge;
+            desired[i] = 0.0;
+            weight[i] = stopband_weight;
+        }
+        grid[i] = cos(2.0 * R2SAMPLER_PI * freq);
+    }
+
+    /* 極値点の初期値: グリッド上に等間隔に配置 */
+    for (i = 0; i < num_points; i++) {
+        extremals[i] = (uint32_t)(((uint64_t)i * (num_grid - 1)) / (num_points - 1));
+    }
+
+    for (iteration = 0; iteration < R2SAMPLER_REMEZ_MAX_NUM_ITERATIONS; iteration++) {
+        double num, den, max_error;
+
+        /* 極値点での重心型補間の重みから誤差δを計算 */
+        for (i = 0; i < num_points; i++) {
+            ext_x[i] = grid[extremals[i]];
+        }
+        R2sampler_RemezCalculateBarycentricWeights(ext_x, num_points, bary_weights);
+        num = den = 0.0;
+        for (i = 0; i < num_points; i++) {
+            const double sign = ((i % 2) == 0) ? 1.0 : -1.0;
+            num += bary_weights[i] * desired[extremals[i]];
+            den += sign * bary_weights[i] / weight[extremals[i]];
+        }
+        delta = num / den;
+
+        /* 極値点で誤差が交互に±δとなる値を通る多項式（最後の点を除いて補間） */
+        for (i = 0; i < num_points; i++) {
+            const double sign = ((i % 2) == 0) ? 1.0 : -1.0;
+            ext_values[i] = desired[extremals[i]] - sign * delta / weight[extremals[i]];
+        }
+        R2sampler_RemezCalculateBarycentricWeights(ext_x, num_points - 1, bary_weights);
+
+        /* グリッド上の重み付き誤差を計算 */
+        max_error = 0.0;
+        for (i = 0; i < num_grid; i++) {
+            error[i] = weight[i] * (desired[i]
+                    - R2sampler_RemezEvaluate(ext_x, ext_values, bary_weights, num_points - 1, grid[i]));
+            max_error = R2SAMPLER_MAX(max_error, fabs(error[i]));
+        }
+
+        /* 収束判定: 最大誤差がδに一致したら等リップル */
+        if ((max_error - fabs(delta)) <= (1.0e-9 + 1.0e-6 * fabs(delta))) {
+            break;
+        }
+
+        /* 新しい極値点の候補: |δ|以上の局所極値（各帯域の端点を含む） */
+        num_candidates = 0;
+        for (i = 0; i < num_grid; i++) {
+            const uint8_t is_band_start = (i == 0) || (i == num_pass_grid);
+            const uint8_t is_band_end = (i == (num_pass_grid - 1)) || (i == (num_grid - 1));
+            const double e = error[i];
+            if (fabs(e) < fabs(delta) * (1.0 - 1.0e-3)) {
+                continue;
+            }
+            if (e > 0.0) {
+                if ((!is_band_start && (error[i - 1] > e)) || (!is_band_end && (error[i + 1] > e))) {
+                    continue;
+                }
+            } else {
+                if ((!is_band_start && (error[i - 1] < e)) || (!is_band_end && (error[i + 1] < e))) {
+                    continue;
+                }
+            }
+            /* 符号が交互になるように同符号が続く場合は絶対値が大きい方を残す */
+            if ((num_candidates > 0) && ((error[candidates[num_candidates - 1]] > 0.0) == (e > 0.0))) {
+                if (fabs(e) > fabs(error[candidates[num_candidates - 1]])) {
+                    candidates[num_candidates - 1] = i;
+                }
+            } else {
+                candidates[num_candidates++] = i;
+            }
+        }
+
+        /* 極値点が足りない場合は数値誤差により交換できない */
+        if (num_candidates < num_points) {
+            break;
+        }
+
+        /* 余分な極値点は両端のうち誤差が小さい方から除去 */
+        k = 0;
+        while (num_candidates > num_points) {
+            if (fabs(error[candidates[k]]) < fabs(error[candidates[k + num_candidates - 1]])) {
+                k++;
+            }
+            num_candidates--;
+        }
+
+        /* 極値点を交換 */
+        for (i = 0; i < num_points; i++) {
+            extremals[i] = candidates[k + i];
+        }
+    }
+
+    /* 振幅特性を周波数n/filter_order(n=0,...,half)でサンプリング */
+    for (i = 0; i <= half; i++) {
+        const double x = cos(2.0 * R2SAMPLER_PI * i / filter_order);
+        amplitude[i] = R2sampler_RemezEvaluate(ext_x, ext_values, bary_weights, num_points - 1, x);
+    }
+
+    /* 周波数サンプリングからインパルス応答を計算（偶対称） */
+    for (i = 0; i <= half; i++) {
+        double sum = amplitude[0];
+        for (k = 1; k <= half; k++) {
+            sum += 2.0 * amplitude[k] * cos(2.0 * R2SAMPLER_PI * k * i / filter_order);
+        }
+        filter_coef[half + i] = filter_coef[half - i] = (float)(sum / filter_order);
+    }
+
+    return fabs(delta);
+}
+
+/* 区間[lower, upper]でのcos(2πkf)の積分 */
+static double R2sampler_IntegrateCosine(int32_t k, double lower, double upper)
+{
+    if (k == 0) {
+        return upper - lower;
+    }
+    return (sin(2.0 * R2SAMPLER_PI * k * upper) - sin(2.0 * R2SAMPLER_PI * k * lower)) / (2.0 * R2SAMPLER_PI * k);
+}
+
+/* 重み付き最小二乗法による設計に必要なワークサイズ計算 */
+int32_t R2sampler_CalculateLeastSquaresWorkSize(uint32_t filter_order)
+{
+    const uint32_t num_coef = (filter_order - 1) / 2 + 1;
+
+    /* フィルタ次数は奇数を要求 */
+    if ((filter_order % 2) == 0) {
+        return -1;
+    }
+
+    /* 正規方程式の係数行列と右辺 */
+    return (int32_t)(sizeof(double) * (num_coef * num_coef + num_coef));
+}
+
+/* 重み付き最小二乗法によりLPF設計 */
+void R2sampler_CreateLPFByLeastSquares(
+        double passband_edge, double stopband_edge, double stopband_weight,
+        float *filter_coef, uint32_t filter_order, void *work, int32_t work_size)
+{
+    int32_t i, j, k;
+    double *matrix, *vector;
+    const int32_t half = (int32_t)(filter_order - 1) / 2;
+    const int32_t num_coef = half + 1;
+
+    /* 引数チェック */
+    assert(filter_coef != NULL);
+    assert(filter_order % 2 == 1);
+    assert((work != NULL) && (work_size >= R2sampler_CalculateLeastSquaresWorkSize(filter_order)));
+    assert((passband_edge > 0.0) && (passband_edge < stopband_edge) && (stopband_edge <= 0.5));
+    assert(stopband_weight > 0.0);
+    /* アサート無効時の未使用警告回避 */
+    (void)work_size;
+
+    /* ワーク領域割り当て */
+    matrix = (double *)work;
+    vector = matrix + num_coef * num_coef;
+
+    /* 振幅特性 A(f) = sum_m a_m cos(2πmf) の重み付き二乗誤差を最小化する正規方程式を作成 */
+    /* cos(2πmf)cos(2πnf) = (cos(2π(m-n)f) + cos(2π(m+n)f)) / 2 を使って積分を計算 */
+    for (i = 0; i < num_coef; i++) {
+        for (j = 0; j <= i; j++) {
+            const double pass = R2sampler_IntegrateCosine(i - j, 0.0, passband_edge)
+                + R2sampler_IntegrateCosine(i + j, 0.0, passband_edge);
+            const double stop = R2sampler_IntegrateCosine(i - j, stopband_edge, 0.5)
+                + R2sampler_IntegrateCosine(i + j, stopband_edge, 0.5);
+            matrix[i * num_coef + j] = matrix[j * num_coef + i] = 0.5 * (pass + stopband_weight * stop);
+        }
+        /* 遷移帯域を考慮しないため次数が高いと悪条件になる: 対角に微小値を加えて正則化 */
+        matrix[i * num_coef + i] += R2SAMPLER_LEAST_SQUARES_REGULARIZATION;
+        /* 通過域の目標値は1 */
+        vector[i] = R2sampler_IntegrateCosine(i, 0.0, passband_edge);
+    }
+
+    /* コレスキー分解（下三角に上書き） */
+    for (j = 0; j < num_coef; j++) {
+        double diag = matrix[j * num_coef + j];
+        for (k = 0; k < j; k++) {
+            diag -= matrix[j * num_coef + k] * matrix[j * num_coef + k];
+        }
+        assert(diag > 0.0);
+        diag = sqrt(diag);
+        matrix[j * num_coef + j] = diag;
+        for (i = j + 1; i < num_coef; i++) {
+            double sum = matrix[i * num_coef + j];
+            for (k = 0; k < j; k++) {
+                sum -= matrix[i * num_coef + k] * matrix[j * num_coef + k];
+            }
+            matrix[i * num_coef + j] = sum / diag;
+        }
+    }
+
+    /* 前進代入・後退代入 */
+    for (i = 0; i < num_coef; i++) {
+        double sum = vector[i];
+        for (k = 0; k < i; k++) {
+            sum -= matrix[i * num_coef + k] * vector[k];
+        }
+        vector[i] = sum / matrix[i * num_coef + i];
+    }
+    for (i = num_coef - 1; i >= 0; i--) {
+        double sum = vector[i];
+        for (k = i + 1; k < num_coef; k++) {
+            sum -= matrix[k * num_coef + i] * vector[k];
+        }
+        vector[i] = sum / matrix[i * num_coef + i];
+    }
+
+    /* 余弦級数の係数からインパルス応答へ変換（偶対称） */
+    filter_coef[half] = (float)vector[0];
+    for (i = 1; i <= half; i++) {
+        filter_coef[half + i] = filter_coef[half - i] = (float)(vector[i] / 2.0);
+    }
+}
+
+/* 窓関数によりハーフバンドLPFを設計 */
+void R2sampler_CreateHalfBandLPFByWindowFunction(
+        R2samplerLPFWindowType window_type, float *filter_coef, uint32_t filter_order)
+{
+    const uint32_t center = (filter_order - 1) / 2;
+
+    /* 引数チェック */
+    assert(filter_coef != NULL);
+    assert(filter_order % 2 == 1);
+
+    /* 正規化カットオフ周波数0.25で設計 */
+    R2sampler_CreateLPFByWindowFunction(0.25f, window_type, filter_coef, filter_order);
+
+    /* sinc関数の零点に当たる係数を丸め誤差を含めて厳密にゼロにする */
+    R2sampler_SetHalfBandZeros(filter_coef, filter_order);
+    filter_coef[center] = 0.5f;
+}
+
+/* ハーフバンドLPFのゼロとなる係数を厳密にゼロにする */
+void R2sampler_SetHalfBandZeros(float *filter_coef, uint32_t filter_order)
+{
+    uint32_t i;
+    const uint32_t center = (filter_order - 1) / 2;
+
+    /* 引数チェック */
+    assert(filter_coef != NULL);
+    assert(filter_order % 2 == 1);
+
+    /* 中央以外の偶数オフセットの係数をゼロにする（中央の係数は変えない） */
     for (i = 0; i < filter_order; i++) {
-        const float x = (float)i - half;
-        filter_coef[i] = 2.0f * cutoff * (float)sinc(2.0f * R2SAMPLER_PI * cutoff * x);
+        const uint32_t offset = (i > center) ? (i - center) : (center - i);
+        if ((offset != 0) && ((offset % 2) == 0)) {
+            filter_coef[i] = 0.0f;
+        }
     }
+}
+
+/* 最小位相化に使うFFTサイズ計算 */
+static uint32_t R2sampler_CalculateMinimumPhaseFFTSize(uint32_t filter_order)
+{
+    return FFTPlan_CalculateFastSize(R2SAMPLER_MINIMUM_PHASE_FFT_SIZE_FACTOR * filter_order);
+}
 
-    /* フィルタサイズが1の場合は矩形窓に読み替えて終わり */
+/* 最小位相化に必要なワークサイズ計算 */
+int32_t R2sampler_CalculateMinimumPhaseWorkSize(uint32_t filter_order)
+{
+    uint32_t fft_size;
+    int32_t plan_work_size;
+    struct FFTPlanConfig plan_config;
+
+    /* 引数チェック */
+    if (filter_order == 0) {
+        return -1;
+    }
+
+    if ((fft_size = R2sampler_CalculateMinimumPhaseFFTSize(filter_order)) == 0) {
+        return -1;
+    }
+    plan_config.fft_size = fft_size;
+    plan_config.max_batch_size = 1;
+    if ((plan_work_size = FFTPlan_CalculateWorkSize(&plan_config)) < 0) {
+        return -1;
+    }
+
+    /* スペクトル・ケプストラム, FFTプラン */
+    return (int32_t)(sizeof(float) * fft_size) + plan_work_size;
+}
+
+/* フィルタを同じ振幅特性の最小位相フィルタに変換 */
+void R2sampler_ConvertToMinimumPhase(float *filter_coef, uint32_t filter_order, void *work, int32_t work_size)
+{
+    uint32_t i, fft_size, half;
+    float *buffer;
+    double max_magnitude, log_floor;
+    struct FFTPlan *plan;
+    struct FFTPlanConfig plan_config;
+
+    /* 引数チェック */
+    assert(filter_coef != NULL);
+    assert((work != NULL) && (work_size >= R2sampler_CalculateMinimumPhaseWorkSize(filter_order)));
+
+    /* 1タップのフィルタは最小位相 */
     if (filter_order == 1) {
-        filter_coef[0] *= 1.0f;
         return;
     }
 
-    /* 窓関数適用 */
-    switch (window_type) {
-    case R2SAMPLERLPF_WINDOW_TYPE_RECTANGULAR:
-        /* 矩形窓: 何もせず打ち切り */
-        break;
-    case R2SAMPLERLPF_WINDOW_TYPE_HANN:
-        /* ハン窓 */
-        for (i = 0; i < filter_order; i++) {
-            filter_coef[i] *= (float)hanning_window(i / (filter_order - 1.0f));
-        }
-        break;
-    case R2SAMPLERLPF_WINDOW_TYPE_BLACKMAN:
-        /* Blackman窓 */
-        for (i = 0; i < filter_order; i++) {
-            filter_coef[i] *= (float)blackman_window(i / (filter_order - 1.0f));
-        }
-        break;
-    case R2SAMPLERLPF_WINDOW_TYPE_NUTTALL:
-        /* Nuttall窓 */
-        for (i = 0; i < filter_order; i++) {
-            filter_coef[i] *= (float)nuttall_window(i / (filter_order - 1.0f));
-        }
-        break;
-    case R2SAMPLERLPF_WINDOW_TYPE_BLACKMANNUTTALL:
-        /* Blackman-Nuttall窓 */
-        for (i = 0; i < filter_order; i++) {
-            filter_coef[i] *= (float)blackman_nuttall_window(i / (filter_order - 1.0f));
-        }
-        break;
-    default:
-        assert(0);
+    /* ワーク領域割り当て */
+    fft_size = R2sampler_CalculateMinimumPhaseFFTSize(filter_order);
+    half = fft_size / 2;
+    buffer = (float *)work;
+    plan_config.fft_size = fft_size;
+    plan_config.max_batch_size = 1;
+    plan = FFTPlan_Create(&plan_config, buffer + fft_size, work_size - (int32_t)(sizeof(float) * fft_size));
+    assert(plan != NULL);
+
+    /* 振幅特性の計算 */
+    for (i = 0; i < fft_size; i++) {
+        buffer[i] = (i < filter_order) ? filter_coef[i] : 0.0f;
+    }
+    FFTPlan_RealFFT(plan, -1, buffer);
+
+    /* 対数振幅に置き換え（実数列のFFTの配置のまま虚部はゼロ） */
+    buffer[0] = (float)fabs(buffer[0]);
+    buffer[1] = (float)fabs(buffer[1]);
+    max_magnitude = R2SAMPLER_MAX(buffer[0], buffer[1]);
+    for (i = 1; i < half; i++) {
+        const double magnitude = sqrt((double)buffer[2 * i] * buffer[2 * i] + (double)buffer[2 * i + 1] * buffer[2 * i + 1]);
+        buffer[2 * i] = (float)magnitude;
+        buffer[2 * i + 1] = 0.0f;
+        max_magnitude = R2SAMPLER_MAX(max_magnitude, magnitude);
+    }
+    assert(max_magnitude > 0.0);
+    log_floor = log(max_magnitude * R2SAMPLER_MINIMUM_PHASE_MAGNITUDE_FLOOR);
+    buffer[0] = (float)R2SAMPLER_MAX(log(buffer[0]), log_floor);
+    buffer[1] = (float)R2SAMPLER_MAX(log(buffer[1]), log_floor);
+    for (i = 1; i < half; i++) {
+        buffer[2 * i] = (float)R2SAMPLER_MAX(log(buffer[2 * i]), log_floor);
+    }
+
+    /* 実ケプストラムの計算 */
+    FFTPlan_RealFFT(plan, 1, buffer);
+
+    /* 因果的に折り返す: 正の時刻を2倍、負の時刻をゼロ（正規化定数2/fft_sizeもここで掛ける） */
+    {
+        const float scale = 2.0f / (float)fft_size;
+        buffer[0] *= scale;
+        for (i = 1; i < half; i++) {
+            buffer[i] *= 2.0f * scale;
+        }
+        buffer[half] *= scale;
+        for (i = half + 1; i < fft_size; i++) {
+            buffer[i] = 0.0f;
+        }
+    }
+
+    /* 複素対数スペクトルの指数を取り最小位相のスペクトルを得る */
+    FFTPlan_RealFFT(plan, -1, buffer);
+    buffer[0] = (float)exp(buffer[0]);
+    buffer[1] = (float)exp(buffer[1]);
+    for (i = 1; i < half; i++) {
+        const double magnitude = exp(buffer[2 * i]);
+        const double phase = buffer[2 * i + 1];
+        buffer[2 * i] = (float)(magnitude * cos(phase));
+        buffer[2 * i + 1] = (float)(magnitude * sin(phase));
+    }
+
+    /* インパルス応答に戻し、先頭から次数分を取り出す */
+    FFTPlan_RealFFT(plan, 1, buffer);
+    for (i = 0; i < filter_order; i++) {
+        filter_coef[i] = buffer[i] * (2.0f / (float)fft_size);
     }
 
+    FFTPlan_Destroy(plan);
 }
@@ -29,6 +29,55 @@ void R2sampler_CreateLPFByWindowFunction(
         float cutoff, R2samplerLPFWindowType window_type,
         float *filter_coef, uint32_t filter_order);
 
+/* カイザー窓のパラメータβを阻止域減衰量[dB]から計算 */
+double R2sampler_CalculateKaiserBeta(double stopband_attenuation);
+
+/* 阻止域減衰量[dB]と遷移帯域幅（正規化周波数）を満たすカイザー窓LPFの最小次数（奇数）を計算 */
+uint32_t R2sampler_CalculateKaiserFilterOrder(double stopband_attenuation, double transition_width);
+
+/* カイザー窓によりLPF設計 */
+void R2sampler_CreateLPFByKaiserWindow(
+        float cutoff, double beta, float *filter_coef, uint32_t filter_order);
+
+/* 阻止域減衰量[dB]と遷移帯域幅（正規化周波数）を満たす等リップルLPFの推定次数（奇数）を計算 */
+uint32_t R2sampler_CalculateEquirippleFilterOrder(double stopband_attenuation, double transition_width);
+
+/* Parks-McClellan法（Remez交換法）による設計に必要なワークサイズ計算 */
+int32_t R2sampler_CalculateRemezWorkSize(uint32_t filter_order);
+
+/* Parks-McClellan法（Remez交換法）により等リップルLPF設計
+ * 通過域[0, passband_edge]・阻止域[stopband_edge, 0.5]の重み付き最大誤差を最小化する
+ * 戻り値は通過域の最大誤差（阻止域の最大誤差はこれをstopband_weightで割ったもの） */
+double R2sampler_CreateLPFByRemez(
+        double passband_edge, double stopband_edge, double stopband_weight,
+        float *filter_coef, uint32_t filter_order, void *work, int32_t work_size);
+
+/* 重み付き最小二乗法による設計に必要なワークサイズ計算 */
+int32_t R2sampler_CalculateLeastSquaresWorkSize(uint32_t filter_order);
+
+/* 重み付き最小二乗法によりLPF設計
+ * 通過域[0, passband_edge]・阻止域[stopband_edge, 0.5]の重み付き二乗誤差の積分を最小化する（遷移帯域は考慮しない）
+ * 重みは通過域を1としたときの阻止域の重み */
+void R2sampler_CreateLPFByLeastSquares(
+        double passband_edge, double stopband_edge, double stopband_weight,
+        float *filter_coef, uint32_t filter_order, void *work, int32_t work_size);
+
+/* 窓関数によりハーフバンドLPF（カットオフが半帯域）を設計
+ * 中央以外の偶数オフセットの係数は厳密にゼロ、中央は0.5となる */
+void R2sampler_CreateHalfBandLPFByWindowFunction(
+        R2samplerLPFWindowType window_type, float *filter_coef, uint32_t filter_order);
+
+/* ハーフバンドLPFのゼロとなる係数（中央以外の偶数オフセット）を厳密にゼロにする
+ * 遷移帯域が0.25に対称な線形位相LPFの設計後に丸め誤差を除くために使用 */
+void R2sampler_SetHalfBandZeros(float *filter_coef, uint32_t filter_order);
+
+/* 最小位相化に必要なワークサイズ計算 */
+int32_t R2sampler_CalculateMinimumPhaseWorkSize(uint32_t filter_order);
+
+/* フィルタを振幅特性の等しい最小位相フィルタに変換（ケプストラム法）
+ * 変換後の係数は先頭に集中し、通過域の群遅延が短くなる（係数の数は変えない） */
+void R2sampler_ConvertToMinimumPhase(float *filter_coef, uint32_t filter_order, void *work, int32_t work_size);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
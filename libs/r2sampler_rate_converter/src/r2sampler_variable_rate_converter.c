@@ -0,0 +1,461 @@
+#include <r2sampler.h>
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "ring_buffer.h"
+#include "r2sampler_utility.h"
+#include "r2sampler_kernel.h"
+#include "r2sampler_internal.h"
+
+/* メモリアラインメント */
+#define R2SAMPLERVRRATECONVERTER_ALIGNMENT 16
+/* 最大値の選択 */
+#define R2SAMPLERVRRATECONVERTER_MAX(a, b) (((a) > (b)) ? (a) : (b))
+/* 最小値の選択 */
+#define R2SAMPLERVRRATECONVERTER_MIN(a, b) (((a) < (b)) ? (a) : (b))
+/* nの倍数に切り上げ */
+#define R2SAMPLERVRRATECONVERTER_ROUNDUP(val, n) ((((val) + ((n) - 1)) / (n)) * (n))
+/* 1位相あたりのタップ数の切り上げ単位（SIMD演算幅に合わせる） */
+#define R2SAMPLERVRRATECONVERTER_TAPS_UNIT 8
+/* 1回の出力で読み飛ばす最大の入力サンプル数 */
+#define R2SAMPLERVRRATECONVERTER_MAX_NUM_SKIP_SAMPLES(min_ratio) ((uint32_t)(1.0 / (min_ratio)) + 2)
+
+/* 可変レート変換器ハンドル */
+struct R2samplerVariableRateConverter {
+    uint32_t max_num_input_samples;
+    uint32_t num_channels;
+    uint32_t num_taps;
+    uint32_t num_phases;
+    uint32_t num_table_taps; /* テーブル1位相あたりのタップ数（切り上げ後） */
+    double min_ratio;
+    double max_ratio;
+    double initial_ratio;
+    double step; /* 1出力あたりに進める入力サンプル数（=1/変換比） */
+    double target_step; /* 遷移後のstep */
+    double step_delta; /* 遷移中の1出力あたりのstep変化量 */
+    uint32_t num_transition_samples; /* 遷移完了までの残り出力サンプル数 */
+    double frac; /* 次の出力サンプルの入力サンプル間での小数位置 [0,1) */
+    uint32_t num_pending_skip_samples; /* 次の入力から読み飛ばすサンプル数 */
+    struct RingBuffer *history;
+    float *table; /* 窓付きsincテーブル (num_phases + 1) * num_table_taps */
+    float *delta_table; /* 隣接位相との差分テーブル (num_phases + 1) * num_table_taps */
+    float *interp_coef; /* 位相補間したフィルタ係数 */
+    float *mc_output; /* 複数チャンネル出力の一時領域 */
+    struct R2samplerKernel kernel;
+    uint8_t alloc_by_own;
+    struct R2samplerAllocator allocator; /* ワーク領域を確保したアロケータ */
+    void *work;
+};
+
+/* フィルタタイプから窓関数タイプに変換 */
+static R2samplerLPFWindowType R2samplerVariableRateConverter_GetWindowType(R2samplerFilterType filter_type)
+{
+    switch (filter_type) {
+    case R2SAMPLER_FILTERTYPE_LPF_HANNWINDOW:
+        return R2SAMPLERLPF_WINDOW_TYPE_HANN;
+    case R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW:
+        return R2SAMPLERLPF_WINDOW_TYPE_BLACKMAN;
+    case R2SAMPLER_FILTERTYPE_LPF_NUTTALLWINDOW:
+        return R2SAMPLERLPF_WINDOW_TYPE_NUTTALL;
+    case R2SAMPLER_FILTERTYPE_LPF_BLACKMANNUTTALLWINDOW:
+        return R2SAMPLERLPF_WINDOW_TYPE_BLACKMANNUTTALL;
+    default:
+        break;
+    }
+    return R2SAMPLERLPF_WINDOW_TYPE_INVALID;
+}
+
+/* 可変レート変換器作成に必要なワークサイズ計算 */
+int32_t R2samplerVariableRateConverter_CalculateWorkSize(const struct R2samplerVariableRateConverterConfig *config)
+{
+    int32_t work_size, tmp_work_size;
+    uint32_t num_table_taps, prototype_order;
+    struct RingBufferConfig buffer_config;
+
+    /* 引数チェック */
+    if (config == NULL) {
+        return -1;
+    }
+
+    /* コンフィグチェック */
+    if ((config->max_num_input_samples == 0) || (config->num_channels == 0)
+            || (config->num_phases == 0)) {
+        return -1;
+    }
+    /* タップ数は正の偶数を要求 */
+    if ((config->num_taps == 0) || ((config->num_taps % 2) != 0)) {
+        return -1;
+    }
+    /* 変換比の範囲チェック */
+    if ((config->min_ratio <= 0.0) || (config->min_ratio > config->max_ratio)
+            || (config->ratio < config->min_ratio) || (config->ratio > config->max_ratio)) {
+        return -1;
+    }
+    /* 窓関数によるLPFのみ対応 */
+    if (R2samplerVariableRateConverter_GetWindowType(config->filter_type) == R2SAMPLERLPF_WINDOW_TYPE_INVALID) {
+        return -1;
+    }
+
+    /* ワークサイズ計算 */
+    work_size = sizeof(struct R2samplerVariableRateConverter) + R2SAMPLERVRRATECONVERTER_ALIGNMENT;
+
+    /* 履歴バッファ: 最大入力数にフィルタ長分を加える */
+    buffer_config.max_size = sizeof(float) * config->num_channels * (config->max_num_input_samples + config->num_taps);
+    buffer_config.max_required_size = sizeof(float) * config->num_channels
+        * R2SAMPLERVRRATECONVERTER_MAX(config->num_taps, R2SAMPLERVRRATECONVERTER_MAX_NUM_SKIP_SAMPLES(config->min_ratio));
+    buffer_config.max_size = R2SAMPLERVRRATECONVERTER_MAX(buffer_config.max_size, buffer_config.max_required_size);
+    if ((tmp_work_size = RingBuffer_CalculateWorkSize(&buffer_config)) < 0) {
+        return -1;
+    }
+    work_size += tmp_work_size;
+
+    /* テーブルサイズ */
+    num_table_taps = R2SAMPLERVRRATECONVERTER_ROUNDUP(config->num_taps, R2SAMPLERVRRATECONVERTER_TAPS_UNIT);
+    work_size += 2 * (sizeof(float) * (config->num_phases + 1) * num_table_taps + R2SAMPLERVRRATECONVERTER_ALIGNMENT);
+    /* 補間係数と複数チャンネル出力の領域 */
+    work_size += sizeof(float) * num_table_taps + R2SAMPLERVRRATECONVERTER_ALIGNMENT;
+    work_size += sizeof(float) * config->num_channels + R2SAMPLERVRRATECONVERTER_ALIGNMENT;
+    /* 設計用のプロトタイプフィルタ（設計後は不要だが同じ領域で確保） */
+    prototype_order = config->num_taps * config->num_phases + 1;
+    work_size += sizeof(float) * prototype_order + R2SAMPLERVRRATECONVERTER_ALIGNMENT;
+
+    return work_size;
+}
+
+/* 可変レート変換器作成 */
+struct R2samplerVariableRateConverter *R2samplerVariableRateConverter_Create(
+        const struct R2samplerVariableRateConverterConfig *config, void *work, int32_t work_size)
+{
+    struct R2samplerVariableRateConverter *converter;
+    uint8_t tmp_alloc_by_own = 0;
+    struct R2samplerAllocator allocator;
+    uint8_t *work_ptr;
+    float *prototype;
+    uint32_t prototype_order;
+
+    /* ワーク領域時前確保の場合 */
+    if ((work == NULL) && (work_size == 0)) {
+        if ((work_size = R2samplerVariableRateConverter_CalculateWorkSize(config)) < 0) {
+            return NULL;
+        }
+        /* 指定されたアロケータ（指定が無ければグローバルに設定したもの）で確保 */
+        if (!R2sampler_GetAllocator(config->allocator, &allocator)) {
+            return NULL;
+        }
+        work = allocator.alloc((size_t)work_size, R2SAMPLERVRRATECONVERTER_ALIGNMENT, allocator.context);
+        tmp_alloc_by_own = 1;
+    }
+
+    /* 引数チェック */
+    if ((config == NULL) || (work == NULL)
+            || (R2samplerVariableRateConverter_CalculateWorkSize(config) < 0)
+            || (work_size < R2samplerVariableRateConverter_CalculateWorkSize(config))) {
+        if ((tmp_alloc_by_own == 1) && (work != NULL)) {
+            allocator.free(work, allocator.context);
+        }
+        return NULL;
+    }
+
+    /* ワーク領域先頭ポインタ取得 */
+    work_ptr = (uint8_t *)work;
+
+    /* ハンドル領域確保 */
+    work_ptr = (uint8_t *)R2SAMPLERVRRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERVRRATECONVERTER_ALIGNMENT);
+    converter = (struct R2samplerVariableRateConverter *)work_ptr;
+    work_ptr += sizeof(struct R2samplerVariableRateConverter);
+
+    /* メンバ設定 */
+    converter->max_num_input_samples = config->max_num_input_samples;
+    converter->num_channels = config->num_channels;
+    converter->num_taps = config->num_taps;
+    converter->num_phases = config->num_phases;
+    converter->num_table_taps = R2SAMPLERVRRATECONVERTER_ROUNDUP(config->num_taps, R2SAMPLERVRRATECONVERTER_TAPS_UNIT);
+    converter->min_ratio = config->min_ratio;
+    converter->max_ratio = config->max_ratio;
+    converter->initial_ratio = config->ratio;
+    converter->alloc_by_own = tmp_alloc_by_own;
+    if (tmp_alloc_by_own == 1) {
+        converter->allocator = allocator;
+    }
+    converter->work = work;
+
+    /* 履歴バッファ作成 */
+    {
+        int32_t tmp_work_size;
+        struct RingBufferConfig buffer_config;
+        buffer_config.max_size = sizeof(float) * config->num_channels * (config->max_num_input_samples + config->num_taps);
+        buffer_config.max_required_size = sizeof(float) * config->num_channels
+            * R2SAMPLERVRRATECONVERTER_MAX(config->num_taps, R2SAMPLERVRRATECONVERTER_MAX_NUM_SKIP_SAMPLES(config->min_ratio));
+        buffer_config.max_size = R2SAMPLERVRRATECONVERTER_MAX(buffer_config.max_size, buffer_config.max_required_size);
+        tmp_work_size = RingBuffer_CalculateWorkSize(&buffer_config);
+        assert(tmp_work_size >= 0);
+        converter->history = RingBuffer_Create(&buffer_config, work_ptr, tmp_work_size);
+        assert(converter->history != NULL);
+        work_ptr += tmp_work_size;
+    }
+
+    /* テーブルの領域確保 */
+    work_ptr = (uint8_t *)R2SAMPLERVRRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERVRRATECONVERTER_ALIGNMENT);
+    converter->table = (float *)work_ptr;
+    work_ptr += sizeof(float) * (converter->num_phases + 1) * converter->num_table_taps;
+    work_ptr = (uint8_t *)R2SAMPLERVRRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERVRRATECONVERTER_ALIGNMENT);
+    converter->delta_table = (float *)work_ptr;
+    work_ptr += sizeof(float) * (converter->num_phases + 1) * converter->num_table_taps;
+
+    /* 補間係数と複数チャンネル出力の領域確保 */
+    work_ptr = (uint8_t *)R2SAMPLERVRRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERVRRATECONVERTER_ALIGNMENT);
+    converter->interp_coef = (float *)work_ptr;
+    work_ptr += sizeof(float) * converter->num_table_taps;
+    work_ptr = (uint8_t *)R2SAMPLERVRRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERVRRATECONVERTER_ALIGNMENT);
+    converter->mc_output = (float *)work_ptr;
+    work_ptr += sizeof(float) * converter->num_channels;
+
+    /* プロトタイプフィルタの領域確保 */
+    prototype_order = converter->num_taps * converter->num_phases + 1;
+    work_ptr = (uint8_t *)R2SAMPLERVRRATECONVERTER_ROUNDUP((uintptr_t)work_ptr, R2SAMPLERVRRATECONVERTER_ALIGNMENT);
+    prototype = (float *)work_ptr;
+    work_ptr += sizeof(float) * prototype_order;
+
+    /* バッファオーバーランチェック */
+    assert((work_ptr - (uint8_t *)work) <= work_size);
+
+    /* プロトタイプフィルタ設計: num_phases倍にオーバーサンプルした窓付きsinc */
+    {
+        uint32_t i;
+        /* 阻止域: 変換比の下限に合わせて帯域制限 */
+        const float cutoff = (float)(0.5 * R2SAMPLERVRRATECONVERTER_MIN(1.0, converter->min_ratio) / converter->num_phases);
+        R2sampler_CreateLPFByWindowFunction(cutoff,
+                R2samplerVariableRateConverter_GetWindowType(config->filter_type), prototype, prototype_order);
+        /* 利得調整 */
+        for (i = 0; i < prototype_order; i++) {
+            prototype[i] *= converter->num_phases;
+        }
+    }
+
+    /* テーブル作成 */
+    /* 位相pの係数は元の係数のp, p + num_phases, p + 2 * num_phases, ...番目を連続して並べたもの */
+    /* 位相間の線形補間のため、位相num_phases + 1（範囲外はゼロ）との差分も記録 */
+    {
+        uint32_t phase, i;
+        for (phase = 0; phase <= converter->num_phases; phase++) {
+            float *ptable = &converter->table[phase * converter->num_table_taps];
+            float *pdelta = &converter->delta_table[phase * converter->num_table_taps];
+            for (i = 0; i < converter->num_table_taps; i++) {
+                const uint32_t idx = phase + i * converter->num_phases;
+                const float coef = ((i < converter->num_taps) && (idx < prototype_order)) ? prototype[idx] : 0.0f;
+                const float next = ((i < converter->num_taps) && ((idx + 1) < prototype_order)) ? prototype[idx + 1] : 0.0f;
+                ptable[i] = coef;
+                pdelta[i] = next - coef;
+            }
+        }
+    }
+
+    /* 実行環境に合わせた演算カーネルを選択 */
+    R2samplerKernel_Select(&converter->kernel);
+
+    /* 作成直後にレート変換を行えるように開始を指示 */
+    (void)R2samplerVariableRateConverter_Start(converter);
+
+    return converter;
+}
+
+/* 可変レート変換器破棄 */
+void R2samplerVariableRateConverter_Destroy(struct R2samplerVariableRateConverter *converter)
+{
+    if (converter != NULL) {
+        RingBuffer_Destroy(converter->history);
+        if (converter->alloc_by_own == 1) {
+            converter->allocator.free(converter->work, converter->allocator.context);
+        }
+    }
+}
+
+/* 可変レート変換開始（内部バッファと変換比をリセット） */
+R2samplerRateConverterApiResult R2samplerVariableRateConverter_Start(struct R2samplerVariableRateConverter *converter)
+{
+    uint32_t i;
+    const float zero = 0.0f;
+
+    /* 引数チェック */
+    if (converter == NULL) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* リングバッファクリア */
+    RingBuffer_Clear(converter->history);
+
+    /* 最初の出力の窓の中心に最初の入力サンプルが来るように遅延を挿入 */
+    for (i = 0; i < converter->num_channels * (converter->num_taps / 2 - 1); i++) {
+        RingBuffer_Put(converter->history, &zero, sizeof(float));
+    }
+
+    /* 位置と変換比をリセット */
+    converter->frac = 0.0;
+    converter->num_pending_skip_samples = 0;
+    converter->step = converter->target_step = 1.0 / converter->initial_ratio;
+    converter->step_delta = 0.0;
+    converter->num_transition_samples = 0;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* 変換比（出力レート/入力レート）を設定 */
+R2samplerRateConverterApiResult R2samplerVariableRateConverter_SetRatio(
+        struct R2samplerVariableRateConverter *converter, double ratio, uint32_t num_transition_samples)
+{
+    /* 引数チェック */
+    if (converter == NULL) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* 作成時に指定した範囲外の変換比は設定不可 */
+    if ((ratio < converter->min_ratio) || (ratio > converter->max_ratio)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    converter->target_step = 1.0 / ratio;
+    if (num_transition_samples == 0) {
+        /* 即時切り替え */
+        converter->step = converter->target_step;
+        converter->step_delta = 0.0;
+        converter->num_transition_samples = 0;
+    } else {
+        /* 現在の（遷移途中を含む）値から線形に遷移 */
+        converter->step_delta = (converter->target_step - converter->step) / num_transition_samples;
+        converter->num_transition_samples = num_transition_samples;
+    }
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* 現在の変換比（出力レート/入力レート）を取得 */
+R2samplerRateConverterApiResult R2samplerVariableRateConverter_GetRatio(
+        const struct R2samplerVariableRateConverter *converter, double *ratio)
+{
+    /* 引数チェック */
+    if ((converter == NULL) || (ratio == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    (*ratio) = 1.0 / converter->step;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
+
+/* 可変レート変換 */
+R2samplerRateConverterApiResult R2samplerVariableRateConverter_Process(
+        struct R2samplerVariableRateConverter *converter,
+        const float *input, uint32_t num_input_samples,
+        float *output_buffer, uint32_t num_buffer_samples, uint32_t *num_output_samples)
+{
+    uint32_t ch, num_channels, num_buffered_samples, tmp_num_output_samples;
+    void *pdata;
+    RingBufferApiResult rbf_ret;
+
+    /* 引数チェック */
+    if ((converter == NULL) || (input == NULL)
+            || (output_buffer == NULL) || (num_output_samples == NULL)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT;
+    }
+
+    /* 入力サンプル数が多すぎる */
+    if (num_input_samples > converter->max_num_input_samples) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_TOOMANY_NUM_INPUTS;
+    }
+
+    /* バッファサイズ不足 */
+    if (num_buffer_samples < R2SAMPLER_VARIABLE_RATE_MAX_NUM_OUTPUT_SAMPLES(num_input_samples, converter->max_ratio)) {
+        return R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER;
+    }
+
+    num_channels = converter->num_channels;
+
+    /* 入力サンプルを履歴バッファに入力 */
+    if (num_input_samples > 0) {
+        rbf_ret = RingBuffer_Put(converter->history, input, sizeof(float) * num_channels * num_input_samples);
+        assert(rbf_ret == RINGBUFFER_APIRESULT_OK);
+    }
+    num_buffered_samples = (uint32_t)(RingBuffer_GetRemainSize(converter->history) / (sizeof(float) * num_channels));
+
+    /* 前回読み飛ばしきれなかったサンプルを捨てる */
+    if ((converter->num_pending_skip_samples > 0) && (num_buffered_samples > 0)) {
+        const uint32_t num_skip = R2SAMPLERVRRATECONVERTER_MIN(converter->num_pending_skip_samples, num_buffered_samples);
+        rbf_ret = RingBuffer_Get(converter->history, &pdata, sizeof(float) * num_channels * num_skip);
+        assert(rbf_ret == RINGBUFFER_APIRESULT_OK);
+        converter->num_pending_skip_samples -= num_skip;
+        num_buffered_samples -= num_skip;
+    }
+
+    /* 窓内にタップ数分の入力が揃っている限り出力 */
+    tmp_num_output_samples = 0;
+    while (num_buffered_samples >= converter->num_taps) {
+        uint32_t i, phase_index, num_skip;
+        const float *px;
+        float weight;
+        double phase, next_pos;
+        const float *ptable, *pdelta;
+
+        /* 小数位置に対応するテーブル位相: 窓の末尾から見た位相 num_phases * (1 - frac) */
+        phase = converter->num_phases * (1.0 - converter->frac);
+        phase_index = (uint32_t)phase;
+        if (phase_index > converter->num_phases) {
+            phase_index = converter->num_phases;
+        }
+        weight = (float)(phase - phase_index);
+
+        /* 隣接位相間で線形補間した係数を作成 */
+        ptable = &converter->table[phase_index * converter->num_table_taps];
+        pdelta = &converter->delta_table[phase_index * converter->num_table_taps];
+        for (i = 0; i < converter->num_taps; i++) {
+            converter->interp_coef[i] = ptable[i] + weight * pdelta[i];
+        }
+
+        /* 畳み込み */
+        rbf_ret = RingBuffer_Peek(converter->history, &pdata, sizeof(float) * num_channels * converter->num_taps);
+        assert(rbf_ret == RINGBUFFER_APIRESULT_OK);
+        px = (const float *)pdata;
+        if (num_channels == 1) {
+            output_buffer[tmp_num_output_samples] = converter->kernel.dot_product(px, converter->interp_coef, converter->num_taps);
+        } else {
+            converter->kernel.multi_channel_dot_product(px, converter->interp_coef, converter->num_taps, num_channels, converter->mc_output);
+            for (ch = 0; ch < num_channels; ch++) {
+                output_buffer[tmp_num_output_samples * num_channels + ch] = converter->mc_output[ch];
+            }
+        }
+        tmp_num_output_samples++;
+        assert(tmp_num_output_samples <= num_buffer_samples);
+
+        /* 変換比の遷移 */
+        if (converter->num_transition_samples > 0) {
+            converter->num_transition_samples--;
+            converter->step = (converter->num_transition_samples == 0)
+                ? converter->target_step : (converter->step + converter->step_delta);
+        }
+
+        /* 位置を進める */
+        next_pos = converter->frac + converter->step;
+        num_skip = (uint32_t)next_pos;
+        converter->frac = next_pos - num_skip;
+
+        /* 整数部分だけ入力を読み飛ばす */
+        if (num_skip > num_buffered_samples) {
+            /* 足りない分は次の入力で読み飛ばす */
+            converter->num_pending_skip_samples = num_skip - num_buffered_samples;
+            num_skip = num_buffered_samples;
+        }
+        if (num_skip > 0) {
+            rbf_ret = RingBuffer_Get(converter->history, &pdata, sizeof(float) * num_channels * num_skip);
+            assert(rbf_ret == RINGBUFFER_APIRESULT_OK);
+            num_buffered_samples -= num_skip;
+        }
+    }
+
+    /* アサート無効時の未使用警告回避 */
+    (void)rbf_ret;
+
+    /* 出力サンプル数をセット */
+    (*num_output_samples) = tmp_num_output_samples;
+
+    return R2SAMPLERRATECONVERTER_APIRESULT_OK;
+}
@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <r2sampler.h>
+#include "r2sampler_internal.h"
+
+/* 仕様ファイル1行の最大文字数 */
+#define GENERATOR_MAX_LINE_LENGTH 256
+/* 生成するテーブルの最大数 */
+#define GENERATOR_MAX_NUM_TABLES 1024
+
+/* フィルタタイプ名とフィルタタイプの対応 */
+static const struct {
+    const char *name;
+    R2samplerFilterType filter_type;
+} filter_type_names[] = {
+    { "NONE",               R2SAMPLER_FILTERTYPE_NONE },
+    { "HANNWINDOW",         R2SAMPLER_FILTERTYPE_LPF_HANNWINDOW },
+    { "BLACKMANWINDOW",     R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW },
+    { "NUTTALLWINDOW",      R2SAMPLER_FILTERTYPE_LPF_NUTTALLWINDOW },
+    { "BLACKMANNUTTALLWINDOW", R2SAMPLER_FILTERTYPE_LPF_BLACKMANNUTTALLWINDOW },
+    { "KAISERWINDOW",       R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW },
+    { "EQUIRIPPLE",         R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE },
+    { "LEASTSQUARES",       R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES },
+};
+
+/* 出力済みのテーブル */
+static struct R2samplerFilterCacheKey generated_keys[GENERATOR_MAX_NUM_TABLES];
+static uint32_t generated_num_polyphase_taps[GENERATOR_MAX_NUM_TABLES];
+static uint8_t generated_half_band[GENERATOR_MAX_NUM_TABLES];
+static uint32_t num_generated_tables = 0;
+
+/* 使用法の表示 */
+static void print_usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s SPECIFICATION_FILE OUTPUT_C_FILE \n", program);
+    fprintf(stderr, "Each line of SPECIFICATION_FILE: \n");
+    fprintf(stderr, "  single|multi INPUT_RATE OUTPUT_RATE FILTER_TYPE FILTER_ORDER "
+            "[STOPBAND_ATTENUATION TRANSITION_WIDTH [STOPBAND_WEIGHT]] \n");
+}
+
+/* float配列の出力 */
+static void print_float_array(FILE *fp, const char *name, uint32_t index, const float *data, uint32_t num_data)
+{
+    uint32_t i;
+
+    fprintf(fp, "static const float r2sampler_table%u_%s[%u] = {", index, name, num_data);
+    for (i = 0; i < num_data; i++) {
+        fprintf(fp, "%s%.9ef,", ((i % 4) == 0) ? "\n    " : " ", data[i]);
+    }
+    fprintf(fp, "\n};\n");
+}
+
+/* 1つのレート変換器の係数を出力（出力済みの係数であれば何もしない） */
+static int generate_table(FILE *fp, const struct R2samplerRateConverter *converter)
+{
+    uint32_t i, num_polyphase_coef;
+    struct R2samplerCoefficientTable table;
+
+    R2samplerRateConverter_GetCoefficientTable(converter, &table);
+
+    /* 出力済みか？ */
+    for (i = 0; i < num_generated_tables; i++) {
+        if (R2samplerFilterCache_IsKeyEqual(&generated_keys[i], &table.key)) {
+            return 0;
+        }
+    }
+    if (num_generated_tables >= GENERATOR_MAX_NUM_TABLES) {
+        fprintf(stderr, "Too many tables. \n");
+        return 1;
+    }
+
+    /* 係数の出力 */
+    fprintf(fp, "\n/* filter_type:%d up_rate:%u down_rate:%u filter_order:%u */\n",
+            (int)table.key.filter_type, table.key.up_rate, table.key.down_rate, table.key.filter_order);
+    num_polyphase_coef = table.key.up_rate * table.num_polyphase_taps;
+    print_float_array(fp, "filter_coef", num_generated_tables, table.filter_coef, table.key.filter_order);
+    print_float_array(fp, "polyphase_coef", num_generated_tables, table.polyphase_coef, num_polyphase_coef);
+    if (table.half_band_coef != NULL) {
+        print_float_array(fp, "half_band_coef", num_generated_tables,
+                table.half_band_coef, (table.key.filter_order + 1) / 4);
+    }
+
+    generated_keys[num_generated_tables] = table.key;
+    generated_num_polyphase_taps[num_generated_tables] = table.num_polyphase_taps;
+    generated_half_band[num_generated_tables] = (table.half_band_coef != NULL) ? 1 : 0;
+    num_generated_tables++;
+
+    return 0;
+}
+
+/* 仕様1行分の係数を出力 */
+static int generate_tables(FILE *fp, const char *line, uint32_t line_no)
+{
+    int num_params;
+    uint32_t i;
+    char mode[16], filter_type_name[32];
+    unsigned int input_rate, output_rate, filter_order;
+    double stopband_attenuation = 0.0, transition_width = 0.0, stopband_weight = 1.0;
+    struct R2samplerMultiStageRateConverterConfig config;
+    struct R2samplerMultiStageRateConverter *converter;
+
+    num_params = sscanf(line, "%15s %u %u %31s %u %lf %lf %lf",
+            mode, &input_rate, &output_rate, filter_type_name, &filter_order,
+            &stopband_attenuation, &transition_width, &stopband_weight);
+    if ((num_params < 5) || (num_params == 6)) {
+        fprintf(stderr, "line %u: Invalid specification. \n", line_no);
+        return 1;
+    }
+
+    /* コンフィグ設定 */
+    config.single.max_num_input_samples = 128;
+    config.single.input_rate = input_rate;
+    config.single.output_rate = output_rate;
+    config.single.filter_order = filter_order;
+    config.single.stopband_attenuation = stopband_attenuation;
+    config.single.transition_width = transition_width;
+    config.single.stopband_weight = stopband_weight;
+    config.single.filter_cache = NULL;
+    config.single.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+    config.single.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+    config.single.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+    config.single.allocator = NULL;
+    for (i = 0; i < sizeof(filter_type_names) / sizeof(filter_type_names[0]); i++) {
+        if (strcmp(filter_type_name, filter_type_names[i].name) == 0) {
+            config.single.filter_type = filter_type_names[i].filter_type;
+            break;
+        }
+    }
+    if (i == sizeof(filter_type_names) / sizeof(filter_type_names[0])) {
+        fprintf(stderr, "line %u: Unknown filter type %s. \n", line_no, filter_type_name);
+        return 1;
+    }
+    if (strcmp(mode, "single") == 0) {
+        config.max_num_stages = 1;
+    } else if (strcmp(mode, "multi") == 0) {
+        config.max_num_stages = R2SAMPLER_MAX_NUM_STAGES;
+    } else {
+        fprintf(stderr, "line %u: Unknown mode %s. \n", line_no, mode);
+        return 1;
+    }
+
+    /* レート変換器を作成して設計した係数を出力 */
+    if ((converter = R2samplerMultiStageRateConverter_Create(&config, NULL, 0)) == NULL) {
+        fprintf(stderr, "line %u: Failed to create rate converter. \n", line_no);
+        return 1;
+    }
+    for (i = 0; i < R2samplerMultiStageRateConverter_GetNumStages(converter); i++) {
+        if (generate_table(fp, R2samplerMultiStageRateConverter_GetStage(converter, i)) != 0) {
+            R2samplerMultiStageRateConverter_Destroy(converter);
+            return 1;
+        }
+    }
+    R2samplerMultiStageRateConverter_Destroy(converter);
+
+    return 0;
+}
+
+/* テーブル一覧の出力 */
+static void print_table_list(FILE *fp)
+{
+    uint32_t i;
+
+    if (num_generated_tables == 0) {
+        fprintf(fp, "\nconst struct R2samplerCoefficientTable *const R2sampler_coefficient_tables = NULL;\n");
+        fprintf(fp, "const uint32_t R2sampler_num_coefficient_tables = 0;\n");
+        return;
+    }
+
+    fprintf(fp, "\nstatic const struct R2samplerCoefficientTable r2sampler_tables[%u] = {\n", num_generated_tables);
+    for (i = 0; i < num_generated_tables; i++) {
+        const struct R2samplerFilterCacheKey *key = &generated_keys[i];
+        fprintf(fp, "    { { (R2samplerFilterType)%d, %u, %u, %u, (R2samplerFilterPhase)%d, %.17g, %.17g, %.17g, %.17g }, %u,\n",
+                (int)key->filter_type, key->up_rate, key->down_rate, key->filter_order, (int)key->filter_phase,
+                key->passband_edge, key->stopband_edge, key->stopband_attenuation, key->stopband_weight,
+                generated_num_polyphase_taps[i]);
+        fprintf(fp, "      r2sampler_table%u_filter_coef, r2sampler_table%u_polyphase_coef, ", i, i);
+        if (generated_half_band[i]) {
+            fprintf(fp, "r2sampler_table%u_half_band_coef },\n", i);
+        } else {
+            fprintf(fp, "NULL },\n");
+        }
+    }
+    fprintf(fp, "};\n");
+    fprintf(fp, "\nconst struct R2samplerCoefficientTable *const R2sampler_coefficient_tables = r2sampler_tables;\n");
+    fprintf(fp, "const uint32_t R2sampler_num_coefficient_tables = %u;\n", num_generated_tables);
+}
+
+/* メインエントリ */
+int main(int argc, char **argv)
+{
+    FILE *spec_fp, *out_fp;
+    char line[GENERATOR_MAX_LINE_LENGTH];
+    uint32_t line_no;
+    int ret = 0;
+
+    if (argc != 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if ((spec_fp = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "Failed to open %s. \n", argv[1]);
+        return 1;
+    }
+    if ((out_fp = fopen(argv[2], "w")) == NULL) {
+        fprintf(stderr, "Failed to open %s. \n", argv[2]);
+        fclose(spec_fp);
+        return 1;
+    }
+
+    fprintf(out_fp, "/* This file is generated by r2sampler_coefficient_table_generator from %s. Do not edit. */\n", argv[1]);
+    fprintf(out_fp, "#include <stddef.h>\n\n#include \"r2sampler_internal.h\"\n");
+
+    /* 仕様ファイルを1行ずつ処理（空行と#以降はコメントとして無視） */
+    line_no = 0;
+    while (fgets(line, sizeof(line), spec_fp) != NULL) {
+        char *comment, *p;
+        line_no++;
+        if ((comment = strchr(line, '#')) != NULL) {
+            (*comment) = '\0';
+        }
+        for (p = line; (*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n'); p++) ;
+        if (*p == '\0') {
+            continue;
+        }
+        if ((ret = generate_tables(out_fp, p, line_no)) != 0) {
+            break;
+        }
+    }
+
+    if (ret == 0) {
+        print_table_list(out_fp);
+    }
+
+    fclose(spec_fp);
+    fclose(out_fp);
+
+    /* 失敗時は中途半端なファイルを残さない */
+    if (ret != 0) {
+        remove(argv[2]);
+    }
+
+    return ret;
+}
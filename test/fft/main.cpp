@@ -6,6 +6,515 @@
 /* テスト対象のモジュール */
 extern "C" {
 #include "../../libs/fft/src/fft.c"
+#include "../../libs/fft/src/fft_kernel.c"
+}
+
+#include <math.h>
+
+/* 離散フーリエ変換による参照値計算 */
+static void FFTTest_DFT(int n, const double *in_real, const double *in_imag, double *out_real, double *out_imag)
+{
+    int k, i;
+    for (k = 0; k < n; k++) {
+        out_real[k] = out_imag[k] = 0.0;
+        for (i = 0; i < n; i++) {
+            const double theta = -2.0 * _PI * k * i / n;
+            out_real[k] += in_real[i] * cos(theta) - in_imag[i] * sin(theta);
+            out_imag[k] += in_real[i] * sin(theta) + in_imag[i] * cos(theta);
+        }
+    }
+}
+
+/* 複素FFTテスト */
+TEST(FFTTest, FloatFFTTest)
+{
+#define MAX_FFT_SIZE 256
+    int n, i;
+    float x[2 * MAX_FFT_SIZE], y[2 * MAX_FFT_SIZE];
+    double in_real[MAX_FFT_SIZE], in_imag[MAX_FFT_SIZE];
+    double ref_real[MAX_FFT_SIZE], ref_imag[MAX_FFT_SIZE];
+
+    srand(0);
+    for (n = 2; n <= MAX_FFT_SIZE; n <<= 1) {
+        for (i = 0; i < n; i++) {
+            in_real[i] = 2.0 * rand() / (double)RAND_MAX - 1.0;
+            in_imag[i] = 2.0 * rand() / (double)RAND_MAX - 1.0;
+            FFTCOMPLEX_REAL(x, i) = (float)in_real[i];
+            FFTCOMPLEX_IMAG(x, i) = (float)in_imag[i];
+        }
+
+        /* 順変換はDFTと一致 */
+        FFTTest_DFT(n, in_real, in_imag, ref_real, ref_imag);
+        FFT_FloatFFT(n, -1, x, y);
+        for (i = 0; i < n; i++) {
+            EXPECT_NEAR(ref_real[i], FFTCOMPLEX_REAL(x, i), 1e-4 * n);
+            EXPECT_NEAR(ref_imag[i], FFTCOMPLEX_IMAG(x, i), 1e-4 * n);
+        }
+
+        /* 逆変換してnで割ると元に戻る */
+        FFT_FloatFFT(n, 1, x, y);
+        for (i = 0; i < n; i++) {
+            EXPECT_NEAR(in_real[i], FFTCOMPLEX_REAL(x, i) / n, 1e-5);
+            EXPECT_NEAR(in_imag[i], FFTCOMPLEX_IMAG(x, i) / n, 1e-5);
+        }
+    }
+#undef MAX_FFT_SIZE
+}
+
+/* 実数FFTテスト */
+TEST(FFTTest, RealFFTTest)
+{
+#define MAX_FFT_SIZE 256
+    int n, i;
+    float x[MAX_FFT_SIZE], y[MAX_FFT_SIZE];
+    double in_real[MAX_FFT_SIZE], in_imag[MAX_FFT_SIZE];
+    double ref_real[MAX_FFT_SIZE], ref_imag[MAX_FFT_SIZE];
+
+    srand(0);
+    for (n = 4; n <= MAX_FFT_SIZE; n <<= 1) {
+        for (i = 0; i < n; i++) {
+            in_real[i] = 2.0 * rand() / (double)RAND_MAX - 1.0;
+            in_imag[i] = 0.0;
+            x[i] = (float)in_real[i];
+        }
+
+        /* 順変換はDFTの前半と一致（x[1]には最高周波数成分の実部が入る） */
+        FFTTest_DFT(n, in_real, in_imag, ref_real, ref_imag);
+        FFT_RealFFT(n, -1, x, y);
+        EXPECT_NEAR(ref_real[0], x[0], 1e-4 * n);
+        EXPECT_NEAR(ref_real[n / 2], x[1], 1e-4 * n);
+        for (i = 1; i < n / 2; i++) {
+            EXPECT_NEAR(ref_real[i], FFTCOMPLEX_REAL(x, i), 1e-4 * n);
+            EXPECT_NEAR(ref_imag[i], FFTCOMPLEX_IMAG(x, i), 1e-4 * n);
+        }
+
+        /* 逆変換して2/nを掛けると元に戻る */
+        FFT_RealFFT(n, 1, x, y);
+        for (i = 0; i < n; i++) {
+            EXPECT_NEAR(in_real[i], x[i] * 2.0f / n, 1e-5);
+        }
+    }
+#undef MAX_FFT_SIZE
+}
+
+/* プラン作成・破棄テスト */
+TEST(FFTTest, CreateDestroyPlanTest)
+{
+    /* ワークサイズ計算テスト */
+    {
+        struct FFTPlanConfig config;
+
+        config.fft_size = 256;
+
+        config.max_batch_size = 1;
+        EXPECT_TRUE(FFTPlan_CalculateWorkSize(&config) > 0);
+
+        /* 不正な引数 */
+        EXPECT_TRUE(FFTPlan_CalculateWorkSize(NULL) < 0);
+
+        /* 2の冪以外に、2・3・5・7の積の変換長も作成できる */
+        config.fft_size = 96;
+        EXPECT_TRUE(FFTPlan_CalculateWorkSize(&config) > 0);
+        config.fft_size = 3 * 3 * 5 * 5;
+        EXPECT_TRUE(FFTPlan_CalculateWorkSize(&config) > 0);
+        config.fft_size = 147 * 64;
+        EXPECT_TRUE(FFTPlan_CalculateWorkSize(&config) > 0);
+
+        /* 2・3・5・7以外の素因数を持つ・小さすぎる変換長 */
+        config.fft_size = 0;
+        EXPECT_TRUE(FFTPlan_CalculateWorkSize(&config) < 0);
+        config.fft_size = 1;
+        EXPECT_TRUE(FFTPlan_CalculateWorkSize(&config) < 0);
+        config.fft_size = 176;
+        EXPECT_TRUE(FFTPlan_CalculateWorkSize(&config) < 0);
+
+        /* 短い変換長では一括変換の系列数を増やすとワークサイズも増える */
+        config.fft_size = 16;
+        config.max_batch_size = 4;
+        {
+            const int32_t batch_work_size = FFTPlan_CalculateWorkSize(&config);
+            config.max_batch_size = 1;
+            EXPECT_TRUE(batch_work_size > FFTPlan_CalculateWorkSize(&config));
+        }
+
+        /* 一括変換の系列数が不正 */
+        config.max_batch_size = 0;
+        EXPECT_TRUE(FFTPlan_CalculateWorkSize(&config) < 0);
+        config.fft_size = 1U << 20;
+        config.max_batch_size = 1U << 12;
+        EXPECT_TRUE(FFTPlan_CalculateWorkSize(&config) < 0);
+    }
+
+    /* ワーク領域渡しによる作成 */
+    {
+        void *work;
+        int32_t work_size;
+        struct FFTPlan *plan;
+        struct FFTPlanConfig config;
+
+        config.fft_size = 256;
+        config.max_batch_size = 1;
+        work_size = FFTPlan_CalculateWorkSize(&config);
+        ASSERT_GT(work_size, 0);
+        work = malloc((size_t)work_size);
+
+        plan = FFTPlan_Create(&config, work, work_size);
+        ASSERT_TRUE(plan != NULL);
+        EXPECT_EQ(config.fft_size, plan->fft_size);
+        FFTPlan_Destroy(plan);
+
+        /* 失敗ケース */
+        EXPECT_TRUE(FFTPlan_Create(NULL, work, work_size) == NULL);
+        EXPECT_TRUE(FFTPlan_Create(&config, NULL, work_size) == NULL);
+        EXPECT_TRUE(FFTPlan_Create(&config, work, work_size - 1) == NULL);
+        config.fft_size = 176;
+        EXPECT_TRUE(FFTPlan_Create(&config, work, work_size) == NULL);
+
+        free(work);
+    }
+}
+
+/* プランを使用したFFTテスト */
+TEST(FFTTest, PlanFFTTest)
+{
+#define MAX_FFT_SIZE 1024
+    int n, i, trial;
+    static float x[2 * MAX_FFT_SIZE], ref[2 * MAX_FFT_SIZE], y[2 * MAX_FFT_SIZE];
+
+    srand(0);
+    for (n = 2; n <= MAX_FFT_SIZE; n <<= 1) {
+        void *work;
+        struct FFTPlan *plan;
+        struct FFTPlanConfig config;
+
+        config.fft_size = (uint32_t)n;
+
+        config.max_batch_size = 1;
+        work = malloc(FFTPlan_CalculateWorkSize(&config));
+        plan = FFTPlan_Create(&config, work, FFTPlan_CalculateWorkSize(&config));
+        ASSERT_TRUE(plan != NULL);
+
+        /* 同じプランで繰り返し変換しても、プランを使わない変換と一致 */
+        for (trial = 0; trial < 2; trial++) {
+            /* 複素FFT */
+            for (i = 0; i < 2 * n; i++) {
+                x[i] = ref[i] = 2.0f * rand() / (float)RAND_MAX - 1.0f;
+            }
+            FFT_FloatFFT(n, -1, ref, y);
+            FFTPlan_FloatFFT(plan, -1, x);
+            for (i = 0; i < 2 * n; i++) {
+                EXPECT_NEAR(ref[i], x[i], 1e-5 * n);
+            }
+            FFT_FloatFFT(n, 1, ref, y);
+            FFTPlan_FloatFFT(plan, 1, x);
+            for (i = 0; i < 2 * n; i++) {
+                EXPECT_NEAR(ref[i], x[i], 1e-5 * n);
+            }
+
+            /* 実数列のFFT */
+            if (n >= 4) {
+                for (i = 0; i < n; i++) {
+                    x[i] = ref[i] = 2.0f * rand() / (float)RAND_MAX - 1.0f;
+                }
+                FFT_RealFFT(n, -1, ref, y);
+                FFTPlan_RealFFT(plan, -1, x);
+                for (i = 0; i < n; i++) {
+                    EXPECT_NEAR(ref[i], x[i], 1e-5 * n);
+                }
+                FFT_RealFFT(n, 1, ref, y);
+                FFTPlan_RealFFT(plan, 1, x);
+                for (i = 0; i < n; i++) {
+                    EXPECT_NEAR(ref[i], x[i], 1e-5 * n);
+                }
+            }
+        }
+
+        FFTPlan_Destroy(plan);
+        free(work);
+    }
+#undef MAX_FFT_SIZE
+}
+
+/* 高速に変換できる変換長の計算テスト */
+TEST(FFTTest, CalculateFastSizeTest)
+{
+    uint32_t n;
+
+    EXPECT_EQ(2, FFTPlan_CalculateFastSize(0));
+    EXPECT_EQ(2, FFTPlan_CalculateFastSize(2));
+    EXPECT_EQ(4, FFTPlan_CalculateFastSize(3));
+    EXPECT_EQ(6, FFTPlan_CalculateFastSize(5));
+    EXPECT_EQ(30, FFTPlan_CalculateFastSize(29));
+    EXPECT_EQ(1024, FFTPlan_CalculateFastSize(1024));
+    EXPECT_EQ(1080, FFTPlan_CalculateFastSize(1025));
+    EXPECT_EQ(0, FFTPlan_CalculateFastSize(UINT32_MAX));
+
+    /* 得られた長さは偶数でプランを作成でき、間に該当する長さは無い */
+    for (n = 1; n < 2000; n++) {
+        uint32_t m;
+        struct FFTPlanConfig config;
+        const uint32_t fast_size = FFTPlan_CalculateFastSize(n);
+        ASSERT_TRUE(fast_size >= n);
+        ASSERT_EQ(0, fast_size % 2);
+        config.fft_size = fast_size;
+        config.max_batch_size = 1;
+        ASSERT_TRUE(FFTPlan_CalculateWorkSize(&config) > 0);
+        for (m = n + (n % 2); m < fast_size; m += 2) {
+            uint32_t r = m;
+            while ((r % 2) == 0) { r /= 2; }
+            while ((r % 3) == 0) { r /= 3; }
+            while ((r % 5) == 0) { r /= 5; }
+            ASSERT_NE(1, r);
+        }
+    }
+}
+
+/* 混合基数のプランを使用したFFTテスト */
+TEST(FFTTest, MixedRadixPlanFFTTest)
+{
+#define MAX_FFT_SIZE 2400
+    /* 2^a 3^b 5^c 7^d の変換長 */
+    static const int fft_sizes[] = {
+        3, 5, 6, 9, 10, 12, 15, 20, 24, 25, 30, 36, 45, 48, 60, 75, 80, 90, 96, 120, 125,
+        150, 160, 180, 240, 300, 320, 375, 480, 600, 640, 720, 960, 1200, 1500, 2400,
+        /* 因数7を含む長さ */
+        7, 14, 21, 28, 35, 49, 56, 98, 147, 160 * 7, 1176, 1470
+    };
+    int n, i, j;
+    static float x[2 * MAX_FFT_SIZE];
+    static double in_real[MAX_FFT_SIZE], in_imag[MAX_FFT_SIZE];
+    static double ref_real[MAX_FFT_SIZE], ref_imag[MAX_FFT_SIZE];
+
+    srand(0);
+    for (j = 0; j < (int)(sizeof(fft_sizes) / sizeof(fft_sizes[0])); j++) {
+        void *work;
+        struct FFTPlan *plan;
+        struct FFTPlanConfig config;
+
+        n = fft_sizes[j];
+        config.fft_size = (uint32_t)n;
+        config.max_batch_size = 1;
+        ASSERT_TRUE(FFTPlan_CalculateWorkSize(&config) > 0);
+        work = malloc(FFTPlan_CalculateWorkSize(&config));
+        plan = FFTPlan_Create(&config, work, FFTPlan_CalculateWorkSize(&config));
+        ASSERT_TRUE(plan != NULL);
+
+        /* 複素FFTはDFTと一致し、逆変換でnで割ると元に戻る */
+        for (i = 0; i < n; i++) {
+            in_real[i] = 2.0 * rand() / (double)RAND_MAX - 1.0;
+            in_imag[i] = 2.0 * rand() / (double)RAND_MAX - 1.0;
+            FFTCOMPLEX_REAL(x, i) = (float)in_real[i];
+            FFTCOMPLEX_IMAG(x, i) = (float)in_imag[i];
+        }
+        FFTTest_DFT(n, in_real, in_imag, ref_real, ref_imag);
+        FFTPlan_FloatFFT(plan, -1, x);
+        for (i = 0; i < n; i++) {
+            ASSERT_NEAR(ref_real[i], FFTCOMPLEX_REAL(x, i), 1e-5 * n);
+            ASSERT_NEAR(ref_imag[i], FFTCOMPLEX_IMAG(x, i), 1e-5 * n);
+        }
+        FFTPlan_FloatFFT(plan, 1, x);
+        for (i = 0; i < n; i++) {
+            ASSERT_NEAR(in_real[i], FFTCOMPLEX_REAL(x, i) / n, 1e-5);
+            ASSERT_NEAR(in_imag[i], FFTCOMPLEX_IMAG(x, i) / n, 1e-5);
+        }
+
+        /* 実数列のFFT（偶数長のみ） */
+        if ((n % 2) == 0) {
+            for (i = 0; i < n; i++) {
+                in_real[i] = 2.0 * rand() / (double)RAND_MAX - 1.0;
+                in_imag[i] = 0.0;
+                x[i] = (float)in_real[i];
+            }
+            FFTTest_DFT(n, in_real, in_imag, ref_real, ref_imag);
+            FFTPlan_RealFFT(plan, -1, x);
+            ASSERT_NEAR(ref_real[0], x[0], 1e-5 * n);
+            ASSERT_NEAR(ref_real[n / 2], x[1], 1e-5 * n);
+            for (i = 1; i < n / 2; i++) {
+                ASSERT_NEAR(ref_real[i], FFTCOMPLEX_REAL(x, i), 1e-5 * n);
+                ASSERT_NEAR(ref_imag[i], FFTCOMPLEX_IMAG(x, i), 1e-5 * n);
+            }
+            FFTPlan_RealFFT(plan, 1, x);
+            for (i = 0; i < n; i++) {
+                ASSERT_NEAR(in_real[i], x[i] * 2.0f / n, 1e-5);
+            }
+        }
+
+        FFTPlan_Destroy(plan);
+        free(work);
+    }
+#undef MAX_FFT_SIZE
+}
+
+/* プランを使用した一括FFTテスト */
+TEST(FFTTest, BatchFFTTest)
+{
+#define MAX_FFT_SIZE 720
+#define MAX_NUM_SIGNALS 11
+#define SIGNAL_STRIDE (2 * MAX_FFT_SIZE + 6)
+    static const int fft_sizes[] = { 2, 4, 6, 8, 12, 14, 16, 28, 30, 60, 64, 96, 128, 240, 256, 720 };
+    static const uint32_t batch_sizes[] = { 1, 2, 3, 4, 8 };
+    int n, i, j, k, type, flag;
+    uint32_t num_signals, b;
+    static float x[MAX_NUM_SIGNALS * SIGNAL_STRIDE], ref[MAX_NUM_SIGNALS * SIGNAL_STRIDE];
+
+    for (type = 0; type < FFTKERNEL_TYPE_INVALID; type++) {
+        struct FFTKernel kernel;
+        if (!FFTKernel_Get((FFTKernelType)type, &kernel)) {
+            continue;
+        }
+        srand(0);
+        for (j = 0; j < (int)(sizeof(fft_sizes) / sizeof(fft_sizes[0])); j++) {
+            for (k = 0; k < (int)(sizeof(batch_sizes) / sizeof(batch_sizes[0])); k++) {
+                void *work[2];
+                struct FFTPlan *plan[2];
+                struct FFTPlanConfig config[2];
+
+                /* 一方は参照実装で1系列ずつ、もう一方は検査対象のカーネルで一括変換 */
+                n = fft_sizes[j];
+                config[0].fft_size = config[1].fft_size = (uint32_t)n;
+                config[0].max_batch_size = 1;
+                config[1].max_batch_size = batch_sizes[k];
+                work[0] = malloc(FFTPlan_CalculateWorkSize(&config[0]));
+                work[1] = malloc(FFTPlan_CalculateWorkSize(&config[1]));
+                plan[0] = FFTPlan_Create(&config[0], work[0], FFTPlan_CalculateWorkSize(&config[0]));
+                plan[1] = FFTPlan_Create(&config[1], work[1], FFTPlan_CalculateWorkSize(&config[1]));
+                ASSERT_TRUE((plan[0] != NULL) && (plan[1] != NULL));
+                (void)FFTKernel_Get(FFTKERNEL_TYPE_SCALAR, &plan[0]->kernel);
+                plan[1]->kernel = kernel;
+
+                /* 系列数が最大系列数の倍数でない場合も含める */
+                for (num_signals = 0; num_signals <= MAX_NUM_SIGNALS; num_signals += 3) {
+                    for (flag = -1; flag <= 1; flag += 2) {
+                        /* 複素FFT（系列間の隙間は変更されない） */
+                        for (i = 0; i < MAX_NUM_SIGNALS * SIGNAL_STRIDE; i++) {
+                            x[i] = ref[i] = 2.0f * rand() / (float)RAND_MAX - 1.0f;
+                        }
+                        for (b = 0; b < num_signals; b++) {
+                            FFTPlan_FloatFFT(plan[0], flag, &ref[b * SIGNAL_STRIDE]);
+                        }
+                        FFTPlan_FloatFFTBatch(plan[1], flag, x, num_signals, SIGNAL_STRIDE);
+                        for (i = 0; i < MAX_NUM_SIGNALS * SIGNAL_STRIDE; i++) {
+                            ASSERT_NEAR(ref[i], x[i], 1e-5 * n);
+                        }
+
+                        /* 実数列のFFT */
+                        for (i = 0; i < MAX_NUM_SIGNALS * SIGNAL_STRIDE; i++) {
+                            x[i] = ref[i] = 2.0f * rand() / (float)RAND_MAX - 1.0f;
+                        }
+                        for (b = 0; b < num_signals; b++) {
+                            FFTPlan_RealFFT(plan[0], flag, &ref[b * SIGNAL_STRIDE]);
+                        }
+                        FFTPlan_RealFFTBatch(plan[1], flag, x, num_signals, SIGNAL_STRIDE);
+                        for (i = 0; i < MAX_NUM_SIGNALS * SIGNAL_STRIDE; i++) {
+                            ASSERT_NEAR(ref[i], x[i], 1e-5 * n);
+                        }
+                    }
+                }
+
+                /* 系列を詰めて並べた場合も一括変換の逆変換で元に戻る */
+                for (i = 0; i < MAX_NUM_SIGNALS * n; i++) {
+                    x[i] = ref[i] = 2.0f * rand() / (float)RAND_MAX - 1.0f;
+                }
+                FFTPlan_RealFFTBatch(plan[1], -1, x, MAX_NUM_SIGNALS, (uint32_t)n);
+                FFTPlan_RealFFTBatch(plan[1],  1, x, MAX_NUM_SIGNALS, (uint32_t)n);
+                for (i = 0; i < MAX_NUM_SIGNALS * n; i++) {
+                    ASSERT_NEAR(ref[i], x[i] * 2.0f / n, 1e-5);
+                }
+
+                FFTPlan_Destroy(plan[0]);
+                FFTPlan_Destroy(plan[1]);
+                free(work[0]);
+                free(work[1]);
+            }
+        }
+    }
+#undef MAX_FFT_SIZE
+#undef MAX_NUM_SIGNALS
+#undef SIGNAL_STRIDE
+}
+
+/* 演算カーネル取得テスト */
+TEST(FFTTest, GetKernelTest)
+{
+    struct FFTKernel kernel;
+
+    /* 参照実装は常に使用可能 */
+    EXPECT_EQ(1, FFTKernel_IsSupported(FFTKERNEL_TYPE_SCALAR));
+    EXPECT_EQ(1, FFTKernel_Get(FFTKERNEL_TYPE_SCALAR, &kernel));
+    EXPECT_EQ(FFTKERNEL_TYPE_SCALAR, kernel.type);
+
+    /* 無効な種別は使用できない */
+    EXPECT_EQ(0, FFTKernel_IsSupported(FFTKERNEL_TYPE_INVALID));
+
+    /* 選択されるカーネルは使用可能なもの */
+    FFTKernel_Select(&kernel);
+    EXPECT_EQ(1, FFTKernel_IsSupported(kernel.type));
+    EXPECT_TRUE(kernel.radix4_stage != NULL);
+    EXPECT_TRUE(kernel.radix2_stage != NULL);
+}
+
+/* 演算カーネルの精度テスト（参照実装との比較） */
+TEST(FFTTest, KernelAccuracyTest)
+{
+#define MAX_FFT_SIZE 4096
+    int type, n, i, flag;
+    static float x[2 * MAX_FFT_SIZE], ref[2 * MAX_FFT_SIZE];
+
+    for (type = 0; type < FFTKERNEL_TYPE_INVALID; type++) {
+        struct FFTKernel kernel;
+        if (!FFTKernel_Get((FFTKernelType)type, &kernel)) {
+            continue;
+        }
+        srand(0);
+        /* 2の冪と、基数3・5の段を含む長さ */
+        for (n = 2; n <= MAX_FFT_SIZE; n = ((n & (n - 1)) == 0) ? (3 * n) : (4 * n / 3)) {
+            void *work[2];
+            struct FFTPlan *plan[2];
+            struct FFTPlanConfig config;
+
+            config.fft_size = (uint32_t)n;
+
+            config.max_batch_size = 1;
+            work[0] = malloc(FFTPlan_CalculateWorkSize(&config));
+            work[1] = malloc(FFTPlan_CalculateWorkSize(&config));
+            plan[0] = FFTPlan_Create(&config, work[0], FFTPlan_CalculateWorkSize(&config));
+            plan[1] = FFTPlan_Create(&config, work[1], FFTPlan_CalculateWorkSize(&config));
+            ASSERT_TRUE((plan[0] != NULL) && (plan[1] != NULL));
+            /* 一方は参照実装、もう一方は検査対象のカーネル */
+            (void)FFTKernel_Get(FFTKERNEL_TYPE_SCALAR, &plan[0]->kernel);
+            plan[1]->kernel = kernel;
+
+            for (flag = -1; flag <= 1; flag += 2) {
+                /* 複素FFT */
+                for (i = 0; i < 2 * n; i++) {
+                    x[i] = ref[i] = 2.0f * rand() / (float)RAND_MAX - 1.0f;
+                }
+                FFTPlan_FloatFFT(plan[0], flag, ref);
+                FFTPlan_FloatFFT(plan[1], flag, x);
+                for (i = 0; i < 2 * n; i++) {
+                    ASSERT_NEAR(ref[i], x[i], 1e-6 * n);
+                }
+
+                /* 実数列のFFT */
+                if (n >= 4) {
+                    for (i = 0; i < n; i++) {
+                        x[i] = ref[i] = 2.0f * rand() / (float)RAND_MAX - 1.0f;
+                    }
+                    FFTPlan_RealFFT(plan[0], flag, ref);
+                    FFTPlan_RealFFT(plan[1], flag, x);
+                    for (i = 0; i < n; i++) {
+                        ASSERT_NEAR(ref[i], x[i], 1e-6 * n);
+                    }
+                }
+            }
+
+            FFTPlan_Destroy(plan[0]);
+            FFTPlan_Destroy(plan[1]);
+            free(work[0]);
+            free(work[1]);
+        }
+    }
+#undef MAX_FFT_SIZE
 }
 
 int main(int argc, char **argv)
@@ -0,0 +1,218 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <gtest/gtest.h>
+
+/* テスト対象のモジュール */
+extern "C" {
+#include "../../libs/r2sampler_rate_converter/src/r2sampler_allocator.c"
+}
+
+/* 確保・解放の呼び出しを記録するアロケータの状態 */
+struct R2samplerAllocatorTestCounter {
+    uint32_t num_allocs;
+    uint32_t num_frees;
+    size_t alignment;
+    uint8_t fail; /* 確保を失敗させるか */
+};
+
+static void *R2samplerAllocatorTest_Alloc(size_t size, size_t alignment, void *context)
+{
+    struct R2samplerAllocatorTestCounter *counter = (struct R2samplerAllocatorTestCounter *)context;
+    if (counter->fail) {
+        return NULL;
+    }
+    counter->num_allocs++;
+    counter->alignment = alignment;
+    return malloc(size);
+}
+
+static void R2samplerAllocatorTest_Free(void *ptr, void *context)
+{
+    struct R2samplerAllocatorTestCounter *counter = (struct R2samplerAllocatorTestCounter *)context;
+    counter->num_frees++;
+    free(ptr);
+}
+
+/* アロケータを作成 */
+static void R2samplerAllocatorTest_SetAllocator(
+        struct R2samplerAllocator *allocator, struct R2samplerAllocatorTestCounter *counter)
+{
+    memset(counter, 0, sizeof(struct R2samplerAllocatorTestCounter));
+    allocator->alloc = R2samplerAllocatorTest_Alloc;
+    allocator->free = R2samplerAllocatorTest_Free;
+    allocator->context = counter;
+}
+
+/* 有効なレート変換器コンフィグをセット */
+static void R2samplerAllocatorTest_SetRateConverterConfig(
+        struct R2samplerRateConverterConfig *config, const struct R2samplerAllocator *allocator)
+{
+    config->max_num_input_samples = 64;
+    config->input_rate = 44100;
+    config->output_rate = 48000;
+    config->filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+    config->filter_order = 31;
+    config->stopband_attenuation = 0.0;
+    config->transition_width = 0.0;
+    config->stopband_weight = 0.0;
+    config->filter_cache = NULL;
+    config->convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+    config->filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+    config->memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+    config->allocator = allocator;
+}
+
+/* ハンドル毎のアロケータ指定テスト */
+TEST(R2samplerAllocatorTest, PerHandleAllocatorTest)
+{
+    struct R2samplerAllocator allocator;
+    struct R2samplerAllocatorTestCounter counter;
+
+    R2samplerAllocatorTest_SetAllocator(&allocator, &counter);
+
+    /* 各ハンドルで確保・解放が対になって呼ばれる */
+    {
+        struct R2samplerRateConverterConfig config;
+        struct R2samplerRateConverter *converter;
+        R2samplerAllocatorTest_SetRateConverterConfig(&config, &allocator);
+        converter = R2samplerRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        EXPECT_EQ(1, counter.num_allocs);
+        EXPECT_EQ(0, counter.num_frees);
+        EXPECT_EQ(16, counter.alignment);
+        R2samplerRateConverter_Destroy(converter);
+        EXPECT_EQ(1, counter.num_frees);
+    }
+    {
+        struct R2samplerMultiStageRateConverterConfig config;
+        struct R2samplerMultiStageRateConverter *converter;
+        R2samplerAllocatorTest_SetRateConverterConfig(&config.single, &allocator);
+        config.max_num_stages = R2SAMPLER_MAX_NUM_STAGES;
+        converter = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        /* ステージの変換器はワーク領域内に作られる */
+        EXPECT_EQ(2, counter.num_allocs);
+        R2samplerMultiStageRateConverter_Destroy(converter);
+        EXPECT_EQ(2, counter.num_frees);
+    }
+    {
+        struct R2samplerMultiChannelRateConverterConfig config;
+        struct R2samplerMultiChannelRateConverter *converter;
+        R2samplerAllocatorTest_SetRateConverterConfig(&config.multi_stage.single, &allocator);
+        config.multi_stage.max_num_stages = R2SAMPLER_MAX_NUM_STAGES;
+        config.num_channels = 2;
+        converter = R2samplerMultiChannelRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        EXPECT_EQ(3, counter.num_allocs);
+        R2samplerMultiChannelRateConverter_Destroy(converter);
+        EXPECT_EQ(3, counter.num_frees);
+    }
+    {
+        struct R2samplerVariableRateConverterConfig config;
+        struct R2samplerVariableRateConverter *converter;
+        config.max_num_input_samples = 64;
+        config.num_channels = 1;
+        config.filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+        config.num_taps = 16;
+        config.num_phases = 32;
+        config.min_ratio = 0.5;
+        config.max_ratio = 2.0;
+        config.ratio = 1.0;
+        config.allocator = &allocator;
+        converter = R2samplerVariableRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        EXPECT_EQ(4, counter.num_allocs);
+        R2samplerVariableRateConverter_Destroy(converter);
+        EXPECT_EQ(4, counter.num_frees);
+    }
+    {
+        struct R2samplerFilterCacheConfig config;
+        struct R2samplerFilterCache *cache;
+        config.max_num_entries = 2;
+        config.max_num_coefficients = 256;
+        config.lock = NULL;
+        config.unlock = NULL;
+        config.lock_context = NULL;
+        config.allocator = &allocator;
+        cache = R2samplerFilterCache_Create(&config, NULL, 0);
+        ASSERT_TRUE(cache != NULL);
+        EXPECT_EQ(5, counter.num_allocs);
+        R2samplerFilterCache_Destroy(cache);
+        EXPECT_EQ(5, counter.num_frees);
+    }
+
+    /* ワーク領域を渡した場合は使用しない */
+    {
+        void *work;
+        int32_t work_size;
+        struct R2samplerRateConverterConfig config;
+        struct R2samplerRateConverter *converter;
+        R2samplerAllocatorTest_SetRateConverterConfig(&config, &allocator);
+        work_size = R2samplerRateConverter_CalculateWorkSize(&config);
+        work = malloc(work_size);
+        converter = R2samplerRateConverter_Create(&config, work, work_size);
+        ASSERT_TRUE(converter != NULL);
+        R2samplerRateConverter_Destroy(converter);
+        EXPECT_EQ(5, counter.num_allocs);
+        EXPECT_EQ(5, counter.num_frees);
+        free(work);
+    }
+
+    /* 確保に失敗した場合は作成失敗 */
+    {
+        struct R2samplerRateConverterConfig config;
+        R2samplerAllocatorTest_SetRateConverterConfig(&config, &allocator);
+        counter.fail = 1;
+        EXPECT_TRUE(R2samplerRateConverter_Create(&config, NULL, 0) == NULL);
+        counter.fail = 0;
+        EXPECT_EQ(5, counter.num_frees);
+    }
+
+    /* 確保・解放のどちらかが無いアロケータは不正 */
+    {
+        struct R2samplerRateConverterConfig config;
+        struct R2samplerAllocator invalid_allocator = allocator;
+        invalid_allocator.free = NULL;
+        R2samplerAllocatorTest_SetRateConverterConfig(&config, &invalid_allocator);
+        EXPECT_TRUE(R2samplerRateConverter_Create(&config, NULL, 0) == NULL);
+        EXPECT_EQ(5, counter.num_allocs);
+    }
+}
+
+/* グローバルなアロケータ設定テスト */
+TEST(R2samplerAllocatorTest, GlobalAllocatorTest)
+{
+    struct R2samplerAllocator allocator;
+    struct R2samplerAllocatorTestCounter counter;
+    struct R2samplerRateConverterConfig config;
+    struct R2samplerRateConverter *converter;
+
+    R2samplerAllocatorTest_SetAllocator(&allocator, &counter);
+    R2samplerAllocatorTest_SetRateConverterConfig(&config, NULL);
+
+    /* 不正な設定は受け付けない */
+    {
+        struct R2samplerAllocator invalid_allocator = allocator;
+        invalid_allocator.alloc = NULL;
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2sampler_SetAllocator(&invalid_allocator));
+    }
+
+    /* 指定が無いハンドルはグローバルに設定したアロケータを使用 */
+    ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2sampler_SetAllocator(&allocator));
+    converter = R2samplerRateConverter_Create(&config, NULL, 0);
+    ASSERT_TRUE(converter != NULL);
+    EXPECT_EQ(1, counter.num_allocs);
+
+    /* 設定を戻しても作成時のアロケータで解放される */
+    ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2sampler_SetAllocator(NULL));
+    R2samplerRateConverter_Destroy(converter);
+    EXPECT_EQ(1, counter.num_frees);
+
+    /* 戻した後は使用されない */
+    converter = R2samplerRateConverter_Create(&config, NULL, 0);
+    ASSERT_TRUE(converter != NULL);
+    R2samplerRateConverter_Destroy(converter);
+    EXPECT_EQ(1, counter.num_allocs);
+    EXPECT_EQ(1, counter.num_frees);
+}
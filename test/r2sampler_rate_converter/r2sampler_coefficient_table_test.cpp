@@ -0,0 +1,123 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <gtest/gtest.h>
+
+/* テスト対象のモジュール */
+extern "C" {
+#include "../../libs/r2sampler_rate_converter/src/r2sampler_internal.h"
+
+/* テスト用の係数テーブル（テスト中に係数をセットする） */
+static struct R2samplerCoefficientTable test_coefficient_tables[1];
+const struct R2samplerCoefficientTable *const R2sampler_coefficient_tables = test_coefficient_tables;
+const uint32_t R2sampler_num_coefficient_tables = 1;
+}
+
+/* 配列の複製 */
+static float *R2samplerCoefficientTableTest_Duplicate(const float *data, uint32_t num_data)
+{
+    float *copy = (float *)malloc(sizeof(float) * num_data);
+    memcpy(copy, data, sizeof(float) * num_data);
+    return copy;
+}
+
+/* 係数テーブル参照テスト */
+TEST(R2samplerCoefficientTableTest, LookupTest)
+{
+#define NUMSAMPLES 512
+    static const R2samplerFilterType filter_types[] = {
+        R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW, R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW,
+        R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE, R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES
+    };
+    static const uint32_t rates[][2] = { { 2, 3 }, { 2, 1 } };
+    uint32_t f, r, i;
+    float input[NUMSAMPLES], output[2][NUMSAMPLES * 2];
+
+    srand(0);
+    for (i = 0; i < NUMSAMPLES; i++) {
+        input[i] = 2.0f * ((float)rand() / RAND_MAX - 0.5f);
+    }
+
+    for (f = 0; f < sizeof(filter_types) / sizeof(filter_types[0]); f++) {
+        for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+            uint32_t num_outputs[2];
+            int32_t work_size;
+            struct R2samplerRateConverter *converter;
+            struct R2samplerRateConverterConfig config;
+            struct R2samplerCoefficientTable designed, referred;
+
+            config.max_num_input_samples = NUMSAMPLES;
+            config.input_rate = rates[r][0];
+            config.output_rate = rates[r][1];
+            config.filter_type = filter_types[f];
+            config.filter_order = (filter_types[f] == R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW) ? 63 : 0;
+            config.stopband_attenuation = 60.0;
+            config.transition_width = 0.2;
+            config.stopband_weight = 1.0;
+            config.filter_cache = NULL;
+            config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.allocator = NULL;
+
+            /* テーブルが空の状態で設計し、その係数をテーブルにセット */
+            memset(&test_coefficient_tables[0], 0, sizeof(struct R2samplerCoefficientTable));
+            work_size = R2samplerRateConverter_CalculateWorkSize(&config);
+            converter = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter != NULL);
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerRateConverter_Process(converter, input, NUMSAMPLES, output[0], NUMSAMPLES * 2, &num_outputs[0]));
+            R2samplerRateConverter_GetCoefficientTable(converter, &designed);
+            test_coefficient_tables[0] = designed;
+            test_coefficient_tables[0].filter_coef
+                = R2samplerCoefficientTableTest_Duplicate(designed.filter_coef, designed.key.filter_order);
+            test_coefficient_tables[0].polyphase_coef
+                = R2samplerCoefficientTableTest_Duplicate(designed.polyphase_coef, designed.key.up_rate * designed.num_polyphase_taps);
+            if (designed.half_band_coef != NULL) {
+                test_coefficient_tables[0].half_band_coef
+                    = R2samplerCoefficientTableTest_Duplicate(designed.half_band_coef, (designed.key.filter_order + 1) / 4);
+            }
+            R2samplerRateConverter_Destroy(converter);
+
+            /* テーブルがあれば係数領域と設計用の作業領域の分ワークサイズが小さい */
+            EXPECT_LT(R2samplerRateConverter_CalculateWorkSize(&config), work_size);
+
+            /* 作成したハンドルはテーブルを直接参照 */
+            converter = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter != NULL);
+            R2samplerRateConverter_GetCoefficientTable(converter, &referred);
+            EXPECT_TRUE(R2samplerFilterCache_IsKeyEqual(&referred.key, &designed.key));
+            EXPECT_TRUE(referred.filter_coef == test_coefficient_tables[0].filter_coef);
+            EXPECT_TRUE(referred.polyphase_coef == test_coefficient_tables[0].polyphase_coef);
+            EXPECT_TRUE(referred.half_band_coef == test_coefficient_tables[0].half_band_coef);
+
+            /* 出力は設計した場合と一致 */
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerRateConverter_Process(converter, input, NUMSAMPLES, output[1], NUMSAMPLES * 2, &num_outputs[1]));
+            ASSERT_EQ(num_outputs[0], num_outputs[1]);
+            for (i = 0; i < num_outputs[0]; i++) {
+                EXPECT_FLOAT_EQ(output[0][i], output[1][i]);
+            }
+            R2samplerRateConverter_Destroy(converter);
+
+            /* 設計パラメータが異なればテーブルは参照しない */
+            if (filter_types[f] == R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW) {
+                config.filter_order = 31;
+            } else {
+                config.stopband_attenuation = 50.0;
+            }
+            converter = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter != NULL);
+            R2samplerRateConverter_GetCoefficientTable(converter, &referred);
+            EXPECT_TRUE(referred.filter_coef != test_coefficient_tables[0].filter_coef);
+            R2samplerRateConverter_Destroy(converter);
+
+            /* 後片付け */
+            free((void *)test_coefficient_tables[0].filter_coef);
+            free((void *)test_coefficient_tables[0].polyphase_coef);
+            free((void *)test_coefficient_tables[0].half_band_coef);
+            memset(&test_coefficient_tables[0], 0, sizeof(struct R2samplerCoefficientTable));
+        }
+    }
+#undef NUMSAMPLES
+}
@@ -0,0 +1,276 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <gtest/gtest.h>
+
+/* テスト対象のモジュール */
+extern "C" {
+#include "../../libs/r2sampler_rate_converter/src/r2sampler_filter_cache.c"
+}
+
+/* 有効なコンフィグをセット */
+#define R2samplerFilterCache_SetValidConfig(p_config)\
+    do {\
+        struct R2samplerFilterCacheConfig *config__p = p_config;\
+        config__p->max_num_entries      = 4;\
+        config__p->max_num_coefficients = 4096;\
+        config__p->lock                 = NULL;\
+        config__p->unlock               = NULL;\
+        config__p->lock_context         = NULL;\
+        config__p->allocator            = NULL;\
+    } while (0);
+
+/* 排他制御の呼び出し回数を記録 */
+struct R2samplerFilterCacheTestLockCounter {
+    uint32_t num_locks;
+    uint32_t num_unlocks;
+    uint8_t locked;
+};
+
+static void R2samplerFilterCacheTest_Lock(void *lock_context)
+{
+    struct R2samplerFilterCacheTestLockCounter *counter = (struct R2samplerFilterCacheTestLockCounter *)lock_context;
+    assert(!counter->locked);
+    counter->locked = 1;
+    counter->num_locks++;
+}
+
+static void R2samplerFilterCacheTest_Unlock(void *lock_context)
+{
+    struct R2samplerFilterCacheTestLockCounter *counter = (struct R2samplerFilterCacheTestLockCounter *)lock_context;
+    assert(counter->locked);
+    counter->locked = 0;
+    counter->num_unlocks++;
+}
+
+/* キーを作成 */
+static void R2samplerFilterCacheTest_SetKey(struct R2samplerFilterCacheKey *key, uint32_t up_rate, uint32_t down_rate)
+{
+    memset(key, 0, sizeof(struct R2samplerFilterCacheKey));
+    key->filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+    key->up_rate = up_rate;
+    key->down_rate = down_rate;
+    key->filter_order = 31;
+}
+
+/* ハンドル作成・破棄テスト */
+TEST(R2samplerFilterCacheTest, CreateDestroyHandleTest)
+{
+    /* ワークサイズ計算テスト */
+    {
+        int32_t work_size;
+        struct R2samplerFilterCacheConfig config;
+
+        /* 最低限構造体本体よりは大きいはず */
+        R2samplerFilterCache_SetValidConfig(&config);
+        work_size = R2samplerFilterCache_CalculateWorkSize(&config);
+        ASSERT_TRUE(work_size > sizeof(struct R2samplerFilterCache));
+
+        /* エントリが増えればワークサイズも増える */
+        config.max_num_entries = 8;
+        EXPECT_TRUE(R2samplerFilterCache_CalculateWorkSize(&config) > work_size);
+
+        /* 不正な引数 */
+        EXPECT_TRUE(R2samplerFilterCache_CalculateWorkSize(NULL) < 0);
+
+        /* 不正なコンフィグ */
+        R2samplerFilterCache_SetValidConfig(&config);
+        config.max_num_entries = 0;
+        EXPECT_TRUE(R2samplerFilterCache_CalculateWorkSize(&config) < 0);
+
+        R2samplerFilterCache_SetValidConfig(&config);
+        config.max_num_coefficients = 0;
+        EXPECT_TRUE(R2samplerFilterCache_CalculateWorkSize(&config) < 0);
+
+        R2samplerFilterCache_SetValidConfig(&config);
+        config.lock = R2samplerFilterCacheTest_Lock;
+        EXPECT_TRUE(R2samplerFilterCache_CalculateWorkSize(&config) < 0);
+    }
+
+    /* ワーク領域渡しによるハンドル作成（成功例） */
+    {
+        void *work;
+        int32_t work_size;
+        struct R2samplerFilterCache *cache;
+        struct R2samplerFilterCacheConfig config;
+
+        R2samplerFilterCache_SetValidConfig(&config);
+        work_size = R2samplerFilterCache_CalculateWorkSize(&config);
+        work = malloc(work_size);
+
+        cache = R2samplerFilterCache_Create(&config, work, work_size);
+        ASSERT_TRUE(cache != NULL);
+        EXPECT_TRUE(cache->work == work);
+        EXPECT_EQ(0, cache->alloc_by_own);
+        EXPECT_EQ(config.max_num_entries, cache->max_num_entries);
+        EXPECT_TRUE(R2samplerFilterCache_GetEntrySize(cache) >= (int32_t)(sizeof(float) * config.max_num_coefficients));
+
+        R2samplerFilterCache_Destroy(cache);
+        free(work);
+    }
+
+    /* 自前確保によるハンドル作成（成功例） */
+    {
+        struct R2samplerFilterCache *cache;
+        struct R2samplerFilterCacheConfig config;
+
+        R2samplerFilterCache_SetValidConfig(&config);
+        cache = R2samplerFilterCache_Create(&config, NULL, 0);
+        ASSERT_TRUE(cache != NULL);
+        EXPECT_TRUE(cache->work != NULL);
+        EXPECT_EQ(1, cache->alloc_by_own);
+
+        R2samplerFilterCache_Destroy(cache);
+    }
+
+    /* ハンドル作成（失敗ケース） */
+    {
+        void *work;
+        int32_t work_size;
+        struct R2samplerFilterCacheConfig config;
+
+        R2samplerFilterCache_SetValidConfig(&config);
+        work_size = R2samplerFilterCache_CalculateWorkSize(&config);
+        work = malloc(work_size);
+
+        /* 引数が不正 */
+        EXPECT_TRUE(R2samplerFilterCache_Create(NULL, work, work_size) == NULL);
+        EXPECT_TRUE(R2samplerFilterCache_Create(&config, NULL, work_size) == NULL);
+        EXPECT_TRUE(R2samplerFilterCache_Create(&config, work, 0) == NULL);
+
+        /* ワークサイズ不足 */
+        EXPECT_TRUE(R2samplerFilterCache_Create(&config, work, work_size - 1) == NULL);
+
+        /* コンフィグが不正 */
+        config.max_num_entries = 0;
+        EXPECT_TRUE(R2samplerFilterCache_Create(&config, work, work_size) == NULL);
+
+        free(work);
+    }
+}
+
+/* エントリの検索・追加・解放テスト */
+TEST(R2samplerFilterCacheTest, FindInsertReleaseTest)
+{
+    struct R2samplerFilterCache *cache;
+    struct R2samplerFilterCacheConfig config;
+    struct R2samplerFilterCacheKey key[3];
+    void *data[3];
+
+    R2samplerFilterCache_SetValidConfig(&config);
+    config.max_num_entries = 2;
+    cache = R2samplerFilterCache_Create(&config, NULL, 0);
+    ASSERT_TRUE(cache != NULL);
+
+    R2samplerFilterCacheTest_SetKey(&key[0], 2, 1);
+    R2samplerFilterCacheTest_SetKey(&key[1], 1, 2);
+    R2samplerFilterCacheTest_SetKey(&key[2], 3, 2);
+
+    /* 空のキャッシュには見つからない */
+    EXPECT_TRUE(R2samplerFilterCache_Find(cache, &key[0]) == NULL);
+
+    /* 追加したエントリは見つかり、同じ領域を共有する */
+    data[0] = R2samplerFilterCache_Insert(cache, &key[0]);
+    ASSERT_TRUE(data[0] != NULL);
+    EXPECT_TRUE(R2samplerFilterCache_Find(cache, &key[0]) == data[0]);
+    EXPECT_EQ(2, cache->entries[0].reference_count);
+
+    /* 設計パラメータが異なれば別のエントリ */
+    key[1].stopband_attenuation = 0.0;
+    data[1] = R2samplerFilterCache_Insert(cache, &key[1]);
+    ASSERT_TRUE(data[1] != NULL);
+    EXPECT_TRUE(data[1] != data[0]);
+    {
+        struct R2samplerFilterCacheKey tmp_key = key[1];
+        tmp_key.stopband_attenuation = 80.0;
+        EXPECT_TRUE(R2samplerFilterCache_Find(cache, &tmp_key) == NULL);
+    }
+
+    /* 全エントリが参照中なら追加できない */
+    EXPECT_TRUE(R2samplerFilterCache_Insert(cache, &key[2]) == NULL);
+
+    /* 参照が無くなったエントリを再利用 */
+    R2samplerFilterCache_Release(cache, data[1]);
+    data[2] = R2samplerFilterCache_Insert(cache, &key[2]);
+    EXPECT_TRUE(data[2] == data[1]);
+    EXPECT_TRUE(R2samplerFilterCache_Find(cache, &key[1]) == NULL);
+
+    /* 参照が無くなっても再利用されるまでは保持される */
+    R2samplerFilterCache_Release(cache, data[0]);
+    R2samplerFilterCache_Release(cache, data[0]);
+    EXPECT_EQ(0, cache->entries[0].reference_count);
+    EXPECT_TRUE(R2samplerFilterCache_Find(cache, &key[0]) == data[0]);
+    R2samplerFilterCache_Release(cache, data[0]);
+    R2samplerFilterCache_Release(cache, data[2]);
+
+    R2samplerFilterCache_Destroy(cache);
+}
+
+/* レート変換器間での係数共有テスト */
+TEST(R2samplerFilterCacheTest, ShareBetweenConvertersTest)
+{
+#define NUM_CONVERTERS 8
+    uint32_t i;
+    struct R2samplerFilterCache *cache;
+    struct R2samplerFilterCacheConfig cache_config;
+    struct R2samplerFilterCacheTestLockCounter counter = { 0, 0, 0 };
+    struct R2samplerMultiStageRateConverter *converter[NUM_CONVERTERS];
+    struct R2samplerMultiStageRateConverterConfig config;
+
+    R2samplerFilterCache_SetValidConfig(&cache_config);
+    cache_config.max_num_entries = 8;
+    cache_config.lock = R2samplerFilterCacheTest_Lock;
+    cache_config.unlock = R2samplerFilterCacheTest_Unlock;
+    cache_config.lock_context = &counter;
+    cache = R2samplerFilterCache_Create(&cache_config, NULL, 0);
+    ASSERT_TRUE(cache != NULL);
+
+    config.single.max_num_input_samples = 64;
+    config.single.input_rate = 48000;
+    config.single.output_rate = 44100;
+    config.single.filter_type = R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW;
+    config.single.filter_order = 0;
+    config.single.stopband_attenuation = 80.0;
+    config.single.transition_width = 0.2;
+    config.single.stopband_weight = 1.0;
+    config.single.filter_cache = cache;
+    config.single.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+    config.single.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+    config.single.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+    config.single.allocator = NULL;
+    config.max_num_stages = R2SAMPLER_MAX_NUM_STAGES;
+
+    /* 同じコンフィグで複数作成 */
+    for (i = 0; i < NUM_CONVERTERS; i++) {
+        converter[i] = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter[i] != NULL);
+    }
+
+    /* 2個目以降は設計済みの係数を共有している */
+    {
+        uint32_t num_valid_entries = 0;
+        for (i = 0; i < cache->max_num_entries; i++) {
+            if (cache->entries[i].valid) {
+                EXPECT_EQ(NUM_CONVERTERS, cache->entries[i].reference_count);
+                num_valid_entries++;
+            }
+        }
+        EXPECT_TRUE(num_valid_entries > 0);
+    }
+
+    /* 排他制御は対になって呼ばれている */
+    EXPECT_TRUE(counter.num_locks > 0);
+    EXPECT_EQ(counter.num_locks, counter.num_unlocks);
+
+    /* 全て破棄すると参照は無くなる */
+    for (i = 0; i < NUM_CONVERTERS; i++) {
+        R2samplerMultiStageRateConverter_Destroy(converter[i]);
+    }
+    for (i = 0; i < cache->max_num_entries; i++) {
+        EXPECT_EQ(0, cache->entries[i].reference_count);
+    }
+    EXPECT_EQ(counter.num_locks, counter.num_unlocks);
+
+    R2samplerFilterCache_Destroy(cache);
+#undef NUM_CONVERTERS
+}
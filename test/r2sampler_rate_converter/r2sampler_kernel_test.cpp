@@ -0,0 +1,241 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include <gtest/gtest.h>
+
+/* テスト対象のモジュール */
+extern "C" {
+#include "../../libs/r2sampler_rate_converter/src/r2sampler_kernel.c"
+}
+
+/* [-1,1]の一様乱数 */
+#define R2SAMPLERKERNELTEST_SIGNED_RAND() (2.0f * (float)rand() / RAND_MAX - 1.0f)
+
+/* 参照実装との許容誤差: 加算順序の違いによる丸め誤差の上限 2(項数+1)ε sum|x h| */
+static double R2samplerKernelTest_Tolerance(uint32_t num_terms, double abs_sum)
+{
+    return 2.0 * (num_terms + 1) * FLT_EPSILON * abs_sum;
+}
+
+/* 各項の絶対値の和 sum|x h| */
+static double R2samplerKernelTest_AbsDotProduct(const float *x, const float *coef, uint32_t num_taps)
+{
+    uint32_t i;
+    double sum = 0.0;
+    for (i = 0; i < num_taps; i++) {
+        sum += fabs((double)x[i] * coef[i]);
+    }
+    return sum;
+}
+
+/* 偶対称に折り返した係数での各項の絶対値の和 */
+static double R2samplerKernelTest_AbsSymmetricDotProduct(const float *x, const float *coef, uint32_t num_taps)
+{
+    uint32_t i;
+    double sum = 0.0;
+    for (i = 0; i < num_taps; i++) {
+        sum += fabs((double)x[i] * coef[(i < num_taps - i - 1) ? i : (num_taps - i - 1)]);
+    }
+    return sum;
+}
+
+/* カーネル選択テスト */
+TEST(R2samplerKernelTest, SelectTest)
+{
+    /* 参照実装は常に使用可能 */
+    {
+        struct R2samplerKernel kernel;
+        EXPECT_EQ(1, R2samplerKernel_IsSupported(R2SAMPLERKERNEL_TYPE_SCALAR));
+        EXPECT_EQ(1, R2samplerKernel_Get(R2SAMPLERKERNEL_TYPE_SCALAR, &kernel));
+        EXPECT_EQ(R2SAMPLERKERNEL_TYPE_SCALAR, kernel.type);
+        EXPECT_TRUE(kernel.dot_product != NULL);
+        EXPECT_TRUE(kernel.symmetric_fir != NULL);
+    }
+
+    /* 選択されたカーネルは使用可能なもの */
+    {
+        struct R2samplerKernel kernel;
+        R2samplerKernel_Select(&kernel);
+        EXPECT_EQ(1, R2samplerKernel_IsSupported(kernel.type));
+        EXPECT_TRUE(kernel.dot_product != NULL);
+        EXPECT_TRUE(kernel.symmetric_fir != NULL);
+    }
+
+    /* 無効な種別 */
+    {
+        struct R2samplerKernel kernel;
+        EXPECT_EQ(0, R2samplerKernel_IsSupported(R2SAMPLERKERNEL_TYPE_INVALID));
+        EXPECT_EQ(0, R2samplerKernel_Get(R2SAMPLERKERNEL_TYPE_INVALID, &kernel));
+    }
+}
+
+/* 参照実装との一致確認テスト */
+TEST(R2samplerKernelTest, CompareWithScalarTest)
+{
+#define MAX_NUM_TAPS 301
+    uint32_t type, n, i;
+    float x[MAX_NUM_TAPS], coef[MAX_NUM_TAPS];
+    struct R2samplerKernel scalar, kernel;
+
+    ASSERT_EQ(1, R2samplerKernel_Get(R2SAMPLERKERNEL_TYPE_SCALAR, &scalar));
+
+    /* 加算順序の違いが現れる桁落ちを含むよう符号付きの値 */
+    srand(0);
+    for (i = 0; i < MAX_NUM_TAPS; i++) {
+        x[i] = R2SAMPLERKERNELTEST_SIGNED_RAND();
+        coef[i] = R2SAMPLERKERNELTEST_SIGNED_RAND();
+    }
+
+    for (type = 0; type < R2SAMPLERKERNEL_TYPE_INVALID; type++) {
+        /* 使用できない命令セットはスキップ */
+        if (!R2samplerKernel_Get((R2samplerKernelType)type, &kernel)) {
+            continue;
+        }
+
+        /* 内積: 端数処理も確認するため全ての長さで確認 */
+        for (n = 1; n <= MAX_NUM_TAPS; n++) {
+            const float ref = scalar.dot_product(x, coef, n);
+            const float test = kernel.dot_product(x, coef, n);
+            EXPECT_NEAR(ref, test, R2samplerKernelTest_Tolerance(n, R2samplerKernelTest_AbsDotProduct(x, coef, n)));
+        }
+
+        /* 偶対称FIR: 奇数次数のみ */
+        for (n = 1; n <= MAX_NUM_TAPS; n += 2) {
+            const float ref = scalar.symmetric_fir(x, coef, n);
+            const float test = kernel.symmetric_fir(x, coef, n);
+            EXPECT_NEAR(ref, test, R2samplerKernelTest_Tolerance(n, R2samplerKernelTest_AbsSymmetricDotProduct(x, coef, n)));
+        }
+
+        /* 係数が偶対称ならば内積と一致 */
+        {
+            float sym_coef[MAX_NUM_TAPS];
+            for (i = 0; i < MAX_NUM_TAPS; i++) {
+                sym_coef[i] = coef[(i <= MAX_NUM_TAPS / 2) ? i : (MAX_NUM_TAPS - i - 1)];
+            }
+            EXPECT_NEAR(kernel.dot_product(x, sym_coef, MAX_NUM_TAPS),
+                    kernel.symmetric_fir(x, sym_coef, MAX_NUM_TAPS),
+                    R2samplerKernelTest_Tolerance(MAX_NUM_TAPS, R2samplerKernelTest_AbsDotProduct(x, sym_coef, MAX_NUM_TAPS)));
+        }
+    }
+#undef MAX_NUM_TAPS
+}
+
+/* 複数チャンネルカーネルと単一チャンネル参照実装の一致確認テスト */
+TEST(R2samplerKernelTest, MultiChannelCompareWithScalarTest)
+{
+#define MAX_NUM_TAPS 63
+#define MAX_NUM_CHANNELS 37
+    uint32_t type, n, ch, i;
+    static float x[MAX_NUM_TAPS * MAX_NUM_CHANNELS], xch[MAX_NUM_TAPS];
+    float coef[MAX_NUM_TAPS], output[MAX_NUM_CHANNELS];
+    struct R2samplerKernel scalar, kernel;
+
+    ASSERT_EQ(1, R2samplerKernel_Get(R2SAMPLERKERNEL_TYPE_SCALAR, &scalar));
+
+    srand(0);
+    for (i = 0; i < MAX_NUM_TAPS * MAX_NUM_CHANNELS; i++) {
+        x[i] = R2SAMPLERKERNELTEST_SIGNED_RAND();
+    }
+    for (i = 0; i < MAX_NUM_TAPS; i++) {
+        coef[i] = R2SAMPLERKERNELTEST_SIGNED_RAND();
+    }
+
+    for (type = 0; type < R2SAMPLERKERNEL_TYPE_INVALID; type++) {
+        uint32_t num_channels;
+        if (!R2samplerKernel_Get((R2samplerKernelType)type, &kernel)) {
+            continue;
+        }
+        ASSERT_TRUE(kernel.multi_channel_dot_product != NULL);
+        ASSERT_TRUE(kernel.multi_channel_symmetric_fir != NULL);
+
+        /* ベクトル幅の端数処理を確認するため全てのチャンネル数で確認 */
+        for (num_channels = 1; num_channels <= MAX_NUM_CHANNELS; num_channels++) {
+            for (n = 1; n <= MAX_NUM_TAPS; n += 2) {
+                kernel.multi_channel_dot_product(x, coef, n, num_channels, output);
+                for (ch = 0; ch < num_channels; ch++) {
+                    for (i = 0; i < n; i++) {
+                        xch[i] = x[i * num_channels + ch];
+                    }
+                    EXPECT_NEAR(scalar.dot_product(xch, coef, n), output[ch],
+                            R2samplerKernelTest_Tolerance(n, R2samplerKernelTest_AbsDotProduct(xch, coef, n)));
+                }
+                kernel.multi_channel_symmetric_fir(x, coef, n, num_channels, output);
+                for (ch = 0; ch < num_channels; ch++) {
+                    for (i = 0; i < n; i++) {
+                        xch[i] = x[i * num_channels + ch];
+                    }
+                    EXPECT_NEAR(scalar.symmetric_fir(xch, coef, n), output[ch],
+                            R2samplerKernelTest_Tolerance(n, R2samplerKernelTest_AbsSymmetricDotProduct(xch, coef, n)));
+                }
+            }
+        }
+    }
+#undef MAX_NUM_TAPS
+#undef MAX_NUM_CHANNELS
+}
+
+/* ハーフバンドフィルタ用カーネルの一致確認テスト */
+TEST(R2samplerKernelTest, HalfBandCompareWithScalarTest)
+{
+#define MAX_NUM_PAIRS 40
+#define MAX_NUM_CHANNELS 19
+    uint32_t type, k, ch, i;
+    static float x[4 * MAX_NUM_PAIRS * MAX_NUM_CHANNELS], xch[4 * MAX_NUM_PAIRS];
+    float coef[MAX_NUM_PAIRS], full_coef[4 * MAX_NUM_PAIRS], output[MAX_NUM_CHANNELS];
+    struct R2samplerKernel scalar, kernel;
+
+    ASSERT_EQ(1, R2samplerKernel_Get(R2SAMPLERKERNEL_TYPE_SCALAR, &scalar));
+
+    srand(0);
+    for (i = 0; i < 4 * MAX_NUM_PAIRS * MAX_NUM_CHANNELS; i++) {
+        x[i] = R2SAMPLERKERNELTEST_SIGNED_RAND();
+    }
+    for (i = 0; i < MAX_NUM_PAIRS; i++) {
+        coef[i] = R2SAMPLERKERNELTEST_SIGNED_RAND();
+    }
+
+    for (type = 0; type < R2SAMPLERKERNEL_TYPE_INVALID; type++) {
+        uint32_t num_channels;
+        if (!R2samplerKernel_Get((R2samplerKernelType)type, &kernel)) {
+            continue;
+        }
+        ASSERT_TRUE(kernel.even_symmetric_fir != NULL);
+        ASSERT_TRUE(kernel.half_band_fir != NULL);
+        ASSERT_TRUE(kernel.multi_channel_half_band_fir != NULL);
+
+        for (k = 1; k <= MAX_NUM_PAIRS; k++) {
+            /* 偶数長の偶対称FIR: 係数を折り返した内積と一致 */
+            for (i = 0; i < 2 * k; i++) {
+                full_coef[i] = coef[(i < k) ? i : (2 * k - i - 1)];
+            }
+            EXPECT_NEAR(scalar.dot_product(x, full_coef, 2 * k), kernel.even_symmetric_fir(x, coef, 2 * k),
+                    R2samplerKernelTest_Tolerance(2 * k, R2samplerKernelTest_AbsDotProduct(x, full_coef, 2 * k)));
+
+            /* ハーフバンドFIR: 係数の間にゼロを挟んで折り返した内積と一致 */
+            for (i = 0; i < 4 * k - 1; i++) {
+                full_coef[i] = 0.0f;
+            }
+            for (i = 0; i < k; i++) {
+                full_coef[2 * i] = full_coef[4 * k - 2 - 2 * i] = coef[i];
+            }
+            EXPECT_NEAR(scalar.dot_product(x, full_coef, 4 * k - 1), kernel.half_band_fir(x, coef, k),
+                    R2samplerKernelTest_Tolerance(4 * k - 1, R2samplerKernelTest_AbsDotProduct(x, full_coef, 4 * k - 1)));
+
+            /* 複数チャンネル: チャンネル毎の参照実装と一致 */
+            for (num_channels = 1; num_channels <= MAX_NUM_CHANNELS; num_channels++) {
+                kernel.multi_channel_half_band_fir(x, coef, k, num_channels, output);
+                for (ch = 0; ch < num_channels; ch++) {
+                    for (i = 0; i < 4 * k - 1; i++) {
+                        xch[i] = x[i * num_channels + ch];
+                    }
+                    EXPECT_NEAR(scalar.half_band_fir(xch, coef, k), output[ch],
+                            R2samplerKernelTest_Tolerance(4 * k - 1, R2samplerKernelTest_AbsDotProduct(xch, full_coef, 4 * k - 1)));
+                }
+            }
+        }
+    }
+#undef MAX_NUM_PAIRS
+#undef MAX_NUM_CHANNELS
+}
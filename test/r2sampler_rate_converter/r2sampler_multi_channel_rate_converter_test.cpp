@@ -0,0 +1,388 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <gtest/gtest.h>
+
+/* テスト対象のモジュール */
+extern "C" {
+#include "../../libs/r2sampler_rate_converter/src/r2sampler_multi_channel_rate_converter.c"
+}
+
+/* 有効なコンフィグをセット */
+#define R2samplerMultiChannelRateConverter_SetValidConfig(p_config)\
+    do {\
+        struct R2samplerMultiChannelRateConverterConfig *config__p = p_config;\
+        config__p->multi_stage.single.max_num_input_samples = 32;\
+        config__p->multi_stage.single.input_rate            = 44100;\
+        config__p->multi_stage.single.output_rate           = 48000;\
+        config__p->multi_stage.single.filter_type           = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;\
+        config__p->multi_stage.single.filter_order          = 31;\
+        config__p->multi_stage.single.filter_cache          = NULL;\
+        config__p->multi_stage.single.convolution_method    = R2SAMPLER_CONVOLUTION_DIRECT;\
+        config__p->multi_stage.single.filter_phase          = R2SAMPLER_FILTERPHASE_LINEAR;\
+        config__p->multi_stage.single.memory_mode           = R2SAMPLER_MEMORYMODE_NORMAL;\
+        config__p->multi_stage.single.allocator             = NULL;\
+        config__p->multi_stage.max_num_stages               = 4;\
+        config__p->num_channels                             = 2;\
+    } while (0);
+
+/* ハンドル作成・破棄テスト */
+TEST(R2samplerMultiChannelRateConverterTest, CreateDestroyHandleTest)
+{
+    /* ワークサイズ計算テスト */
+    {
+        int32_t work_size;
+        struct R2samplerMultiChannelRateConverterConfig config;
+
+        /* 最低限構造体本体よりは大きいはず */
+        R2samplerMultiChannelRateConverter_SetValidConfig(&config);
+        work_size = R2samplerMultiChannelRateConverter_CalculateWorkSize(&config);
+        ASSERT_TRUE(work_size > sizeof(struct R2samplerMultiChannelRateConverter));
+
+        /* チャンネル数が増えればワークサイズも増える */
+        config.num_channels = 8;
+        EXPECT_TRUE(R2samplerMultiChannelRateConverter_CalculateWorkSize(&config) > work_size);
+
+        /* 不正な引数 */
+        EXPECT_TRUE(R2samplerMultiChannelRateConverter_CalculateWorkSize(NULL) < 0);
+
+        /* 不正なコンフィグ */
+        R2samplerMultiChannelRateConverter_SetValidConfig(&config);
+        config.num_channels = 0;
+        EXPECT_TRUE(R2samplerMultiChannelRateConverter_CalculateWorkSize(&config) < 0);
+
+        R2samplerMultiChannelRateConverter_SetValidConfig(&config);
+        config.multi_stage.single.max_num_input_samples = 0;
+        EXPECT_TRUE(R2samplerMultiChannelRateConverter_CalculateWorkSize(&config) < 0);
+
+        R2samplerMultiChannelRateConverter_SetValidConfig(&config);
+        config.multi_stage.max_num_stages = 0;
+        EXPECT_TRUE(R2samplerMultiChannelRateConverter_CalculateWorkSize(&config) < 0);
+    }
+
+    /* ワーク領域渡しによるハンドル作成（成功例） */
+    {
+        void *work;
+        int32_t work_size;
+        struct R2samplerMultiChannelRateConverter *converter;
+        struct R2samplerMultiChannelRateConverterConfig config;
+
+        R2samplerMultiChannelRateConverter_SetValidConfig(&config);
+        work_size = R2samplerMultiChannelRateConverter_CalculateWorkSize(&config);
+        work = malloc(work_size);
+
+        converter = R2samplerMultiChannelRateConverter_Create(&config, work, work_size);
+        ASSERT_TRUE(converter != NULL);
+        EXPECT_TRUE(converter->work == work);
+        EXPECT_EQ(0, converter->alloc_by_own);
+        EXPECT_TRUE(converter->multi_stage != NULL);
+        EXPECT_TRUE(converter->input_buffer != NULL);
+        EXPECT_TRUE(converter->output_buffer != NULL);
+        EXPECT_EQ(config.num_channels, converter->num_channels);
+
+        R2samplerMultiChannelRateConverter_Destroy(converter);
+        free(work);
+    }
+
+    /* 自前確保によるハンドル作成（成功例） */
+    {
+        struct R2samplerMultiChannelRateConverter *converter;
+        struct R2samplerMultiChannelRateConverterConfig config;
+
+        R2samplerMultiChannelRateConverter_SetValidConfig(&config);
+        converter = R2samplerMultiChannelRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        EXPECT_TRUE(converter->work != NULL);
+        EXPECT_EQ(1, converter->alloc_by_own);
+
+        R2samplerMultiChannelRateConverter_Destroy(converter);
+    }
+
+    /* ハンドル作成（失敗ケース） */
+    {
+        void *work;
+        int32_t work_size;
+        struct R2samplerMultiChannelRateConverterConfig config;
+
+        R2samplerMultiChannelRateConverter_SetValidConfig(&config);
+        work_size = R2samplerMultiChannelRateConverter_CalculateWorkSize(&config);
+        work = malloc(work_size);
+
+        /* 引数が不正 */
+        EXPECT_TRUE(R2samplerMultiChannelRateConverter_Create(NULL, work, work_size) == NULL);
+        EXPECT_TRUE(R2samplerMultiChannelRateConverter_Create(&config, NULL, work_size) == NULL);
+        EXPECT_TRUE(R2samplerMultiChannelRateConverter_Create(&config, work, 0) == NULL);
+
+        /* ワークサイズ不足 */
+        EXPECT_TRUE(R2samplerMultiChannelRateConverter_Create(&config, work, work_size - 1) == NULL);
+
+        /* コンフィグが不正 */
+        R2samplerMultiChannelRateConverter_SetValidConfig(&config);
+        config.num_channels = 0;
+        EXPECT_TRUE(R2samplerMultiChannelRateConverter_Create(&config, work, work_size) == NULL);
+
+        free(work);
+    }
+
+    /* 既定値で初期化したコンフィグによるハンドル作成 */
+    {
+        struct R2samplerMultiChannelRateConverter *converter;
+        struct R2samplerMultiChannelRateConverterConfig config;
+
+        memset(&config, 0xFF, sizeof(config));
+        ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerMultiChannelRateConverter_InitializeConfig(&config));
+        EXPECT_EQ(1, config.num_channels);
+        EXPECT_EQ(R2SAMPLER_MAX_NUM_STAGES, config.multi_stage.max_num_stages);
+        EXPECT_EQ(1.0, config.multi_stage.single.stopband_weight);
+
+        config.multi_stage.single.max_num_input_samples = 32;
+        config.multi_stage.single.input_rate = 44100;
+        config.multi_stage.single.output_rate = 48000;
+        config.num_channels = 2;
+        converter = R2samplerMultiChannelRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        R2samplerMultiChannelRateConverter_Destroy(converter);
+
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerMultiChannelRateConverter_InitializeConfig(NULL));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerMultiStageRateConverter_InitializeConfig(NULL));
+    }
+}
+
+/* 各チャンネルを単一チャンネルのマルチステージ変換器で処理した結果と一致するか確認 */
+TEST(R2samplerMultiChannelRateConverterTest, CompareWithMultiStageTest)
+{
+#define NUM_SAMPLES 1024
+#define MAX_NUM_CHANNELS 9
+#define NUM_INPUTS 32
+    static const uint32_t rates[][2] = {
+        { 44100, 48000 }, { 48000, 44100 }, { 8000, 48000 }, { 48000, 16000 }, { 3, 2 }
+    };
+    static const uint32_t num_channels_list[] = { 1, 2, 3, 8, MAX_NUM_CHANNELS };
+    uint32_t r, c, smpl, ch, interleaved;
+    float *input, *output, *ref_output;
+
+    input = (float *)malloc(sizeof(float) * NUM_SAMPLES * MAX_NUM_CHANNELS);
+
+    /* チャンネル毎に異なる信号 */
+    srand(0);
+    for (smpl = 0; smpl < NUM_SAMPLES; smpl++) {
+        for (ch = 0; ch < MAX_NUM_CHANNELS; ch++) {
+            input[ch * NUM_SAMPLES + smpl]
+                = (float)sin(0.01 * (ch + 1) * smpl) + 0.1f * ((float)rand() / RAND_MAX - 0.5f);
+        }
+    }
+
+    for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        /* ドレインで出力される遅延分の余裕を持たせる */
+        const uint32_t num_buffer_samples = R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(NUM_SAMPLES, rates[r][0], rates[r][1]) + rates[r][1] + 256;
+        output = (float *)malloc(sizeof(float) * num_buffer_samples * MAX_NUM_CHANNELS);
+        ref_output = (float *)malloc(sizeof(float) * num_buffer_samples * MAX_NUM_CHANNELS);
+
+        for (c = 0; c < sizeof(num_channels_list) / sizeof(num_channels_list[0]); c++) {
+            const uint32_t num_channels = num_channels_list[c];
+            uint32_t ref_num_outputs = 0;
+            struct R2samplerMultiChannelRateConverterConfig config;
+
+            R2samplerMultiChannelRateConverter_SetValidConfig(&config);
+            config.multi_stage.single.max_num_input_samples = NUM_INPUTS;
+            config.multi_stage.single.input_rate = rates[r][0];
+            config.multi_stage.single.output_rate = rates[r][1];
+            config.num_channels = num_channels;
+
+            /* 単一チャンネル変換器による参照出力（プレーナ） */
+            for (ch = 0; ch < num_channels; ch++) {
+                struct R2samplerMultiStageRateConverter *ms;
+                uint32_t in_prog = 0, out_prog = 0;
+                ms = R2samplerMultiStageRateConverter_Create(&config.multi_stage, NULL, 0);
+                ASSERT_TRUE(ms != NULL);
+                while (in_prog < NUM_SAMPLES) {
+                    uint32_t num_outputs;
+                    ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                            R2samplerMultiStageRateConverter_Process(ms,
+                                &input[ch * NUM_SAMPLES + in_prog], NUM_INPUTS,
+                                &ref_output[ch * num_buffer_samples + out_prog], num_buffer_samples - out_prog, &num_outputs));
+                    in_prog += NUM_INPUTS;
+                    out_prog += num_outputs;
+                }
+                /* 残りを出力 */
+                while (1) {
+                    uint32_t num_outputs;
+                    ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                            R2samplerMultiStageRateConverter_Drain(ms,
+                                &ref_output[ch * num_buffer_samples + out_prog], num_buffer_samples - out_prog, &num_outputs));
+                    if (num_outputs == 0) {
+                        break;
+                    }
+                    out_prog += num_outputs;
+                }
+                R2samplerMultiStageRateConverter_Destroy(ms);
+                ref_num_outputs = out_prog;
+            }
+
+            /* プレーナ入出力とインターリーブ入出力の両方で確認 */
+            for (interleaved = 0; interleaved <= 1; interleaved++) {
+                struct R2samplerMultiChannelRateConverter *converter;
+                uint32_t in_prog = 0, out_prog = 0;
+                float *pinput;
+                const uint32_t in_ch_stride = interleaved ? 1 : NUM_SAMPLES;
+                const uint32_t in_smpl_stride = interleaved ? num_channels : 1;
+                const uint32_t out_ch_stride = interleaved ? 1 : num_buffer_samples;
+                const uint32_t out_smpl_stride = interleaved ? num_channels : 1;
+
+                /* 入力を指定形式に並べ替え */
+                pinput = (float *)malloc(sizeof(float) * NUM_SAMPLES * num_channels);
+                for (ch = 0; ch < num_channels; ch++) {
+                    for (smpl = 0; smpl < NUM_SAMPLES; smpl++) {
+                        pinput[ch * in_ch_stride + smpl * in_smpl_stride] = input[ch * NUM_SAMPLES + smpl];
+                    }
+                }
+
+                converter = R2samplerMultiChannelRateConverter_Create(&config, NULL, 0);
+                ASSERT_TRUE(converter != NULL);
+                while (in_prog < NUM_SAMPLES) {
+                    uint32_t num_outputs;
+                    ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                            R2samplerMultiChannelRateConverter_Process(converter,
+                                &pinput[in_prog * in_smpl_stride], in_ch_stride, in_smpl_stride, NUM_INPUTS,
+                                &output[out_prog * out_smpl_stride], out_ch_stride, out_smpl_stride,
+                                num_buffer_samples - out_prog, &num_outputs));
+                    in_prog += NUM_INPUTS;
+                    out_prog += num_outputs;
+                }
+                while (1) {
+                    uint32_t num_outputs;
+                    ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                            R2samplerMultiChannelRateConverter_Drain(converter,
+                                &output[out_prog * out_smpl_stride], out_ch_stride, out_smpl_stride,
+                                num_buffer_samples - out_prog, &num_outputs));
+                    if (num_outputs == 0) {
+                        break;
+                    }
+                    out_prog += num_outputs;
+                }
+                R2samplerMultiChannelRateConverter_Destroy(converter);
+
+                ASSERT_EQ(ref_num_outputs, out_prog);
+                for (ch = 0; ch < num_channels; ch++) {
+                    for (smpl = 0; smpl < out_prog; smpl++) {
+                        EXPECT_NEAR(ref_output[ch * num_buffer_samples + smpl],
+                                output[ch * out_ch_stride + smpl * out_smpl_stride], 1e-5);
+                    }
+                }
+
+                free(pinput);
+            }
+        }
+
+        free(output);
+        free(ref_output);
+    }
+
+    free(input);
+#undef NUM_SAMPLES
+#undef MAX_NUM_CHANNELS
+#undef NUM_INPUTS
+}
+
+/* 省メモリモードのテスト */
+TEST(R2samplerMultiChannelRateConverterTest, CompactMemoryTest)
+{
+#define NUM_SAMPLES 5000
+#define NUM_CHANNELS 3
+#define NUM_INPUTS 2048
+    static const uint32_t rates[][2] = { { 44100, 48000 }, { 48000, 44100 }, { 8000, 48000 } };
+    uint32_t r, k, ch, smpl;
+    float *input, *output[2];
+
+    input = (float *)malloc(sizeof(float) * NUM_SAMPLES * NUM_CHANNELS);
+    srand(0);
+    for (smpl = 0; smpl < NUM_SAMPLES; smpl++) {
+        for (ch = 0; ch < NUM_CHANNELS; ch++) {
+            input[ch * NUM_SAMPLES + smpl]
+                = (float)sin(0.01 * (ch + 1) * smpl) + 0.1f * ((float)rand() / RAND_MAX - 0.5f);
+        }
+    }
+
+    for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        const uint32_t num_buffer_samples = R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(NUM_SAMPLES, rates[r][0], rates[r][1]) + rates[r][1] + 256;
+        struct R2samplerMultiChannelRateConverterConfig config;
+        struct R2samplerWorkSizeBreakdown breakdown[2];
+        uint32_t num_total_outputs[2];
+
+        output[0] = (float *)malloc(sizeof(float) * num_buffer_samples * NUM_CHANNELS);
+        output[1] = (float *)malloc(sizeof(float) * num_buffer_samples * NUM_CHANNELS);
+
+        R2samplerMultiChannelRateConverter_SetValidConfig(&config);
+        config.multi_stage.single.max_num_input_samples = NUM_INPUTS;
+        config.multi_stage.single.input_rate = rates[r][0];
+        config.multi_stage.single.output_rate = rates[r][1];
+        config.num_channels = NUM_CHANNELS;
+
+        /* 通常モードと省メモリモードでプレーナ入出力を処理 */
+        for (k = 0; k < 2; k++) {
+            struct R2samplerMultiChannelRateConverter *converter;
+            uint32_t in_prog = 0, num_outputs;
+
+            config.multi_stage.single.memory_mode = (k == 0) ? R2SAMPLER_MEMORYMODE_NORMAL : R2SAMPLER_MEMORYMODE_COMPACT;
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerMultiChannelRateConverter_CalculateWorkSizeBreakdown(&config, &breakdown[k]));
+            EXPECT_EQ(R2samplerMultiChannelRateConverter_CalculateWorkSize(&config), breakdown[k].total);
+            EXPECT_EQ(breakdown[k].total,
+                    breakdown[k].coefficients + breakdown[k].history + breakdown[k].staging + breakdown[k].design + breakdown[k].other);
+
+            converter = R2samplerMultiChannelRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter != NULL);
+            num_total_outputs[k] = 0;
+            while (in_prog < NUM_SAMPLES) {
+                const uint32_t num_process_samples = (NUM_SAMPLES - in_prog < NUM_INPUTS) ? (NUM_SAMPLES - in_prog) : NUM_INPUTS;
+                /* 省メモリモードではバッファ不足で一度失敗させる（状態は変わらない） */
+                if ((k == 1) && (R2samplerMultiStageRateConverter_GetNumOutputSamples(converter->multi_stage, num_process_samples) > 0)) {
+                    EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER,
+                            R2samplerMultiChannelRateConverter_Process(converter,
+                                &input[in_prog], NUM_SAMPLES, 1, num_process_samples,
+                                &output[k][num_total_outputs[k]], num_buffer_samples, 1, 0, &num_outputs));
+                }
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerMultiChannelRateConverter_Process(converter,
+                            &input[in_prog], NUM_SAMPLES, 1, num_process_samples,
+                            &output[k][num_total_outputs[k]], num_buffer_samples, 1,
+                            num_buffer_samples - num_total_outputs[k], &num_outputs));
+                in_prog += num_process_samples;
+                num_total_outputs[k] += num_outputs;
+            }
+            /* ドレインも同様 */
+            if (k == 1) {
+                EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER,
+                        R2samplerMultiChannelRateConverter_Drain(converter,
+                            &output[k][num_total_outputs[k]], num_buffer_samples, 1, 0, &num_outputs));
+            }
+            do {
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerMultiChannelRateConverter_Drain(converter,
+                            &output[k][num_total_outputs[k]], num_buffer_samples, 1,
+                            num_buffer_samples - num_total_outputs[k], &num_outputs));
+                num_total_outputs[k] += num_outputs;
+            } while (num_outputs > 0);
+
+            R2samplerMultiChannelRateConverter_Destroy(converter);
+        }
+
+        /* ワークサイズは小さくなり、出力は一致 */
+        EXPECT_TRUE(breakdown[1].total < breakdown[0].total);
+        ASSERT_EQ(num_total_outputs[0], num_total_outputs[1]);
+        for (ch = 0; ch < NUM_CHANNELS; ch++) {
+            for (smpl = 0; smpl < num_total_outputs[0]; smpl++) {
+                ASSERT_FLOAT_EQ(output[0][ch * num_buffer_samples + smpl], output[1][ch * num_buffer_samples + smpl]);
+            }
+        }
+
+        free(output[0]);
+        free(output[1]);
+    }
+
+    free(input);
+#undef NUM_SAMPLES
+#undef NUM_CHANNELS
+#undef NUM_INPUTS
+}
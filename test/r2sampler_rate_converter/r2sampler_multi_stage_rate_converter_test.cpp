@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 #include <gtest/gtest.h>
 
@@ -20,6 +21,11 @@ TEST(R2samplerMultiStageRateConverterTest, CreateDestroyHandleTest)
         config__p->single.output_rate           = 48000;\
         config__p->single.filter_type           = R2SAMPLER_FILTERTYPE_NONE;\
         config__p->single.filter_order          = 1;\
+        config__p->single.filter_cache          = NULL;\
+        config__p->single.convolution_method    = R2SAMPLER_CONVOLUTION_DIRECT;\
+        config__p->single.filter_phase          = R2SAMPLER_FILTERPHASE_LINEAR;\
+        config__p->single.memory_mode           = R2SAMPLER_MEMORYMODE_NORMAL;\
+        config__p->single.allocator             = NULL;\
         config__p->max_num_stages               = 4;\
     } while (0);
 
@@ -217,6 +223,11 @@ TEST(R2samplerMultiStageRateConverterTest, RateConvertTest)
             config.single.output_rate = rate;
             config.single.filter_type = R2SAMPLER_FILTERTYPE_NONE;
             config.single.filter_order = 1;
+            config.single.filter_cache = NULL;
+            config.single.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.single.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.single.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.single.allocator = NULL;
             config.max_num_stages = 2;
             converter = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
             ASSERT_TRUE(converter != NULL);
@@ -286,6 +297,11 @@ TEST(R2samplerMultiStageRateConverterTest, RateConvertTest)
             config.single.output_rate = 1;
             config.single.filter_type = R2SAMPLER_FILTERTYPE_NONE;
             config.single.filter_order = 1;
+            config.single.filter_cache = NULL;
+            config.single.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.single.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.single.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.single.allocator = NULL;
             config.max_num_stages = 2;
             converter = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
             ASSERT_TRUE(converter != NULL);
@@ -362,6 +378,11 @@ TEST(R2samplerMultiStageRateConverterTest, RateConvertTest)
                 config.single.output_rate = out_rate;
                 config.single.filter_type = R2SAMPLER_FILTERTYPE_NONE;
                 config.single.filter_order = 1;
+                config.single.filter_cache = NULL;
+                config.single.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+                config.single.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+                config.single.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+                config.single.allocator = NULL;
                 config.max_num_stages = 2;
 
                 converter = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
@@ -456,3 +477,733 @@ TEST(R2samplerMultiStageRateConverterTest, SetUpDownConfigTest)
         }
     }
 }
+
+/* 阻止域減衰量と遷移帯域幅によるフィルタ設計のテスト */
+TEST(R2samplerMultiStageRateConverterTest, DesignBySpecificationTest)
+{
+#define NUMSAMPLES 4096
+    static const R2samplerFilterType filter_types[] = {
+        R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW, R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE,
+        R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES
+    };
+    /* 入力レート, 出力レート, ステージ数 */
+    static const uint32_t rates[][3] = { { 4, 1, 2 }, { 2, 1, 1 } };
+    uint32_t f, r, t, i, num_outputs;
+    float *input, *output;
+
+    input = (float *)malloc(sizeof(float) * NUMSAMPLES);
+    output = (float *)malloc(sizeof(float) * NUMSAMPLES);
+
+    for (f = 0; f < sizeof(filter_types) / sizeof(filter_types[0]); f++) {
+        for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+            /* 最終出力のナイキスト周波数（入力レートを1とした単位） */
+            const double nyquist = 0.5 * rates[r][1] / rates[r][0];
+            /* 阻止域の奥の周波数と、ナイキスト周波数の直上の周波数 */
+            const double frequencies[] = { 0.3, 1.02 * nyquist };
+            struct R2samplerMultiStageRateConverterConfig config;
+
+            R2samplerMultiStageRateConverter_InitializeConfig(&config);
+            config.single.max_num_input_samples = NUMSAMPLES;
+            config.single.input_rate = rates[r][0];
+            config.single.output_rate = rates[r][1];
+            config.single.filter_type = filter_types[f];
+            config.single.stopband_attenuation = 80.0;
+            config.single.transition_width = 0.1;
+            config.single.stopband_weight = 1.0;
+            config.max_num_stages = 4;
+
+            for (t = 0; t < sizeof(frequencies) / sizeof(frequencies[0]); t++) {
+                struct R2samplerMultiStageRateConverter *converter;
+                double max_amp;
+
+                /* 最小二乗の減衰量は阻止域の平均電力であり、阻止域端の直近では指定を満たさない */
+                if ((filter_types[f] == R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES) && (t > 0)) {
+                    continue;
+                }
+
+                converter = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
+                ASSERT_TRUE(converter != NULL);
+                EXPECT_EQ(rates[r][2], converter->num_stages);
+
+                /* 最終出力のナイキスト周波数より上の成分は減衰 */
+                for (i = 0; i < NUMSAMPLES; i++) {
+                    input[i] = (float)sin(2.0 * 3.14159265358979 * frequencies[t] * i);
+                }
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerMultiStageRateConverter_Process(converter, input, NUMSAMPLES, output, NUMSAMPLES, &num_outputs));
+                max_amp = 0.0;
+                for (i = num_outputs / 2; i < num_outputs; i++) {
+                    max_amp = R2SAMPLERMSRATECONVERTER_MAX(max_amp, fabs(output[i]));
+                }
+                EXPECT_LT(max_amp, pow(10.0, -79.0 / 20.0));
+
+                R2samplerMultiStageRateConverter_Destroy(converter);
+            }
+        }
+    }
+
+    free(input);
+    free(output);
+#undef NUMSAMPLES
+}
+
+/* ステージ毎のフィルタ設計テスト */
+TEST(R2samplerMultiStageRateConverterTest, StageFilterOrderTest)
+{
+    static const R2samplerFilterType filter_types[] = {
+        R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW, R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE,
+        R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES
+    };
+
+    /* 各ステージの次数取得 */
+    {
+        uint32_t f;
+
+        for (f = 0; f < sizeof(filter_types) / sizeof(filter_types[0]); f++) {
+            uint32_t i, num_stages, total_order, uniform_order;
+            uint32_t filter_orders[R2SAMPLER_MAX_NUM_STAGES];
+            struct R2samplerMultiStageRateConverter *converter;
+            struct R2samplerMultiStageRateConverterConfig config;
+
+            /* 1/4倍（2段の1/2倍） */
+            config.single.max_num_input_samples = 256;
+            config.single.input_rate = 4;
+            config.single.output_rate = 1;
+            config.single.filter_type = filter_types[f];
+            config.single.filter_order = 0;
+            config.single.filter_cache = NULL;
+            config.single.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.single.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.single.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.single.allocator = NULL;
+            config.single.stopband_attenuation = 80.0;
+            config.single.transition_width = 0.1;
+            config.single.stopband_weight = 1.0;
+            config.max_num_stages = 4;
+            converter = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter != NULL);
+
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerMultiStageRateConverter_GetStageFilterOrders(converter,
+                        filter_orders, R2SAMPLER_MAX_NUM_STAGES, &num_stages));
+            ASSERT_EQ(2, num_stages);
+
+            /* 前段は遷移帯域を広く取れるため次数は大幅に小さい */
+            EXPECT_LT(4 * filter_orders[0], filter_orders[1]);
+
+            /* 全ステージで同じ遷移帯域幅（1/2倍変換のナイキスト周波数基準）とした場合よりも総次数が小さい */
+            total_order = 0;
+            for (i = 0; i < num_stages; i++) {
+                EXPECT_EQ(1, filter_orders[i] % 2);
+                EXPECT_EQ(R2samplerRateConverter_GetFilterOrder(converter->resampler[i]), filter_orders[i]);
+                total_order += filter_orders[i];
+            }
+            uniform_order = R2sampler_CalculateKaiserFilterOrder(80.0, 0.1 * 0.25);
+            EXPECT_LT(total_order, 2 * uniform_order);
+
+            R2samplerMultiStageRateConverter_Destroy(converter);
+        }
+    }
+
+    /* 取得失敗ケース */
+    {
+        uint32_t num_stages;
+        uint32_t filter_orders[R2SAMPLER_MAX_NUM_STAGES];
+        struct R2samplerMultiStageRateConverter *converter;
+        struct R2samplerMultiStageRateConverterConfig config;
+
+        R2samplerMultiStageRateConverter_SetValidConfig(&config);
+        converter = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT,
+                R2samplerMultiStageRateConverter_GetStageFilterOrders(NULL, filter_orders, R2SAMPLER_MAX_NUM_STAGES, &num_stages));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT,
+                R2samplerMultiStageRateConverter_GetStageFilterOrders(converter, NULL, R2SAMPLER_MAX_NUM_STAGES, &num_stages));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT,
+                R2samplerMultiStageRateConverter_GetStageFilterOrders(converter, filter_orders, R2SAMPLER_MAX_NUM_STAGES, NULL));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER,
+                R2samplerMultiStageRateConverter_GetStageFilterOrders(converter, filter_orders, 0, &num_stages));
+
+        R2samplerMultiStageRateConverter_Destroy(converter);
+    }
+}
+
+/* 2倍/1/2倍ステージの帯域端テスト */
+TEST(R2samplerMultiStageRateConverterTest, HalfBandStageBandEdgesTest)
+{
+    static const R2samplerFilterType filter_types[] = {
+        R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW, R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE,
+        R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES
+    };
+    static const uint32_t rates[][2] = { { 4, 1 }, { 1, 4 } };
+    uint32_t f, r, i, num_stages;
+    struct R2samplerRateConverterConfig config;
+    struct R2samplerMultiStageUpDownRateConfig udconfig[R2SAMPLER_MAX_NUM_STAGES];
+    struct R2samplerFilterBandEdges band_edges[R2SAMPLER_MAX_NUM_STAGES];
+    struct R2samplerFilterBandEdges asymmetric_edges[R2SAMPLER_MAX_NUM_STAGES];
+
+    for (f = 0; f < sizeof(filter_types) / sizeof(filter_types[0]); f++) {
+        for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+            R2samplerRateConverter_InitializeConfig(&config);
+            config.input_rate = rates[r][0];
+            config.output_rate = rates[r][1];
+            config.filter_type = filter_types[f];
+            config.transition_width = 0.1;
+            config.stopband_weight = 1.0;
+            R2samplerMultiStageRateConverter_SetUpDownRateConfig(
+                    config.output_rate, config.input_rate, udconfig, R2SAMPLER_MAX_NUM_STAGES, &num_stages);
+            ASSERT_EQ(2, num_stages);
+
+            /* ハーフバンドとして設計しない場合の帯域端 */
+            config.filter_phase = R2SAMPLER_FILTERPHASE_MINIMUM;
+            ASSERT_TRUE(R2samplerMultiStageRateConverter_CalculateStageBandEdges(&config, udconfig, num_stages, asymmetric_edges) != NULL);
+
+            /* 阻止域端は変えず、阻止域端が0.25より大きいステージのみ通過域端を広げて0.25に対称にする */
+            config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            ASSERT_TRUE(R2samplerMultiStageRateConverter_CalculateStageBandEdges(&config, udconfig, num_stages, band_edges) != NULL);
+            for (i = 0; i < num_stages; i++) {
+                EXPECT_DOUBLE_EQ(asymmetric_edges[i].stopband_edge, band_edges[i].stopband_edge);
+                if (asymmetric_edges[i].stopband_edge > 0.25) {
+                    EXPECT_NEAR(0.5, band_edges[i].passband_edge + band_edges[i].stopband_edge, 1.0e-12);
+                    EXPECT_LT(asymmetric_edges[i].passband_edge, band_edges[i].passband_edge);
+                } else {
+                    EXPECT_DOUBLE_EQ(asymmetric_edges[i].passband_edge, band_edges[i].passband_edge);
+                }
+            }
+        }
+    }
+}
+
+/* ステージ構成探索テスト */
+TEST(R2samplerMultiStageRateConverterTest, PlanStagesTest)
+{
+    /* 探索結果は素因数分解による構成よりコストが小さく、変換比を保つ */
+    {
+        uint32_t i, f;
+        static const uint32_t rates[][2] = {
+            { 44100, 48000 }, { 48000, 44100 }, { 22050, 32000 }, { 8000, 44100 }, { 192000, 44100 }, { 4, 1 }
+        };
+        static const R2samplerFilterType filter_types[] = {
+            R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW, R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE
+        };
+
+        for (f = 0; f < sizeof(filter_types) / sizeof(filter_types[0]); f++) {
+            for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+                uint32_t j, gcd, up_rate, down_rate, up_product, down_product;
+                uint32_t num_stages, greedy_num_stages;
+                double cost, greedy_cost;
+                struct R2samplerMultiStageUpDownRateConfig udconfig[R2SAMPLER_MAX_NUM_STAGES];
+                struct R2samplerMultiStageUpDownRateConfig greedy_udconfig[R2SAMPLER_MAX_NUM_STAGES];
+                struct R2samplerRateConverterConfig config;
+
+                config.max_num_input_samples = 128;
+                config.input_rate = rates[i][0];
+                config.output_rate = rates[i][1];
+                config.filter_type = filter_types[f];
+                config.filter_order = 0;
+                config.filter_cache = NULL;
+                config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+                config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+                config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+                config.allocator = NULL;
+                config.stopband_attenuation = 100.0;
+                config.transition_width = 0.1;
+                config.stopband_weight = 1.0;
+
+                gcd = R2sampler_GCD(config.input_rate, config.output_rate);
+                up_rate = config.output_rate / gcd;
+                down_rate = config.input_rate / gcd;
+
+                R2samplerMultiStageRateConverter_SetUpDownRateConfig(up_rate, down_rate,
+                        greedy_udconfig, R2SAMPLER_MAX_NUM_STAGES, &greedy_num_stages);
+                R2samplerMultiStageRateConverter_PlanStages(&config, up_rate, down_rate,
+                        udconfig, R2SAMPLER_MAX_NUM_STAGES, &num_stages);
+                ASSERT_TRUE(num_stages <= R2SAMPLER_MAX_NUM_STAGES);
+
+                up_product = down_product = 1;
+                for (j = 0; j < num_stages; j++) {
+                    up_product *= udconfig[j].up_rate;
+                    down_product *= udconfig[j].down_rate;
+                }
+                EXPECT_EQ(up_rate, up_product);
+                EXPECT_EQ(down_rate, down_product);
+
+                greedy_cost = R2samplerMultiStageRateConverter_CalculatePlanCost(&config, greedy_udconfig, greedy_num_stages);
+                cost = R2samplerMultiStageRateConverter_CalculatePlanCost(&config, udconfig, num_stages);
+                ASSERT_GT(greedy_cost, 0.0);
+                EXPECT_LE(cost, greedy_cost);
+            }
+        }
+    }
+
+    /* ステージ数の上限を守る（次数の自動決定・固定の両方） */
+    {
+        static const uint32_t filter_orders[] = { 0, 31 };
+        static const uint32_t rates[][2] = { { 160, 147 }, { 6, 1 }, { 1, 30 } };
+        uint32_t f, r, j, max_num_stages, num_stages, up_product, down_product;
+        struct R2samplerMultiStageUpDownRateConfig udconfig[R2SAMPLER_MAX_NUM_STAGES];
+        struct R2samplerRateConverterConfig config;
+
+        for (f = 0; f < sizeof(filter_orders) / sizeof(filter_orders[0]); f++) {
+            for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+                R2samplerRateConverter_InitializeConfig(&config);
+                config.max_num_input_samples = 128;
+                config.input_rate = rates[r][1];
+                config.output_rate = rates[r][0];
+                config.filter_order = filter_orders[f];
+                config.filter_type = (filter_orders[f] == 0)
+                    ? R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW : R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+                config.stopband_attenuation = 100.0;
+                config.transition_width = 0.1;
+
+                for (max_num_stages = 1; max_num_stages <= R2SAMPLER_MAX_NUM_STAGES; max_num_stages++) {
+                    ASSERT_EQ(1, R2samplerMultiStageRateConverter_PlanStages(&config,
+                                rates[r][0], rates[r][1], udconfig, max_num_stages, &num_stages));
+                    EXPECT_TRUE((num_stages >= 1) && (num_stages <= max_num_stages));
+                    up_product = down_product = 1;
+                    for (j = 0; j < num_stages; j++) {
+                        up_product *= udconfig[j].up_rate;
+                        down_product *= udconfig[j].down_rate;
+                    }
+                    EXPECT_EQ(rates[r][0], up_product);
+                    EXPECT_EQ(rates[r][1], down_product);
+                }
+            }
+        }
+    }
+
+    /* 作成したハンドルもステージ数の上限を守る */
+    {
+        uint32_t max_num_stages;
+        struct R2samplerMultiStageRateConverter *converter;
+        struct R2samplerMultiStageRateConverterConfig config;
+
+        R2samplerMultiStageRateConverter_InitializeConfig(&config);
+        config.single.max_num_input_samples = 128;
+        config.single.input_rate = 44100;
+        config.single.output_rate = 48000;
+        config.single.filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+        config.single.filter_order = 31;
+        for (max_num_stages = 1; max_num_stages <= R2SAMPLER_MAX_NUM_STAGES; max_num_stages++) {
+            config.max_num_stages = max_num_stages;
+            ASSERT_TRUE(R2samplerMultiStageRateConverter_CalculateWorkSize(&config) > 0);
+            converter = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter != NULL);
+            EXPECT_TRUE(converter->num_stages <= max_num_stages);
+            R2samplerMultiStageRateConverter_Destroy(converter);
+        }
+    }
+
+    /* 次数固定の場合は素因数分解による構成 */
+    {
+        uint32_t j, num_stages, greedy_num_stages;
+        struct R2samplerMultiStageUpDownRateConfig udconfig[R2SAMPLER_MAX_NUM_STAGES];
+        struct R2samplerMultiStageUpDownRateConfig greedy_udconfig[R2SAMPLER_MAX_NUM_STAGES];
+        struct R2samplerRateConverterConfig config;
+
+        config.max_num_input_samples = 128;
+        config.input_rate = 44100;
+        config.output_rate = 48000;
+        config.filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+        config.filter_order = 31;
+        config.filter_cache = NULL;
+        config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+        config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+        config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+        config.allocator = NULL;
+
+        R2samplerMultiStageRateConverter_SetUpDownRateConfig(160, 147,
+                greedy_udconfig, R2SAMPLER_MAX_NUM_STAGES, &greedy_num_stages);
+        R2samplerMultiStageRateConverter_PlanStages(&config, 160, 147,
+                udconfig, R2SAMPLER_MAX_NUM_STAGES, &num_stages);
+        ASSERT_EQ(greedy_num_stages, num_stages);
+        for (j = 0; j < num_stages; j++) {
+            EXPECT_EQ(greedy_udconfig[j].up_rate, udconfig[j].up_rate);
+            EXPECT_EQ(greedy_udconfig[j].down_rate, udconfig[j].down_rate);
+        }
+    }
+}
+
+/* 遅延取得テスト */
+TEST(R2samplerMultiStageRateConverterTest, GetLatencyTest)
+{
+    /* ステップ応答が半分に達する位置が線形位相の遅延と一致し、最小位相では短くなる */
+    {
+#define NUMSAMPLES 1024
+        uint32_t p, i, num_outputs;
+        float *input, *output;
+        double latency[2];
+
+        input = (float *)malloc(sizeof(float) * NUMSAMPLES);
+        output = (float *)malloc(sizeof(float) * NUMSAMPLES * 2);
+        for (i = 0; i < NUMSAMPLES; i++) {
+            input[i] = 1.0f;
+        }
+
+        for (p = 0; p < 2; p++) {
+            struct R2samplerMultiStageRateConverter *converter;
+            struct R2samplerMultiStageRateConverterConfig config;
+
+            config.single.max_num_input_samples = NUMSAMPLES;
+            config.single.input_rate = 44100;
+            config.single.output_rate = 48000;
+            config.single.filter_type = R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW;
+            config.single.filter_order = 0;
+            config.single.filter_cache = NULL;
+            config.single.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.single.filter_phase = (p == 0) ? R2SAMPLER_FILTERPHASE_LINEAR : R2SAMPLER_FILTERPHASE_MINIMUM;
+            config.single.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.single.allocator = NULL;
+            config.single.stopband_attenuation = 80.0;
+            config.single.transition_width = 0.2;
+            config.single.stopband_weight = 1.0;
+            config.max_num_stages = R2SAMPLER_MAX_NUM_STAGES;
+            converter = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter != NULL);
+            ASSERT_TRUE(R2samplerMultiStageRateConverter_GetNumStages(converter) > 1);
+
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerMultiStageRateConverter_GetLatency(converter, &latency[p]));
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerMultiStageRateConverter_Process(converter, input, NUMSAMPLES, output, NUMSAMPLES * 2, &num_outputs));
+
+            /* 入力サンプル単位の遅延は変換比で換算した値 */
+            {
+                double input_latency;
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerMultiStageRateConverter_GetInputLatency(converter, &input_latency));
+                EXPECT_NEAR(latency[p] * 44100.0 / 48000.0, input_latency, 1.0e-9);
+            }
+
+            /* 線形位相のステップ応答は遅延位置で半分を横切る */
+            if (p == 0) {
+                for (i = 0; i < num_outputs; i++) {
+                    if (output[i] >= 0.5f) {
+                        break;
+                    }
+                }
+                EXPECT_NEAR(latency[p], (double)i, 1.0);
+            }
+
+            R2samplerMultiStageRateConverter_Destroy(converter);
+        }
+        EXPECT_GT(latency[1], 0.0);
+        EXPECT_LT(latency[1], latency[0] / 2.0);
+
+        free(input);
+        free(output);
+#undef NUMSAMPLES
+    }
+
+    /* 取得失敗ケース */
+    {
+        double latency;
+        struct R2samplerMultiStageRateConverter *converter;
+        struct R2samplerMultiStageRateConverterConfig config;
+
+        R2samplerMultiStageRateConverter_SetValidConfig(&config);
+        converter = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerMultiStageRateConverter_GetLatency(NULL, &latency));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerMultiStageRateConverter_GetLatency(converter, NULL));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerMultiStageRateConverter_GetInputLatency(NULL, &latency));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerMultiStageRateConverter_GetInputLatency(converter, NULL));
+
+        /* フィルタを適用しなければ遅延はない */
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerMultiStageRateConverter_GetLatency(converter, &latency));
+        EXPECT_DOUBLE_EQ(0.0, latency);
+
+        R2samplerMultiStageRateConverter_Destroy(converter);
+    }
+}
+
+/* 残りのサンプルの出力（ドレイン）テスト */
+TEST(R2samplerMultiStageRateConverterTest, DrainTest)
+{
+    /* 入力の後にゼロを入れた場合と一致し、遅延を含めた長さだけ出力される */
+    {
+#define NUMSAMPLES 1000
+#define MAX_NUM_INPUT_SAMPLES 64
+        static const uint32_t rates[][2] = { { 44100, 48000 }, { 48000, 16000 }, { 8000, 48000 } };
+        uint32_t r, i;
+
+        for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+            struct R2samplerMultiStageRateConverter *converter[2];
+            struct R2samplerMultiStageRateConverterConfig config;
+            float *input, *output[2], zeros[MAX_NUM_INPUT_SAMPLES];
+            uint32_t num_outputs, num_total_outputs[2], num_buffer_samples;
+            double latency;
+
+            config.single.max_num_input_samples = MAX_NUM_INPUT_SAMPLES;
+            config.single.input_rate = rates[r][0];
+            config.single.output_rate = rates[r][1];
+            config.single.filter_type = R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW;
+            config.single.filter_order = 0;
+            config.single.filter_cache = NULL;
+            config.single.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.single.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.single.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.single.allocator = NULL;
+            config.single.stopband_attenuation = 80.0;
+            config.single.transition_width = 0.2;
+            config.single.stopband_weight = 1.0;
+            config.max_num_stages = R2SAMPLER_MAX_NUM_STAGES;
+            converter[0] = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter[0] != NULL);
+            converter[1] = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter[1] != NULL);
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerMultiStageRateConverter_GetLatency(converter[0], &latency));
+
+            num_buffer_samples = R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(MAX_NUM_INPUT_SAMPLES, rates[r][0], rates[r][1]);
+            input = (float *)malloc(sizeof(float) * NUMSAMPLES);
+            output[0] = (float *)malloc(sizeof(float) * NUMSAMPLES * 8);
+            output[1] = (float *)malloc(sizeof(float) * (NUMSAMPLES * 8 + num_buffer_samples));
+            for (i = 0; i < NUMSAMPLES; i++) {
+                input[i] = (float)sin(0.05 * i);
+            }
+            for (i = 0; i < MAX_NUM_INPUT_SAMPLES; i++) {
+                zeros[i] = 0.0f;
+            }
+
+            /* 同じ入力を処理（バッファ不足で失敗した呼び出しは状態を変えない） */
+            num_total_outputs[0] = num_total_outputs[1] = 0;
+            for (i = 0; i < NUMSAMPLES; i += MAX_NUM_INPUT_SAMPLES) {
+                const uint32_t num_process_samples = R2SAMPLERMSRATECONVERTER_MIN(MAX_NUM_INPUT_SAMPLES, NUMSAMPLES - i);
+                if (R2samplerMultiStageRateConverter_GetNumOutputSamples(converter[0], num_process_samples) > 0) {
+                    EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER,
+                            R2samplerMultiStageRateConverter_Process(converter[0], &input[i], num_process_samples,
+                                &output[0][num_total_outputs[0]], 0, &num_outputs));
+                }
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerMultiStageRateConverter_Process(converter[0], &input[i], num_process_samples,
+                            &output[0][num_total_outputs[0]], num_buffer_samples, &num_outputs));
+                num_total_outputs[0] += num_outputs;
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerMultiStageRateConverter_Process(converter[1], &input[i], num_process_samples,
+                            &output[1][num_total_outputs[1]], num_buffer_samples, &num_outputs));
+                num_total_outputs[1] += num_outputs;
+            }
+
+            /* 一方はドレイン、もう一方はゼロを入力 */
+            EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER,
+                    R2samplerMultiStageRateConverter_Drain(converter[0], &output[0][num_total_outputs[0]], 0, &num_outputs));
+            do {
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerMultiStageRateConverter_Drain(converter[0], &output[0][num_total_outputs[0]], num_buffer_samples, &num_outputs));
+                num_total_outputs[0] += num_outputs;
+            } while (num_outputs > 0);
+            while (num_total_outputs[1] < num_total_outputs[0]) {
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerMultiStageRateConverter_Process(converter[1], zeros, MAX_NUM_INPUT_SAMPLES,
+                            &output[1][num_total_outputs[1]], num_buffer_samples, &num_outputs));
+                num_total_outputs[1] += num_outputs;
+            }
+
+            /* 出力サンプル数は入力サンプル数を変換比で換算し遅延分を加えたもの */
+            EXPECT_EQ((uint32_t)ceil((double)NUMSAMPLES * rates[r][1] / rates[r][0] + latency), num_total_outputs[0]);
+            for (i = 0; i < num_total_outputs[0]; i++) {
+                EXPECT_FLOAT_EQ(output[1][i], output[0][i]);
+            }
+
+            /* 出力し終えた後は何も出力しない */
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerMultiStageRateConverter_Drain(converter[0], output[0], num_buffer_samples, &num_outputs));
+            EXPECT_EQ(0, num_outputs);
+
+            R2samplerMultiStageRateConverter_Destroy(converter[0]);
+            R2samplerMultiStageRateConverter_Destroy(converter[1]);
+            free(input);
+            free(output[0]);
+            free(output[1]);
+        }
+#undef NUMSAMPLES
+#undef MAX_NUM_INPUT_SAMPLES
+    }
+
+    /* 不正な引数 */
+    {
+        float output[64];
+        uint32_t num_outputs;
+        struct R2samplerMultiStageRateConverter *converter;
+        struct R2samplerMultiStageRateConverterConfig config;
+
+        R2samplerMultiStageRateConverter_SetValidConfig(&config);
+        converter = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerMultiStageRateConverter_Drain(NULL, output, 64, &num_outputs));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerMultiStageRateConverter_Drain(converter, NULL, 64, &num_outputs));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerMultiStageRateConverter_Drain(converter, output, 64, NULL));
+
+        R2samplerMultiStageRateConverter_Destroy(converter);
+    }
+}
+
+/* 省メモリモードのテスト */
+TEST(R2samplerMultiStageRateConverterTest, CompactMemoryTest)
+{
+#define NUMSAMPLES 10000
+#define MAX_NUM_INPUT_SAMPLES 4096
+    static const uint32_t rates[][2] = { { 44100, 48000 }, { 48000, 44100 }, { 48000, 16000 }, { 8000, 48000 } };
+    uint32_t r, k, i;
+
+    for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        struct R2samplerMultiStageRateConverter *converter[2];
+        struct R2samplerMultiStageRateConverterConfig config;
+        struct R2samplerWorkSizeBreakdown breakdown[2];
+        float *input, *output[2];
+        uint32_t num_outputs, num_total_outputs[2], num_buffer_samples, max_num_outputs;
+
+        config.single.max_num_input_samples = MAX_NUM_INPUT_SAMPLES;
+        config.single.input_rate = rates[r][0];
+        config.single.output_rate = rates[r][1];
+        config.single.filter_type = R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW;
+        config.single.filter_order = 0;
+        config.single.filter_cache = NULL;
+        config.single.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+        config.single.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+        config.single.allocator = NULL;
+        config.single.stopband_attenuation = 80.0;
+        config.single.transition_width = 0.2;
+        config.single.stopband_weight = 1.0;
+        config.max_num_stages = R2SAMPLER_MAX_NUM_STAGES;
+
+        num_buffer_samples = R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(MAX_NUM_INPUT_SAMPLES, rates[r][0], rates[r][1]);
+        max_num_outputs = 2 * R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(NUMSAMPLES, rates[r][0], rates[r][1]) + num_buffer_samples;
+        input = (float *)malloc(sizeof(float) * NUMSAMPLES);
+        output[0] = (float *)malloc(sizeof(float) * max_num_outputs);
+        output[1] = (float *)malloc(sizeof(float) * max_num_outputs);
+        for (i = 0; i < NUMSAMPLES; i++) {
+            input[i] = (float)sin(0.05 * i);
+        }
+
+        /* 通常モードと省メモリモードで同じ入力を処理しドレインまで行う */
+        for (k = 0; k < 2; k++) {
+            config.single.memory_mode = (k == 0) ? R2SAMPLER_MEMORYMODE_NORMAL : R2SAMPLER_MEMORYMODE_COMPACT;
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerMultiStageRateConverter_CalculateWorkSizeBreakdown(&config, &breakdown[k]));
+            EXPECT_EQ(R2samplerMultiStageRateConverter_CalculateWorkSize(&config), breakdown[k].total);
+            EXPECT_EQ(breakdown[k].total,
+                    breakdown[k].coefficients + breakdown[k].history + breakdown[k].staging + breakdown[k].design + breakdown[k].other);
+            converter[k] = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter[k] != NULL);
+            num_total_outputs[k] = 0;
+            for (i = 0; i < NUMSAMPLES; i += MAX_NUM_INPUT_SAMPLES) {
+                const uint32_t num_process_samples = R2SAMPLERMSRATECONVERTER_MIN(MAX_NUM_INPUT_SAMPLES, NUMSAMPLES - i);
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerMultiStageRateConverter_Process(converter[k], &input[i], num_process_samples,
+                            &output[k][num_total_outputs[k]], num_buffer_samples, &num_outputs));
+                num_total_outputs[k] += num_outputs;
+            }
+            do {
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerMultiStageRateConverter_Drain(converter[k], &output[k][num_total_outputs[k]], num_buffer_samples, &num_outputs));
+                num_total_outputs[k] += num_outputs;
+            } while (num_outputs > 0);
+            ASSERT_TRUE(num_total_outputs[k] <= max_num_outputs);
+        }
+
+        /* 係数は同じで、バッファが小さくなる */
+        EXPECT_EQ(breakdown[0].coefficients, breakdown[1].coefficients);
+        EXPECT_TRUE(breakdown[1].history < breakdown[0].history);
+        EXPECT_TRUE(breakdown[1].staging < breakdown[0].staging);
+        EXPECT_TRUE(converter[1]->max_num_block_samples < MAX_NUM_INPUT_SAMPLES);
+
+        /* 出力は一致 */
+        ASSERT_EQ(num_total_outputs[0], num_total_outputs[1]);
+        for (i = 0; i < num_total_outputs[0]; i++) {
+            ASSERT_FLOAT_EQ(output[0][i], output[1][i]);
+        }
+
+        R2samplerMultiStageRateConverter_Destroy(converter[0]);
+        R2samplerMultiStageRateConverter_Destroy(converter[1]);
+        free(input);
+        free(output[0]);
+        free(output[1]);
+    }
+
+    /* 不正な引数 */
+    {
+        struct R2samplerWorkSizeBreakdown breakdown;
+        struct R2samplerMultiStageRateConverterConfig config;
+
+        R2samplerMultiStageRateConverter_SetValidConfig(&config);
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerMultiStageRateConverter_CalculateWorkSizeBreakdown(NULL, &breakdown));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerMultiStageRateConverter_CalculateWorkSizeBreakdown(&config, NULL));
+    }
+#undef NUMSAMPLES
+#undef MAX_NUM_INPUT_SAMPLES
+}
+
+/* 処理バッファサイズのテスト */
+TEST(R2samplerMultiStageRateConverterTest, ProcessBufferSizeTest)
+{
+#define MAX_NUM_INPUT_SAMPLES 4096
+#define NUM_BLOCKS 4
+    static const uint32_t rates[][2] = { { 44100, 48000 }, { 48000, 44100 }, { 48000, 16000 }, { 8000, 48000 }, { 44100, 96000 } };
+    uint32_t r, i, j;
+
+    for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        struct R2samplerMultiStageRateConverter *converter;
+        struct R2samplerMultiStageRateConverterConfig config;
+        float *input, *output;
+        uint32_t gcd, num_stages, num_samples, num_outputs, max_num_outputs, max_num_stage_outputs[2];
+        struct R2samplerMultiStageUpDownRateConfig udconfig[R2SAMPLER_MAX_NUM_STAGES];
+
+        config.single.max_num_input_samples = MAX_NUM_INPUT_SAMPLES;
+        config.single.input_rate = rates[r][0];
+        config.single.output_rate = rates[r][1];
+        config.single.filter_type = R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW;
+        config.single.filter_order = 0;
+        config.single.filter_cache = NULL;
+        config.single.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+        config.single.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+        config.single.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+        config.single.allocator = NULL;
+        config.single.stopband_attenuation = 80.0;
+        config.single.transition_width = 0.2;
+        config.single.stopband_weight = 1.0;
+        config.max_num_stages = R2SAMPLER_MAX_NUM_STAGES;
+
+        converter = R2samplerMultiStageRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+
+        /* 各ステージの出力が収まり、合計は全体のアップレート倍のバッファ2本分より小さい */
+        gcd = R2sampler_GCD(rates[r][0], rates[r][1]);
+        R2samplerMultiStageRateConverter_PlanStages(&config.single,
+                rates[r][1] / gcd, rates[r][0] / gcd, udconfig, config.max_num_stages, &num_stages);
+        ASSERT_EQ(num_stages, converter->num_stages);
+        num_samples = MAX_NUM_INPUT_SAMPLES;
+        max_num_stage_outputs[0] = num_samples;
+        max_num_stage_outputs[1] = 0;
+        for (i = 0; i < num_stages; i++) {
+            num_samples = R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(num_samples, udconfig[i].down_rate, udconfig[i].up_rate);
+            EXPECT_TRUE(num_samples <= converter->max_num_buffer_samples[(i + 1) % 2]);
+            max_num_stage_outputs[(i + 1) % 2] = R2SAMPLERMSRATECONVERTER_MAX(max_num_stage_outputs[(i + 1) % 2], num_samples);
+        }
+        EXPECT_EQ(max_num_stage_outputs[0], converter->max_num_buffer_samples[0]);
+        EXPECT_EQ(max_num_stage_outputs[1], converter->max_num_buffer_samples[1]);
+        EXPECT_EQ(num_samples, R2samplerMultiStageRateConverter_CalculateMaxNumOutputSamples(&config));
+        EXPECT_TRUE(converter->max_num_buffer_samples[0] + converter->max_num_buffer_samples[1]
+                < 2 * (rates[r][1] / gcd) * MAX_NUM_INPUT_SAMPLES);
+
+        /* 最大入力数で繰り返し処理しても出力数は上限内 */
+        max_num_outputs = R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(MAX_NUM_INPUT_SAMPLES, rates[r][0], rates[r][1]);
+        input = (float *)malloc(sizeof(float) * MAX_NUM_INPUT_SAMPLES);
+        output = (float *)malloc(sizeof(float) * max_num_outputs);
+        for (i = 0; i < MAX_NUM_INPUT_SAMPLES; i++) {
+            input[i] = (float)sin(0.05 * i);
+        }
+        for (j = 0; j < NUM_BLOCKS; j++) {
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerMultiStageRateConverter_Process(converter, input, MAX_NUM_INPUT_SAMPLES, output, max_num_outputs, &num_outputs));
+            EXPECT_TRUE(num_outputs <= max_num_outputs);
+        }
+
+        R2samplerMultiStageRateConverter_Destroy(converter);
+        free(input);
+        free(output);
+    }
+#undef MAX_NUM_INPUT_SAMPLES
+#undef NUM_BLOCKS
+}
@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 #include <gtest/gtest.h>
 
@@ -20,6 +21,11 @@ TEST(R2samplerRateConverterTest, CreateDestroyHandleTest)
         config__p->output_rate              = 48000;\
         config__p->filter_type              = R2SAMPLER_FILTERTYPE_NONE;\
         config__p->filter_order             = 1;\
+        config__p->filter_cache             = NULL;\
+        config__p->convolution_method       = R2SAMPLER_CONVOLUTION_DIRECT;\
+        config__p->filter_phase             = R2SAMPLER_FILTERPHASE_LINEAR;\
+        config__p->memory_mode              = R2SAMPLER_MEMORYMODE_NORMAL;\
+        config__p->allocator                = NULL;\
     } while (0);
 
     /* ワークサイズ計算テスト */
@@ -65,8 +71,8 @@ TEST(R2samplerRateConverterTest, CreateDestroyHandleTest)
         EXPECT_TRUE(converter->work == work);
         EXPECT_EQ(0, converter->alloc_by_own);
         EXPECT_TRUE(converter->output_buffer != NULL);
-        EXPECT_TRUE(converter->interp_buffer != NULL);
         EXPECT_TRUE(converter->filter_coef != NULL);
+        EXPECT_TRUE(converter->polyphase_coef != NULL);
         EXPECT_EQ(config.filter_order, converter->filter_order);
 
         R2samplerRateConverter_Destroy(converter);
@@ -85,8 +91,8 @@ TEST(R2samplerRateConverterTest, CreateDestroyHandleTest)
         EXPECT_TRUE(converter->work != NULL);
         EXPECT_EQ(1, converter->alloc_by_own);
         EXPECT_TRUE(converter->output_buffer != NULL);
-        EXPECT_TRUE(converter->interp_buffer != NULL);
         EXPECT_TRUE(converter->filter_coef != NULL);
+        EXPECT_TRUE(converter->polyphase_coef != NULL);
         EXPECT_EQ(config.filter_order, converter->filter_order);
 
         R2samplerRateConverter_Destroy(converter);
@@ -158,6 +164,80 @@ TEST(R2samplerRateConverterTest, CreateDestroyHandleTest)
         config.output_rate = 0;
         converter = R2samplerRateConverter_Create(&config, NULL, 0);
         EXPECT_TRUE(converter == NULL);
+
+        R2samplerRateConverter_SetValidConfig(&config);
+        config.convolution_method = (R2samplerConvolutionMethod)-1;
+        converter = R2samplerRateConverter_Create(&config, NULL, 0);
+        EXPECT_TRUE(converter == NULL);
+    }
+
+    /* 既定値で初期化したコンフィグによるハンドル作成 */
+    {
+        struct R2samplerRateConverter *converter;
+        struct R2samplerRateConverterConfig config;
+
+        memset(&config, 0xFF, sizeof(config));
+        ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerRateConverter_InitializeConfig(&config));
+        EXPECT_EQ(R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW, config.filter_type);
+        EXPECT_EQ(1.0, config.stopband_weight);
+        EXPECT_TRUE(config.filter_cache == NULL);
+        EXPECT_TRUE(config.allocator == NULL);
+
+        /* 入出力レートを設定するまでは作成できない */
+        EXPECT_TRUE(R2samplerRateConverter_Create(&config, NULL, 0) == NULL);
+
+        config.max_num_input_samples = 32;
+        config.input_rate = 44100;
+        config.output_rate = 48000;
+        converter = R2samplerRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        R2samplerRateConverter_Destroy(converter);
+
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerRateConverter_InitializeConfig(NULL));
+    }
+}
+
+/* ポリフェーズフィルタ係数作成テスト */
+TEST(R2samplerRateConverterTest, PolyphaseCoefTest)
+{
+    {
+        uint32_t i, phase, order;
+        struct R2samplerRateConverter *converter;
+        struct R2samplerRateConverterConfig config;
+
+        for (order = 1; order <= 63; order += 2) {
+            config.max_num_input_samples = 16;
+            config.input_rate = 44100;
+            config.output_rate = 48000;
+            config.filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+            config.filter_order = order;
+            config.filter_cache = NULL;
+            config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.allocator = NULL;
+            converter = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter != NULL);
+
+            /* 位相あたりのタップ数は切り上げ単位の倍数 */
+            EXPECT_EQ(0, converter->num_polyphase_taps % R2SAMPLERRATECONVERTER_POLYPHASE_TAPS_UNIT);
+            EXPECT_TRUE(converter->num_polyphase_taps * converter->up_rate >= order);
+
+            /* 元の係数がup_rate間隔で並び、範囲外は0 */
+            for (phase = 0; phase < converter->up_rate; phase++) {
+                const float *pcoef = &converter->polyphase_coef[phase * converter->num_polyphase_taps];
+                for (i = 0; i < converter->num_polyphase_taps; i++) {
+                    const uint32_t idx = phase + i * converter->up_rate;
+                    if (idx < order) {
+                        EXPECT_EQ(converter->filter_coef[idx], pcoef[i]);
+                    } else {
+                        EXPECT_EQ(0.0f, pcoef[i]);
+                    }
+                }
+            }
+
+            R2samplerRateConverter_Destroy(converter);
+        }
     }
 }
 
@@ -188,6 +268,11 @@ TEST(R2samplerRateConverterTest, RateConvertTest)
             config.output_rate = rate;
             config.filter_type = R2SAMPLER_FILTERTYPE_NONE;
             config.filter_order = 1;
+            config.filter_cache = NULL;
+            config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.allocator = NULL;
             converter = R2samplerRateConverter_Create(&config, NULL, 0);
             ASSERT_TRUE(converter != NULL);
 
@@ -256,6 +341,11 @@ TEST(R2samplerRateConverterTest, RateConvertTest)
             config.output_rate = 1;
             config.filter_type = R2SAMPLER_FILTERTYPE_NONE;
             config.filter_order = 1;
+            config.filter_cache = NULL;
+            config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.allocator = NULL;
             converter = R2samplerRateConverter_Create(&config, NULL, 0);
             ASSERT_TRUE(converter != NULL);
 
@@ -331,6 +421,11 @@ TEST(R2samplerRateConverterTest, RateConvertTest)
                 config.output_rate = out_rate;
                 config.filter_type = R2SAMPLER_FILTERTYPE_NONE;
                 config.filter_order = 1;
+                config.filter_cache = NULL;
+                config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+                config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+                config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+                config.allocator = NULL;
 
                 converter = R2samplerRateConverter_Create(&config, NULL, 0);
                 ASSERT_TRUE(converter != NULL);
@@ -398,6 +493,11 @@ TEST(R2samplerRateConverterTest, RateConvertTest)
             config.output_rate = rate;
             config.filter_type = R2SAMPLER_FILTERTYPE_LPF_HANNWINDOW;
             config.filter_order = 3;
+            config.filter_cache = NULL;
+            config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.allocator = NULL;
             converter = R2samplerRateConverter_Create(&config, NULL, 0);
             ASSERT_TRUE(converter != NULL);
 
@@ -467,6 +567,11 @@ TEST(R2samplerRateConverterTest, RateConvertTest)
             config.output_rate = 1;
             config.filter_type = R2SAMPLER_FILTERTYPE_LPF_HANNWINDOW;
             config.filter_order = 1;
+            config.filter_cache = NULL;
+            config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.allocator = NULL;
             converter = R2samplerRateConverter_Create(&config, NULL, 0);
             ASSERT_TRUE(converter != NULL);
 
@@ -513,3 +618,1234 @@ TEST(R2samplerRateConverterTest, RateConvertTest)
     }
 
 }
+
+/* ゼロ値挿入による素朴な実装との一致確認テスト */
+TEST(R2samplerRateConverterTest, CompareWithNaiveImplementationTest)
+{
+    {
+#define NUMSAMPLES 512
+#define NUMINPUTS 7
+        uint32_t i, j;
+        struct RateConvertTestCase {
+            uint32_t input_rate;
+            uint32_t output_rate;
+            uint32_t filter_order;
+        };
+        static const struct RateConvertTestCase test_cases[] = {
+            { 44100, 48000, 31 }, { 48000, 44100, 31 },
+            { 1, 3, 5 }, { 3, 1, 5 }, { 2, 5, 63 }, { 5, 2, 63 },
+            { 1, 7, 3 }, { 7, 1, 3 }, { 3, 4, 1 }, { 4, 3, 1 },
+            { 1, 2, 31 }, { 2, 1, 31 }, { 1, 2, 33 }, { 2, 1, 33 },
+            { 1, 2, 3 }, { 2, 1, 5 },
+        };
+        const uint32_t num_test_cases = sizeof(test_cases) / sizeof(test_cases[0]);
+
+        for (i = 0; i < num_test_cases; i++) {
+            const struct RateConvertTestCase *ptest = &test_cases[i];
+            struct R2samplerRateConverter *converter;
+            struct R2samplerRateConverterConfig config;
+            uint32_t in_prog, out_prog, up_rate, down_rate, num_buffer_samples, num_interp_samples;
+            float *input, *output, *interp;
+
+            config.max_num_input_samples = NUMINPUTS;
+            config.input_rate = ptest->input_rate;
+            config.output_rate = ptest->output_rate;
+            config.filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+            config.filter_order = ptest->filter_order;
+            config.filter_cache = NULL;
+            config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.allocator = NULL;
+            converter = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter != NULL);
+            up_rate = converter->up_rate;
+            down_rate = converter->down_rate;
+
+            num_buffer_samples = R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(NUMSAMPLES, ptest->input_rate, ptest->output_rate);
+            input = (float *)malloc(sizeof(float) * NUMSAMPLES);
+            output = (float *)malloc(sizeof(float) * num_buffer_samples);
+            for (j = 0; j < NUMSAMPLES; j++) {
+                input[j] = (float)sin(0.1 * j) + 0.25f * (float)cos(0.77 * j);
+            }
+
+            /* 入力サンプル数を変えながら変換 */
+            in_prog = out_prog = 0;
+            while (in_prog < NUMSAMPLES) {
+                uint32_t num_outputs;
+                const uint32_t num_inputs = R2SAMPLERRATECONVERTER_MIN(1 + (in_prog % NUMINPUTS), NUMSAMPLES - in_prog);
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerRateConverter_Process(converter,
+                            &input[in_prog], num_inputs,
+                            &output[out_prog], num_buffer_samples - out_prog, &num_outputs));
+                in_prog += num_inputs;
+                out_prog += num_outputs;
+            }
+            EXPECT_EQ((NUMSAMPLES * up_rate) / down_rate, out_prog);
+
+            /* 遅延挿入+ゼロ値挿入した系列を作成 */
+            num_interp_samples = (config.filter_order - 1) + NUMSAMPLES * up_rate;
+            interp = (float *)calloc(num_interp_samples, sizeof(float));
+            for (j = 0; j < NUMSAMPLES; j++) {
+                interp[(config.filter_order - 1) + j * up_rate] = input[j];
+            }
+
+            /* 素朴な畳み込み結果と比較 */
+            for (j = 0; j < out_prog; j++) {
+                uint32_t k;
+                double ref = 0.0;
+                for (k = 0; k < config.filter_order; k++) {
+                    ref += interp[j * down_rate + k] * converter->filter_coef[k];
+                }
+                EXPECT_NEAR(ref, output[j], 1.0e-5);
+            }
+
+            R2samplerRateConverter_Destroy(converter);
+            free(interp);
+            free(output);
+            free(input);
+        }
+#undef NUMSAMPLES
+#undef NUMINPUTS
+    }
+}
+
+/* ハーフバンドフィルタ処理の選択テスト */
+TEST(R2samplerRateConverterTest, HalfBandTest)
+{
+    {
+        uint32_t i, r, order;
+        static const uint32_t rates[][2] = { { 1, 2 }, { 2, 1 }, { 44100, 88200 }, { 96000, 48000 } };
+        struct R2samplerRateConverter *converter;
+        struct R2samplerRateConverterConfig config;
+
+        for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+            for (order = 3; order <= 65; order += 2) {
+                uint32_t center;
+                config.max_num_input_samples = 16;
+                config.input_rate = rates[r][0];
+                config.output_rate = rates[r][1];
+                config.filter_type = R2SAMPLER_FILTERTYPE_LPF_NUTTALLWINDOW;
+                config.filter_order = order;
+                config.filter_cache = NULL;
+                config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+                config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+                config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+                config.allocator = NULL;
+                converter = R2samplerRateConverter_Create(&config, NULL, 0);
+                ASSERT_TRUE(converter != NULL);
+                EXPECT_EQ(1, converter->half_band);
+
+                /* 中央から偶数オフセットの係数は厳密にゼロ */
+                center = (order - 1) / 2;
+                for (i = 0; i < order; i++) {
+                    if ((i != center) && (((i + center) % 2) == 0)) {
+                        EXPECT_EQ(0.0f, converter->filter_coef[i]);
+                    }
+                }
+                EXPECT_FLOAT_EQ(0.5f * converter->up_rate, converter->half_band_center_coef);
+
+                /* 非ゼロ係数の前半が並ぶ */
+                EXPECT_EQ((order + 1) / 4, converter->num_half_band_pairs);
+                for (i = 0; i < converter->num_half_band_pairs; i++) {
+                    EXPECT_EQ(converter->filter_coef[converter->half_band_offset + 2 * i], converter->half_band_coef[i]);
+                    EXPECT_NE(0.0f, converter->half_band_coef[i]);
+                }
+
+                R2samplerRateConverter_Destroy(converter);
+            }
+        }
+    }
+
+    /* 2倍/1/2倍以外ではハーフバンド処理しない */
+    {
+        static const uint32_t rates[][2] = { { 1, 3 }, { 3, 2 }, { 1, 4 }, { 1, 1 } };
+        uint32_t r;
+        struct R2samplerRateConverter *converter;
+        struct R2samplerRateConverterConfig config;
+
+        for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+            config.max_num_input_samples = 16;
+            config.input_rate = rates[r][0];
+            config.output_rate = rates[r][1];
+            config.filter_type = R2SAMPLER_FILTERTYPE_LPF_NUTTALLWINDOW;
+            config.filter_order = 31;
+            config.filter_cache = NULL;
+            config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.allocator = NULL;
+            converter = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter != NULL);
+            EXPECT_EQ(0, converter->half_band);
+            R2samplerRateConverter_Destroy(converter);
+        }
+    }
+
+    /* 仕様から設計するフィルタは帯域端が0.25に対称な場合のみハーフバンド処理 */
+    {
+        static const R2samplerFilterType filter_types[] = {
+            R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW, R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE,
+            R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES
+        };
+        static const uint32_t rates[][2] = { { 1, 2 }, { 2, 1 } };
+        uint32_t f, r, i, center;
+        struct R2samplerRateConverter *converter;
+        struct R2samplerRateConverterConfig config;
+        struct R2samplerFilterBandEdges band_edges;
+
+        for (f = 0; f < sizeof(filter_types) / sizeof(filter_types[0]); f++) {
+            for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+                R2samplerRateConverter_InitializeConfig(&config);
+                config.max_num_input_samples = 16;
+                config.input_rate = rates[r][0];
+                config.output_rate = rates[r][1];
+                config.filter_type = filter_types[f];
+                config.stopband_attenuation = 80.0;
+                config.stopband_weight = 1.0;
+
+                /* 対称な帯域端 */
+                band_edges.passband_edge = 0.2;
+                band_edges.stopband_edge = 0.3;
+                converter = R2samplerRateConverter_CreateWithBandEdges(&config, 1, &band_edges, NULL, 0);
+                ASSERT_TRUE(converter != NULL);
+                EXPECT_EQ(1, converter->half_band);
+                center = (converter->filter_order - 1) / 2;
+                for (i = 0; i < converter->filter_order; i++) {
+                    if ((i != center) && (((i + center) % 2) == 0)) {
+                        EXPECT_EQ(0.0f, converter->filter_coef[i]);
+                    }
+                }
+                EXPECT_NEAR(0.5f * converter->up_rate, converter->half_band_center_coef, 1.0e-3);
+                for (i = 0; i < converter->num_half_band_pairs; i++) {
+                    EXPECT_EQ(converter->filter_coef[converter->half_band_offset + 2 * i], converter->half_band_coef[i]);
+                }
+                R2samplerRateConverter_Destroy(converter);
+
+                /* 非対称な帯域端（コンフィグの遷移帯域幅による既定の帯域端も非対称） */
+                band_edges.passband_edge = 0.2;
+                band_edges.stopband_edge = 0.25;
+                converter = R2samplerRateConverter_CreateWithBandEdges(&config, 1, &band_edges, NULL, 0);
+                ASSERT_TRUE(converter != NULL);
+                EXPECT_EQ(0, converter->half_band);
+                R2samplerRateConverter_Destroy(converter);
+                converter = R2samplerRateConverter_Create(&config, NULL, 0);
+                ASSERT_TRUE(converter != NULL);
+                EXPECT_EQ(0, converter->half_band);
+                R2samplerRateConverter_Destroy(converter);
+
+                /* 最小位相では係数が非対称 */
+                config.filter_phase = R2SAMPLER_FILTERPHASE_MINIMUM;
+                band_edges.passband_edge = 0.2;
+                band_edges.stopband_edge = 0.3;
+                converter = R2samplerRateConverter_CreateWithBandEdges(&config, 1, &band_edges, NULL, 0);
+                ASSERT_TRUE(converter != NULL);
+                EXPECT_EQ(0, converter->half_band);
+                R2samplerRateConverter_Destroy(converter);
+            }
+        }
+
+        /* 最小二乗は帯域の重みが等しくないと0.25に対称な応答にならない */
+        R2samplerRateConverter_InitializeConfig(&config);
+        config.max_num_input_samples = 16;
+        config.input_rate = 2;
+        config.output_rate = 1;
+        config.filter_type = R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES;
+        config.stopband_attenuation = 80.0;
+        config.stopband_weight = 100.0;
+        band_edges.passband_edge = 0.2;
+        band_edges.stopband_edge = 0.3;
+        converter = R2samplerRateConverter_CreateWithBandEdges(&config, 1, &band_edges, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        EXPECT_EQ(0, converter->half_band);
+        R2samplerRateConverter_Destroy(converter);
+    }
+}
+
+/* カイザー窓による次数自動決定テスト */
+TEST(R2samplerRateConverterTest, KaiserWindowTest)
+{
+    /* 指定した仕様から奇数次数が決まる */
+    {
+        struct R2samplerRateConverter *converter;
+        struct R2samplerRateConverterConfig config;
+        uint32_t order_60db, order_100db;
+
+        config.max_num_input_samples = 16;
+        config.input_rate = 44100;
+        config.output_rate = 48000;
+        config.filter_type = R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW;
+        config.filter_order = 0;
+        config.filter_cache = NULL;
+        config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+        config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+        config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+        config.allocator = NULL;
+        config.stopband_attenuation = 60.0;
+        config.transition_width = 0.2;
+        converter = R2samplerRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        order_60db = converter->filter_order;
+        EXPECT_EQ(1, order_60db % 2);
+        EXPECT_EQ(R2sampler_CalculateKaiserFilterOrder(60.0, 0.2 * 0.5 / 160), order_60db);
+        R2samplerRateConverter_Destroy(converter);
+
+        /* 減衰量を増やすと次数も増える */
+        config.stopband_attenuation = 100.0;
+        converter = R2samplerRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        order_100db = converter->filter_order;
+        EXPECT_GT(order_100db, order_60db);
+        R2samplerRateConverter_Destroy(converter);
+
+        /* 次数を指定した場合はその次数を使用 */
+        config.filter_order = 31;
+        config.filter_cache = NULL;
+        config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+        config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+        config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+        config.allocator = NULL;
+        converter = R2samplerRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        EXPECT_EQ(31, converter->filter_order);
+        R2samplerRateConverter_Destroy(converter);
+    }
+
+    /* 不正な仕様 */
+    {
+        struct R2samplerRateConverterConfig config;
+
+        config.max_num_input_samples = 16;
+        config.input_rate = 1;
+        config.output_rate = 2;
+        config.filter_type = R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW;
+        config.filter_order = 0;
+        config.filter_cache = NULL;
+        config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+        config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+        config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+        config.allocator = NULL;
+        config.stopband_attenuation = 0.0;
+        config.transition_width = 0.2;
+        EXPECT_TRUE(R2samplerRateConverter_CalculateWorkSize(&config) < 0);
+        EXPECT_TRUE(R2samplerRateConverter_Create(&config, NULL, 0) == NULL);
+        config.stopband_attenuation = 60.0;
+        config.transition_width = 0.0;
+        EXPECT_TRUE(R2samplerRateConverter_CalculateWorkSize(&config) < 0);
+        config.transition_width = 1.0;
+        EXPECT_TRUE(R2samplerRateConverter_CalculateWorkSize(&config) < 0);
+    }
+
+    /* 阻止域の正弦波が十分に減衰する */
+    {
+#define NUMSAMPLES 4096
+        struct R2samplerRateConverter *converter;
+        struct R2samplerRateConverterConfig config;
+        uint32_t i, num_outputs;
+        float *input, *output;
+        double max_amp;
+
+        config.max_num_input_samples = NUMSAMPLES;
+        config.input_rate = 2;
+        config.output_rate = 1;
+        config.filter_type = R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW;
+        config.filter_order = 0;
+        config.filter_cache = NULL;
+        config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+        config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+        config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+        config.allocator = NULL;
+        config.stopband_attenuation = 80.0;
+        config.transition_width = 0.1;
+        converter = R2samplerRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+
+        /* 出力ナイキスト周波数より上の成分（エイリアスとなる） */
+        input = (float *)malloc(sizeof(float) * NUMSAMPLES);
+        output = (float *)malloc(sizeof(float) * NUMSAMPLES);
+        for (i = 0; i < NUMSAMPLES; i++) {
+            input[i] = (float)sin(2.0 * 3.14159265358979 * 0.3 * i);
+        }
+        ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                R2samplerRateConverter_Process(converter, input, NUMSAMPLES, output, NUMSAMPLES, &num_outputs));
+
+        /* フィルタの立ち上がり後の振幅 */
+        max_amp = 0.0;
+        for (i = converter->filter_order; i < num_outputs; i++) {
+            max_amp = R2SAMPLERRATECONVERTER_MAX(max_amp, fabs(output[i]));
+        }
+        EXPECT_LT(max_amp, pow(10.0, -79.0 / 20.0));
+
+        R2samplerRateConverter_Destroy(converter);
+        free(input);
+        free(output);
+#undef NUMSAMPLES
+    }
+}
+
+/* 等リップルフィルタによる変換テスト */
+TEST(R2samplerRateConverterTest, EquirippleTest)
+{
+    /* 同じ仕様ならカイザー窓より次数が小さい */
+    {
+        struct R2samplerRateConverter *converter;
+        struct R2samplerRateConverterConfig config;
+        uint32_t kaiser_order;
+
+        config.max_num_input_samples = 16;
+        config.input_rate = 3;
+        config.output_rate = 2;
+        config.filter_type = R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW;
+        config.filter_order = 0;
+        config.filter_cache = NULL;
+        config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+        config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+        config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+        config.allocator = NULL;
+        config.stopband_attenuation = 90.0;
+        config.transition_width = 0.1;
+        converter = R2samplerRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        kaiser_order = converter->filter_order;
+        R2samplerRateConverter_Destroy(converter);
+
+        config.filter_type = R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE;
+        converter = R2samplerRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        EXPECT_EQ(1, converter->filter_order % 2);
+        EXPECT_LT(converter->filter_order, kaiser_order);
+        R2samplerRateConverter_Destroy(converter);
+
+        /* 入出力レートが等しい場合も作成可能 */
+        config.input_rate = config.output_rate = 1;
+        converter = R2samplerRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        R2samplerRateConverter_Destroy(converter);
+
+        /* 不正な仕様 */
+        config.stopband_attenuation = -1.0;
+        EXPECT_TRUE(R2samplerRateConverter_CalculateWorkSize(&config) < 0);
+    }
+
+    /* 通過域のリップルと阻止域の減衰量が仕様を満たす */
+    {
+#define NUMSAMPLES 4096
+        static const double attenuations[] = { 60.0, 80.0, 100.0 };
+        struct R2samplerRateConverter *converter;
+        struct R2samplerRateConverterConfig config;
+        uint32_t a, i, num_outputs;
+        float *input, *output;
+
+        input = (float *)malloc(sizeof(float) * NUMSAMPLES);
+        output = (float *)malloc(sizeof(float) * NUMSAMPLES);
+
+        for (a = 0; a < sizeof(attenuations) / sizeof(attenuations[0]); a++) {
+            const double delta = pow(10.0, -attenuations[a] / 20.0);
+            double max_amp;
+
+            config.max_num_input_samples = NUMSAMPLES;
+            config.input_rate = 2;
+            config.output_rate = 1;
+            config.filter_type = R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE;
+            config.filter_order = 0;
+            config.filter_cache = NULL;
+            config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.allocator = NULL;
+            config.stopband_attenuation = attenuations[a];
+            config.transition_width = 0.1;
+
+            /* 阻止域: 出力ナイキスト周波数より上の成分 */
+            converter = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter != NULL);
+            for (i = 0; i < NUMSAMPLES; i++) {
+                input[i] = (float)sin(2.0 * 3.14159265358979 * 0.26 * i);
+            }
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerRateConverter_Process(converter, input, NUMSAMPLES, output, NUMSAMPLES, &num_outputs));
+            max_amp = 0.0;
+            for (i = converter->filter_order; i < num_outputs; i++) {
+                max_amp = R2SAMPLERRATECONVERTER_MAX(max_amp, fabs(output[i]));
+            }
+            EXPECT_LT(max_amp, delta);
+
+            /* 通過域: 通過域端の直流成分（利得が1に近い） */
+            R2samplerRateConverter_Start(converter);
+            for (i = 0; i < NUMSAMPLES; i++) {
+                input[i] = 1.0f;
+            }
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerRateConverter_Process(converter, input, NUMSAMPLES, output, NUMSAMPLES, &num_outputs));
+            for (i = converter->filter_order; i < num_outputs; i++) {
+                EXPECT_NEAR(1.0, output[i], delta + 1.0e-5);
+            }
+
+            R2samplerRateConverter_Destroy(converter);
+        }
+
+        free(input);
+        free(output);
+#undef NUMSAMPLES
+    }
+}
+
+/* 最小二乗法フィルタによる変換テスト */
+TEST(R2samplerRateConverterTest, LeastSquaresTest)
+{
+    /* 自動決定した次数で阻止域の平均電力が仕様を満たす */
+    {
+        static const double attenuations[] = { 40.0, 60.0, 80.0 };
+        static const uint32_t rates[][2] = { { 2, 1 }, { 1, 3 }, { 3, 2 } };
+        uint32_t a, r, i, k;
+
+        for (a = 0; a < sizeof(attenuations) / sizeof(attenuations[0]); a++) {
+            for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+                struct R2samplerRateConverter *converter;
+                struct R2samplerRateConverterConfig config;
+                double nyquist, power;
+
+                config.max_num_input_samples = 16;
+                config.input_rate = rates[r][0];
+                config.output_rate = rates[r][1];
+                config.filter_type = R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES;
+                config.filter_order = 0;
+                config.filter_cache = NULL;
+                config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+                config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+                config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+                config.allocator = NULL;
+                config.stopband_attenuation = attenuations[a];
+                config.transition_width = 0.2;
+                config.stopband_weight = 1.0;
+                converter = R2samplerRateConverter_Create(&config, NULL, 0);
+                ASSERT_TRUE(converter != NULL);
+                EXPECT_EQ(1, converter->filter_order % 2);
+
+                /* 阻止域の平均電力（利得調整分を戻して評価） */
+                nyquist = 0.5 / R2SAMPLERRATECONVERTER_MAX(converter->up_rate, converter->down_rate);
+                power = 0.0;
+                for (i = 0; i <= 1000; i++) {
+                    const double freq = nyquist + (0.5 - nyquist) * i / 1000.0;
+                    double re = 0.0, im = 0.0;
+                    for (k = 0; k < converter->filter_order; k++) {
+                        re += converter->filter_coef[k] * cos(2.0 * 3.14159265358979 * freq * k) / converter->up_rate;
+                        im += converter->filter_coef[k] * sin(2.0 * 3.14159265358979 * freq * k) / converter->up_rate;
+                    }
+                    power += (re * re + im * im) / 1001.0;
+                }
+                EXPECT_LT(10.0 * log10(power), -attenuations[a]);
+
+                R2samplerRateConverter_Destroy(converter);
+            }
+        }
+    }
+
+    /* 不正な重み */
+    {
+        struct R2samplerRateConverterConfig config;
+        config.max_num_input_samples = 16;
+        config.input_rate = 2;
+        config.output_rate = 1;
+        config.filter_type = R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES;
+        config.filter_order = 0;
+        config.filter_cache = NULL;
+        config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+        config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+        config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+        config.allocator = NULL;
+        config.stopband_attenuation = 60.0;
+        config.transition_width = 0.2;
+        config.stopband_weight = 0.0;
+        EXPECT_TRUE(R2samplerRateConverter_CalculateWorkSize(&config) < 0);
+        EXPECT_TRUE(R2samplerRateConverter_Create(&config, NULL, 0) == NULL);
+    }
+}
+
+/* フィルタ係数キャッシュによる係数共有テスト */
+TEST(R2samplerRateConverterTest, FilterCacheTest)
+{
+#define NUMSAMPLES 512
+    static const R2samplerFilterType filter_types[] = {
+        R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW, R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW,
+        R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE, R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES
+    };
+    static const uint32_t rates[][2] = { { 2, 3 }, { 2, 1 } };
+    uint32_t f, r, i;
+    float input[NUMSAMPLES], output[2][NUMSAMPLES * 2];
+    struct R2samplerFilterCache *cache;
+    struct R2samplerFilterCacheConfig cache_config;
+
+    cache_config.max_num_entries = 2;
+    cache_config.max_num_coefficients = 8192;
+    cache_config.lock = cache_config.unlock = NULL;
+    cache_config.lock_context = NULL;
+    cache_config.allocator = NULL;
+    cache = R2samplerFilterCache_Create(&cache_config, NULL, 0);
+    ASSERT_TRUE(cache != NULL);
+
+    srand(0);
+    for (i = 0; i < NUMSAMPLES; i++) {
+        input[i] = 2.0f * ((float)rand() / RAND_MAX - 0.5f);
+    }
+
+    for (f = 0; f < sizeof(filter_types) / sizeof(filter_types[0]); f++) {
+        for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+            uint32_t num_outputs[2];
+            struct R2samplerRateConverter *converter, *shared[2];
+            struct R2samplerRateConverterConfig config;
+
+            config.max_num_input_samples = NUMSAMPLES;
+            config.input_rate = rates[r][0];
+            config.output_rate = rates[r][1];
+            config.filter_type = filter_types[f];
+            config.filter_order = (filter_types[f] == R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW) ? 63 : 0;
+            config.stopband_attenuation = 60.0;
+            config.transition_width = 0.2;
+            config.stopband_weight = 1.0;
+
+            /* キャッシュを使わない参照 */
+            config.filter_cache = NULL;
+            config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.allocator = NULL;
+            converter = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter != NULL);
+
+            /* キャッシュを使うと係数領域の分ワークサイズが小さい */
+            {
+                const int32_t work_size = R2samplerRateConverter_CalculateWorkSize(&config);
+                config.filter_cache = cache;
+                EXPECT_LT(R2samplerRateConverter_CalculateWorkSize(&config), work_size);
+            }
+
+            /* 同じ設定のハンドルは係数を共有 */
+            shared[0] = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(shared[0] != NULL);
+            shared[1] = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(shared[1] != NULL);
+            EXPECT_TRUE(shared[0]->polyphase_coef == shared[1]->polyphase_coef);
+            EXPECT_TRUE(shared[0]->polyphase_coef != converter->polyphase_coef);
+            EXPECT_EQ(shared[0]->half_band, converter->half_band);
+
+            /* 出力は共有しない場合と一致 */
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerRateConverter_Process(converter, input, NUMSAMPLES, output[0], NUMSAMPLES * 2, &num_outputs[0]));
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerRateConverter_Process(shared[1], input, NUMSAMPLES, output[1], NUMSAMPLES * 2, &num_outputs[1]));
+            ASSERT_EQ(num_outputs[0], num_outputs[1]);
+            for (i = 0; i < num_outputs[0]; i++) {
+                EXPECT_FLOAT_EQ(output[0][i], output[1][i]);
+            }
+
+            R2samplerRateConverter_Destroy(converter);
+            R2samplerRateConverter_Destroy(shared[0]);
+            R2samplerRateConverter_Destroy(shared[1]);
+        }
+    }
+
+    /* 全エントリが参照中の場合は作成できない */
+    {
+        struct R2samplerRateConverter *converter[3];
+        struct R2samplerRateConverterConfig config;
+
+        config.max_num_input_samples = NUMSAMPLES;
+        config.filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+        config.filter_order = 31;
+        config.filter_cache = cache;
+        config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+        config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+        config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+        config.allocator = NULL;
+        for (i = 0; i < 3; i++) {
+            config.input_rate = 1;
+            config.output_rate = i + 2;
+            converter[i] = R2samplerRateConverter_Create(&config, NULL, 0);
+        }
+        EXPECT_TRUE(converter[0] != NULL);
+        EXPECT_TRUE(converter[1] != NULL);
+        EXPECT_TRUE(converter[2] == NULL);
+
+        /* 参照が無くなれば作成できる */
+        R2samplerRateConverter_Destroy(converter[0]);
+        converter[2] = R2samplerRateConverter_Create(&config, NULL, 0);
+        EXPECT_TRUE(converter[2] != NULL);
+
+        R2samplerRateConverter_Destroy(converter[1]);
+        R2samplerRateConverter_Destroy(converter[2]);
+    }
+
+    R2samplerFilterCache_Destroy(cache);
+#undef NUMSAMPLES
+}
+
+/* FFTによる畳み込みテスト */
+TEST(R2samplerRateConverterTest, FFTConvolutionTest)
+{
+#define NUMSAMPLES 2048
+#define MAX_NUM_CHANNELS 2
+    static const uint32_t rates[][2] = {
+        { 1, 1 }, { 1, 2 }, { 2, 1 }, { 3, 2 }, { 2, 3 }, { 1, 3 }, { 5, 2 }, { 147, 160 }, { 160, 147 }
+    };
+    static const uint32_t num_input_samples[] = { 1, 7, 64, 1000 };
+    static const uint32_t filter_orders[] = { 1, 63, 511 };
+    uint32_t r, o, n, c, i;
+    float *input, *output[2];
+
+    input = (float *)malloc(sizeof(float) * NUMSAMPLES * MAX_NUM_CHANNELS);
+    srand(0);
+    for (i = 0; i < NUMSAMPLES * MAX_NUM_CHANNELS; i++) {
+        input[i] = 2.0f * ((float)rand() / RAND_MAX - 0.5f);
+    }
+
+    for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        const uint32_t max_num_outputs = R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(NUMSAMPLES, rates[r][0], rates[r][1]);
+        output[0] = (float *)malloc(sizeof(float) * max_num_outputs * MAX_NUM_CHANNELS);
+        output[1] = (float *)malloc(sizeof(float) * max_num_outputs * MAX_NUM_CHANNELS);
+        for (o = 0; o < sizeof(filter_orders) / sizeof(filter_orders[0]); o++) {
+            for (n = 0; n < sizeof(num_input_samples) / sizeof(num_input_samples[0]); n++) {
+                for (c = 1; c <= MAX_NUM_CHANNELS; c++) {
+                    uint32_t m, num_outputs[2];
+                    struct R2samplerRateConverter *converter[2];
+                    struct R2samplerRateConverterConfig config;
+
+                    /* 1回の入力で出力が得られない設定は作成できない */
+                    if ((rates[r][1] * num_input_samples[n]) < rates[r][0]) {
+                        continue;
+                    }
+
+                    config.max_num_input_samples = num_input_samples[n];
+                    config.input_rate = rates[r][0];
+                    config.output_rate = rates[r][1];
+                    config.filter_type = (filter_orders[o] == 1) ? R2SAMPLER_FILTERTYPE_NONE : R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+                    config.filter_order = filter_orders[o];
+                    config.filter_cache = NULL;
+
+                    /* 直接畳み込みとFFTによる畳み込み */
+                    for (m = 0; m < 2; m++) {
+                        uint32_t smpl = 0;
+                        config.convolution_method = (m == 0) ? R2SAMPLER_CONVOLUTION_DIRECT : R2SAMPLER_CONVOLUTION_FFT;
+                        config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+                        config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+                        config.allocator = NULL;
+                        converter[m] = R2samplerRateConverter_CreateMultiChannel(&config, c, NULL, 0);
+                        ASSERT_TRUE(converter[m] != NULL);
+                        num_outputs[m] = 0;
+                        while (smpl < NUMSAMPLES) {
+                            uint32_t num_process_outputs;
+                            const uint32_t num_process_samples = R2SAMPLERRATECONVERTER_MIN(num_input_samples[n], NUMSAMPLES - smpl);
+                            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                                    R2samplerRateConverter_ProcessInterleaved(converter[m],
+                                        &input[smpl * c], num_process_samples,
+                                        &output[m][num_outputs[m] * c], max_num_outputs - num_outputs[m], &num_process_outputs));
+                            num_outputs[m] += num_process_outputs;
+                            smpl += num_process_samples;
+                        }
+                    }
+
+                    /* 出力は一致 */
+                    ASSERT_EQ(num_outputs[0], num_outputs[1]);
+                    for (i = 0; i < num_outputs[0] * c; i++) {
+                        ASSERT_NEAR(output[0][i], output[1][i], 1.0e-4);
+                    }
+
+                    R2samplerRateConverter_Destroy(converter[0]);
+                    R2samplerRateConverter_Destroy(converter[1]);
+                }
+            }
+        }
+        free(output[0]);
+        free(output[1]);
+    }
+
+    free(input);
+#undef NUMSAMPLES
+#undef MAX_NUM_CHANNELS
+}
+
+/* 最小位相フィルタによる変換テスト */
+TEST(R2samplerRateConverterTest, MinimumPhaseTest)
+{
+    static const R2samplerFilterType filter_types[] = {
+        R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW, R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW,
+        R2SAMPLER_FILTERTYPE_LPF_EQUIRIPPLE, R2SAMPLER_FILTERTYPE_LPF_LEASTSQUARES
+    };
+
+    /* 線形位相より遅延が短く、阻止域は同程度に減衰する */
+    {
+#define NUMSAMPLES 4096
+        uint32_t f, i, num_outputs;
+        float *input, *output;
+
+        input = (float *)malloc(sizeof(float) * NUMSAMPLES);
+        output = (float *)malloc(sizeof(float) * NUMSAMPLES);
+
+        /* 出力ナイキスト周波数より上の成分（エイリアスとなる） */
+        for (i = 0; i < NUMSAMPLES; i++) {
+            input[i] = (float)sin(2.0 * 3.14159265358979 * 0.3 * i);
+        }
+
+        for (f = 0; f < sizeof(filter_types) / sizeof(filter_types[0]); f++) {
+            struct R2samplerRateConverter *converter[2];
+            struct R2samplerRateConverterConfig config;
+            double latency[2], max_amp;
+
+            config.max_num_input_samples = NUMSAMPLES;
+            config.input_rate = 2;
+            config.output_rate = 1;
+            config.filter_type = filter_types[f];
+            config.filter_order = (filter_types[f] == R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW) ? 127 : 0;
+            config.filter_cache = NULL;
+            config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.stopband_attenuation = 80.0;
+            config.transition_width = 0.1;
+            config.stopband_weight = 100.0;
+            config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+            config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.allocator = NULL;
+            converter[0] = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter[0] != NULL);
+            config.filter_phase = R2SAMPLER_FILTERPHASE_MINIMUM;
+            converter[1] = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter[1] != NULL);
+
+            /* 係数が非対称になるためハーフバンドとしては処理しない */
+            EXPECT_EQ(0, converter[1]->half_band);
+            EXPECT_EQ(converter[0]->filter_order, converter[1]->filter_order);
+
+            /* 線形位相の遅延は次数の半分 */
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerRateConverter_GetLatency(converter[0], &latency[0]));
+            EXPECT_DOUBLE_EQ((converter[0]->filter_order - 1) / 2.0 / 2.0, latency[0]);
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerRateConverter_GetLatency(converter[1], &latency[1]));
+            EXPECT_GT(latency[1], 0.0);
+            EXPECT_LT(latency[1], latency[0] / 2.0);
+
+            /* フィルタの立ち上がり後の振幅 */
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerRateConverter_Process(converter[1], input, NUMSAMPLES, output, NUMSAMPLES, &num_outputs));
+            max_amp = 0.0;
+            for (i = converter[1]->filter_order; i < num_outputs; i++) {
+                max_amp = R2SAMPLERRATECONVERTER_MAX(max_amp, fabs(output[i]));
+            }
+            EXPECT_LT(max_amp, pow(10.0, -60.0 / 20.0));
+
+            R2samplerRateConverter_Destroy(converter[0]);
+            R2samplerRateConverter_Destroy(converter[1]);
+        }
+
+        free(input);
+        free(output);
+#undef NUMSAMPLES
+    }
+
+    /* ステップ応答が線形位相より早く立ち上がる */
+    {
+#define NUMSAMPLES 128
+        uint32_t p, i, num_outputs;
+        float input[NUMSAMPLES], output[NUMSAMPLES * 3];
+        uint32_t rise[2];
+
+        for (i = 0; i < NUMSAMPLES; i++) {
+            input[i] = 1.0f;
+        }
+
+        for (p = 0; p < 2; p++) {
+            struct R2samplerRateConverter *converter;
+            struct R2samplerRateConverterConfig config;
+
+            config.max_num_input_samples = NUMSAMPLES;
+            config.input_rate = 16000;
+            config.output_rate = 48000;
+            config.filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+            config.filter_order = 255;
+            config.filter_cache = NULL;
+            config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+            config.filter_phase = (p == 0) ? R2SAMPLER_FILTERPHASE_LINEAR : R2SAMPLER_FILTERPHASE_MINIMUM;
+            config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.allocator = NULL;
+            converter = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter != NULL);
+
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerRateConverter_Process(converter, input, NUMSAMPLES, output, NUMSAMPLES * 3, &num_outputs));
+
+            /* 直流利得は保たれる */
+            EXPECT_NEAR(1.0, output[num_outputs - 1], 1.0e-2);
+
+            /* 半分に達するまでのサンプル数 */
+            for (rise[p] = 0; rise[p] < num_outputs; rise[p]++) {
+                if (output[rise[p]] >= 0.5f) {
+                    break;
+                }
+            }
+
+            R2samplerRateConverter_Destroy(converter);
+        }
+        EXPECT_LT(2 * rise[1], rise[0]);
+#undef NUMSAMPLES
+    }
+
+    /* 不正な引数 */
+    {
+        double latency;
+        struct R2samplerRateConverter *converter;
+        struct R2samplerRateConverterConfig config;
+
+        config.max_num_input_samples = 16;
+        config.input_rate = 44100;
+        config.output_rate = 48000;
+        config.filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+        config.filter_order = 31;
+        config.filter_cache = NULL;
+        config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+        config.filter_phase = (R2samplerFilterPhase)-1;
+        config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+        config.allocator = NULL;
+        EXPECT_TRUE(R2samplerRateConverter_CalculateWorkSize(&config) < 0);
+        EXPECT_TRUE(R2samplerRateConverter_Create(&config, NULL, 0) == NULL);
+
+        config.filter_phase = R2SAMPLER_FILTERPHASE_MINIMUM;
+        converter = R2samplerRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerRateConverter_GetLatency(NULL, &latency));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerRateConverter_GetLatency(converter, NULL));
+        R2samplerRateConverter_Destroy(converter);
+    }
+}
+
+/* 残りのサンプルの出力（ドレイン）テスト */
+TEST(R2samplerRateConverterTest, DrainTest)
+{
+    /* 入力の後にゼロを入れた場合と一致し、遅延を含めた長さだけ出力される */
+    {
+#define NUMSAMPLES 100
+#define MAX_NUM_INPUT_SAMPLES 16
+        struct DrainTestCase {
+            uint32_t input_rate;
+            uint32_t output_rate;
+            R2samplerConvolutionMethod convolution_method;
+            R2samplerFilterPhase filter_phase;
+        };
+        static const struct DrainTestCase test_cases[] = {
+            {     1,     3, R2SAMPLER_CONVOLUTION_DIRECT, R2SAMPLER_FILTERPHASE_LINEAR },
+            {     3,     1, R2SAMPLER_CONVOLUTION_DIRECT, R2SAMPLER_FILTERPHASE_LINEAR },
+            {     2,     3, R2SAMPLER_CONVOLUTION_DIRECT, R2SAMPLER_FILTERPHASE_LINEAR },
+            {   160,   147, R2SAMPLER_CONVOLUTION_DIRECT, R2SAMPLER_FILTERPHASE_LINEAR },
+            {     1,     4, R2SAMPLER_CONVOLUTION_FFT,    R2SAMPLER_FILTERPHASE_LINEAR },
+            {     2,     1, R2SAMPLER_CONVOLUTION_DIRECT, R2SAMPLER_FILTERPHASE_MINIMUM },
+            {     2,     3, R2SAMPLER_CONVOLUTION_DIRECT, R2SAMPLER_FILTERPHASE_MINIMUM },
+        };
+        uint32_t t, i;
+
+        for (t = 0; t < sizeof(test_cases) / sizeof(test_cases[0]); t++) {
+            struct R2samplerRateConverter *converter[2];
+            struct R2samplerRateConverterConfig config;
+            float input[NUMSAMPLES], zeros[MAX_NUM_INPUT_SAMPLES];
+            float *output[2];
+            uint32_t num_outputs, num_total_outputs[2], num_buffer_samples;
+            double latency, input_latency;
+
+            config.max_num_input_samples = MAX_NUM_INPUT_SAMPLES;
+            config.input_rate = test_cases[t].input_rate;
+            config.output_rate = test_cases[t].output_rate;
+            config.filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+            config.filter_order = 63;
+            config.filter_cache = NULL;
+            config.convolution_method = test_cases[t].convolution_method;
+            config.filter_phase = test_cases[t].filter_phase;
+            config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+            config.allocator = NULL;
+            converter[0] = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter[0] != NULL);
+            converter[1] = R2samplerRateConverter_Create(&config, NULL, 0);
+            ASSERT_TRUE(converter[1] != NULL);
+
+            /* 入力サンプル単位の遅延は変換比で換算した値 */
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerRateConverter_GetLatency(converter[0], &latency));
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerRateConverter_GetInputLatency(converter[0], &input_latency));
+            EXPECT_NEAR(latency * config.input_rate / config.output_rate, input_latency, 1.0e-9);
+
+            num_buffer_samples = R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(MAX_NUM_INPUT_SAMPLES, config.input_rate, config.output_rate);
+            output[0] = (float *)malloc(sizeof(float) * NUMSAMPLES * 8);
+            output[1] = (float *)malloc(sizeof(float) * NUMSAMPLES * 8);
+            for (i = 0; i < NUMSAMPLES; i++) {
+                input[i] = (float)sin(0.1 * i);
+            }
+            for (i = 0; i < MAX_NUM_INPUT_SAMPLES; i++) {
+                zeros[i] = 0.0f;
+            }
+
+            /* 同じ入力を処理 */
+            num_total_outputs[0] = num_total_outputs[1] = 0;
+            for (i = 0; i < NUMSAMPLES; i += MAX_NUM_INPUT_SAMPLES) {
+                const uint32_t num_process_samples = R2SAMPLERRATECONVERTER_MIN(MAX_NUM_INPUT_SAMPLES, NUMSAMPLES - i);
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerRateConverter_Process(converter[0], &input[i], num_process_samples,
+                            &output[0][num_total_outputs[0]], num_buffer_samples, &num_outputs));
+                num_total_outputs[0] += num_outputs;
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerRateConverter_Process(converter[1], &input[i], num_process_samples,
+                            &output[1][num_total_outputs[1]], num_buffer_samples, &num_outputs));
+                num_total_outputs[1] += num_outputs;
+            }
+
+            /* 一方はドレイン、もう一方はゼロを入力 */
+            do {
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerRateConverter_Drain(converter[0], &output[0][num_total_outputs[0]], num_buffer_samples, &num_outputs));
+                EXPECT_TRUE(num_outputs <= num_buffer_samples);
+                num_total_outputs[0] += num_outputs;
+            } while (num_outputs > 0);
+            while (num_total_outputs[1] < num_total_outputs[0]) {
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerRateConverter_Process(converter[1], zeros, MAX_NUM_INPUT_SAMPLES,
+                            &output[1][num_total_outputs[1]], num_buffer_samples, &num_outputs));
+                num_total_outputs[1] += num_outputs;
+            }
+
+            /* 出力サンプル数は入力サンプル数を変換比で換算し遅延分を加えたもの */
+            EXPECT_EQ((uint32_t)ceil((double)NUMSAMPLES * config.output_rate / config.input_rate + latency), num_total_outputs[0]);
+            for (i = 0; i < num_total_outputs[0]; i++) {
+                EXPECT_NEAR(output[1][i], output[0][i], 1.0e-5);
+            }
+
+            /* 出力し終えた後は何も出力しない */
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerRateConverter_Drain(converter[0], output[0], num_buffer_samples, &num_outputs));
+            EXPECT_EQ(0, num_outputs);
+
+            /* 開始し直すと入力が無い状態からドレインする */
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerRateConverter_Start(converter[0]));
+            num_total_outputs[0] = 0;
+            do {
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                        R2samplerRateConverter_Drain(converter[0], output[0], num_buffer_samples, &num_outputs));
+                num_total_outputs[0] += num_outputs;
+            } while (num_outputs > 0);
+            EXPECT_EQ((uint32_t)ceil(latency), num_total_outputs[0]);
+
+            R2samplerRateConverter_Destroy(converter[0]);
+            R2samplerRateConverter_Destroy(converter[1]);
+            free(output[0]);
+            free(output[1]);
+        }
+#undef NUMSAMPLES
+#undef MAX_NUM_INPUT_SAMPLES
+    }
+
+    /* 不正な引数 */
+    {
+        float output[16];
+        uint32_t num_outputs;
+        double latency;
+        struct R2samplerRateConverter *converter;
+        struct R2samplerRateConverterConfig config;
+
+        config.max_num_input_samples = 16;
+        config.input_rate = 1;
+        config.output_rate = 2;
+        config.filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+        config.filter_order = 31;
+        config.filter_cache = NULL;
+        config.convolution_method = R2SAMPLER_CONVOLUTION_DIRECT;
+        config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+        config.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+        config.allocator = NULL;
+        converter = R2samplerRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerRateConverter_GetInputLatency(NULL, &latency));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerRateConverter_GetInputLatency(converter, NULL));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerRateConverter_Drain(NULL, output, 16, &num_outputs));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerRateConverter_Drain(converter, NULL, 16, &num_outputs));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerRateConverter_Drain(converter, output, 16, NULL));
+
+        /* 残りがあるのにバッファが無い */
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER, R2samplerRateConverter_Drain(converter, output, 0, &num_outputs));
+
+        R2samplerRateConverter_Destroy(converter);
+    }
+}
+
+/* 省メモリモードのテスト */
+TEST(R2samplerRateConverterTest, CompactMemoryTest)
+{
+    /* 出力は通常モードと一致し、ワークサイズは小さくなる */
+    {
+#define NUMSAMPLES 3000
+#define MAX_NUM_INPUT_SAMPLES 1024
+#define MAX_NUM_CHANNELS 2
+        static const uint32_t rates[][2] = {
+            { 1, 2 }, { 2, 1 }, { 3, 2 }, { 2, 3 }, { 147, 160 }, { 160, 147 }
+        };
+        uint32_t r, m, c, i;
+        float *input, *output[2];
+
+        input = (float *)malloc(sizeof(float) * NUMSAMPLES * MAX_NUM_CHANNELS);
+        srand(0);
+        for (i = 0; i < NUMSAMPLES * MAX_NUM_CHANNELS; i++) {
+            input[i] = 2.0f * ((float)rand() / RAND_MAX - 0.5f);
+        }
+
+        for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+            const uint32_t num_buffer_samples = R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(MAX_NUM_INPUT_SAMPLES, rates[r][0], rates[r][1]);
+            const uint32_t max_num_outputs = 2 * R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(NUMSAMPLES, rates[r][0], rates[r][1]);
+            output[0] = (float *)malloc(sizeof(float) * max_num_outputs * MAX_NUM_CHANNELS);
+            output[1] = (float *)malloc(sizeof(float) * max_num_outputs * MAX_NUM_CHANNELS);
+            for (m = 0; m < 2; m++) {
+                for (c = 1; c <= MAX_NUM_CHANNELS; c++) {
+                    uint32_t k, num_outputs[2];
+                    int32_t work_size[2];
+                    struct R2samplerRateConverter *converter[2];
+                    struct R2samplerRateConverterConfig config;
+
+                    config.max_num_input_samples = MAX_NUM_INPUT_SAMPLES;
+                    config.input_rate = rates[r][0];
+                    config.output_rate = rates[r][1];
+                    config.filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+                    config.filter_order = 255;
+                    config.filter_cache = NULL;
+                    config.convolution_method = (m == 0) ? R2SAMPLER_CONVOLUTION_DIRECT : R2SAMPLER_CONVOLUTION_FFT;
+                    config.filter_phase = R2SAMPLER_FILTERPHASE_LINEAR;
+                    config.allocator = NULL;
+
+                    /* 通常モードと省メモリモード */
+                    for (k = 0; k < 2; k++) {
+                        uint32_t smpl, num_process_outputs;
+                        config.memory_mode = (k == 0) ? R2SAMPLER_MEMORYMODE_NORMAL : R2SAMPLER_MEMORYMODE_COMPACT;
+                        work_size[k] = R2samplerRateConverter_CalculateMultiChannelWorkSize(&config, c);
+                        ASSERT_TRUE(work_size[k] > 0);
+                        converter[k] = R2samplerRateConverter_CreateMultiChannel(&config, c, NULL, 0);
+                        ASSERT_TRUE(converter[k] != NULL);
+                        num_outputs[k] = 0;
+                        for (smpl = 0; smpl < NUMSAMPLES; smpl += MAX_NUM_INPUT_SAMPLES) {
+                            const uint32_t num_process_samples = R2SAMPLERRATECONVERTER_MIN(MAX_NUM_INPUT_SAMPLES, NUMSAMPLES - smpl);
+                            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                                    R2samplerRateConverter_ProcessInterleaved(converter[k],
+                                        &input[smpl * c], num_process_samples,
+                                        &output[k][num_outputs[k] * c], num_buffer_samples, &num_process_outputs));
+                            num_outputs[k] += num_process_outputs;
+                        }
+                        /* ドレインも1回の出力が制限されるだけで同じ長さ */
+                        do {
+                            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                                    R2samplerRateConverter_Drain(converter[k],
+                                        &output[k][num_outputs[k] * c], num_buffer_samples, &num_process_outputs));
+                            num_outputs[k] += num_process_outputs;
+                        } while (num_process_outputs > 0);
+                        ASSERT_TRUE(num_outputs[k] <= max_num_outputs);
+                    }
+
+                    /* 省メモリモードではディレイバッファが最大入力サンプル数によらない */
+                    EXPECT_TRUE(work_size[1] < work_size[0]);
+                    EXPECT_TRUE(converter[1]->max_num_block_samples < MAX_NUM_INPUT_SAMPLES);
+
+                    /* 出力は一致（直接畳み込みでは演算順序も同じ） */
+                    ASSERT_EQ(num_outputs[0], num_outputs[1]);
+                    for (i = 0; i < num_outputs[0] * c; i++) {
+                        if (m == 0) {
+                            ASSERT_FLOAT_EQ(output[0][i], output[1][i]);
+                        } else {
+                            ASSERT_NEAR(output[0][i], output[1][i], 1.0e-4);
+                        }
+                    }
+
+                    R2samplerRateConverter_Destroy(converter[0]);
+                    R2samplerRateConverter_Destroy(converter[1]);
+                }
+            }
+            free(output[0]);
+            free(output[1]);
+        }
+
+        free(input);
+#undef NUMSAMPLES
+#undef MAX_NUM_INPUT_SAMPLES
+#undef MAX_NUM_CHANNELS
+    }
+
+    /* 不正なモード */
+    {
+        struct R2samplerRateConverterConfig config;
+        R2samplerRateConverter_SetValidConfig(&config);
+        config.memory_mode = (R2samplerMemoryMode)-1;
+        EXPECT_TRUE(R2samplerRateConverter_CalculateWorkSize(&config) < 0);
+        EXPECT_TRUE(R2samplerRateConverter_Create(&config, NULL, 0) == NULL);
+    }
+}
+
+/* ワークサイズの内訳テスト */
+TEST(R2samplerRateConverterTest, WorkSizeBreakdownTest)
+{
+    /* 内訳の合計はワークサイズに一致 */
+    {
+        uint32_t m, k;
+        for (m = 0; m < 2; m++) {
+            for (k = 0; k < 2; k++) {
+                struct R2samplerWorkSizeBreakdown breakdown;
+                struct R2samplerRateConverterConfig config;
+
+                R2samplerRateConverter_SetValidConfig(&config);
+                config.max_num_input_samples = 4096;
+                config.filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+                config.filter_order = 255;
+                config.convolution_method = (m == 0) ? R2SAMPLER_CONVOLUTION_DIRECT : R2SAMPLER_CONVOLUTION_FFT;
+                config.memory_mode = (k == 0) ? R2SAMPLER_MEMORYMODE_NORMAL : R2SAMPLER_MEMORYMODE_COMPACT;
+                ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerRateConverter_CalculateWorkSizeBreakdown(&config, &breakdown));
+                EXPECT_EQ(R2samplerRateConverter_CalculateWorkSize(&config), breakdown.total);
+                EXPECT_EQ(breakdown.total,
+                        breakdown.coefficients + breakdown.history + breakdown.staging + breakdown.design + breakdown.other);
+                EXPECT_TRUE(breakdown.coefficients > 0);
+                EXPECT_TRUE(breakdown.history > 0);
+                EXPECT_TRUE(breakdown.design > 0);
+                EXPECT_TRUE(breakdown.other >= (int32_t)sizeof(struct R2samplerRateConverter));
+                /* 直接畳み込みでは受け渡し用の領域は不要 */
+                if (m == 0) {
+                    EXPECT_EQ(0, breakdown.staging);
+                } else {
+                    EXPECT_TRUE(breakdown.staging > 0);
+                }
+            }
+        }
+    }
+
+    /* キャッシュで共有する係数は含まない */
+    {
+        struct R2samplerFilterCache *cache;
+        struct R2samplerFilterCacheConfig cache_config;
+        struct R2samplerWorkSizeBreakdown breakdown;
+        struct R2samplerRateConverterConfig config;
+
+        cache_config.max_num_entries = 1;
+        cache_config.max_num_coefficients = 4096;
+        cache_config.lock = NULL;
+        cache_config.unlock = NULL;
+        cache_config.lock_context = NULL;
+        cache_config.allocator = NULL;
+        cache = R2samplerFilterCache_Create(&cache_config, NULL, 0);
+        ASSERT_TRUE(cache != NULL);
+
+        R2samplerRateConverter_SetValidConfig(&config);
+        config.filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
+        config.filter_order = 255;
+        config.filter_cache = cache;
+        ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerRateConverter_CalculateWorkSizeBreakdown(&config, &breakdown));
+        EXPECT_EQ(0, breakdown.coefficients);
+        EXPECT_EQ(R2samplerRateConverter_CalculateWorkSize(&config), breakdown.total);
+
+        R2samplerFilterCache_Destroy(cache);
+    }
+
+    /* 不正な引数 */
+    {
+        struct R2samplerWorkSizeBreakdown breakdown;
+        struct R2samplerRateConverterConfig config;
+
+        R2samplerRateConverter_SetValidConfig(&config);
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerRateConverter_CalculateWorkSizeBreakdown(NULL, &breakdown));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerRateConverter_CalculateWorkSizeBreakdown(&config, NULL));
+        config.input_rate = 0;
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerRateConverter_CalculateWorkSizeBreakdown(&config, &breakdown));
+    }
+}
@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 #include <gtest/gtest.h>
 
@@ -8,3 +9,385 @@ extern "C" {
 #include "../../libs/r2sampler_rate_converter/src/r2sampler_utility.c"
 }
 
+
+/* 振幅応答の計算 */
+static double R2samplerUtilityTest_CalculateAmplitude(const float *coef, uint32_t num_coef, double freq)
+{
+    uint32_t i;
+    double re = 0.0, im = 0.0;
+    for (i = 0; i < num_coef; i++) {
+        re += coef[i] * cos(2.0 * R2SAMPLER_PI * freq * i);
+        im -= coef[i] * sin(2.0 * R2SAMPLER_PI * freq * i);
+    }
+    return sqrt(re * re + im * im);
+}
+
+/* 三角関数・ベッセル関数を係数ごとに直接計算する参照実装 */
+static double R2samplerUtilityTest_ReferenceWindow(R2samplerLPFWindowType window_type, double x)
+{
+    const double a = 2.0 * R2SAMPLER_PI * x;
+    switch (window_type) {
+    case R2SAMPLERLPF_WINDOW_TYPE_RECTANGULAR:
+        return 1.0;
+    case R2SAMPLERLPF_WINDOW_TYPE_HANN:
+        return 0.5 - 0.5 * cos(a);
+    case R2SAMPLERLPF_WINDOW_TYPE_BLACKMAN:
+        return 0.42 - 0.5 * cos(a) + 0.08 * cos(2.0 * a);
+    case R2SAMPLERLPF_WINDOW_TYPE_NUTTALL:
+        return 0.355768 - 0.487396 * cos(a) + 0.144232 * cos(2.0 * a) - 0.012604 * cos(3.0 * a);
+    case R2SAMPLERLPF_WINDOW_TYPE_BLACKMANNUTTALL:
+        return 0.3635819 - 0.4891775 * cos(a) + 0.1365995 * cos(2.0 * a) - 0.0106411 * cos(3.0 * a);
+    default:
+        assert(0);
+    }
+    return 0.0;
+}
+
+static double R2samplerUtilityTest_ReferenceBesselI0(double x)
+{
+    uint32_t k;
+    double term = 1.0, sum = 1.0;
+    for (k = 1; k < 256; k++) {
+        term *= (x / 2.0) / k;
+        sum += term * term;
+        if ((term * term) < (sum * 1.0e-16)) {
+            break;
+        }
+    }
+    return sum;
+}
+
+static void R2samplerUtilityTest_ReferenceLPF(
+        float cutoff, R2samplerLPFWindowType window_type, double kaiser_beta, float *filter_coef, uint32_t filter_order)
+{
+    uint32_t i;
+    const double half = (filter_order - 1.0) / 2.0;
+    for (i = 0; i < filter_order; i++) {
+        const double x = 2.0 * R2SAMPLER_PI * cutoff * (i - half);
+        double coef = 2.0 * cutoff * ((fabs(x) > 1.0e-8) ? (sin(x) / x) : 1.0);
+        if (filter_order > 1) {
+            const double t = (double)i / (filter_order - 1.0);
+            if (kaiser_beta >= 0.0) {
+                coef *= R2samplerUtilityTest_ReferenceBesselI0(kaiser_beta * sqrt(fmax(1.0 - (2.0 * t - 1.0) * (2.0 * t - 1.0), 0.0)))
+                    / R2samplerUtilityTest_ReferenceBesselI0(kaiser_beta);
+            } else {
+                coef *= R2samplerUtilityTest_ReferenceWindow(window_type, t);
+            }
+        }
+        filter_coef[i] = (float)coef;
+    }
+}
+
+/* 窓関数によるLPF設計の参照実装との比較テスト */
+TEST(R2samplerUtilityTest, WindowFunctionDesignTest)
+{
+    /* 参照実装と一致するか */
+    {
+        static const uint32_t orders[] = { 1, 3, 63, 1023, 16385 };
+        static const float cutoffs[] = { 0.0f, 0.1f, 0.25f, 0.45f };
+        static const double betas[] = { 0.0, 3.0, 8.0, 14.0 };
+        uint32_t o, c, w, b, i;
+
+        for (o = 0; o < sizeof(orders) / sizeof(orders[0]); o++) {
+            const uint32_t order = orders[o];
+            float *coef = (float *)malloc(sizeof(float) * order);
+            float *ref = (float *)malloc(sizeof(float) * order);
+            for (c = 0; c < sizeof(cutoffs) / sizeof(cutoffs[0]); c++) {
+                for (w = 0; w < R2SAMPLERLPF_WINDOW_TYPE_INVALID; w++) {
+                    R2sampler_CreateLPFByWindowFunction(cutoffs[c], (R2samplerLPFWindowType)w, coef, order);
+                    R2samplerUtilityTest_ReferenceLPF(cutoffs[c], (R2samplerLPFWindowType)w, -1.0, ref, order);
+                    for (i = 0; i < order; i++) {
+                        ASSERT_NEAR(ref[i], coef[i], 1.0e-6);
+                    }
+                }
+                for (b = 0; b < sizeof(betas) / sizeof(betas[0]); b++) {
+                    R2sampler_CreateLPFByKaiserWindow(cutoffs[c], betas[b], coef, order);
+                    R2samplerUtilityTest_ReferenceLPF(cutoffs[c], R2SAMPLERLPF_WINDOW_TYPE_RECTANGULAR, betas[b], ref, order);
+                    for (i = 0; i < order; i++) {
+                        ASSERT_NEAR(ref[i], coef[i], 1.0e-6);
+                    }
+                }
+            }
+            free(coef);
+            free(ref);
+        }
+    }
+}
+
+/* カイザー窓によるLPF設計テスト */
+TEST(R2samplerUtilityTest, KaiserWindowTest)
+{
+    /* 次数計算 */
+    {
+        EXPECT_EQ(1, R2sampler_CalculateKaiserFilterOrder(60.0, 0.05) % 2);
+        EXPECT_EQ(1, R2sampler_CalculateKaiserFilterOrder(60.0, 0.02) % 2);
+        /* 減衰量が大きい・遷移帯域が狭いほど次数が増える */
+        EXPECT_LT(R2sampler_CalculateKaiserFilterOrder(40.0, 0.05), R2sampler_CalculateKaiserFilterOrder(80.0, 0.05));
+        EXPECT_LT(R2sampler_CalculateKaiserFilterOrder(60.0, 0.05), R2sampler_CalculateKaiserFilterOrder(60.0, 0.02));
+        /* βは減衰量に対して単調増加し、低い減衰量では矩形窓 */
+        EXPECT_EQ(0.0, R2sampler_CalculateKaiserBeta(20.0));
+        EXPECT_LT(R2sampler_CalculateKaiserBeta(30.0), R2sampler_CalculateKaiserBeta(60.0));
+    }
+
+    /* 設計したフィルタが仕様を満たすか */
+    {
+        static const double attenuations[] = { 30.0, 50.0, 80.0, 100.0 };
+        static const double transition_widths[] = { 0.1, 0.05, 0.02 };
+        const double cutoff = 0.2;
+        uint32_t a, t, i;
+
+        for (a = 0; a < sizeof(attenuations) / sizeof(attenuations[0]); a++) {
+            for (t = 0; t < sizeof(transition_widths) / sizeof(transition_widths[0]); t++) {
+                const double attenuation = attenuations[a];
+                const double width = transition_widths[t];
+                /* Kaiserの経験式による誤差を1.5dB許容 */
+                const double delta = pow(10.0, -(attenuation - 1.5) / 20.0);
+                const uint32_t order = R2sampler_CalculateKaiserFilterOrder(attenuation, width);
+                float *coef = (float *)malloc(sizeof(float) * order);
+
+                R2sampler_CreateLPFByKaiserWindow((float)cutoff,
+                        R2sampler_CalculateKaiserBeta(attenuation), coef, order);
+
+                /* 偶対称 */
+                for (i = 0; i < order / 2; i++) {
+                    EXPECT_FLOAT_EQ(coef[i], coef[order - i - 1]);
+                }
+
+                /* 通過域のリップル */
+                for (i = 0; i <= 100; i++) {
+                    const double freq = (cutoff - width / 2.0) * i / 100.0;
+                    EXPECT_NEAR(1.0, R2samplerUtilityTest_CalculateAmplitude(coef, order, freq), delta);
+                }
+
+                /* 阻止域の減衰量 */
+                for (i = 0; i <= 200; i++) {
+                    const double freq = (cutoff + width / 2.0) + (0.5 - (cutoff + width / 2.0)) * i / 200.0;
+                    EXPECT_LE(R2samplerUtilityTest_CalculateAmplitude(coef, order, freq), delta);
+                }
+
+                free(coef);
+            }
+        }
+    }
+}
+
+/* Parks-McClellan法によるLPF設計テスト */
+TEST(R2samplerUtilityTest, RemezTest)
+{
+    /* 次数計算 */
+    {
+        EXPECT_EQ(1, R2sampler_CalculateEquirippleFilterOrder(60.0, 0.05) % 2);
+        EXPECT_LT(R2sampler_CalculateEquirippleFilterOrder(40.0, 0.05), R2sampler_CalculateEquirippleFilterOrder(80.0, 0.05));
+        EXPECT_LT(R2sampler_CalculateEquirippleFilterOrder(60.0, 0.05), R2sampler_CalculateEquirippleFilterOrder(60.0, 0.02));
+        /* 同じ仕様ならカイザー窓より少ない次数 */
+        EXPECT_LT(R2sampler_CalculateEquirippleFilterOrder(80.0, 0.02), R2sampler_CalculateKaiserFilterOrder(80.0, 0.02));
+        /* ワークサイズ */
+        EXPECT_TRUE(R2sampler_CalculateRemezWorkSize(31) > 0);
+        EXPECT_TRUE(R2sampler_CalculateRemezWorkSize(32) < 0);
+    }
+
+    /* 設計したフィルタが等リップルで仕様を満たすか */
+    {
+        static const double attenuations[] = { 40.0, 60.0, 80.0, 100.0 };
+        static const double transition_widths[] = { 0.1, 0.05, 0.02 };
+        static const double stopband_weights[] = { 1.0, 10.0 };
+        const double cutoff = 0.2;
+        uint32_t a, t, w, i;
+
+        for (a = 0; a < sizeof(attenuations) / sizeof(attenuations[0]); a++) {
+            for (t = 0; t < sizeof(transition_widths) / sizeof(transition_widths[0]); t++) {
+                for (w = 0; w < sizeof(stopband_weights) / sizeof(stopband_weights[0]); w++) {
+                    const double attenuation = attenuations[a];
+                    const double width = transition_widths[t];
+                    const double passband_edge = cutoff - width / 2.0;
+                    const double stopband_edge = cutoff + width / 2.0;
+                    const uint32_t order = R2sampler_CalculateEquirippleFilterOrder(attenuation, width);
+                    const int32_t work_size = R2sampler_CalculateRemezWorkSize(order);
+                    float *coef = (float *)malloc(sizeof(float) * order);
+                    void *work = malloc(work_size);
+                    double delta, max_pass_error, max_stop_amp;
+
+                    delta = R2sampler_CreateLPFByRemez(passband_edge, stopband_edge, stopband_weights[w],
+                            coef, order, work, work_size);
+                    ASSERT_GT(delta, 0.0);
+
+                    /* 偶対称 */
+                    for (i = 0; i < order / 2; i++) {
+                        EXPECT_FLOAT_EQ(coef[i], coef[order - i - 1]);
+                    }
+
+                    /* 各帯域の最大誤差 */
+                    max_pass_error = max_stop_amp = 0.0;
+                    for (i = 0; i <= 2000; i++) {
+                        const double pfreq = passband_edge * i / 2000.0;
+                        const double sfreq = stopband_edge + (0.5 - stopband_edge) * i / 2000.0;
+                        max_pass_error = fmax(max_pass_error, fabs(1.0 - R2samplerUtilityTest_CalculateAmplitude(coef, order, pfreq)));
+                        max_stop_amp = fmax(max_stop_amp, R2samplerUtilityTest_CalculateAmplitude(coef, order, sfreq));
+                    }
+
+                    /* 戻り値の誤差と一致（等リップル）: グリッド間の誤差と係数の単精度丸め分を許容 */
+                    EXPECT_NEAR(delta, max_pass_error, 0.1 * delta);
+                    EXPECT_NEAR(delta / stopband_weights[w], max_stop_amp, 0.1 * delta / stopband_weights[w]);
+
+                    /* 推定次数でおおよそ減衰量を満たす（推定式の誤差を2dB許容） */
+                    if (stopband_weights[w] == 1.0) {
+                        EXPECT_LE(max_stop_amp, pow(10.0, -(attenuation - 2.0) / 20.0));
+                    }
+
+                    free(work);
+                    free(coef);
+                }
+            }
+        }
+    }
+}
+
+/* 重み付き最小二乗法によるLPF設計テスト */
+TEST(R2samplerUtilityTest, LeastSquaresTest)
+{
+/* 阻止域の平均電力 */
+#define CALCULATE_STOPBAND_POWER(coef, order, stopband_edge, power)\
+    do {\
+        uint32_t i__;\
+        (power) = 0.0;\
+        for (i__ = 0; i__ <= 1000; i__++) {\
+            const double amp__ = R2samplerUtilityTest_CalculateAmplitude(coef, order,\
+                    (stopband_edge) + (0.5 - (stopband_edge)) * i__ / 1000.0);\
+            (power) += amp__ * amp__ / 1001.0;\
+        }\
+    } while (0);
+
+    /* ワークサイズ */
+    EXPECT_TRUE(R2sampler_CalculateLeastSquaresWorkSize(31) > 0);
+    EXPECT_TRUE(R2sampler_CalculateLeastSquaresWorkSize(32) < 0);
+
+    /* 同じ次数の窓関数法より阻止域の電力が小さい */
+    {
+        static const uint32_t orders[] = { 31, 63, 127, 255 };
+        static const double transition_widths[] = { 0.1, 0.05, 0.02 };
+        const double cutoff = 0.2;
+        uint32_t o, t, i;
+
+        for (o = 0; o < sizeof(orders) / sizeof(orders[0]); o++) {
+            for (t = 0; t < sizeof(transition_widths) / sizeof(transition_widths[0]); t++) {
+                const uint32_t order = orders[o];
+                const double stopband_edge = cutoff + transition_widths[t] / 2.0;
+                const int32_t work_size = R2sampler_CalculateLeastSquaresWorkSize(order);
+                float *coef = (float *)malloc(sizeof(float) * order);
+                float *window_coef = (float *)malloc(sizeof(float) * order);
+                void *work = malloc(work_size);
+                double power, window_power;
+
+                R2sampler_CreateLPFByLeastSquares(cutoff - transition_widths[t] / 2.0, stopband_edge, 1.0,
+                        coef, order, work, work_size);
+                R2sampler_CreateLPFByWindowFunction((float)cutoff, R2SAMPLERLPF_WINDOW_TYPE_BLACKMAN, window_coef, order);
+
+                /* 偶対称 */
+                for (i = 0; i < order / 2; i++) {
+                    EXPECT_FLOAT_EQ(coef[i], coef[order - i - 1]);
+                }
+
+                CALCULATE_STOPBAND_POWER(coef, order, stopband_edge, power);
+                CALCULATE_STOPBAND_POWER(window_coef, order, stopband_edge, window_power);
+                EXPECT_LT(power, window_power);
+
+                free(work);
+                free(window_coef);
+                free(coef);
+            }
+        }
+    }
+
+    /* 阻止域の重みを大きくすると阻止域の電力が下がる */
+    {
+        const uint32_t order = 63;
+        const double passband_edge = 0.175, stopband_edge = 0.225;
+        const int32_t work_size = R2sampler_CalculateLeastSquaresWorkSize(order);
+        float coef[63];
+        void *work = malloc(work_size);
+        double prev_power = 1.0, power;
+        static const double weights[] = { 0.1, 1.0, 10.0, 100.0 };
+        uint32_t w;
+
+        for (w = 0; w < sizeof(weights) / sizeof(weights[0]); w++) {
+            R2sampler_CreateLPFByLeastSquares(passband_edge, stopband_edge, weights[w], coef, order, work, work_size);
+            CALCULATE_STOPBAND_POWER(coef, order, stopband_edge, power);
+            EXPECT_LT(power, prev_power);
+            prev_power = power;
+        }
+
+        free(work);
+    }
+
+#undef CALCULATE_STOPBAND_POWER
+}
+
+/* 最小位相化テスト */
+TEST(R2samplerUtilityTest, MinimumPhaseTest)
+{
+    /* ワークサイズ */
+    EXPECT_TRUE(R2sampler_CalculateMinimumPhaseWorkSize(31) > 0);
+    EXPECT_TRUE(R2sampler_CalculateMinimumPhaseWorkSize(0) < 0);
+
+    /* 振幅特性を保ったまま係数が先頭に集中する */
+    {
+        static const uint32_t orders[] = { 31, 63, 255, 1023 };
+        static const double attenuations[] = { 60.0, 100.0 };
+        const double cutoff = 0.1;
+        uint32_t o, a, i;
+
+        for (o = 0; o < sizeof(orders) / sizeof(orders[0]); o++) {
+            for (a = 0; a < sizeof(attenuations) / sizeof(attenuations[0]); a++) {
+                const uint32_t order = orders[o];
+                const int32_t work_size = R2sampler_CalculateMinimumPhaseWorkSize(order);
+                float *coef = (float *)malloc(sizeof(float) * order);
+                float *linear_coef = (float *)malloc(sizeof(float) * order);
+                void *work = malloc(work_size);
+                double sum, moment, max_stopband, max_linear_stopband;
+
+                R2sampler_CreateLPFByKaiserWindow((float)cutoff,
+                        R2sampler_CalculateKaiserBeta(attenuations[a]), linear_coef, order);
+                memcpy(coef, linear_coef, sizeof(float) * order);
+                R2sampler_ConvertToMinimumPhase(coef, order, work, work_size);
+
+                /* 通過域の振幅は一致 */
+                for (i = 0; i <= 100; i++) {
+                    const double freq = 0.5 * cutoff * i / 100.0;
+                    EXPECT_NEAR(R2samplerUtilityTest_CalculateAmplitude(linear_coef, order, freq),
+                            R2samplerUtilityTest_CalculateAmplitude(coef, order, freq), 1.0e-3);
+                }
+
+                /* 阻止域の最大振幅もほぼ変わらない（3dB以内） */
+                max_stopband = max_linear_stopband = 0.0;
+                for (i = 0; i <= 1000; i++) {
+                    const double freq = 0.2 + 0.3 * i / 1000.0;
+                    max_stopband = R2SAMPLER_MAX(max_stopband, R2samplerUtilityTest_CalculateAmplitude(coef, order, freq));
+                    max_linear_stopband = R2SAMPLER_MAX(max_linear_stopband, R2samplerUtilityTest_CalculateAmplitude(linear_coef, order, freq));
+                }
+                EXPECT_LT(max_stopband, max_linear_stopband * sqrt(2.0) + 1.0e-6);
+
+                /* 直流の群遅延は線形位相（(order - 1) / 2）の半分未満 */
+                sum = moment = 0.0;
+                for (i = 0; i < order; i++) {
+                    sum += coef[i];
+                    moment += (double)i * coef[i];
+                }
+                EXPECT_LT(moment / sum, (order - 1) / 4.0);
+
+                free(work);
+                free(linear_coef);
+                free(coef);
+            }
+        }
+    }
+
+    /* 1タップのフィルタはそのまま */
+    {
+        float coef = 1.0f;
+        const int32_t work_size = R2sampler_CalculateMinimumPhaseWorkSize(1);
+        void *work = malloc(work_size);
+        R2sampler_ConvertToMinimumPhase(&coef, 1, work, work_size);
+        EXPECT_FLOAT_EQ(1.0f, coef);
+        free(work);
+    }
+}
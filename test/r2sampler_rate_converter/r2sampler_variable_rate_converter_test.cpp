@@ -0,0 +1,404 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <gtest/gtest.h>
+
+/* テスト対象のモジュール */
+extern "C" {
+#include "../../libs/r2sampler_rate_converter/src/r2sampler_variable_rate_converter.c"
+}
+
+/* 有効なコンフィグをセット */
+#define R2samplerVariableRateConverter_SetValidConfig(p_config)\
+    do {\
+        struct R2samplerVariableRateConverterConfig *config__p = p_config;\
+        config__p->max_num_input_samples = 64;\
+        config__p->num_channels          = 1;\
+        config__p->filter_type           = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;\
+        config__p->num_taps              = 32;\
+        config__p->num_phases            = 256;\
+        config__p->min_ratio             = 0.9;\
+        config__p->max_ratio             = 1.1;\
+        config__p->ratio                 = 1.0;\
+        config__p->allocator             = NULL;\
+    } while (0);
+
+/* 入力全体をブロック毎に変換 */
+static void R2samplerVariableRateConverterTest_ProcessAll(
+        struct R2samplerVariableRateConverter *converter, uint32_t num_channels,
+        const float *input, uint32_t num_input_samples, uint32_t block_size,
+        float *output, uint32_t num_buffer_samples, uint32_t *num_output_samples)
+{
+    uint32_t in_prog = 0, out_prog = 0;
+    while (in_prog < num_input_samples) {
+        uint32_t num_outputs;
+        const uint32_t num_process = (num_input_samples - in_prog < block_size) ? (num_input_samples - in_prog) : block_size;
+        ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                R2samplerVariableRateConverter_Process(converter,
+                    &input[in_prog * num_channels], num_process,
+                    &output[out_prog * num_channels], num_buffer_samples - out_prog, &num_outputs));
+        in_prog += num_process;
+        out_prog += num_outputs;
+    }
+    (*num_output_samples) = out_prog;
+}
+
+/* ハンドル作成・破棄テスト */
+TEST(R2samplerVariableRateConverterTest, CreateDestroyHandleTest)
+{
+    /* ワークサイズ計算テスト */
+    {
+        int32_t work_size;
+        struct R2samplerVariableRateConverterConfig config;
+
+        /* 最低限構造体本体よりは大きいはず */
+        R2samplerVariableRateConverter_SetValidConfig(&config);
+        work_size = R2samplerVariableRateConverter_CalculateWorkSize(&config);
+        ASSERT_TRUE(work_size > sizeof(struct R2samplerVariableRateConverter));
+
+        /* 不正な引数 */
+        EXPECT_TRUE(R2samplerVariableRateConverter_CalculateWorkSize(NULL) < 0);
+
+        /* 不正なコンフィグ */
+        R2samplerVariableRateConverter_SetValidConfig(&config);
+        config.max_num_input_samples = 0;
+        EXPECT_TRUE(R2samplerVariableRateConverter_CalculateWorkSize(&config) < 0);
+
+        R2samplerVariableRateConverter_SetValidConfig(&config);
+        config.num_channels = 0;
+        EXPECT_TRUE(R2samplerVariableRateConverter_CalculateWorkSize(&config) < 0);
+
+        R2samplerVariableRateConverter_SetValidConfig(&config);
+        config.num_taps = 31;
+        EXPECT_TRUE(R2samplerVariableRateConverter_CalculateWorkSize(&config) < 0);
+
+        R2samplerVariableRateConverter_SetValidConfig(&config);
+        config.num_phases = 0;
+        EXPECT_TRUE(R2samplerVariableRateConverter_CalculateWorkSize(&config) < 0);
+
+        R2samplerVariableRateConverter_SetValidConfig(&config);
+        config.min_ratio = 0.0;
+        EXPECT_TRUE(R2samplerVariableRateConverter_CalculateWorkSize(&config) < 0);
+
+        R2samplerVariableRateConverter_SetValidConfig(&config);
+        config.min_ratio = 1.2;
+        EXPECT_TRUE(R2samplerVariableRateConverter_CalculateWorkSize(&config) < 0);
+
+        R2samplerVariableRateConverter_SetValidConfig(&config);
+        config.ratio = 2.0;
+        EXPECT_TRUE(R2samplerVariableRateConverter_CalculateWorkSize(&config) < 0);
+
+        R2samplerVariableRateConverter_SetValidConfig(&config);
+        config.filter_type = R2SAMPLER_FILTERTYPE_NONE;
+        EXPECT_TRUE(R2samplerVariableRateConverter_CalculateWorkSize(&config) < 0);
+    }
+
+    /* ワーク領域渡しによるハンドル作成（成功例） */
+    {
+        void *work;
+        int32_t work_size;
+        struct R2samplerVariableRateConverter *converter;
+        struct R2samplerVariableRateConverterConfig config;
+
+        R2samplerVariableRateConverter_SetValidConfig(&config);
+        work_size = R2samplerVariableRateConverter_CalculateWorkSize(&config);
+        work = malloc(work_size);
+
+        converter = R2samplerVariableRateConverter_Create(&config, work, work_size);
+        ASSERT_TRUE(converter != NULL);
+        EXPECT_TRUE(converter->work == work);
+        EXPECT_EQ(0, converter->alloc_by_own);
+        EXPECT_TRUE(converter->history != NULL);
+        EXPECT_TRUE(converter->table != NULL);
+        EXPECT_TRUE(converter->delta_table != NULL);
+        EXPECT_EQ(config.num_taps, converter->num_taps);
+        EXPECT_EQ(config.num_phases, converter->num_phases);
+
+        R2samplerVariableRateConverter_Destroy(converter);
+        free(work);
+    }
+
+    /* 自前確保によるハンドル作成（成功例） */
+    {
+        struct R2samplerVariableRateConverter *converter;
+        struct R2samplerVariableRateConverterConfig config;
+
+        R2samplerVariableRateConverter_SetValidConfig(&config);
+        converter = R2samplerVariableRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        EXPECT_TRUE(converter->work != NULL);
+        EXPECT_EQ(1, converter->alloc_by_own);
+
+        R2samplerVariableRateConverter_Destroy(converter);
+    }
+
+    /* ハンドル作成（失敗ケース） */
+    {
+        void *work;
+        int32_t work_size;
+        struct R2samplerVariableRateConverterConfig config;
+
+        R2samplerVariableRateConverter_SetValidConfig(&config);
+        work_size = R2samplerVariableRateConverter_CalculateWorkSize(&config);
+        work = malloc(work_size);
+
+        /* 引数が不正 */
+        EXPECT_TRUE(R2samplerVariableRateConverter_Create(NULL, work, work_size) == NULL);
+        EXPECT_TRUE(R2samplerVariableRateConverter_Create(&config, NULL, work_size) == NULL);
+        EXPECT_TRUE(R2samplerVariableRateConverter_Create(&config, work, 0) == NULL);
+
+        /* ワークサイズ不足 */
+        EXPECT_TRUE(R2samplerVariableRateConverter_Create(&config, work, work_size - 1) == NULL);
+
+        /* コンフィグが不正 */
+        R2samplerVariableRateConverter_SetValidConfig(&config);
+        config.num_taps = 0;
+        EXPECT_TRUE(R2samplerVariableRateConverter_Create(&config, work, work_size) == NULL);
+
+        free(work);
+    }
+}
+
+/* 変換比設定テスト */
+TEST(R2samplerVariableRateConverterTest, SetRatioTest)
+{
+    struct R2samplerVariableRateConverter *converter;
+    struct R2samplerVariableRateConverterConfig config;
+    double ratio;
+
+    R2samplerVariableRateConverter_SetValidConfig(&config);
+    converter = R2samplerVariableRateConverter_Create(&config, NULL, 0);
+    ASSERT_TRUE(converter != NULL);
+
+    /* 初期値 */
+    EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerVariableRateConverter_GetRatio(converter, &ratio));
+    EXPECT_DOUBLE_EQ(config.ratio, ratio);
+
+    /* 即時切り替え */
+    EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerVariableRateConverter_SetRatio(converter, 1.05, 0));
+    EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerVariableRateConverter_GetRatio(converter, &ratio));
+    EXPECT_DOUBLE_EQ(1.05, ratio);
+
+    /* 遷移付きの設定は処理が進むまで反映されない */
+    EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerVariableRateConverter_SetRatio(converter, 0.95, 100));
+    EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerVariableRateConverter_GetRatio(converter, &ratio));
+    EXPECT_DOUBLE_EQ(1.05, ratio);
+
+    /* Startで初期値に戻る */
+    EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerVariableRateConverter_Start(converter));
+    EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerVariableRateConverter_GetRatio(converter, &ratio));
+    EXPECT_DOUBLE_EQ(config.ratio, ratio);
+
+    /* 範囲外の変換比 */
+    EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerVariableRateConverter_SetRatio(converter, 1.2, 0));
+    EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerVariableRateConverter_SetRatio(converter, 0.5, 0));
+    EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerVariableRateConverter_SetRatio(NULL, 1.0, 0));
+    EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INVALID_ARGUMENT, R2samplerVariableRateConverter_GetRatio(converter, NULL));
+
+    /* 出力バッファ不足 */
+    {
+        float input[64] = { 0.0f, }, output[64];
+        uint32_t num_outputs;
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_INSUFFICIENT_BUFFER,
+                R2samplerVariableRateConverter_Process(converter, input, 64, output, 64, &num_outputs));
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_TOOMANY_NUM_INPUTS,
+                R2samplerVariableRateConverter_Process(converter, input, 65, output, 64, &num_outputs));
+    }
+
+    R2samplerVariableRateConverter_Destroy(converter);
+}
+
+/* 変換比1では入力をそのまま出力 */
+TEST(R2samplerVariableRateConverterTest, IdentityTest)
+{
+#define NUM_SAMPLES 1000
+    struct R2samplerVariableRateConverter *converter;
+    struct R2samplerVariableRateConverterConfig config;
+    const uint32_t num_buffer_samples = NUM_SAMPLES + 2;
+    float input[NUM_SAMPLES], output[NUM_SAMPLES + 2];
+    uint32_t smpl, num_outputs;
+
+    R2samplerVariableRateConverter_SetValidConfig(&config);
+    config.min_ratio = config.max_ratio = config.ratio = 1.0;
+    converter = R2samplerVariableRateConverter_Create(&config, NULL, 0);
+    ASSERT_TRUE(converter != NULL);
+
+    srand(0);
+    for (smpl = 0; smpl < NUM_SAMPLES; smpl++) {
+        input[smpl] = 2.0f * ((float)rand() / RAND_MAX - 0.5f);
+    }
+
+    R2samplerVariableRateConverterTest_ProcessAll(converter, 1,
+            input, NUM_SAMPLES, 37, output, num_buffer_samples, &num_outputs);
+
+    /* 窓の後半分の先読みが必要 */
+    EXPECT_EQ(NUM_SAMPLES - config.num_taps / 2, num_outputs);
+    for (smpl = 0; smpl < num_outputs; smpl++) {
+        EXPECT_NEAR(input[smpl], output[smpl], 1e-5);
+    }
+
+    R2samplerVariableRateConverter_Destroy(converter);
+#undef NUM_SAMPLES
+}
+
+/* 非整数比（クロックドリフト相当）での正弦波の変換精度 */
+TEST(R2samplerVariableRateConverterTest, SineAccuracyTest)
+{
+#define NUM_SAMPLES 48000
+    static const double ratios[] = { 47998.7 / 48000.0, 48000.0 / 47998.7, 44100.0 / 48000.0, 1.0 / 1.03 };
+    const double omega = 2.0 * 3.14159265358979323846 * 1000.0 / 48000.0;
+    uint32_t r, smpl;
+    float *input, *output;
+
+    input = (float *)malloc(sizeof(float) * NUM_SAMPLES);
+    output = (float *)malloc(sizeof(float) * (NUM_SAMPLES * 2));
+    for (smpl = 0; smpl < NUM_SAMPLES; smpl++) {
+        input[smpl] = (float)sin(omega * smpl);
+    }
+
+    for (r = 0; r < sizeof(ratios) / sizeof(ratios[0]); r++) {
+        struct R2samplerVariableRateConverter *converter;
+        struct R2samplerVariableRateConverterConfig config;
+        uint32_t num_outputs;
+        double max_error = 0.0;
+
+        R2samplerVariableRateConverter_SetValidConfig(&config);
+        config.ratio = ratios[r];
+        converter = R2samplerVariableRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+
+        R2samplerVariableRateConverterTest_ProcessAll(converter, 1,
+                input, NUM_SAMPLES, config.max_num_input_samples, output, NUM_SAMPLES * 2, &num_outputs);
+
+        /* 出力数は概ね入力数 * 変換比 */
+        EXPECT_NEAR((NUM_SAMPLES - config.num_taps / 2) * ratios[r], (double)num_outputs, 2.0);
+
+        /* 立ち上がりを除いて出力m番目は入力時刻 m / ratio の値 */
+        for (smpl = config.num_taps; smpl < num_outputs; smpl++) {
+            const double error = fabs(sin(omega * smpl / ratios[r]) - output[smpl]);
+            max_error = (error > max_error) ? error : max_error;
+        }
+        EXPECT_LT(max_error, 1.0e-3);
+
+        R2samplerVariableRateConverter_Destroy(converter);
+    }
+
+    free(input);
+    free(output);
+#undef NUM_SAMPLES
+}
+
+/* 処理中の変換比変更で不連続が生じないか確認 */
+TEST(R2samplerVariableRateConverterTest, SmoothRatioChangeTest)
+{
+#define NUM_SAMPLES 20000
+    const double omega = 2.0 * 3.14159265358979323846 * 1000.0 / 48000.0;
+    struct R2samplerVariableRateConverter *converter;
+    struct R2samplerVariableRateConverterConfig config;
+    uint32_t smpl, in_prog, out_prog;
+    float *input, *output;
+    double ratio;
+
+    input = (float *)malloc(sizeof(float) * NUM_SAMPLES);
+    output = (float *)malloc(sizeof(float) * (NUM_SAMPLES * 2));
+    for (smpl = 0; smpl < NUM_SAMPLES; smpl++) {
+        input[smpl] = (float)sin(omega * smpl);
+    }
+
+    R2samplerVariableRateConverter_SetValidConfig(&config);
+    converter = R2samplerVariableRateConverter_Create(&config, NULL, 0);
+    ASSERT_TRUE(converter != NULL);
+
+    /* ブロック毎に変換比を変えながら変換 */
+    in_prog = out_prog = 0;
+    while (in_prog + config.max_num_input_samples <= NUM_SAMPLES) {
+        uint32_t num_outputs;
+        const double target = 1.0 + 0.08 * sin(0.01 * in_prog);
+        ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                R2samplerVariableRateConverter_SetRatio(converter, target, 50));
+        ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                R2samplerVariableRateConverter_Process(converter,
+                    &input[in_prog], config.max_num_input_samples,
+                    &output[out_prog], NUM_SAMPLES * 2 - out_prog, &num_outputs));
+        in_prog += config.max_num_input_samples;
+        out_prog += num_outputs;
+    }
+
+    for (smpl = 1; smpl < out_prog; smpl++) {
+        /* 隣接サンプル差は正弦波の最大傾き * 最大step以下（不連続があれば超える） */
+        EXPECT_LT(fabs(output[smpl] - output[smpl - 1]), omega / config.min_ratio + 1.0e-3);
+    }
+
+    /* 最終的に最後に設定した変換比に到達 */
+    {
+        uint32_t num_outputs;
+        float zeros[64] = { 0.0f, };
+        const double last = 1.0 + 0.08 * sin(0.01 * (in_prog - config.max_num_input_samples));
+        for (smpl = 0; smpl < 4; smpl++) {
+            ASSERT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK,
+                    R2samplerVariableRateConverter_Process(converter, zeros, 64, output, NUM_SAMPLES * 2, &num_outputs));
+        }
+        EXPECT_EQ(R2SAMPLERRATECONVERTER_APIRESULT_OK, R2samplerVariableRateConverter_GetRatio(converter, &ratio));
+        EXPECT_NEAR(last, ratio, 1.0e-12);
+    }
+
+    R2samplerVariableRateConverter_Destroy(converter);
+    free(input);
+    free(output);
+#undef NUM_SAMPLES
+}
+
+/* 複数チャンネルの変換結果は各チャンネルを個別に変換した結果と一致 */
+TEST(R2samplerVariableRateConverterTest, MultiChannelTest)
+{
+#define NUM_SAMPLES 2000
+#define NUM_CHANNELS 5
+    struct R2samplerVariableRateConverter *converter;
+    struct R2samplerVariableRateConverterConfig config;
+    uint32_t smpl, ch, num_outputs, ref_num_outputs;
+    float *input, *output, *mono_input, *mono_output;
+    const uint32_t num_buffer_samples = NUM_SAMPLES * 2;
+
+    input = (float *)malloc(sizeof(float) * NUM_SAMPLES * NUM_CHANNELS);
+    output = (float *)malloc(sizeof(float) * num_buffer_samples * NUM_CHANNELS);
+    mono_input = (float *)malloc(sizeof(float) * NUM_SAMPLES);
+    mono_output = (float *)malloc(sizeof(float) * num_buffer_samples);
+
+    srand(0);
+    for (smpl = 0; smpl < NUM_SAMPLES * NUM_CHANNELS; smpl++) {
+        input[smpl] = 2.0f * ((float)rand() / RAND_MAX - 0.5f);
+    }
+
+    R2samplerVariableRateConverter_SetValidConfig(&config);
+    config.ratio = 1.0 / 1.07;
+    config.num_channels = NUM_CHANNELS;
+    converter = R2samplerVariableRateConverter_Create(&config, NULL, 0);
+    ASSERT_TRUE(converter != NULL);
+    R2samplerVariableRateConverterTest_ProcessAll(converter, NUM_CHANNELS,
+            input, NUM_SAMPLES, 50, output, num_buffer_samples, &num_outputs);
+    R2samplerVariableRateConverter_Destroy(converter);
+
+    config.num_channels = 1;
+    for (ch = 0; ch < NUM_CHANNELS; ch++) {
+        converter = R2samplerVariableRateConverter_Create(&config, NULL, 0);
+        ASSERT_TRUE(converter != NULL);
+        for (smpl = 0; smpl < NUM_SAMPLES; smpl++) {
+            mono_input[smpl] = input[smpl * NUM_CHANNELS + ch];
+        }
+        R2samplerVariableRateConverterTest_ProcessAll(converter, 1,
+                mono_input, NUM_SAMPLES, 50, mono_output, num_buffer_samples, &ref_num_outputs);
+        ASSERT_EQ(ref_num_outputs, num_outputs);
+        for (smpl = 0; smpl < num_outputs; smpl++) {
+            EXPECT_NEAR(mono_output[smpl], output[smpl * NUM_CHANNELS + ch], 1e-5);
+        }
+        R2samplerVariableRateConverter_Destroy(converter);
+    }
+
+    free(input);
+    free(output);
+    free(mono_input);
+    free(mono_output);
+#undef NUM_SAMPLES
+#undef NUM_CHANNELS
+}
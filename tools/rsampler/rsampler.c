@@ -5,6 +5,7 @@
 
 #include <r2sampler.h>
 #include "wav.h"
+#include "fft.h"
 #include "command_line_parser.h"
 
 /* 最小値の選択 */
@@ -13,6 +14,13 @@
 #define RSAMPLER_MAX(a, b) (((a) > (b)) ? (a) : (b))
 /* 範囲内にクリップ */
 #define RSAMPLER_INNER_VAL(val, min, max) RSAMPLER_MIN(max, RSAMPLER_MAX(min, val))
+/* 円周率 */
+#define RSAMPLER_PI 3.14159265358979323846
+/* スペクトル変換モードのブロックの最小・最大FFTサイズ */
+#define RSAMPLER_SPECTRAL_MIN_BLOCK_SIZE (1UL << 16)
+#define RSAMPLER_SPECTRAL_MAX_BLOCK_SIZE (1UL << 23)
+/* スペクトル変換モードでブロックの前後に置くゼロ区間の割合（1/RSAMPLER_SPECTRAL_GUARD_DIVISOR） */
+#define RSAMPLER_SPECTRAL_GUARD_DIVISOR 16
 
 /* コマンドライン仕様 */
 static struct CommandLineParserSpecification command_line_spec[] = {
@@ -25,6 +33,12 @@ static struct CommandLineParserSpecification command_line_spec[] = {
     { 'q', "quality", COMMAND_LINE_PARSER_TRUE,
         "Specify resampling quality. 0:low(fast), ..., 9:high(slow), 10, ... (default:5)",
         "5", COMMAND_LINE_PARSER_TRUE },
+    { 's', "spectral", COMMAND_LINE_PARSER_FALSE,
+        "Use offline spectral resampling (FFT of overlapped long blocks, buffer-size is ignored)",
+        NULL, COMMAND_LINE_PARSER_FALSE },
+    { 'm', "minimum-phase", COMMAND_LINE_PARSER_FALSE,
+        "Use minimum-phase filters (lower latency, not linear phase)",
+        NULL, COMMAND_LINE_PARSER_FALSE },
     { 'h', "help", COMMAND_LINE_PARSER_FALSE,
         "Show command help message",
         NULL, COMMAND_LINE_PARSER_FALSE },
@@ -43,13 +57,14 @@ static double myround(double f)
 /* レート変換実行 */
 static int do_rate_convert(
         const char *input_file, const char *output_file,
-        uint32_t output_rate, uint32_t num_buffer_samples, uint32_t quality)
+        uint32_t output_rate, uint32_t num_buffer_samples, uint32_t quality, R2samplerFilterPhase filter_phase)
 {
     uint32_t ch, num_channels, num_samples, num_output_buffer_samples;
+    uint32_t in_progress, out_progress, num_skip_samples;
     struct WAVFile *inwav, *outwav;
     struct WAVFileFormat outformat;
     float *input_buffer, *output_buffer;
-    struct R2samplerMultiStageRateConverter **srcs;
+    struct R2samplerMultiChannelRateConverter *src;
 
     /* 入力wavファイルを開く */
     if ((inwav = WAV_CreateFromFile(input_file)) == NULL) {
@@ -69,67 +84,98 @@ static int do_rate_convert(
     /* 出力wavファイル作成 */
     outwav = WAV_Create(&outformat);
 
-    /* 変換バッファ作成 */
-    input_buffer = (float *)malloc(sizeof(float) * num_buffer_samples);
+    /* 変換バッファ作成（チャンネルインターリーブ） */
+    input_buffer = (float *)malloc(sizeof(float) * num_channels * num_buffer_samples);
     num_output_buffer_samples = R2SAMPLER_MAX_NUM_OUTPUT_SAMPLES(num_buffer_samples, inwav->format.sampling_rate, output_rate);
-    output_buffer = (float *)malloc(sizeof(float) * num_output_buffer_samples);
+    output_buffer = (float *)malloc(sizeof(float) * num_channels * num_output_buffer_samples);
 
-    /* レート変換器作成 */
+    /* レート変換器作成（全チャンネルで1つのハンドルを使用） */
     {
-        struct R2samplerMultiStageRateConverterConfig config;
-        config.single.max_num_input_samples = num_buffer_samples;
-        config.single.input_rate = inwav->format.sampling_rate;
-        config.single.output_rate = output_rate;
-        config.single.filter_type = R2SAMPLER_FILTERTYPE_LPF_BLACKMANWINDOW;
-        config.single.filter_order = 11 + quality * 20;
-        config.max_num_stages = R2SAMPLER_MAX_NUM_STAGES;
-
-        srcs = (struct R2samplerMultiStageRateConverter **)malloc(sizeof(struct R2samplerMultiStageRateConverter *) * num_channels);
-        for (ch = 0; ch < num_channels; ch++) {
-            if ((srcs[ch] = R2samplerMultiStageRateConverter_Create(&config, NULL, 0)) == NULL) {
-                fprintf(stderr, "Failed to create converter handle. \n");
-                return 1;
-            }
+        struct R2samplerMultiChannelRateConverterConfig config;
+        config.multi_stage.single.max_num_input_samples = num_buffer_samples;
+        config.multi_stage.single.input_rate = inwav->format.sampling_rate;
+        config.multi_stage.single.output_rate = output_rate;
+        /* 品質から阻止域減衰量を決め、それを満たす最小次数のフィルタを使用 */
+        config.multi_stage.single.filter_type = R2SAMPLER_FILTERTYPE_LPF_KAISERWINDOW;
+        config.multi_stage.single.filter_order = 0;
+        config.multi_stage.single.filter_cache = NULL;
+        /* 高品質（長いフィルタ）での整数倍アップサンプリングはFFTによる畳み込みが速い */
+        config.multi_stage.single.convolution_method
+            = ((quality >= 9) && ((output_rate % inwav->format.sampling_rate) == 0))
+            ? R2SAMPLER_CONVOLUTION_FFT : R2SAMPLER_CONVOLUTION_DIRECT;
+        config.multi_stage.single.filter_phase = filter_phase;
+        config.multi_stage.single.memory_mode = R2SAMPLER_MEMORYMODE_NORMAL;
+        config.multi_stage.single.allocator = NULL;
+        config.multi_stage.single.stopband_attenuation = 40.0 + 10.0 * quality;
+        config.multi_stage.single.transition_width = 0.2;
+        config.multi_stage.single.stopband_weight = 1.0;
+        config.multi_stage.max_num_stages = R2SAMPLER_MAX_NUM_STAGES;
+        config.num_channels = num_channels;
+        if ((src = R2samplerMultiChannelRateConverter_Create(&config, NULL, 0)) == NULL) {
+            fprintf(stderr, "Failed to create converter handle. \n");
+            return 1;
         }
     }
 
-    /* レート変換 */
-    for (ch = 0; ch < num_channels; ch++) {
-        uint32_t in_progress, out_progress;
-        in_progress = out_progress = 0;
-        R2samplerMultiStageRateConverter_Start(srcs[ch]);
-        while (in_progress < num_samples) {
-            uint32_t smpl, num_process_samples, num_output_samples;
-            R2samplerRateConverterApiResult ret;
+    /* レート変換（全チャンネルを1パスで処理） */
+    /* 先頭のフィルタの遅延分の出力を捨て、入力終了後は残りを出力して時間位置と長さを入力に揃える */
+    {
+        double latency;
+        (void)R2samplerMultiChannelRateConverter_GetLatency(src, &latency);
+        num_skip_samples = (uint32_t)myround(latency);
+    }
+    in_progress = out_progress = 0;
+    R2samplerMultiChannelRateConverter_Start(src);
+    while (out_progress < outformat.num_samples) {
+        uint32_t smpl, num_process_samples, num_output_samples, num_skip;
+        R2samplerRateConverterApiResult ret;
+        if (in_progress < num_samples) {
             /* 処理サンプル数 */
             num_process_samples = RSAMPLER_MIN(num_buffer_samples, num_samples - in_progress);
             /* floatに変換 */
             for (smpl = 0; smpl < num_process_samples; smpl++) {
-                input_buffer[smpl] = (float)(WAVFile_PCM(inwav, in_progress + smpl, ch) * pow(2.0f, -31));
+                for (ch = 0; ch < num_channels; ch++) {
+                    input_buffer[smpl * num_channels + ch] = (float)(WAVFile_PCM(inwav, in_progress + smpl, ch) * pow(2.0f, -31));
+                }
             }
             /* レート変換処理 */
-            if ((ret = R2samplerMultiStageRateConverter_Process(srcs[ch],
-                    input_buffer, num_process_samples,
-                    output_buffer, num_output_buffer_samples, &num_output_samples)) != R2SAMPLERRATECONVERTER_APIRESULT_OK) {
+            if ((ret = R2samplerMultiChannelRateConverter_Process(src,
+                    input_buffer, 1, num_channels, num_process_samples,
+                    output_buffer, 1, num_channels, num_output_buffer_samples, &num_output_samples)) != R2SAMPLERRATECONVERTER_APIRESULT_OK) {
                 fprintf(stderr, "Failed to process rate conversion. (api ret:%d) \n", ret);
                 return 1;
             }
-            /* 結果を整数に丸め込み */
-            for (smpl = 0; smpl < num_output_samples; smpl++) {
-                const int64_t pcm = (int64_t)myround(output_buffer[smpl] * pow(2.0f, 31));
-                WAVFile_PCM(outwav, out_progress + smpl, ch) = (int32_t)RSAMPLER_INNER_VAL(pcm, INT32_MIN, INT32_MAX);
-            }
             in_progress += num_process_samples;
-            out_progress += num_output_samples;
             /* 進捗表示 */
             if (in_progress % (num_buffer_samples * 50) == 0) {
-                printf("progress... %5.2f%% \r",
-                        ((in_progress + ch * num_samples) * 100.0f) / (num_channels * num_samples));
+                printf("progress... %5.2f%% \r", (in_progress * 100.0f) / num_samples);
                 fflush(stdout);
             }
+        } else {
+            /* 内部に残ったサンプルを出力 */
+            if ((ret = R2samplerMultiChannelRateConverter_Drain(src,
+                    output_buffer, 1, num_channels, num_output_buffer_samples, &num_output_samples)) != R2SAMPLERRATECONVERTER_APIRESULT_OK) {
+                fprintf(stderr, "Failed to drain rate converter. (api ret:%d) \n", ret);
+                return 1;
+            }
+            if (num_output_samples == 0) {
+                break;
+            }
+        }
+        /* 遅延分を捨てる */
+        num_skip = RSAMPLER_MIN(num_skip_samples, num_output_samples);
+        num_skip_samples -= num_skip;
+        /* 結果を整数に丸め込み */
+        num_output_samples = RSAMPLER_MIN(num_output_samples - num_skip, outformat.num_samples - out_progress);
+        for (smpl = 0; smpl < num_output_samples; smpl++) {
+            for (ch = 0; ch < num_channels; ch++) {
+                const int64_t pcm = (int64_t)myround(output_buffer[(num_skip + smpl) * num_channels + ch] * pow(2.0f, 31));
+                WAVFile_PCM(outwav, out_progress + smpl, ch) = (int32_t)RSAMPLER_INNER_VAL(pcm, INT32_MIN, INT32_MAX);
+            }
         }
-        assert(out_progress <= outwav->format.num_samples);
+        out_progress += num_output_samples;
     }
+    assert(out_progress <= outwav->format.num_samples);
 
     /* 結果出力 */
     if (WAV_WriteToFile(output_file, outwav) != WAV_APIRESULT_OK) {
@@ -140,10 +186,7 @@ static int do_rate_convert(
     printf("finished!                                \n");
 
     /* リソース破棄 */
-    for (ch = 0; ch < num_channels; ch++) {
-        R2samplerMultiStageRateConverter_Destroy(srcs[ch]);
-    }
-    free(srcs);
+    R2samplerMultiChannelRateConverter_Destroy(src);
     free(output_buffer);
     free(input_buffer);
     WAV_Destroy(outwav);
@@ -152,6 +195,201 @@ static int do_rate_convert(
     return 0;
 }
 
+/* 最大公約数 */
+static uint32_t calculate_gcd(uint32_t a, uint32_t b)
+{
+    while (b != 0) {
+        const uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* FFTプラン作成 領域は*workに確保する */
+static struct FFTPlan *create_fft_plan(uint32_t fft_size, void **work)
+{
+    int32_t work_size;
+    struct FFTPlanConfig config;
+    config.fft_size = fft_size;
+    config.max_batch_size = 1;
+    *work = NULL;
+    if ((work_size = FFTPlan_CalculateWorkSize(&config)) < 0) {
+        return NULL;
+    }
+    *work = malloc((size_t)work_size);
+    return FFTPlan_Create(&config, *work, work_size);
+}
+
+/* スペクトル変換によるレート変換実行
+* 入力を50%オーバーラップのハン窓で切り出し、前後にゼロを詰めた長さnum_in_block（入力レート/最大公約数の倍数）のブロックを
+* 実数FFTし、スペクトルを出力側の長さnum_out_blockに切り詰め（ゼロ拡張し）て逆FFTしたものを重ね合わせる
+* ブロック長の比は入出力レートの比に一致するので、ブロックの先頭は入出力で同じ時刻を指す */
+static int do_spectral_rate_convert(
+        const char *input_file, const char *output_file, uint32_t output_rate, uint32_t quality)
+{
+    uint32_t ch, i, j, num_channels, num_samples, num_blocks, num_output_samples;
+    uint32_t ratio_in, ratio_out, num_in_block = 0, num_out_block = 0, num_pass_bins;
+    uint32_t num_in_hop, num_out_hop, num_in_guard, num_out_guard;
+    double rolloff_width;
+    struct WAVFile *inwav, *outwav;
+    struct WAVFileFormat outformat;
+    struct FFTPlan *in_plan, *out_plan;
+    void *in_plan_work, *out_plan_work;
+    float *window, *in_block, *out_block, *output;
+
+    /* 入力wavファイルを開く */
+    if ((inwav = WAV_CreateFromFile(input_file)) == NULL) {
+        fprintf(stderr, "Failed to open wav file. \n");
+        return 1;
+    }
+    num_channels = inwav->format.num_channels;
+    num_samples = inwav->format.num_samples;
+
+    /* ブロック長の決定: 比を保ったまま両方ともFFT可能な長さで、ゼロ区間・ホップ長が整数となる最小のもの
+    * 倍数kは2・3・5の積に限り、低速な因数7の段を増やさない */
+    {
+        uint32_t k;
+        const uint32_t gcd = calculate_gcd(inwav->format.sampling_rate, output_rate);
+        ratio_in = inwav->format.sampling_rate / gcd;
+        ratio_out = output_rate / gcd;
+        for (k = RSAMPLER_SPECTRAL_GUARD_DIVISOR;
+                ((uint64_t)RSAMPLER_MAX(ratio_in, ratio_out) * k) <= RSAMPLER_SPECTRAL_MAX_BLOCK_SIZE;
+                k += RSAMPLER_SPECTRAL_GUARD_DIVISOR) {
+            struct FFTPlanConfig config;
+            config.max_batch_size = 1;
+            if (((ratio_in * k) < RSAMPLER_SPECTRAL_MIN_BLOCK_SIZE) || (FFTPlan_CalculateFastSize(k) != k)) {
+                continue;
+            }
+            config.fft_size = ratio_in * k;
+            if (FFTPlan_CalculateWorkSize(&config) < 0) {
+                continue;
+            }
+            config.fft_size = ratio_out * k;
+            if (FFTPlan_CalculateWorkSize(&config) < 0) {
+                continue;
+            }
+            num_in_block = ratio_in * k;
+            num_out_block = ratio_out * k;
+            break;
+        }
+        if (num_in_block == 0) {
+            fprintf(stderr, "Spectral resampling does not support this rate pair (%lu:%lu). \n",
+                    (unsigned long)ratio_in, (unsigned long)ratio_out);
+            return 1;
+        }
+    }
+    num_in_guard = num_in_block / RSAMPLER_SPECTRAL_GUARD_DIVISOR;
+    num_out_guard = num_out_block / RSAMPLER_SPECTRAL_GUARD_DIVISOR;
+    num_in_hop = (num_in_block - 2 * num_in_guard) / 2;
+    num_out_hop = (num_out_block - 2 * num_out_guard) / 2;
+
+    /* 通過させるビン数（低い方のレートのナイキスト周波数まで）とロールオフ幅（品質が高いほど狭くする） */
+    num_pass_bins = RSAMPLER_MIN(num_in_block, num_out_block) / 2;
+    rolloff_width = RSAMPLER_INNER_VAL(0.2 / (1.0 + quality), 0.002, 0.2);
+
+    /* 出力wavファイル作成 */
+    outformat = inwav->format;
+    outformat.sampling_rate = output_rate;
+    outformat.num_samples = num_output_samples = (uint32_t)(((uint64_t)num_samples * output_rate) / inwav->format.sampling_rate);
+    outwav = WAV_Create(&outformat);
+
+    /* FFTプラン・バッファ作成 */
+    in_plan = create_fft_plan(num_in_block, &in_plan_work);
+    out_plan = create_fft_plan(num_out_block, &out_plan_work);
+    if ((in_plan == NULL) || (out_plan == NULL)) {
+        fprintf(stderr, "Failed to create FFT plan. \n");
+        return 1;
+    }
+    /* ブロックiの窓の中心はi * num_in_hopで、窓は中心から前後num_in_hopの範囲 */
+    num_blocks = (num_samples + num_in_hop - 1) / num_in_hop + 1;
+    window = (float *)malloc(sizeof(float) * 2 * num_in_hop);
+    in_block = (float *)malloc(sizeof(float) * num_in_block);
+    out_block = (float *)malloc(sizeof(float) * num_out_block);
+    output = (float *)malloc(sizeof(float) * ((num_blocks - 1) * num_out_hop + num_out_block));
+
+    /* 50%オーバーラップで和が1になるハン窓 */
+    for (i = 0; i < 2 * num_in_hop; i++) {
+        window[i] = (float)(0.5 * (1.0 - cos(RSAMPLER_PI * i / num_in_hop)));
+    }
+
+    for (ch = 0; ch < num_channels; ch++) {
+        uint32_t blk;
+        /* 先頭ブロックの先頭（出力の-(num_out_hop + num_out_guard)番目）から蓄積 */
+        for (i = 0; i < (num_blocks - 1) * num_out_hop + num_out_block; i++) {
+            output[i] = 0.0f;
+        }
+        for (blk = 0; blk < num_blocks; blk++) {
+            /* ブロックの先頭の入力サンプル位置（負になりうる） */
+            const int64_t head = (int64_t)blk * num_in_hop - (int64_t)(num_in_hop + num_in_guard);
+            /* 窓をかけて切り出し 前後のゼロ区間は巡回畳み込みの回り込み防止 */
+            for (j = 0; j < num_in_block; j++) {
+                const int64_t t = head + j;
+                in_block[j] = 0.0f;
+                if ((j >= num_in_guard) && (j < num_in_guard + 2 * num_in_hop) && (t >= 0) && (t < num_samples)) {
+                    in_block[j] = (float)(WAVFile_PCM(inwav, (uint32_t)t, ch) * pow(2.0f, -31)) * window[j - num_in_guard];
+                }
+            }
+            FFTPlan_RealFFT(in_plan, -1, in_block);
+            /* スペクトルの切り詰め・ゼロ拡張 正規化（2/num_in_block）もここで行う */
+            for (j = 0; j < num_out_block / 2; j++) {
+                float gain = 0.0f;
+                const double f = (double)j / num_pass_bins;
+                if (f <= 1.0 - rolloff_width) {
+                    gain = 1.0f;
+                } else if (f < 1.0) {
+                    gain = (float)(0.5 * (1.0 + cos(RSAMPLER_PI * (f - (1.0 - rolloff_width)) / rolloff_width)));
+                }
+                gain *= 2.0f / (float)num_in_block;
+                if (j == 0) {
+                    /* 直流成分（最高周波数成分はロールオフにより0） */
+                    out_block[0] = gain * in_block[0];
+                    out_block[1] = 0.0f;
+                } else if (j < num_pass_bins) {
+                    out_block[2 * j] = gain * in_block[2 * j];
+                    out_block[2 * j + 1] = gain * in_block[2 * j + 1];
+                } else {
+                    out_block[2 * j] = out_block[2 * j + 1] = 0.0f;
+                }
+            }
+            FFTPlan_RealFFT(out_plan, 1, out_block);
+            /* 重ね合わせ */
+            for (j = 0; j < num_out_block; j++) {
+                output[blk * num_out_hop + j] += out_block[j];
+            }
+        }
+        /* 結果を整数に丸め込み */
+        for (i = 0; i < num_output_samples; i++) {
+            const int64_t pcm = (int64_t)myround(output[i + num_out_hop + num_out_guard] * pow(2.0f, 31));
+            WAVFile_PCM(outwav, i, ch) = (int32_t)RSAMPLER_INNER_VAL(pcm, INT32_MIN, INT32_MAX);
+        }
+        printf("progress... %5.2f%% \r", ((ch + 1) * 100.0f) / num_channels);
+        fflush(stdout);
+    }
+
+    /* 結果出力 */
+    if (WAV_WriteToFile(output_file, outwav) != WAV_APIRESULT_OK) {
+        fprintf(stderr, "Failed to write file. \n");
+        return 1;
+    }
+
+    printf("finished!                                \n");
+
+    /* リソース破棄 */
+    free(output);
+    free(out_block);
+    free(in_block);
+    free(window);
+    FFTPlan_Destroy(out_plan);
+    FFTPlan_Destroy(in_plan);
+    free(out_plan_work);
+    free(in_plan_work);
+    WAV_Destroy(outwav);
+    WAV_Destroy(inwav);
+
+    return 0;
+}
+
 /* 使用法の表示 */
 static void print_usage(char** argv)
 {
@@ -248,8 +486,19 @@ int main(int argc, char** argv)
         }
     }
 
+    /* スペクトル変換によるレート変換実行 */
+    if (CommandLineParser_GetOptionAcquired(command_line_spec, "spectral") == COMMAND_LINE_PARSER_TRUE) {
+        if (do_spectral_rate_convert(input_file, output_file, output_rate, quality) != 0) {
+            fprintf(stderr, "%s: failed to rate conversion. \n", argv[0]);
+            return 1;
+        }
+        return 0;
+    }
+
     /* レート変換実行 */
-    if (do_rate_convert(input_file, output_file, output_rate, num_buffer_samples, quality) != 0) {
+    if (do_rate_convert(input_file, output_file, output_rate, num_buffer_samples, quality,
+                (CommandLineParser_GetOptionAcquired(command_line_spec, "minimum-phase") == COMMAND_LINE_PARSER_TRUE)
+                ? R2SAMPLER_FILTERPHASE_MINIMUM : R2SAMPLER_FILTERPHASE_LINEAR) != 0) {
         fprintf(stderr, "%s: failed to rate conversion. \n", argv[0]);
         return 1;
     }